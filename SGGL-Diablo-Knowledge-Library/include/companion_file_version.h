@@ -0,0 +1,63 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_COMPANION_FILE_VERSION_H_
+#define SGGLDKL_COMPANION_FILE_VERSION_H_
+
+#include <wchar.h>
+
+#include "game_info.h"
+
+enum {
+  KNOWLEDGE_MAX_COMPANION_FILES = 32
+};
+
+enum KnowledgeCompanionFileStatus {
+  KNOWLEDGE_COMPANION_FILE_MATCHED,
+  KNOWLEDGE_COMPANION_FILE_MISMATCHED,
+  KNOWLEDGE_COMPANION_FILE_NOT_FOUND,
+  KNOWLEDGE_COMPANION_FILE_READ_FAILED
+};
+
+/*
+* The version of one of the game's libraries. A library is matched if
+* its file version is the same as that of the game executable. The
+* game version is that of the patch that ships the library's file
+* version, or -1 if no known patch does. The file name is static, and
+* must not be freed.
+*/
+struct KnowledgeCompanionFileVersion {
+  const wchar_t* file_name;
+
+  enum KnowledgeCompanionFileStatus status;
+  struct KnowledgeGameFileVersion file_version;
+  int game_version;
+};
+
+#endif /* SGGLDKL_COMPANION_FILE_VERSION_H_ */
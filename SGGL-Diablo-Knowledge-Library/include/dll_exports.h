@@ -27,20 +27,35 @@
  *  to convey the resulting work.
  */
 
-#ifndef SGGLKL_DLL_EXPORTS_H_
-#define SGGLKL_DLL_EXPORTS_H_
+#ifndef SGGLDKL_DLL_EXPORTS_H_
+#define SGGLDKL_DLL_EXPORTS_H_
 
 #include <stddef.h>
 #include <wchar.h>
 #include <windows.h>
 
+#include "companion_file_version.h"
 #include "dllexport_define.inc"
+#include "error_detail.h"
+#include "file_buffer.h"
+#include "game_info.h"
+#include "injection_progress.h"
+#include "injection_strategy.h"
+#include "library_load_result.h"
+#include "library_preflight_result.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
-DLLEXPORT void Knowledge_Init(
+/*
+* Failures are returned to the caller, and the reason can be retrieved
+* with Knowledge_GetLastErrorDetail, on the same thread. Functions that
+* return int return zero on failure, and functions that return a
+* pointer return NULL.
+*/
+
+DLLEXPORT int Knowledge_Init(
     const wchar_t* game_path,
     size_t game_path_len
 );
@@ -50,7 +65,136 @@ DLLEXPORT void Knowledge_Deinit(
     size_t num_instances
 );
 
-DLLEXPORT void Knowledge_PrintGameInfo(void);
+/*
+* Copies the last failure on the calling thread. Returns zero if no
+* failure has been recorded on the thread. The detail is not cleared by
+* successful calls, so it is only meaningful after a failure.
+*/
+DLLEXPORT int Knowledge_GetLastErrorDetail(
+    struct KnowledgeErrorDetail* error_detail
+);
+
+/*
+* Enables or disables exiting the process on a failure, after showing
+* a message box in debug builds, as was done before failures could be
+* returned. Disabled by default.
+*/
+DLLEXPORT void Knowledge_SetExitOnFailureEnabled(int is_enabled);
+
+DLLEXPORT int Knowledge_PrintGameInfo(void);
+
+/*
+* Fills the struct with the detected game, and how it was detected.
+* This does no heap allocation once the game has been detected, and is
+* safe to call from any thread.
+*/
+DLLEXPORT int Knowledge_GetGameInfo(struct KnowledgeGameInfo* game_info);
+
+/*
+* Fills the struct with the game running in the process, detected from
+* the images mapped in its memory instead of the files on disk, with
+* the same version tables as Knowledge_GetGameInfo. The handle needs
+* PROCESS_QUERY_INFORMATION and PROCESS_VM_READ access. The versions
+* told apart by Storm.dll need the game to have loaded it, so a process
+* that is still suspended at creation can only be detected by its
+* executable. Knowledge_Init does not need to be called first.
+*/
+DLLEXPORT int Knowledge_DetectFromProcess(
+    HANDLE process_handle,
+    struct KnowledgeGameInfo* game_info
+);
+
+/*
+* Fills the struct with the game detected from the contents of its
+* files, which the caller already holds in memory, with the same
+* version tables as Knowledge_GetGameInfo. The buffers are read in
+* place, and the file system is not accessed. The companion files that
+* some versions need, such as L"storm.dll", are looked up by name.
+* Knowledge_Init does not need to be called first.
+*/
+DLLEXPORT int Knowledge_DetectFromBuffers(
+    const void* game_data,
+    size_t game_size,
+    const struct KnowledgeFileBuffer* companion_buffers,
+    size_t num_companion_buffers,
+    struct KnowledgeGameInfo* game_info
+);
+
+/*
+* Knowledge_Init only records the game path, and the game is detected
+* on first use. This starts the detection on a worker thread instead,
+* so that it can overlap with the creation of the game processes. This
+* must be called after Knowledge_Init.
+*/
+DLLEXPORT int Knowledge_StartPrefetch(void);
+
+/*
+* Enables or disables the use of a shared memory control block for the
+* injection handshake, instead of polling the game thread's stack. This
+* must be called after Knowledge_Init. Disabled by default.
+*/
+DLLEXPORT void Knowledge_SetSharedMemoryTransportEnabled(int is_enabled);
+
+/*
+* Enables or disables reading the libraries to inject into the file
+* cache while the game processes are being patched, so that the payload
+* loads them from memory. The load times are recorded in the trace, to
+* compare with and without it. This must be called after Knowledge_Init.
+* Enabled by default.
+*/
+DLLEXPORT void Knowledge_SetLibraryReadAheadEnabled(int is_enabled);
+
+/*
+* Sets how the libraries are loaded into the game processes. With
+* KNOWLEDGE_INJECTION_STRATEGY_AUTO, the default, the entry hijack is used for
+* every game version that has one. On Windows NT, a remote thread is
+* used for the game versions that have no entry hijack. Early bird APCs
+* are only used if selected. This must be called after Knowledge_Init.
+*/
+DLLEXPORT void Knowledge_SetInjectionStrategy(
+    enum KnowledgeInjectionStrategy injection_strategy
+);
+
+/*
+* Enables or disables recording of the injection phases. Disabled by
+* default.
+*/
+DLLEXPORT void Knowledge_SetTraceEnabled(int is_enabled);
+
+/*
+* Writes the recorded injection phases to the specified file, in the
+* Chrome trace-event JSON format. Returns zero on failure.
+*/
+DLLEXPORT int Knowledge_ExportTrace(const wchar_t* output_path);
+
+/*
+* Checks that each library exists, is built for x86, and that the DLLs
+* it imports can be found, without touching any game process. With
+* KNOWLEDGE_INJECTION_STRATEGY_IMPORT_DESCRIPTOR, each library must also export
+* ordinal 1. One result is output for each library. Returns zero if any
+* library is not valid. The same check is done at the start of every
+* injection.
+*/
+DLLEXPORT int Knowledge_PreflightLibraries(
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    struct KnowledgeLibraryPreflight* preflights
+);
+
+/*
+* Checks the file version of each of the game's libraries against that
+* of the game executable, to find installs that were only partly
+* patched. One entry is output for each library, and the number of
+* entries is output to num_file_versions. file_versions needs room for
+* KNOWLEDGE_MAX_COMPANION_FILES entries. Only Diablo II before 1.14 has
+* separate libraries; other games output no entries. The check reads
+* every library, so it is not part of the game version detection.
+* Returns zero on failure.
+*/
+DLLEXPORT int Knowledge_CheckCompanionFiles(
+    struct KnowledgeCompanionFileVersion* file_versions,
+    size_t* num_file_versions
+);
 
 DLLEXPORT int Knowledge_InjectLibrariesToProcesses(
     const wchar_t** libraries_to_inject,
@@ -59,9 +203,209 @@ DLLEXPORT int Knowledge_InjectLibrariesToProcesses(
     size_t num_instances
 );
 
+/*
+* Same as Knowledge_InjectLibrariesToProcesses, but also outputs how
+* each library loaded. load_results must hold num_libraries results for
+* each instance, in instance order, and is filled even if the injection
+* fails.
+*/
+DLLEXPORT int Knowledge_InjectLibrariesToProcessesWithResults(
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    struct KnowledgeLibraryLoadResult* load_results
+);
+
+struct KnowledgeInjectionOperation;
+
+/*
+* Called on the injection's worker thread once it has finished. The
+* callback must not wait on or close the operation.
+*/
+typedef void (*KnowledgeInjectionCallback)(
+    struct KnowledgeInjectionOperation* operation,
+    int result,
+    void* context
+);
+
+/*
+* Starts injecting the libraries on a worker thread, and returns
+* immediately. The arrays are copied, so they do not need to outlive
+* this call. The callback can be NULL. The returned operation must be
+* closed with Knowledge_CloseInjection, before Knowledge_Deinit.
+*
+* The operation keeps the settings that were set when it started, such
+* as the injection strategy. Changing them afterwards only affects the
+* injections started after the change.
+*/
+DLLEXPORT struct KnowledgeInjectionOperation*
+Knowledge_InjectLibrariesToProcessesAsync(
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    KnowledgeInjectionCallback callback,
+    void* callback_context
+);
+
+/*
+* Waits up to timeout_ms milliseconds for the injection to finish.
+* Returns nonzero if it has finished.
+*/
+DLLEXPORT int Knowledge_WaitForInjection(
+    struct KnowledgeInjectionOperation* operation,
+    DWORD timeout_ms
+);
+
+DLLEXPORT int Knowledge_IsInjectionComplete(
+    const struct KnowledgeInjectionOperation* operation
+);
+
+/* Only valid once the injection has finished. */
+DLLEXPORT int Knowledge_GetInjectionResult(
+    const struct KnowledgeInjectionOperation* operation
+);
+
+/*
+* Copies the failure that stopped the injection, as it was recorded on
+* the injection's worker thread. Only valid once the injection has
+* finished. Returns zero if the injection did not fail.
+*/
+DLLEXPORT int Knowledge_GetInjectionErrorDetail(
+    const struct KnowledgeInjectionOperation* operation,
+    struct KnowledgeErrorDetail* error_detail
+);
+
+/*
+* Stops the injection of any further libraries. The game instances are
+* still resumed, and the result of the injection is zero.
+*/
+DLLEXPORT void Knowledge_CancelInjection(
+    struct KnowledgeInjectionOperation* operation
+);
+
+/* Returns zero if i_instance is out of range. */
+DLLEXPORT int Knowledge_GetInjectionProgress(
+    const struct KnowledgeInjectionOperation* operation,
+    size_t i_instance,
+    struct KnowledgeInjectionProgress* progress
+);
+
+/*
+* Copies how one library loaded in one instance. Only valid once the
+* injection has finished. Returns zero if i_instance or i_library is
+* out of range.
+*/
+DLLEXPORT int Knowledge_GetInjectionLibraryLoadResult(
+    const struct KnowledgeInjectionOperation* operation,
+    size_t i_instance,
+    size_t i_library,
+    struct KnowledgeLibraryLoadResult* load_result
+);
+
+/* Waits for the injection to finish, and then frees the operation. */
+DLLEXPORT void Knowledge_CloseInjection(
+    struct KnowledgeInjectionOperation* operation
+);
+
+/*
+* A context holds the state for one game install, so that a single
+* loader can serve several installs. Operations on distinct contexts
+* are thread-safe. The information about an install is cached, and
+* shared by every context of the same game path.
+*
+* The exports above that do not take a context operate on a default
+* context, which is created by Knowledge_Init. Calling Knowledge_Init
+* again replaces the default context. The exports fail, and record a
+* failure, if they are given a NULL context or if Knowledge_Init has not
+* been called.
+*/
+struct KnowledgeContext;
+
+DLLEXPORT struct KnowledgeContext* Knowledge_CreateContext(
+    const wchar_t* game_path,
+    size_t game_path_len
+);
+
+/*
+* Any injection operations started on the context must be closed
+* before it is destroyed.
+*/
+DLLEXPORT void Knowledge_DestroyContext(struct KnowledgeContext* context);
+
+DLLEXPORT int Knowledge_ContextPrintGameInfo(
+    struct KnowledgeContext* context
+);
+
+DLLEXPORT int Knowledge_ContextGetGameInfo(
+    struct KnowledgeContext* context,
+    struct KnowledgeGameInfo* game_info
+);
+
+DLLEXPORT int Knowledge_ContextStartPrefetch(
+    struct KnowledgeContext* context
+);
+
+DLLEXPORT void Knowledge_ContextSetSharedMemoryTransportEnabled(
+    struct KnowledgeContext* context,
+    int is_enabled
+);
+
+DLLEXPORT void Knowledge_ContextSetLibraryReadAheadEnabled(
+    struct KnowledgeContext* context,
+    int is_enabled
+);
+
+DLLEXPORT void Knowledge_ContextSetInjectionStrategy(
+    struct KnowledgeContext* context,
+    enum KnowledgeInjectionStrategy injection_strategy
+);
+
+DLLEXPORT int Knowledge_ContextPreflightLibraries(
+    struct KnowledgeContext* context,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    struct KnowledgeLibraryPreflight* preflights
+);
+
+DLLEXPORT int Knowledge_ContextCheckCompanionFiles(
+    struct KnowledgeContext* context,
+    struct KnowledgeCompanionFileVersion* file_versions,
+    size_t* num_file_versions
+);
+
+DLLEXPORT int Knowledge_ContextInjectLibrariesToProcesses(
+    struct KnowledgeContext* context,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances
+);
+
+DLLEXPORT int Knowledge_ContextInjectLibrariesToProcessesWithResults(
+    struct KnowledgeContext* context,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    struct KnowledgeLibraryLoadResult* load_results
+);
+
+DLLEXPORT struct KnowledgeInjectionOperation*
+Knowledge_ContextInjectLibrariesToProcessesAsync(
+    struct KnowledgeContext* context,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    KnowledgeInjectionCallback callback,
+    void* callback_context
+);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif /* __cplusplus */
 
 #include "dllexport_undefine.inc"
-#endif /* SGGLKL_DLL_EXPORTS_H_ */
+#endif /* SGGLDKL_DLL_EXPORTS_H_ */
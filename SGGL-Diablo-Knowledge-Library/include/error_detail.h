@@ -0,0 +1,65 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_ERROR_DETAIL_H_
+#define SGGLDKL_ERROR_DETAIL_H_
+
+#include <wchar.h>
+#include <windows.h>
+
+enum KnowledgeErrorKind {
+  KNOWLEDGE_ERROR_NONE,
+  KNOWLEDGE_ERROR_GENERAL,
+  KNOWLEDGE_ERROR_ALLOCATION,
+  KNOWLEDGE_ERROR_WINDOWS_FUNCTION
+};
+
+/* String lengths, including null-terminator. */
+enum {
+  KNOWLEDGE_ERROR_FUNCTION_NAME_LENGTH = 64,
+  KNOWLEDGE_ERROR_MESSAGE_LENGTH = 256,
+  KNOWLEDGE_ERROR_CAPTION_LENGTH = 64
+};
+
+/*
+* The last failure recorded on a thread. The strings are truncated if
+* they do not fit. The function name and Windows error code are only
+* set for KNOWLEDGE_ERROR_WINDOWS_FUNCTION.
+*/
+struct KnowledgeErrorDetail {
+  enum KnowledgeErrorKind kind;
+
+  DWORD last_error;
+  wchar_t function_name[KNOWLEDGE_ERROR_FUNCTION_NAME_LENGTH];
+
+  wchar_t message[KNOWLEDGE_ERROR_MESSAGE_LENGTH];
+  wchar_t caption[KNOWLEDGE_ERROR_CAPTION_LENGTH];
+};
+
+#endif /* SGGLDKL_ERROR_DETAIL_H_ */
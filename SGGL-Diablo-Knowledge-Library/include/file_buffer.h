@@ -0,0 +1,48 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_FILE_BUFFER_H_
+#define SGGLDKL_FILE_BUFFER_H_
+
+#include <stddef.h>
+#include <wchar.h>
+
+/*
+* The contents of a game file that the caller already holds in memory,
+* as laid out on disk. The file name has no directory, such as
+* L"storm.dll", and is matched without case.
+*/
+struct KnowledgeFileBuffer {
+  const wchar_t* file_name;
+
+  const void* data;
+  size_t size;
+};
+
+#endif /* SGGLDKL_FILE_BUFFER_H_ */
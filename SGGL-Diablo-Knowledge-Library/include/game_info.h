@@ -0,0 +1,103 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_GAME_INFO_H_
+#define SGGLDKL_GAME_INFO_H_
+
+#include <stddef.h>
+
+enum KnowledgeGameFamily {
+  KNOWLEDGE_GAME_FAMILY_UNKNOWN,
+  KNOWLEDGE_GAME_FAMILY_DIABLO,
+  KNOWLEDGE_GAME_FAMILY_HELLFIRE,
+  KNOWLEDGE_GAME_FAMILY_DIABLO_II,
+
+  /* The number of game families, which is not a game family itself. */
+  KNOWLEDGE_GAME_FAMILY_END
+};
+
+/* The data that determined the game version. */
+enum KnowledgeGameDetectionMethod {
+  KNOWLEDGE_GAME_DETECTION_METHOD_NONE,
+  KNOWLEDGE_GAME_DETECTION_METHOD_PRODUCT_VERSION,
+  KNOWLEDGE_GAME_DETECTION_METHOD_FILE_VERSION,
+  KNOWLEDGE_GAME_DETECTION_METHOD_FILE_VERSION_STRING,
+  KNOWLEDGE_GAME_DETECTION_METHOD_STORM_FILE_VERSION,
+  KNOWLEDGE_GAME_DETECTION_METHOD_FILE_SIGNATURE
+};
+
+/*
+* INFERRED is used when the version data is shared with other builds,
+* and the version was chosen because the signature of the other builds
+* did not match.
+*/
+enum KnowledgeGameDetectionConfidence {
+  KNOWLEDGE_GAME_DETECTION_CONFIDENCE_NONE,
+  KNOWLEDGE_GAME_DETECTION_CONFIDENCE_INFERRED,
+  KNOWLEDGE_GAME_DETECTION_CONFIDENCE_CONFIRMED
+};
+
+/* A version from a file's version resource, if it was read. */
+struct KnowledgeGameFileVersion {
+  int is_read;
+
+  unsigned short major_left;
+  unsigned short major_right;
+  unsigned short minor_left;
+  unsigned short minor_right;
+};
+
+struct KnowledgeGameDetection {
+  enum KnowledgeGameDetectionMethod method;
+  enum KnowledgeGameDetectionConfidence confidence;
+
+  struct KnowledgeGameFileVersion game_file_version;
+  struct KnowledgeGameFileVersion game_product_version;
+  struct KnowledgeGameFileVersion storm_file_version;
+};
+
+/*
+* The strings are static, and must not be freed. The game version is
+* the value of the library's internal version enum, which is -1 for an
+* unknown version.
+*/
+struct KnowledgeGameInfo {
+  enum KnowledgeGameFamily game_family;
+  int game_version;
+
+  const char* game_name;
+  size_t game_name_len;
+
+  const char* version_text;
+  size_t version_text_len;
+
+  struct KnowledgeGameDetection detection;
+};
+
+#endif /* SGGLDKL_GAME_INFO_H_ */
@@ -0,0 +1,56 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_INJECTION_PROGRESS_H_
+#define SGGLDKL_INJECTION_PROGRESS_H_
+
+#include <stddef.h>
+
+enum KnowledgeInjectionPhase {
+  KNOWLEDGE_INJECTION_PHASE_PENDING,
+  KNOWLEDGE_INJECTION_PHASE_PATCHING,
+  KNOWLEDGE_INJECTION_PHASE_LOADING_LIBRARIES,
+  KNOWLEDGE_INJECTION_PHASE_CLEANING_UP,
+  KNOWLEDGE_INJECTION_PHASE_COMPLETE,
+  KNOWLEDGE_INJECTION_PHASE_CANCELLED,
+
+  /*
+  * The injection stopped on an error. The game instance could be left
+  * suspended or in an unusable state.
+  */
+  KNOWLEDGE_INJECTION_PHASE_FAILED
+};
+
+/* A snapshot of the injection of one game instance. */
+struct KnowledgeInjectionProgress {
+  enum KnowledgeInjectionPhase phase;
+  size_t num_libs_loaded;
+};
+
+#endif /* SGGLDKL_INJECTION_PROGRESS_H_ */
@@ -0,0 +1,72 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_INJECTION_STRATEGY_H_
+#define SGGLDKL_INJECTION_STRATEGY_H_
+
+/* How the libraries are loaded into a suspended game process. */
+enum KnowledgeInjectionStrategy {
+  /*
+  * Chooses the strategy from the game version and the capabilities of
+  * the running version of Windows.
+  */
+  KNOWLEDGE_INJECTION_STRATEGY_AUTO,
+
+  /*
+  * Patches the game's entry point to run a payload that loads the
+  * libraries one at a time. Works on every version of Windows, but not
+  * on every game version, such as Diablo II 1.14A and later.
+  */
+  KNOWLEDGE_INJECTION_STRATEGY_ENTRY_HIJACK,
+
+  /*
+  * Queues LoadLibraryW calls as APCs on the game's main thread before
+  * it first runs. No code is patched. Windows NT only, and never chosen
+  * automatically. The libraries are loaded after the injection returns,
+  * while the game initializes, so no load results are captured.
+  */
+  KNOWLEDGE_INJECTION_STRATEGY_EARLY_BIRD_APC,
+
+  /*
+  * Runs a single thread in the game process that loads every library,
+  * before the game's main thread first runs. No code of the game is
+  * patched. Windows NT only.
+  */
+  KNOWLEDGE_INJECTION_STRATEGY_REMOTE_THREAD,
+
+  /*
+  * Adds the libraries to the game's import directory before the game
+  * first runs, so that the Windows loader loads them. Each library must
+  * export ordinal 1, which is checked before the game is touched.
+  * Windows NT only, and never chosen automatically.
+  */
+  KNOWLEDGE_INJECTION_STRATEGY_IMPORT_DESCRIPTOR
+};
+
+#endif /* SGGLDKL_INJECTION_STRATEGY_H_ */
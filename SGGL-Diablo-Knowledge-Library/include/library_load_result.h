@@ -0,0 +1,55 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_LIBRARY_LOAD_RESULT_H_
+#define SGGLDKL_LIBRARY_LOAD_RESULT_H_
+
+#include <windows.h>
+
+/*
+* The outcome of loading one library inside a game instance, as
+* captured by the payload around its LoadLibrary call. The module is
+* NULL if the library failed to load, in which case last_error holds
+* the reason. The ticks come from the game's GetTickCount, so their
+* resolution is that of the system timer.
+*
+* is_attempted is zero if the library was never loaded, such as after
+* a cancellation or a failure in an earlier library's injection.
+*/
+struct KnowledgeLibraryLoadResult {
+  int is_attempted;
+
+  HMODULE module;
+  DWORD last_error;
+
+  DWORD load_start_tick;
+  DWORD load_end_tick;
+};
+
+#endif /* SGGLDKL_LIBRARY_LOAD_RESULT_H_ */
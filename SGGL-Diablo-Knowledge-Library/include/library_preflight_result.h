@@ -0,0 +1,72 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_LIBRARY_PREFLIGHT_RESULT_H_
+#define SGGLDKL_LIBRARY_PREFLIGHT_RESULT_H_
+
+enum KnowledgeLibraryStatus {
+  KNOWLEDGE_LIBRARY_VALID,
+
+  /* The file does not exist, or could not be opened. */
+  KNOWLEDGE_LIBRARY_NOT_FOUND,
+
+  /* The file could not be read to the end of its headers. */
+  KNOWLEDGE_LIBRARY_READ_FAILED,
+
+  KNOWLEDGE_LIBRARY_NOT_PE,
+
+  /* The library is not built for x86. */
+  KNOWLEDGE_LIBRARY_WRONG_MACHINE,
+
+  /* A DLL imported by the library could not be found. */
+  KNOWLEDGE_LIBRARY_MISSING_IMPORT,
+
+  /*
+  * The library does not export ordinal 1, which the import descriptor
+  * strategy requires.
+  */
+  KNOWLEDGE_LIBRARY_NO_ORDINAL_1_EXPORT
+};
+
+/* String length, including null-terminator. */
+enum {
+  KNOWLEDGE_LIBRARY_IMPORT_NAME_LENGTH = 64
+};
+
+/*
+* The result of checking one library before it is injected. The name of
+* the missing import is only set for KNOWLEDGE_LIBRARY_MISSING_IMPORT,
+* and is truncated if it does not fit.
+*/
+struct KnowledgeLibraryPreflight {
+  enum KnowledgeLibraryStatus status;
+  char missing_import_name[KNOWLEDGE_LIBRARY_IMPORT_NAME_LENGTH];
+};
+
+#endif /* SGGLDKL_LIBRARY_PREFLIGHT_RESULT_H_ */
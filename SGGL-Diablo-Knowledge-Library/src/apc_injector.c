@@ -0,0 +1,186 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "apc_injector.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "helper/error_handling.h"
+#include "helper/windows_version.h"
+
+int ApcInjector_IsSupported(void) {
+  return WindowsVersion_IsNt();
+}
+
+int ApcInjector_InjectLibraries(
+    const struct RemoteProcess* remote_process,
+    const wchar_t** libraries_to_inject,
+    const size_t* libraries_to_inject_lens,
+    size_t num_libraries
+) {
+  size_t i_library;
+
+  void* load_library_w_address;
+
+  wchar_t* lib_paths;
+  size_t lib_paths_len;
+  size_t lib_path_offset;
+  wchar_t* remote_lib_paths;
+
+  DWORD previous_suspend_count;
+  int is_success;
+
+  is_success = 0;
+
+  if (!ApcInjector_IsSupported()) {
+    RecordGeneralFailure(
+        L"Early bird APC injection requires Windows NT.",
+        L"Unsupported Operation"
+    );
+
+    return 0;
+  }
+
+  /*
+  * The address is taken directly from kernel32, which is mapped at the
+  * same address in the game process.
+  */
+  load_library_w_address = (void*) GetProcAddress(
+      GetModuleHandleA("kernel32.dll"),
+      "LoadLibraryW"
+  );
+
+  if (load_library_w_address == NULL) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"GetProcAddress",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  /* Pack the paths, so that they are written with a single transfer. */
+  lib_paths_len = 0;
+
+  for (i_library = 0; i_library < num_libraries; i_library += 1) {
+    lib_paths_len += libraries_to_inject_lens[i_library] + 1;
+  }
+
+  lib_paths = malloc((lib_paths_len + 1) * sizeof(lib_paths[0]));
+
+  if (lib_paths == NULL) {
+    RecordAllocationFailure();
+    return 0;
+  }
+
+  lib_path_offset = 0;
+
+  for (i_library = 0; i_library < num_libraries; i_library += 1) {
+    memcpy(
+        &lib_paths[lib_path_offset],
+        libraries_to_inject[i_library],
+        (libraries_to_inject_lens[i_library] + 1) * sizeof(lib_paths[0])
+    );
+
+    lib_path_offset += libraries_to_inject_lens[i_library] + 1;
+  }
+
+  if (!RemoteProcess_AllocateMemory(
+      remote_process,
+      NULL,
+      (lib_paths_len + 1) * sizeof(lib_paths[0]),
+      PAGE_READWRITE,
+      (void**) &remote_lib_paths
+  )) {
+    goto free_lib_paths;
+  }
+
+  if (!RemoteProcess_WriteMemory(
+      remote_process,
+      remote_lib_paths,
+      lib_paths,
+      lib_paths_len * sizeof(lib_paths[0]),
+      NULL
+  )) {
+    RemoteProcess_FreeMemory(remote_process, remote_lib_paths);
+    goto free_lib_paths;
+  }
+
+  /*
+  * APCs are run in the order they are queued. Once one is queued, the
+  * paths can no longer be freed, as the thread could still run it.
+  * They are left to be freed when the game process exits.
+  */
+  lib_path_offset = 0;
+
+  for (i_library = 0; i_library < num_libraries; i_library += 1) {
+    if (!RemoteProcess_QueueApc(
+        remote_process,
+        load_library_w_address,
+        (ULONG_PTR) &remote_lib_paths[lib_path_offset]
+    )) {
+      break;
+    }
+
+    lib_path_offset += libraries_to_inject_lens[i_library] + 1;
+  }
+
+  if (i_library == 0 && num_libraries > 0) {
+    RemoteProcess_FreeMemory(remote_process, remote_lib_paths);
+    goto free_lib_paths;
+  }
+
+  /*
+  * The APCs are delivered as the thread starts to initialize. If only
+  * some of them were queued, the thread is still resumed, so that the
+  * game is not left suspended with calls pending.
+  */
+  if (!RemoteProcess_ResumeThread(remote_process, &previous_suspend_count)) {
+    goto free_lib_paths;
+  }
+
+  if (i_library < num_libraries) {
+    RecordGeneralFailure(
+        L"Only some of the libraries could be queued. The game was "
+        L"resumed with those libraries.",
+        L"Partial Injection"
+    );
+
+    goto free_lib_paths;
+  }
+
+  is_success = 1;
+
+free_lib_paths:
+  free(lib_paths);
+
+  return is_success;
+}
@@ -0,0 +1,60 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_APC_INJECTOR_H_
+#define SGGLDKL_APC_INJECTOR_H_
+
+#include <stddef.h>
+#include <wchar.h>
+
+#include "patch_helper/remote_process.h"
+
+/*
+* Returns nonzero if APCs queued to a thread that has not yet run are
+* delivered as it starts, which is the case on Windows NT.
+*/
+int ApcInjector_IsSupported(void);
+
+/*
+* Copies the library paths into the game process, queues a LoadLibraryW
+* call for each of them on the game's main thread, and then resumes
+* the thread. The main thread must never have run. The paths are left
+* in the game process until it exits, as the calls only run after this
+* returns. If only some of the calls could be queued, then the thread is
+* still resumed with those calls, and a partial injection is reported
+* by returning zero.
+*/
+int ApcInjector_InjectLibraries(
+    const struct RemoteProcess* remote_process,
+    const wchar_t** libraries_to_inject,
+    const size_t* libraries_to_inject_lens,
+    size_t num_libraries
+);
+
+#endif /* SGGLDKL_APC_INJECTOR_H_ */
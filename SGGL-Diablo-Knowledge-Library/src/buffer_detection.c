@@ -0,0 +1,284 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "buffer_detection.h"
+
+#include <string.h>
+
+#include "helper/error_handling.h"
+#include "helper/game_file_source.h"
+#include "image_file_source.h"
+#include "patch_helper/pe_header.h"
+
+enum Constant {
+  PE_HEADER_PTR_OFFSET = 0x3C
+};
+
+struct CompanionBuffers {
+  const struct KnowledgeFileBuffer* buffers;
+  size_t num_buffers;
+};
+
+/*
+* Maps the RVA to an offset in the file. The headers are at the same
+* offsets in the file as in the image, which is also how the headers
+* are read before they are known to be valid.
+*/
+static int MapRvaToFileOffset(
+    const unsigned char* file_data,
+    size_t file_size,
+    DWORD rva,
+    size_t size,
+    size_t* file_offset
+) {
+  IMAGE_NT_HEADERS nt_headers;
+  LONG e_lfanew;
+  size_t section_table_offset;
+  size_t section_header_offset;
+  IMAGE_SECTION_HEADER section_header;
+  WORD i_section;
+  DWORD section_offset;
+
+  if (!PeHeader_ParseNtHeaders(&nt_headers, file_data, file_size)
+      || rva < nt_headers.OptionalHeader.SizeOfHeaders) {
+    *file_offset = rva;
+
+    return 1;
+  }
+
+  /* The parser has already checked the offset. */
+  memcpy(&e_lfanew, file_data + PE_HEADER_PTR_OFFSET, sizeof(e_lfanew));
+
+  section_table_offset = e_lfanew
+      + sizeof(nt_headers.Signature)
+      + sizeof(nt_headers.FileHeader)
+      + nt_headers.FileHeader.SizeOfOptionalHeader;
+
+  for (i_section = 0;
+      i_section < nt_headers.FileHeader.NumberOfSections;
+      i_section += 1) {
+    section_header_offset = section_table_offset
+        + i_section * sizeof(section_header);
+
+    if (section_header_offset > file_size
+        || file_size - section_header_offset < sizeof(section_header)) {
+      break;
+    }
+
+    memcpy(
+        &section_header,
+        file_data + section_header_offset,
+        sizeof(section_header)
+    );
+
+    if (rva < section_header.VirtualAddress) {
+      continue;
+    }
+
+    section_offset = rva - section_header.VirtualAddress;
+
+    if (section_offset >= section_header.SizeOfRawData
+        || section_header.SizeOfRawData - section_offset < size) {
+      continue;
+    }
+
+    *file_offset = section_header.PointerToRawData + section_offset;
+
+    return 1;
+  }
+
+  RecordGeneralFailure(
+      L"The data is not in any section of the game file.",
+      L"Invalid PE Header"
+  );
+
+  return 0;
+}
+
+static const void* ViewFileBuffer(
+    void* context,
+    const void* image,
+    size_t image_size,
+    DWORD rva,
+    size_t size
+) {
+  size_t file_offset;
+
+  if (!MapRvaToFileOffset(image, image_size, rva, size, &file_offset)) {
+    return NULL;
+  }
+
+  if (file_offset > image_size || image_size - file_offset < size) {
+    RecordGeneralFailure(
+        L"The game file is truncated.",
+        L"Invalid PE Header"
+    );
+
+    return NULL;
+  }
+
+  return (const unsigned char*) image + file_offset;
+}
+
+static int ReadFileBuffer(
+    void* context,
+    const void* image,
+    size_t image_size,
+    DWORD rva,
+    void* buffer,
+    size_t size
+) {
+  const void* data;
+
+  data = ViewFileBuffer(context, image, image_size, rva, size);
+
+  if (data == NULL) {
+    return 0;
+  }
+
+  memcpy(buffer, data, size);
+
+  return 1;
+}
+
+static void InitFileBufferReader(
+    struct ImageReader* reader,
+    const void* data,
+    size_t size
+) {
+  reader->read_func_ptr = &ReadFileBuffer;
+  reader->view_func_ptr = &ViewFileBuffer;
+  reader->context = NULL;
+  reader->image = data;
+  reader->image_size = size;
+}
+
+static int FindCompanionBuffer(
+    void* context,
+    const wchar_t* file_name,
+    size_t file_name_len,
+    struct ImageReader* reader
+) {
+  const struct CompanionBuffers* companion_buffers;
+  const struct KnowledgeFileBuffer* buffer;
+  size_t i_buffer;
+
+  companion_buffers = (const struct CompanionBuffers*) context;
+
+  for (i_buffer = 0;
+      i_buffer < companion_buffers->num_buffers;
+      i_buffer += 1) {
+    buffer = &companion_buffers->buffers[i_buffer];
+
+    if (wcslen(buffer->file_name) == file_name_len
+        && _wcsnicmp(buffer->file_name, file_name, file_name_len) == 0) {
+      InitFileBufferReader(reader, buffer->data, buffer->size);
+
+      return 1;
+    }
+  }
+
+  RecordGeneralFailure(
+      L"The companion file was not provided.",
+      L"Companion File Not Found"
+  );
+
+  return 0;
+}
+
+int BufferDetection_DetectGameVersion(
+    const void* game_data,
+    size_t game_size,
+    const struct KnowledgeFileBuffer* companion_buffers,
+    size_t num_companion_buffers,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
+) {
+  struct CompanionBuffers companions;
+  struct ImageReader game_reader;
+  struct ImageFileSource image_source;
+  struct GameFileSource source;
+  int is_success;
+
+  companions.buffers = companion_buffers;
+  companions.num_buffers = num_companion_buffers;
+
+  InitFileBufferReader(&game_reader, game_data, game_size);
+
+  ImageFileSource_Init(
+      &image_source,
+      &game_reader,
+      &FindCompanionBuffer,
+      &companions
+  );
+
+  GameFileSource_Init(&source, GameFileSourceOps_GetImage(), &image_source);
+
+  is_success = GameVersion_DetectGameVersionFromSource(
+      &source,
+      detection,
+      game_version
+  );
+
+  ImageFileSource_Deinit(&image_source);
+
+  return is_success;
+}
+
+int BufferDetection_ExtractFileInfo(
+    const void* file_data,
+    size_t file_size,
+    VS_FIXEDFILEINFO* file_info
+) {
+  struct CompanionBuffers companions;
+  struct ImageReader reader;
+  struct ImageFileSource image_source;
+  struct GameFileSource source;
+  int is_success;
+
+  companions.buffers = NULL;
+  companions.num_buffers = 0;
+
+  InitFileBufferReader(&reader, file_data, file_size);
+
+  ImageFileSource_Init(
+      &image_source,
+      &reader,
+      &FindCompanionBuffer,
+      &companions
+  );
+
+  GameFileSource_Init(&source, GameFileSourceOps_GetImage(), &image_source);
+
+  is_success = GameFileSource_ExtractFileInfo(&source, NULL, 0, file_info);
+
+  ImageFileSource_Deinit(&image_source);
+
+  return is_success;
+}
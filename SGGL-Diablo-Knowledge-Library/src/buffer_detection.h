@@ -0,0 +1,66 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_BUFFER_DETECTION_H_
+#define SGGLDKL_BUFFER_DETECTION_H_
+
+#include <stddef.h>
+#include <windows.h>
+
+#include "../include/file_buffer.h"
+#include "game_version.h"
+
+/*
+* Detects the version of the game from the contents of its files, with
+* the same version tables as the path-based detection. The version
+* resources and signatures are read in place, without copying the
+* buffers or touching the file system. The buffers must outlive the
+* call. Returns zero if the files could not be read, which is distinct
+* from an unknown version.
+*/
+int BufferDetection_DetectGameVersion(
+    const void* game_data,
+    size_t game_size,
+    const struct KnowledgeFileBuffer* companion_buffers,
+    size_t num_companion_buffers,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
+);
+
+/*
+* Outputs the fixed file info from the version resource in the contents
+* of a file, which is read in place. Returns zero on failure.
+*/
+int BufferDetection_ExtractFileInfo(
+    const void* file_data,
+    size_t file_size,
+    VS_FIXEDFILEINFO* file_info
+);
+
+#endif /* SGGLDKL_BUFFER_DETECTION_H_ */
@@ -32,8 +32,7 @@
 #include <stdlib.h>
 #include <windows.h>
 
-#include "../helper/file_info.h"
-#include "../helper/file_path.h"
+#include "../helper/game_file_source.h"
 #include "../helper/short_version.h"
 
 /*
@@ -73,7 +72,8 @@ kStormFileVersionsToGameVersion[] = {
 
 static enum GameVersion SearchGameVersionTable(
     const VS_FIXEDFILEINFO* diablo_file_info,
-    const VS_FIXEDFILEINFO* storm_file_info
+    const VS_FIXEDFILEINFO* storm_file_info,
+    struct KnowledgeGameDetection* detection
 ) {
   struct ShortVersionAndGameVersionEntry* search_result;
 
@@ -108,6 +108,9 @@ static enum GameVersion SearchGameVersionTable(
   );
 
   if (search_result != NULL) {
+    detection->method = KNOWLEDGE_GAME_DETECTION_METHOD_PRODUCT_VERSION;
+    detection->confidence = KNOWLEDGE_GAME_DETECTION_CONFIDENCE_CONFIRMED;
+
     return search_result->game_version;
   }
 
@@ -122,37 +125,61 @@ static enum GameVersion SearchGameVersionTable(
   );
 
   if (search_result != NULL) {
+    detection->method = KNOWLEDGE_GAME_DETECTION_METHOD_STORM_FILE_VERSION;
+    detection->confidence = KNOWLEDGE_GAME_DETECTION_CONFIDENCE_CONFIRMED;
+
     return search_result->game_version;
   }
 
   return VERSION_UNKNOWN;
 }
 
-enum GameVersion Diablo_FindGameVersion(
-    const wchar_t* diablo_file_path,
-    size_t diablo_file_path_len
+int Diablo_FindGameVersion(
+    const struct GameFileSource* source,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
 ) {
   const wchar_t* kStormFileName = L"storm.dll";
   const size_t kStormFileNameLen =
       (sizeof(L"storm.dll") / sizeof(kStormFileName[0])) - 1;
 
-  wchar_t* storm_file_path;
-
   VS_FIXEDFILEINFO diablo_file_info;
   VS_FIXEDFILEINFO storm_file_info;
 
   /* Diablo has to use Storm.dll and Diablo.exe to determine the version. */
-  storm_file_path = GetAdjacentFilePath(
-      diablo_file_path,
-      diablo_file_path_len,
-      kStormFileName,
-      kStormFileNameLen
+  if (!GameFileSource_ExtractFileInfo(source, NULL, 0, &diablo_file_info)
+      || !GameFileSource_ExtractFileInfo(
+          source,
+          kStormFileName,
+          kStormFileNameLen,
+          &storm_file_info
+      )) {
+    return 0;
+  }
+
+  GameFileVersion_Init(
+      &detection->game_file_version,
+      diablo_file_info.dwFileVersionMS,
+      diablo_file_info.dwFileVersionLS
   );
 
-  ExtractFileInfo(&diablo_file_info, diablo_file_path);
-  ExtractFileInfo(&storm_file_info, storm_file_path);
+  GameFileVersion_Init(
+      &detection->game_product_version,
+      diablo_file_info.dwProductVersionMS,
+      diablo_file_info.dwProductVersionLS
+  );
+
+  GameFileVersion_Init(
+      &detection->storm_file_version,
+      storm_file_info.dwFileVersionMS,
+      storm_file_info.dwFileVersionLS
+  );
 
-  free(storm_file_path);
+  *game_version = SearchGameVersionTable(
+      &diablo_file_info,
+      &storm_file_info,
+      detection
+  );
 
-  return SearchGameVersionTable(&diablo_file_info, &storm_file_info);
+  return 1;
 }
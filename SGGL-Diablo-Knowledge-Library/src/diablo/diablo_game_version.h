@@ -35,9 +35,11 @@
 
 #include "../game_version.h"
 
-enum GameVersion Diablo_FindGameVersion(
-    const wchar_t* diablo_file_path,
-    size_t diablo_file_path_len
+/* Returns zero if the game files could not be read. */
+int Diablo_FindGameVersion(
+    const struct GameFileSource* source,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
 );
 
 #endif /* SGGLDKL_DIABLO_DIABLO_GAME_VERSION_H_ */
@@ -0,0 +1,355 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "diablo_ii_companion_files.h"
+
+#include <process.h>
+#include <string.h>
+#include <windows.h>
+
+#include "../buffer_detection.h"
+#include "../helper/encoding.h"
+#include "../helper/trace.h"
+#include "diablo_ii_game_version.h"
+
+enum Constant {
+  COMPANION_CHECK_MAX_THREADS = 4
+};
+
+/* Storm.dll and the third-party libraries have their own versions. */
+static const wchar_t* const kCompanionFileNames[] = {
+    L"Bnclient.dll",
+    L"D2CMP.dll",
+    L"D2Client.dll",
+    L"D2Common.dll",
+    L"D2DDraw.dll",
+    L"D2Direct3D.dll",
+    L"D2Game.dll",
+    L"D2Gdi.dll",
+    L"D2Gfx.dll",
+    L"D2Glide.dll",
+    L"D2Lang.dll",
+    L"D2Launch.dll",
+    L"D2MCPClient.dll",
+    L"D2Multi.dll",
+    L"D2Net.dll",
+    L"D2Sound.dll",
+    L"D2Win.dll",
+    L"Fog.dll"
+};
+
+/* The libraries checked by one thread, which are every stride-th one. */
+struct CompanionCheckWork {
+  const wchar_t* game_dir_path;
+  size_t game_dir_path_len;
+  const struct KnowledgeGameFileVersion* game_file_version;
+  struct KnowledgeCompanionFileVersion* file_versions;
+  size_t num_files;
+
+  size_t i_first_file;
+  size_t stride;
+};
+
+static int GameFileVersion_Equals(
+    const struct KnowledgeGameFileVersion* file_version1,
+    const struct KnowledgeGameFileVersion* file_version2
+) {
+  return file_version1->major_left == file_version2->major_left
+      && file_version1->major_right == file_version2->major_right
+      && file_version1->minor_left == file_version2->minor_left
+      && file_version1->minor_right == file_version2->minor_right;
+}
+
+/*
+* Reads the version resource from a read-only view of the file, so that
+* the library is not copied.
+*/
+static enum KnowledgeCompanionFileStatus ReadCompanionFileVersion(
+    const char* file_path,
+    VS_FIXEDFILEINFO* file_info
+) {
+  HANDLE file_handle;
+  DWORD file_size;
+  HANDLE mapping_handle;
+  void* file_view;
+  enum KnowledgeCompanionFileStatus status;
+
+  file_handle = CreateFileA(
+      file_path,
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      NULL,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL,
+      NULL
+  );
+
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    return KNOWLEDGE_COMPANION_FILE_NOT_FOUND;
+  }
+
+  status = KNOWLEDGE_COMPANION_FILE_READ_FAILED;
+
+  file_size = GetFileSize(file_handle, NULL);
+
+  if (file_size == (DWORD) -1 || file_size == 0) {
+    goto close_file_handle;
+  }
+
+  mapping_handle = CreateFileMappingA(
+      file_handle,
+      NULL,
+      PAGE_READONLY,
+      0,
+      0,
+      NULL
+  );
+
+  if (mapping_handle == NULL) {
+    goto close_file_handle;
+  }
+
+  file_view = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+
+  if (file_view == NULL) {
+    goto close_mapping_handle;
+  }
+
+  if (BufferDetection_ExtractFileInfo(file_view, file_size, file_info)) {
+    status = KNOWLEDGE_COMPANION_FILE_MATCHED;
+  }
+
+  UnmapViewOfFile(file_view);
+
+close_mapping_handle:
+  CloseHandle(mapping_handle);
+
+close_file_handle:
+  CloseHandle(file_handle);
+
+  return status;
+}
+
+static void CheckCompanionFile(
+    const struct CompanionCheckWork* work,
+    size_t i_file
+) {
+  struct KnowledgeCompanionFileVersion* file_version;
+  size_t file_name_len;
+
+  wchar_t file_path[MAX_PATH];
+  char file_path_mb_buffer[MAX_PATH];
+  struct ConvertedString file_path_mb;
+  VS_FIXEDFILEINFO file_info;
+
+  file_version = &work->file_versions[i_file];
+  file_version->file_name = kCompanionFileNames[i_file];
+  file_version->status = KNOWLEDGE_COMPANION_FILE_READ_FAILED;
+  file_version->game_version = VERSION_UNKNOWN;
+
+  memset(
+      &file_version->file_version,
+      0,
+      sizeof(file_version->file_version)
+  );
+
+  file_name_len = wcslen(file_version->file_name);
+
+  if (work->game_dir_path_len + file_name_len >= MAX_PATH) {
+    return;
+  }
+
+  memcpy(
+      file_path,
+      work->game_dir_path,
+      work->game_dir_path_len * sizeof(file_path[0])
+  );
+
+  memcpy(
+      &file_path[work->game_dir_path_len],
+      file_version->file_name,
+      (file_name_len + 1) * sizeof(file_path[0])
+  );
+
+  /*
+  * The multibyte path is used, as CreateFileW is not implemented on
+  * Windows 9X.
+  */
+  ConvertWideToMultibyteInBuffer(
+      &file_path_mb,
+      file_path_mb_buffer,
+      sizeof(file_path_mb_buffer),
+      file_path
+  );
+
+  if (file_path_mb.str == NULL) {
+    return;
+  }
+
+  file_version->status = ReadCompanionFileVersion(
+      file_path_mb.str,
+      &file_info
+  );
+
+  ConvertedString_Deinit(&file_path_mb);
+
+  if (file_version->status != KNOWLEDGE_COMPANION_FILE_MATCHED) {
+    return;
+  }
+
+  GameFileVersion_Init(
+      &file_version->file_version,
+      file_info.dwFileVersionMS,
+      file_info.dwFileVersionLS
+  );
+
+  file_version->game_version = Diablo_II_SearchGameFileVersion(&file_info);
+
+  if (!GameFileVersion_Equals(
+      &file_version->file_version,
+      work->game_file_version
+  )) {
+    file_version->status = KNOWLEDGE_COMPANION_FILE_MISMATCHED;
+  }
+}
+
+static unsigned __stdcall RunCompanionCheckWork(void* param) {
+  const struct CompanionCheckWork* work;
+  size_t i_file;
+
+  work = param;
+
+  for (i_file = work->i_first_file;
+      i_file < work->num_files;
+      i_file += work->stride) {
+    CheckCompanionFile(work, i_file);
+  }
+
+  return 0;
+}
+
+size_t Diablo_II_CheckCompanionFiles(
+    const wchar_t* game_path,
+    size_t game_path_len,
+    enum GameVersion game_version,
+    const struct KnowledgeGameFileVersion* game_file_version,
+    struct KnowledgeCompanionFileVersion* file_versions
+) {
+  size_t game_dir_path_len;
+  size_t num_files;
+
+  struct CompanionCheckWork works[COMPANION_CHECK_MAX_THREADS];
+  HANDLE thread_handles[COMPANION_CHECK_MAX_THREADS];
+  size_t num_threads;
+  size_t num_started_threads;
+  size_t i_thread;
+  unsigned int thread_id;
+
+  /* Diablo II 1.14 merged its libraries into the game executable. */
+  if (game_version >= DIABLO_II_1_14A) {
+    return 0;
+  }
+
+  num_files = sizeof(kCompanionFileNames) / sizeof(kCompanionFileNames[0]);
+
+  game_dir_path_len = game_path_len;
+
+  while (game_dir_path_len > 0
+      && game_path[game_dir_path_len - 1] != L'\\'
+      && game_path[game_dir_path_len - 1] != L'/'
+      && game_path[game_dir_path_len - 1] != L':') {
+    game_dir_path_len -= 1;
+  }
+
+  Trace_BeginEvent("CheckCompanionFiles", GetCurrentProcessId(), num_files);
+
+  num_threads = (num_files < COMPANION_CHECK_MAX_THREADS)
+      ? num_files
+      : COMPANION_CHECK_MAX_THREADS;
+
+  for (i_thread = 0; i_thread < num_threads; i_thread += 1) {
+    works[i_thread].game_dir_path = game_path;
+    works[i_thread].game_dir_path_len = game_dir_path_len;
+    works[i_thread].game_file_version = game_file_version;
+    works[i_thread].file_versions = file_versions;
+    works[i_thread].num_files = num_files;
+    works[i_thread].i_first_file = i_thread;
+    works[i_thread].stride = num_threads;
+  }
+
+  /*
+  * The first share is checked on the calling thread. A share whose
+  * thread could not be started is also checked here, afterwards.
+  */
+  num_started_threads = 0;
+
+  for (i_thread = 1; i_thread < num_threads; i_thread += 1) {
+    thread_handles[num_started_threads] = (HANDLE) _beginthreadex(
+        NULL,
+        0,
+        &RunCompanionCheckWork,
+        &works[i_thread],
+        0,
+        &thread_id
+    );
+
+    if (thread_handles[num_started_threads] == NULL) {
+      break;
+    }
+
+    num_started_threads += 1;
+  }
+
+  if (num_threads > 0) {
+    RunCompanionCheckWork(&works[0]);
+  }
+
+  for (i_thread = num_started_threads + 1;
+      i_thread < num_threads;
+      i_thread += 1) {
+    RunCompanionCheckWork(&works[i_thread]);
+  }
+
+  if (num_started_threads > 0) {
+    WaitForMultipleObjects(
+        (DWORD) num_started_threads,
+        thread_handles,
+        TRUE,
+        INFINITE
+    );
+  }
+
+  for (i_thread = 0; i_thread < num_started_threads; i_thread += 1) {
+    CloseHandle(thread_handles[i_thread]);
+  }
+
+  Trace_EndEvent("CheckCompanionFiles", GetCurrentProcessId(), num_files);
+
+  return num_files;
+}
@@ -0,0 +1,57 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_DIABLO_II_DIABLO_II_COMPANION_FILES_H_
+#define SGGLDKL_DIABLO_II_DIABLO_II_COMPANION_FILES_H_
+
+#include <stddef.h>
+#include <wchar.h>
+#include <windows.h>
+
+#include "../../include/companion_file_version.h"
+#include "../game_version.h"
+
+/*
+* Checks the file version of each library that Diablo II ships beside
+* the game executable against the game executable's file version, so
+* that installs that were only partly patched can be found. The
+* libraries are read in parallel. Outputs one entry per library into
+* file_versions, which needs room for KNOWLEDGE_MAX_COMPANION_FILES
+* entries, and returns the number of entries. Diablo II 1.14 has no
+* separate libraries, so it has no entries.
+*/
+size_t Diablo_II_CheckCompanionFiles(
+    const wchar_t* game_path,
+    size_t game_path_len,
+    enum GameVersion game_version,
+    const struct KnowledgeGameFileVersion* game_file_version,
+    struct KnowledgeCompanionFileVersion* file_versions
+);
+
+#endif /* SGGLDKL_DIABLO_II_DIABLO_II_COMPANION_FILES_H_ */
@@ -30,14 +30,10 @@
 #include "diablo_ii_game_version.h"
 
 #include <stddef.h>
-#include <stdio.h>
 #include <string.h>
 
-#include "../helper/encoding.h"
-#include "../helper/error_handling.h"
-#include "../helper/file_info.h"
-#include "../helper/file_path.h"
 #include "../helper/file_signature.h"
+#include "../helper/game_file_source.h"
 #include "../helper/short_version.h"
 
 /*
@@ -196,10 +192,11 @@ static const struct GameVersionSignature k1001GameVersionSignatureTable[] = {
     },
 };
 
-static enum GameVersion DetermineGameVersionByData(
-    const wchar_t* game_file_path,
-    size_t game_file_path_len,
-    enum GameVersion guessed_game_version
+static int DetermineGameVersionByData(
+    const struct GameFileSource* source,
+    enum GameVersion guessed_game_version,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
 ) {
   const struct GuessCorrectionSignature search_key = {
       guessed_game_version
@@ -209,17 +206,6 @@ static enum GameVersion DetermineGameVersionByData(
   const struct GameVersionSignature* game_version_signature;
 
   unsigned char check_buffer[4];
-  size_t actual_num_check_bytes;
-
-  const size_t kExpectedNumCheckBytes = sizeof(check_buffer);
-  const size_t kExpectedNumCheckElems =
-      kExpectedNumCheckBytes / sizeof(check_buffer[0]);
-
-  wchar_t* adjacent_file_path;
-  FILE* game_file_stream;
-
-  int is_fseek_fail;
-  int is_fclose_fail;
 
   int compare_result;
 
@@ -234,83 +220,58 @@ static enum GameVersion DetermineGameVersionByData(
 
   /* It's not found, so the initial guess was likely correct. */
   if (search_result == NULL) {
-    return guessed_game_version;
+    detection->method = KNOWLEDGE_GAME_DETECTION_METHOD_FILE_VERSION;
+    detection->confidence = KNOWLEDGE_GAME_DETECTION_CONFIDENCE_CONFIRMED;
+
+    *game_version = guessed_game_version;
+
+    return 1;
   }
 
   game_version_signature = &search_result->game_version_signature;
 
-  /* Open the file for reading. */
-  adjacent_file_path = GetAdjacentFilePath(
-      game_file_path,
-      game_file_path_len,
+  if (!GameFileSource_ReadBytes(
+      source,
       game_version_signature->file_signature.file_path,
-      wcslen(game_version_signature->file_signature.file_path)
-  );
-
-  game_file_stream = _wfopen(adjacent_file_path, L"rb");
-
-  if (game_file_stream == NULL) {
-    ExitOnGeneralFailure(
-        L"Could not open file for reading.",
-        L"File Could Not Be Opened"
-    );
-  }
-
-  /* Seek to the pos */
-  is_fseek_fail = fseek(
-      game_file_stream,
+      wcslen(game_version_signature->file_signature.file_path),
       game_version_signature->file_signature.offset,
-      SEEK_SET
-  );
-
-  if (is_fseek_fail) {
-    ExitOnGeneralFailure(
-        L"Cannot seek to the file's target offset.",
-        L"Game Version Check Failure"
-    );
+      check_buffer,
+      sizeof(check_buffer)
+  )) {
+    return 0;
   }
 
-  actual_num_check_bytes = fread(
+  /* Check the bytes for each possible version. */
+  compare_result = memcmp(
       check_buffer,
-      sizeof(check_buffer[0]),
-      kExpectedNumCheckElems,
-      game_file_stream
+      game_version_signature->file_signature.signature,
+      sizeof(game_version_signature->file_signature.signature)
   );
 
-  if (actual_num_check_bytes != kExpectedNumCheckElems) {
-    ExitOnGeneralFailure(
-        L"Number of check bytes does not match.",
-        L"Game Version Check Failure"
-    );
-  }
+  /*
+  * If the signature does not match, the guess is only kept because it
+  * is not the other build that shares its file version.
+  */
+  if (compare_result == 0) {
+    detection->method = KNOWLEDGE_GAME_DETECTION_METHOD_FILE_SIGNATURE;
+    detection->confidence = KNOWLEDGE_GAME_DETECTION_CONFIDENCE_CONFIRMED;
 
-  is_fclose_fail = fclose(game_file_stream);
+    *game_version = game_version_signature->game_version;
 
-  if (is_fclose_fail) {
-    ExitOnGeneralFailure(
-        L"Failed to close the file stream.",
-        L"File Stream Failure"
-    );
+    return 1;
   }
 
-free_adjacent_file_path:
-  free(adjacent_file_path);
+  detection->method = KNOWLEDGE_GAME_DETECTION_METHOD_FILE_VERSION;
+  detection->confidence = KNOWLEDGE_GAME_DETECTION_CONFIDENCE_INFERRED;
 
-  /* Check the bytes for each possible version. */
-  compare_result = memcmp(
-      check_buffer,
-      game_version_signature->file_signature.signature,
-      sizeof(game_version_signature->file_signature.signature)
-  );
+  *game_version = guessed_game_version;
 
-  return (compare_result == 0)
-      ? game_version_signature->game_version
-      : guessed_game_version;
+  return 1;
 }
 
-static enum GameVersion Determine1001GameVersionByData(
-    const wchar_t* game_file_path,
-    size_t game_file_path_len
+static int Determine1001GameVersionByData(
+    const struct GameFileSource* source,
+    enum GameVersion* game_version
 ) {
   enum Constant {
     CHECK_POSITION = 0xF0
@@ -323,77 +284,15 @@ static enum GameVersion Determine1001GameVersionByData(
   struct GameVersionSignature search_key;
   const struct GameVersionSignature* search_result;
 
-  const size_t kExpectedNumCheckBytes =
-      sizeof(search_key.file_signature.signature);
-  const size_t kExpectedNumCheckElems = kExpectedNumCheckBytes
-      / sizeof(search_key.file_signature.signature[0]);
-
-  wchar_t* storm_file_path;
-  char* storm_file_path_mb;
-  FILE* game_file_stream;
-
-  int is_fseek_fail;
-  int is_fclose_fail;
-
-  size_t actual_num_check_bytes;
-
-  /* Determine the file for reading. */
-  storm_file_path = GetAdjacentFilePath(
-      game_file_path,
-      game_file_path_len,
+  if (!GameFileSource_ReadBytes(
+      source,
       kStormFileName,
-      kStormFileNameLen
-  );
-
-  /* Convert the path to multibyte characters. */
-  storm_file_path_mb = ConvertWideToMultibyte(NULL, storm_file_path);
-
-  game_file_stream = fopen(storm_file_path_mb, "rb");
-
-  if (game_file_stream == NULL) {
-    ExitOnGeneralFailure(
-        L"Could not open Storm.dll for reading.",
-        L"File Could Not Be Opened"
-    );
-  }
-
-  /* Seek to the pos */
-  is_fseek_fail = fseek(
-      game_file_stream,
+      kStormFileNameLen,
       CHECK_POSITION,
-      SEEK_SET
-  );
-
-  if (is_fseek_fail) {
-    ExitOnGeneralFailure(
-        L"Cannot seek to the file's target offset.",
-        L"Game Version Check Failure"
-    );
-  }
-
-  /* Read the bytes that will be checked. */
-  actual_num_check_bytes = fread(
       search_key.file_signature.signature,
-      sizeof(search_key.file_signature.signature[0]),
-      kExpectedNumCheckBytes,
-      game_file_stream
-  );
-
-  if (actual_num_check_bytes != kExpectedNumCheckElems) {
-    ExitOnGeneralFailure(
-        L"Number of check bytes does not match.",
-        L"Game Version Check Failure"
-    );
-  }
-
-  /* Close the file, now that the bytes have been read. */
-  is_fclose_fail = fclose(game_file_stream);
-
-  if (is_fclose_fail) {
-    ExitOnGeneralFailure(
-        L"Failed to close the file stream.",
-        L"File Stream Failure"
-    );
+      sizeof(search_key.file_signature.signature)
+  )) {
+    return 0;
   }
 
   /* Check the bytes for each possible version. */
@@ -409,20 +308,14 @@ static enum GameVersion Determine1001GameVersionByData(
       &GameVersionSignature_CompareAsVoidSignature
   );
 
-  if (search_result == NULL) {
-    return VERSION_UNKNOWN;
-  }
+  *game_version = (search_result != NULL)
+      ? search_result->game_version
+      : VERSION_UNKNOWN;
 
-free_storm_file_path_mb:
-  free(storm_file_path_mb);
-
-free_storm_file_path:
-  free(storm_file_path);
-
-  return search_result->game_version;
+  return 1;
 }
 
-static enum GameVersion SearchGameFileInfoTable(
+enum GameVersion Diablo_II_SearchGameFileVersion(
     const VS_FIXEDFILEINFO* game_file_info
 ) {
   const struct ShortVersionAndGameVersionEntry search_key = {
@@ -452,36 +345,54 @@ static enum GameVersion SearchGameFileInfoTable(
   return search_result->game_version;
 }
 
-enum GameVersion Diablo_II_FindGameVersion(
-    const wchar_t* game_file_path,
-    size_t game_file_path_len
+int Diablo_II_FindGameVersion(
+    const struct GameFileSource* source,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
 ) {
   VS_FIXEDFILEINFO game_file_info;
   enum GameVersion first_guess_game_version;
 
   /* Extract the file info from the game executable. */
-  ExtractFileInfo(&game_file_info, game_file_path);
+  if (!GameFileSource_ExtractFileInfo(source, NULL, 0, &game_file_info)) {
+    return 0;
+  }
+
+  GameFileVersion_Init(
+      &detection->game_file_version,
+      game_file_info.dwFileVersionMS,
+      game_file_info.dwFileVersionLS
+  );
+
+  GameFileVersion_Init(
+      &detection->game_product_version,
+      game_file_info.dwProductVersionMS,
+      game_file_info.dwProductVersionLS
+  );
 
   /*
   * Perform a search of the game version in the table. This will not
   * cover all cases, as some versions share file versions.
   */
-  first_guess_game_version = SearchGameFileInfoTable(&game_file_info);
+  first_guess_game_version = Diablo_II_SearchGameFileVersion(
+      &game_file_info
+  );
 
   /*
   * File version 1.0.0.1 is shared across prerelease and release
   * versions, so special case is needed.
   */
   if (first_guess_game_version == DIABLO_II_1_01) {
-    return Determine1001GameVersionByData(
-        game_file_path,
-        game_file_path_len
-    );
+    detection->method = KNOWLEDGE_GAME_DETECTION_METHOD_FILE_SIGNATURE;
+    detection->confidence = KNOWLEDGE_GAME_DETECTION_CONFIDENCE_CONFIRMED;
+
+    return Determine1001GameVersionByData(source, game_version);
   }
 
   return DetermineGameVersionByData(
-      game_file_path,
-      game_file_path_len,
-      first_guess_game_version
+      source,
+      first_guess_game_version,
+      detection,
+      game_version
   );
 }
@@ -35,9 +35,21 @@
 
 #include "../game_version.h"
 
-enum GameVersion Diablo_II_FindGameVersion(
-    const wchar_t* game_file_path,
-    size_t game_file_path_len
+/* Returns zero if the game files could not be read. */
+int Diablo_II_FindGameVersion(
+    const struct GameFileSource* source,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
+);
+
+/*
+* Returns the version whose game executable has the file version, or
+* VERSION_UNKNOWN. Some versions share a file version, in which case
+* only one of them is returned. The game's libraries have the same file
+* version as the game executable of their patch.
+*/
+enum GameVersion Diablo_II_SearchGameFileVersion(
+    const VS_FIXEDFILEINFO* file_info
 );
 
 #endif /* SGGLDKL_DIABLO_II_DIABLO_GAME_VERSION_H_ */
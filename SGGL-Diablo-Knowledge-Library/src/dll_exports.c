@@ -29,39 +29,450 @@
 
 #include "../include/dll_exports.h"
 
-#include "game_version.h"
+#include "buffer_detection.h"
+#include "diablo_ii/diablo_ii_companion_files.h"
 #include "game_version_printer.h"
-#include "library_injector.h"
+#include "helper/error_handling.h"
+#include "helper/trace.h"
+#include "injection_operation.h"
+#include "knowledge_context.h"
+#include "process_detection.h"
 
-static enum GameVersion running_game_version;
-static struct LibraryInjector library_injector;
+/* The context used by the exports that do not take one. */
+static struct KnowledgeContext* default_context = NULL;
 
-void Knowledge_Init(
+static void FillGameInfo(
+    struct KnowledgeGameInfo* game_info,
+    enum GameVersion game_version,
+    const struct KnowledgeGameDetection* detection
+) {
+  game_info->game_family = GameVersion_GetGameFamily(game_version);
+  game_info->game_version = game_version;
+
+  game_info->game_name = GameVersion_GetGameName(game_version);
+  game_info->game_name_len = GameVersion_GetGameNameLen(game_version);
+
+  game_info->version_text = GameVersion_GetVersionText(game_version);
+  game_info->version_text_len = GameVersion_GetVersionTextLen(game_version);
+
+  game_info->detection = *detection;
+}
+
+/*
+* Records a failure if there is no context, which is the case for the
+* default context before Knowledge_Init.
+*/
+static int IsContextValid(const struct KnowledgeContext* context) {
+  if (context == NULL) {
+    RecordGeneralFailure(
+        L"There is no context. Call Knowledge_Init or "
+            L"Knowledge_CreateContext first.",
+        L"No Context"
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+struct KnowledgeContext* Knowledge_CreateContext(
     const wchar_t* game_path,
     size_t game_path_len
 ) {
-  running_game_version = GameVersion_DetermineRunningGameVersion(
-      game_path,
-      game_path_len
+  return KnowledgeContext_Create(game_path, game_path_len);
+}
+
+void Knowledge_DestroyContext(struct KnowledgeContext* context) {
+  if (context == NULL) {
+    return;
+  }
+
+  KnowledgeContext_Destroy(context);
+}
+
+int Knowledge_ContextPrintGameInfo(struct KnowledgeContext* context) {
+  const struct InstallCacheEntry* install;
+
+  if (!IsContextValid(context)) {
+    return 0;
+  }
+
+  install = KnowledgeContext_GetInstall(context);
+
+  if (install == NULL) {
+    return 0;
+  }
+
+  PrintGameVersion(install->game_version);
+
+  return 1;
+}
+
+int Knowledge_ContextGetGameInfo(
+    struct KnowledgeContext* context,
+    struct KnowledgeGameInfo* game_info
+) {
+  const struct InstallCacheEntry* install;
+
+  if (!IsContextValid(context)) {
+    return 0;
+  }
+
+  install = KnowledgeContext_GetInstall(context);
+
+  if (install == NULL) {
+    return 0;
+  }
+
+  FillGameInfo(game_info, install->game_version, &install->detection);
+
+  return 1;
+}
+
+int Knowledge_ContextStartPrefetch(struct KnowledgeContext* context) {
+  if (!IsContextValid(context)) {
+    return 0;
+  }
+
+  return KnowledgeContext_StartPrefetch(context);
+}
+
+void Knowledge_ContextSetSharedMemoryTransportEnabled(
+    struct KnowledgeContext* context,
+    int is_enabled
+) {
+  if (!IsContextValid(context)) {
+    return;
+  }
+
+  LibraryInjector_SetSharedMemoryTransportEnabled(
+      &context->library_injector,
+      is_enabled
+  );
+}
+
+void Knowledge_ContextSetLibraryReadAheadEnabled(
+    struct KnowledgeContext* context,
+    int is_enabled
+) {
+  if (!IsContextValid(context)) {
+    return;
+  }
+
+  LibraryInjector_SetReadAheadEnabled(
+      &context->library_injector,
+      is_enabled
   );
+}
+
+void Knowledge_ContextSetInjectionStrategy(
+    struct KnowledgeContext* context,
+    enum KnowledgeInjectionStrategy injection_strategy
+) {
+  if (!IsContextValid(context)) {
+    return;
+  }
+
+  LibraryInjector_SetInjectionStrategy(
+      &context->library_injector,
+      injection_strategy
+  );
+}
+
+int Knowledge_ContextPreflightLibraries(
+    struct KnowledgeContext* context,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    struct KnowledgeLibraryPreflight* preflights
+) {
+  struct LibraryInjector* library_injector;
+
+  if (!IsContextValid(context)) {
+    return 0;
+  }
+
+  library_injector = KnowledgeContext_GetLibraryInjector(context);
+
+  if (library_injector == NULL) {
+    return 0;
+  }
+
+  return LibraryInjector_PreflightLibraries(
+      library_injector,
+      libraries_to_inject,
+      num_libraries,
+      preflights
+  );
+}
+
+int Knowledge_ContextCheckCompanionFiles(
+    struct KnowledgeContext* context,
+    struct KnowledgeCompanionFileVersion* file_versions,
+    size_t* num_file_versions
+) {
+  const struct InstallCacheEntry* install;
+
+  if (!IsContextValid(context)) {
+    return 0;
+  }
+
+  install = KnowledgeContext_GetInstall(context);
+
+  if (install == NULL) {
+    return 0;
+  }
+
+  if (GameVersion_GetGameFamily(install->game_version)
+      != KNOWLEDGE_GAME_FAMILY_DIABLO_II) {
+    *num_file_versions = 0;
+    return 1;
+  }
+
+  *num_file_versions = Diablo_II_CheckCompanionFiles(
+      install->game_path,
+      install->game_path_len,
+      install->game_version,
+      &install->detection.game_file_version,
+      file_versions
+  );
+
+  return 1;
+}
+
+int Knowledge_ContextInjectLibrariesToProcesses(
+    struct KnowledgeContext* context,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances
+) {
+  struct LibraryInjector* library_injector;
+
+  if (!IsContextValid(context)) {
+    return 0;
+  }
+
+  library_injector = KnowledgeContext_GetLibraryInjector(context);
+
+  if (library_injector == NULL) {
+    return 0;
+  }
+
+  return LibraryInjector_InjectLibrariesToProcesses(
+      library_injector,
+      libraries_to_inject,
+      num_libraries,
+      processes_infos,
+      num_instances
+  );
+}
+
+int Knowledge_ContextInjectLibrariesToProcessesWithResults(
+    struct KnowledgeContext* context,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    struct KnowledgeLibraryLoadResult* load_results
+) {
+  struct LibraryInjector* library_injector;
+
+  if (!IsContextValid(context)) {
+    return 0;
+  }
+
+  library_injector = KnowledgeContext_GetLibraryInjector(context);
+
+  if (library_injector == NULL) {
+    return 0;
+  }
+
+  return LibraryInjector_InjectLibrariesToProcessesWithStatus(
+      library_injector,
+      &library_injector->settings,
+      libraries_to_inject,
+      num_libraries,
+      processes_infos,
+      num_instances,
+      NULL,
+      load_results,
+      NULL
+  );
+}
+
+struct KnowledgeInjectionOperation*
+Knowledge_ContextInjectLibrariesToProcessesAsync(
+    struct KnowledgeContext* context,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    KnowledgeInjectionCallback callback,
+    void* callback_context
+) {
+  struct LibraryInjector* library_injector;
+
+  if (!IsContextValid(context)) {
+    return NULL;
+  }
+
+  library_injector = KnowledgeContext_GetLibraryInjector(context);
+
+  if (library_injector == NULL) {
+    return NULL;
+  }
 
-  LibraryInjector_Init(
-      &library_injector,
-      game_path,
-      game_path_len,
-      running_game_version
+  return InjectionOperation_Start(
+      library_injector,
+      libraries_to_inject,
+      num_libraries,
+      processes_infos,
+      num_instances,
+      callback,
+      callback_context
   );
 }
 
+int Knowledge_Init(
+    const wchar_t* game_path,
+    size_t game_path_len
+) {
+  /* Calling Knowledge_Init again replaces the default context. */
+  if (default_context != NULL) {
+    KnowledgeContext_Destroy(default_context);
+  }
+
+  default_context = KnowledgeContext_Create(game_path, game_path_len);
+
+  return default_context != NULL;
+}
+
 void Knowledge_Deinit(
     const PROCESS_INFORMATION* processes_infos,
     size_t num_instances
 ) {
-  LibraryInjector_Deinit(&library_injector);
+  if (default_context == NULL) {
+    return;
+  }
+
+  KnowledgeContext_Destroy(default_context);
+  default_context = NULL;
+}
+
+int Knowledge_GetLastErrorDetail(struct KnowledgeErrorDetail* error_detail) {
+  return ErrorHandling_GetLastErrorDetail(error_detail);
+}
+
+void Knowledge_SetExitOnFailureEnabled(int is_enabled) {
+  ErrorHandling_SetExitOnFailureEnabled(is_enabled);
+}
+
+int Knowledge_PrintGameInfo(void) {
+  return Knowledge_ContextPrintGameInfo(default_context);
+}
+
+int Knowledge_GetGameInfo(struct KnowledgeGameInfo* game_info) {
+  return Knowledge_ContextGetGameInfo(default_context, game_info);
+}
+
+int Knowledge_DetectFromProcess(
+    HANDLE process_handle,
+    struct KnowledgeGameInfo* game_info
+) {
+  struct KnowledgeGameDetection detection;
+  enum GameVersion game_version;
+
+  if (!ProcessDetection_DetectGameVersion(
+      process_handle,
+      &detection,
+      &game_version
+  )) {
+    return 0;
+  }
+
+  FillGameInfo(game_info, game_version, &detection);
+
+  return 1;
+}
+
+int Knowledge_DetectFromBuffers(
+    const void* game_data,
+    size_t game_size,
+    const struct KnowledgeFileBuffer* companion_buffers,
+    size_t num_companion_buffers,
+    struct KnowledgeGameInfo* game_info
+) {
+  struct KnowledgeGameDetection detection;
+  enum GameVersion game_version;
+
+  if (!BufferDetection_DetectGameVersion(
+      game_data,
+      game_size,
+      companion_buffers,
+      num_companion_buffers,
+      &detection,
+      &game_version
+  )) {
+    return 0;
+  }
+
+  FillGameInfo(game_info, game_version, &detection);
+
+  return 1;
+}
+
+int Knowledge_StartPrefetch(void) {
+  return Knowledge_ContextStartPrefetch(default_context);
+}
+
+void Knowledge_SetSharedMemoryTransportEnabled(int is_enabled) {
+  Knowledge_ContextSetSharedMemoryTransportEnabled(
+      default_context,
+      is_enabled
+  );
+}
+
+void Knowledge_SetLibraryReadAheadEnabled(int is_enabled) {
+  Knowledge_ContextSetLibraryReadAheadEnabled(default_context, is_enabled);
 }
 
-void Knowledge_PrintGameInfo(void) {
-  PrintGameVersion(running_game_version);
+void Knowledge_SetInjectionStrategy(
+    enum KnowledgeInjectionStrategy injection_strategy
+) {
+  Knowledge_ContextSetInjectionStrategy(default_context, injection_strategy);
+}
+
+void Knowledge_SetTraceEnabled(int is_enabled) {
+  Trace_SetEnabled(is_enabled);
+}
+
+int Knowledge_ExportTrace(const wchar_t* output_path) {
+  return Trace_ExportChromeJson(output_path);
+}
+
+int Knowledge_PreflightLibraries(
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    struct KnowledgeLibraryPreflight* preflights
+) {
+  return Knowledge_ContextPreflightLibraries(
+      default_context,
+      libraries_to_inject,
+      num_libraries,
+      preflights
+  );
+}
+
+int Knowledge_CheckCompanionFiles(
+    struct KnowledgeCompanionFileVersion* file_versions,
+    size_t* num_file_versions
+) {
+  return Knowledge_ContextCheckCompanionFiles(
+      default_context,
+      file_versions,
+      num_file_versions
+  );
 }
 
 int Knowledge_InjectLibrariesToProcesses(
@@ -70,11 +481,103 @@ int Knowledge_InjectLibrariesToProcesses(
     const PROCESS_INFORMATION* processes_infos,
     size_t num_instances
 ) {
-  return LibraryInjector_InjectLibrariesToProcesses(
-      &library_injector,
+  return Knowledge_ContextInjectLibrariesToProcesses(
+      default_context,
       libraries_to_inject,
       num_libraries,
       processes_infos,
       num_instances
   );
 }
+
+int Knowledge_InjectLibrariesToProcessesWithResults(
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    struct KnowledgeLibraryLoadResult* load_results
+) {
+  return Knowledge_ContextInjectLibrariesToProcessesWithResults(
+      default_context,
+      libraries_to_inject,
+      num_libraries,
+      processes_infos,
+      num_instances,
+      load_results
+  );
+}
+
+struct KnowledgeInjectionOperation* Knowledge_InjectLibrariesToProcessesAsync(
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    KnowledgeInjectionCallback callback,
+    void* callback_context
+) {
+  return Knowledge_ContextInjectLibrariesToProcessesAsync(
+      default_context,
+      libraries_to_inject,
+      num_libraries,
+      processes_infos,
+      num_instances,
+      callback,
+      callback_context
+  );
+}
+
+int Knowledge_WaitForInjection(
+    struct KnowledgeInjectionOperation* operation,
+    DWORD timeout_ms
+) {
+  return InjectionOperation_Wait(operation, timeout_ms);
+}
+
+int Knowledge_IsInjectionComplete(
+    const struct KnowledgeInjectionOperation* operation
+) {
+  return InjectionOperation_IsComplete(operation);
+}
+
+int Knowledge_GetInjectionResult(
+    const struct KnowledgeInjectionOperation* operation
+) {
+  return InjectionOperation_GetResult(operation);
+}
+
+int Knowledge_GetInjectionErrorDetail(
+    const struct KnowledgeInjectionOperation* operation,
+    struct KnowledgeErrorDetail* error_detail
+) {
+  return InjectionOperation_GetErrorDetail(operation, error_detail);
+}
+
+void Knowledge_CancelInjection(struct KnowledgeInjectionOperation* operation) {
+  InjectionOperation_Cancel(operation);
+}
+
+int Knowledge_GetInjectionProgress(
+    const struct KnowledgeInjectionOperation* operation,
+    size_t i_instance,
+    struct KnowledgeInjectionProgress* progress
+) {
+  return InjectionOperation_GetProgress(operation, i_instance, progress);
+}
+
+int Knowledge_GetInjectionLibraryLoadResult(
+    const struct KnowledgeInjectionOperation* operation,
+    size_t i_instance,
+    size_t i_library,
+    struct KnowledgeLibraryLoadResult* load_result
+) {
+  return InjectionOperation_GetLibraryLoadResult(
+      operation,
+      i_instance,
+      i_library,
+      load_result
+  );
+}
+
+void Knowledge_CloseInjection(struct KnowledgeInjectionOperation* operation) {
+  InjectionOperation_Close(operation);
+}
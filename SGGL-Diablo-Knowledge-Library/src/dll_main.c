@@ -29,6 +29,10 @@
 
 #include <windows.h>
 
+#include "helper/error_handling.h"
+#include "helper/trace.h"
+#include "install_cache.h"
+
 BOOL WINAPI DllMain(
     HINSTANCE hinstDLL,
     DWORD fdwReason,
@@ -36,10 +40,21 @@ BOOL WINAPI DllMain(
 ) {
   switch (fdwReason) {
     case DLL_PROCESS_ATTACH: {
+      ErrorHandling_Init();
+      Trace_Init();
+      InstallCache_Init();
+      break;
+    }
+
+    case DLL_THREAD_DETACH: {
+      ErrorHandling_DeinitThread();
       break;
     }
 
     case DLL_PROCESS_DETACH: {
+      InstallCache_Deinit();
+      Trace_Deinit();
+      ErrorHandling_Deinit();
       break;
     }
   }
@@ -30,24 +30,27 @@
 #include "game_version.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <windows.h>
 
 #include "diablo/diablo_game_version.h"
 #include "diablo_ii/diablo_ii_game_version.h"
 #include "hellfire/hellfire_game_version.h"
 #include "helper/error_handling.h"
-#include "helper/file_info.h"
+#include "helper/file_path.h"
+#include "helper/game_file_source.h"
 #include "helper/game_version_finder.h"
 
 /*
-* The order of the entries should be in lexicographical order, due to
-* the reliance on bsearch.
+* The order of the entries should be in the order of wcscmp, due to the
+* reliance on bsearch. Uppercase letters come before lowercase ones, so
+* "BLizzard" comes before "Blizzard".
 */
 
 static const struct ProductNameAndFindGameVersionFunctionEntry
 find_version_func_table[] = {
-    { L"Blizzard Entertainment Diablo", &Diablo_FindGameVersion },
     { L"BLizzard North Diablo 2", &Diablo_II_FindGameVersion },
+    { L"Blizzard Entertainment Diablo", &Diablo_FindGameVersion },
     { L"Blizzard North Diablo II", &Diablo_II_FindGameVersion },
     { L"Diablo II", &Diablo_II_FindGameVersion },
     { L"Diablo II : Lord of Destruction", &Diablo_II_FindGameVersion },
@@ -58,8 +61,60 @@ enum GameVersion GameVersion_DetermineRunningGameVersion(
     const wchar_t* game_path,
     size_t game_path_len
 ) {
+  struct GamePathContext path_context;
+  struct KnowledgeGameDetection detection;
   enum GameVersion running_game_version;
 
+  if (!GamePathContext_Init(&path_context, game_path, game_path_len)) {
+    return VERSION_UNKNOWN;
+  }
+
+  if (!GameVersion_DetectRunningGameVersion(
+      game_path,
+      game_path_len,
+      &path_context,
+      &detection,
+      &running_game_version
+  )) {
+    return VERSION_UNKNOWN;
+  }
+
+  return running_game_version;
+}
+
+int GameVersion_DetectRunningGameVersion(
+    const wchar_t* game_path,
+    size_t game_path_len,
+    struct GamePathContext* path_context,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
+) {
+  struct GameFilePaths file_paths;
+  struct GameFileSource source;
+
+  file_paths.game_path = game_path;
+  file_paths.path_context = path_context;
+
+  GameFileSource_Init(
+      &source,
+      GameFileSourceOps_GetFileSystem(),
+      &file_paths
+  );
+
+  return GameVersion_DetectGameVersionFromSource(
+      &source,
+      detection,
+      game_version
+  );
+}
+
+int GameVersion_DetectGameVersionFromSource(
+    const struct GameFileSource* source,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
+) {
+  int is_success;
+
   const wchar_t* kProductNameStr = L"ProductName";
   const size_t kProductNameLen =
       (sizeof(L"ProductName") / sizeof(kProductNameStr[0])) - 1;
@@ -69,13 +124,19 @@ enum GameVersion GameVersion_DetermineRunningGameVersion(
 
   wchar_t* running_product_name;
 
+  GameDetection_Init(detection);
+
   /* Initialize everything required for determining the game. */
-  running_product_name = ExtractFileStringValue(
-      game_path,
+  running_product_name = GameFileSource_ExtractStringValue(
+      source,
       kProductNameStr,
       kProductNameLen
   );
 
+  if (running_product_name == NULL) {
+    return 0;
+  }
+
   search_key.product_name = running_product_name;
 
   /* Determine what to do based on the reported game name. */
@@ -90,18 +151,62 @@ enum GameVersion GameVersion_DetermineRunningGameVersion(
       );
 
   if (search_result == NULL) {
-    running_game_version = VERSION_UNKNOWN;
+    *game_version = VERSION_UNKNOWN;
+    is_success = 1;
 
     goto free_running_product_name;
   }
 
-  running_game_version = search_result->game_version_find_func_ptr(
-      game_path,
-      game_path_len
+  is_success = search_result->game_version_find_func_ptr(
+      source,
+      detection,
+      game_version
   );
 
+  /* A version that is not found cannot have been confirmed. */
+  if (!is_success || *game_version == VERSION_UNKNOWN) {
+    detection->method = KNOWLEDGE_GAME_DETECTION_METHOD_NONE;
+    detection->confidence = KNOWLEDGE_GAME_DETECTION_CONFIDENCE_NONE;
+  }
+
 free_running_product_name:
   free(running_product_name);
 
-  return running_game_version;
+  return is_success;
+}
+
+void GameDetection_Init(struct KnowledgeGameDetection* detection) {
+  detection->method = KNOWLEDGE_GAME_DETECTION_METHOD_NONE;
+  detection->confidence = KNOWLEDGE_GAME_DETECTION_CONFIDENCE_NONE;
+
+  memset(
+      &detection->game_file_version,
+      0,
+      sizeof(detection->game_file_version)
+  );
+
+  memset(
+      &detection->game_product_version,
+      0,
+      sizeof(detection->game_product_version)
+  );
+
+  memset(
+      &detection->storm_file_version,
+      0,
+      sizeof(detection->storm_file_version)
+  );
+}
+
+void GameFileVersion_Init(
+    struct KnowledgeGameFileVersion* file_version,
+    unsigned long version_ms,
+    unsigned long version_ls
+) {
+  file_version->is_read = 1;
+
+  file_version->major_left = (unsigned short) ((version_ms >> 16) & 0xFFFF);
+  file_version->major_right = (unsigned short) ((version_ms >> 0) & 0xFFFF);
+  file_version->minor_left = (unsigned short) ((version_ls >> 16) & 0xFFFF);
+  file_version->minor_right = (unsigned short) ((version_ls >> 0) & 0xFFFF);
 }
@@ -33,29 +33,63 @@
 #include <stddef.h>
 #include <wchar.h>
 
+#include "../include/game_info.h"
+
+struct GameFileSource;
+struct GamePathContext;
+
 enum GameVersion {
   VERSION_UNKNOWN = -1,
 
-  DIABLO_1_00 = 1, DIABLO_1_02, DIABLO_1_03, DIABLO_1_04, DIABLO_1_05,
-  DIABLO_1_07, DIABLO_1_08, DIABLO_1_09, DIABLO_1_09B,
-
-  HELLFIRE_1_00, HELLFIRE_1_01,
+  /* Not a game version. This keeps the first game version at 1. */
+  VERSION_RESERVED,
 
-  DIABLO_II_BETA_1_02, DIABLO_II_STRESS_TEST_BETA_1_02,
-  DIABLO_II_1_00, DIABLO_II_1_01, DIABLO_II_1_02, DIABLO_II_1_03,
-  DIABLO_II_1_04, DIABLO_II_1_04B, DIABLO_II_1_04C, DIABLO_II_1_05,
-  DIABLO_II_1_05B, DIABLO_II_1_06, DIABLO_II_1_06B,
+#define GAME_VERSION_ENTRY(game_version, game_family, version_text) \
+    game_version,
+#include "game_version_manifest.inc"
+#undef GAME_VERSION_ENTRY
 
-  DIABLO_II_1_07_BETA, DIABLO_II_1_07, DIABLO_II_1_08, DIABLO_II_1_09,
-  DIABLO_II_1_09B, DIABLO_II_1_09C, DIABLO_II_1_09D, DIABLO_II_1_10_BETA,
-  DIABLO_II_1_10S_BETA, DIABLO_II_1_10, DIABLO_II_1_11, DIABLO_II_1_11B,
-  DIABLO_II_1_12A, DIABLO_II_1_13A_PTR, DIABLO_II_1_13C, DIABLO_II_1_13D,
-  DIABLO_II_1_14A, DIABLO_II_1_14B, DIABLO_II_1_14C, DIABLO_II_1_14D
+  /* One past the last game version. */
+  VERSION_END
 };
 
+/* Returns VERSION_UNKNOWN if the game files could not be read. */
 enum GameVersion GameVersion_DetermineRunningGameVersion(
     const wchar_t* game_path,
     size_t game_path_len
 );
 
+/*
+* Same as GameVersion_DetermineRunningGameVersion, but also records how
+* the version was determined. The paths of the companion files that
+* are found are cached in the path context. Returns zero if the game
+* files could not be read, which is distinct from an unknown version.
+*/
+int GameVersion_DetectRunningGameVersion(
+    const wchar_t* game_path,
+    size_t game_path_len,
+    struct GamePathContext* path_context,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
+);
+
+/*
+* Same as GameVersion_DetectRunningGameVersion, but reads the game files
+* from the source, which need not be on disk.
+*/
+int GameVersion_DetectGameVersionFromSource(
+    const struct GameFileSource* source,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
+);
+
+void GameDetection_Init(struct KnowledgeGameDetection* detection);
+
+/* Records a version from the version resource of a file. */
+void GameFileVersion_Init(
+    struct KnowledgeGameFileVersion* file_version,
+    unsigned long version_ms,
+    unsigned long version_ls
+);
+
 #endif /* SGGLDKL_GAME_VERSION_H_ */
@@ -31,220 +31,123 @@
 
 #include <stdio.h>
 
-#include "helper/error_handling.h"
 #include "game_version.h"
 
-static const char* GetGameName(enum GameVersion game_version) {
-  if (game_version >= DIABLO_1_00 && game_version <= DIABLO_1_09B) {
-    return "Diablo";
-  } else if (game_version >= HELLFIRE_1_00
-      && game_version <= HELLFIRE_1_01) {
-    return "Hellfire";
-  } else if (game_version >= DIABLO_II_BETA_1_02
-      && game_version <= DIABLO_II_1_14D) {
-    return "Diablo II";
-  } else if (game_version == VERSION_UNKNOWN) {
-    return "Unknown game";
-  } else {
-    ExitOnGeneralFailure(
-        L"Invalid game version state.",
-        L"Error"
-    );
-
-    return NULL;
-  }
+/*
+* The tables are generated from the game version manifest, and are
+* indexed by the game version. Index VERSION_RESERVED is shared by
+* VERSION_UNKNOWN and any invalid value.
+*/
+static const enum KnowledgeGameFamily kGameFamilies[] = {
+    KNOWLEDGE_GAME_FAMILY_UNKNOWN,
+
+#define GAME_VERSION_ENTRY(game_version, game_family, version_text) \
+    game_family,
+#include "game_version_manifest.inc"
+#undef GAME_VERSION_ENTRY
+};
+
+static const char* const kVersionTexts[] = {
+    "Invalid",
+
+#define GAME_VERSION_ENTRY(game_version, game_family, version_text) \
+    version_text,
+#include "game_version_manifest.inc"
+#undef GAME_VERSION_ENTRY
+};
+
+static const size_t kVersionTextLens[] = {
+    sizeof("Invalid") - 1,
+
+#define GAME_VERSION_ENTRY(game_version, game_family, version_text) \
+    sizeof(version_text) - 1,
+#include "game_version_manifest.inc"
+#undef GAME_VERSION_ENTRY
+};
+
+static const char* const kGameNames[] = {
+    /* KNOWLEDGE_GAME_FAMILY_UNKNOWN */ "Unknown game",
+    /* KNOWLEDGE_GAME_FAMILY_DIABLO */ "Diablo",
+    /* KNOWLEDGE_GAME_FAMILY_HELLFIRE */ "Hellfire",
+    /* KNOWLEDGE_GAME_FAMILY_DIABLO_II */ "Diablo II"
+};
+
+static const size_t kGameNameLens[] = {
+    sizeof("Unknown game") - 1,
+    sizeof("Diablo") - 1,
+    sizeof("Hellfire") - 1,
+    sizeof("Diablo II") - 1
+};
+
+/*
+* Compile time checks that the tables cover every game version and game
+* family. An array with a negative size fails to compile.
+*/
+typedef char GameFamiliesSizeCheck[
+    (sizeof(kGameFamilies) / sizeof(kGameFamilies[0]) == VERSION_END)
+        ? 1
+        : -1
+];
+
+typedef char VersionTextsSizeCheck[
+    (sizeof(kVersionTexts) / sizeof(kVersionTexts[0]) == VERSION_END)
+        ? 1
+        : -1
+];
+
+typedef char VersionTextLensSizeCheck[
+    (sizeof(kVersionTextLens) / sizeof(kVersionTextLens[0]) == VERSION_END)
+        ? 1
+        : -1
+];
+
+typedef char GameNamesSizeCheck[
+    (sizeof(kGameNames) / sizeof(kGameNames[0]) == KNOWLEDGE_GAME_FAMILY_END)
+        ? 1
+        : -1
+];
+
+typedef char GameNameLensSizeCheck[
+    (sizeof(kGameNameLens) / sizeof(kGameNameLens[0])
+        == sizeof(kGameNames) / sizeof(kGameNames[0]))
+        ? 1
+        : -1
+];
+
+static size_t GetTableIndex(enum GameVersion game_version) {
+  return ((unsigned int) game_version < (unsigned int) VERSION_END)
+      ? (size_t) game_version
+      : (size_t) VERSION_RESERVED;
 }
 
-static const char* GetVersionText(enum GameVersion game_version) {
-  switch (game_version) {
-    case DIABLO_1_00: {
-      return "1.00";
-    }
-
-    case DIABLO_1_02: {
-      return "1.02";
-    }
-
-    case DIABLO_1_03: {
-      return "1.03";
-    }
-
-    case DIABLO_1_04: {
-      return "1.04";
-    }
-
-    case DIABLO_1_05: {
-      return "1.05";
-    }
-
-    case DIABLO_1_07: {
-      return "1.07";
-    }
-
-    case DIABLO_1_08: {
-      return "1.08";
-    }
-
-    case DIABLO_1_09: {
-      return "1.09";
-    }
-
-    case DIABLO_1_09B: {
-      return "1.09B";
-    }
-
-    case HELLFIRE_1_00: {
-      return "1.00";
-    }
-
-    case HELLFIRE_1_01: {
-      return "1.01";
-    }
-
-    case DIABLO_II_BETA_1_02: {
-      return "Beta 1.02";
-    }
-
-    case DIABLO_II_STRESS_TEST_BETA_1_02: {
-      return "Beta Stress Test 1.02";
-    }
-
-    case DIABLO_II_1_00: {
-      return "1.00";
-    }
-
-    case DIABLO_II_1_01: {
-      return "1.01";
-    }
-
-    case DIABLO_II_1_02: {
-      return "1.02";
-    }
-
-    case DIABLO_II_1_03: {
-      return "1.03";
-    }
-
-    case DIABLO_II_1_04: {
-      return "1.04";
-    }
-
-    case DIABLO_II_1_04B: {
-      return "1.04B";
-    }
-
-    case DIABLO_II_1_04C: {
-      return "1.04C";
-    }
-
-    case DIABLO_II_1_05: {
-      return "1.05";
-    }
-
-    case DIABLO_II_1_05B: {
-      return "1.05B";
-    }
-
-    case DIABLO_II_1_06: {
-      return "1.06";
-    }
-
-    case DIABLO_II_1_06B: {
-      return "1.06B";
-    }
-
-    case DIABLO_II_1_07_BETA: {
-      return "1.07 Beta";
-    }
-
-    case DIABLO_II_1_07: {
-      return "1.07";
-    }
-
-    case DIABLO_II_1_08: {
-      return "1.08";
-    }
-
-    case DIABLO_II_1_09: {
-      return "1.09";
-    }
-
-    case DIABLO_II_1_09B: {
-      return "1.09B";
-    }
-
-    case DIABLO_II_1_09C: {
-      return "1.09C";
-    }
-
-    case DIABLO_II_1_09D: {
-      return "1.09D";
-    }
-
-    case DIABLO_II_1_10_BETA: {
-      return "1.10 Beta";
-    }
-
-    case DIABLO_II_1_10S_BETA: {
-      return "1.10S Beta";
-    }
-
-    case DIABLO_II_1_10: {
-      return "1.10";
-    }
-
-    case DIABLO_II_1_11: {
-      return "1.11";
-    }
-
-    case DIABLO_II_1_11B: {
-      return "1.11B";
-    }
-
-    case DIABLO_II_1_12A: {
-      return "1.12A";
-    }
-
-    case DIABLO_II_1_13A_PTR: {
-      return "1.13A";
-    }
-
-    case DIABLO_II_1_13C: {
-      return "1.13C";
-    }
-
-    case DIABLO_II_1_13D: {
-      return "1.13D";
-    }
-
-    case DIABLO_II_1_14A: {
-      return "1.14A";
-    }
+enum KnowledgeGameFamily GameVersion_GetGameFamily(
+    enum GameVersion game_version
+) {
+  return kGameFamilies[GetTableIndex(game_version)];
+}
 
-    case DIABLO_II_1_14B: {
-      return "1.14B";
-    }
+const char* GameVersion_GetGameName(enum GameVersion game_version) {
+  return kGameNames[GameVersion_GetGameFamily(game_version)];
+}
 
-    case DIABLO_II_1_14C: {
-      return "1.14C";
-    }
+size_t GameVersion_GetGameNameLen(enum GameVersion game_version) {
+  return kGameNameLens[GameVersion_GetGameFamily(game_version)];
+}
 
-    case DIABLO_II_1_14D: {
-      return "1.14D";
-    }
+const char* GameVersion_GetVersionText(enum GameVersion game_version) {
+  return kVersionTexts[GetTableIndex(game_version)];
+}
 
-    default: {
-      return "Invalid";
-    }
-  }
+size_t GameVersion_GetVersionTextLen(enum GameVersion game_version) {
+  return kVersionTextLens[GetTableIndex(game_version)];
 }
 
 void PrintGameVersion(enum GameVersion game_version) {
   const char* game_name;
   const char* game_version_text;
 
-  game_name = GetGameName(game_version);
-  game_version_text = GetVersionText(game_version);
+  game_name = GameVersion_GetGameName(game_version);
+  game_version_text = GameVersion_GetVersionText(game_version);
 
   printf("Game information: \n");
   printf("%s %s \n\n", game_name, game_version_text);
@@ -30,8 +30,27 @@
 #ifndef SGGLDKL_GAME_VERSION_PRINTER_H_
 #define SGGLDKL_GAME_VERSION_PRINTER_H_
 
+#include <stddef.h>
+
+#include "../include/game_info.h"
 #include "game_version.h"
 
+/*
+* These are backed by constant tables, so they do not allocate and are
+* safe to call from any thread. The returned strings are static.
+*/
+enum KnowledgeGameFamily GameVersion_GetGameFamily(
+    enum GameVersion game_version
+);
+
+const char* GameVersion_GetGameName(enum GameVersion game_version);
+
+size_t GameVersion_GetGameNameLen(enum GameVersion game_version);
+
+const char* GameVersion_GetVersionText(enum GameVersion game_version);
+
+size_t GameVersion_GetVersionTextLen(enum GameVersion game_version);
+
 void PrintGameVersion(enum GameVersion game_version);
 
 #endif /* SGGLDKL_GAME_VERSION_PRINTER_H_ */
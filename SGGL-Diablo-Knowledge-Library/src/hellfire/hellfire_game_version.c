@@ -33,7 +33,7 @@
 #include <stddef.h>
 #include <windows.h>
 
-#include "../helper/file_info.h"
+#include "../helper/game_file_source.h"
 #include "../helper/short_version.h"
 
 /*
@@ -77,27 +77,34 @@ static enum GameVersion SearchGameVersionTable(
   return VERSION_UNKNOWN;
 }
 
-enum GameVersion Hellfire_FindGameVersion(
-    const wchar_t* hellfire_file_path,
-    size_t hellfire_file_path_len
+int Hellfire_FindGameVersion(
+    const struct GameFileSource* source,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
 ) {
   const wchar_t* kFileVersionString = L"FileVersion";
   const size_t kFileVersionStringLen =
       (sizeof(L"FileVersion") / sizeof(kFileVersionString[0])) - 1;
 
-  enum GameVersion running_game_version;
   wchar_t* file_version_str;
 
-  file_version_str = ExtractFileStringValue(
-      hellfire_file_path,
+  file_version_str = GameFileSource_ExtractStringValue(
+      source,
       L"FileVersion",
       kFileVersionStringLen
   );
 
-  running_game_version = SearchGameVersionTable(file_version_str);
+  if (file_version_str == NULL) {
+    return 0;
+  }
+
+  *game_version = SearchGameVersionTable(file_version_str);
+
+  detection->method = KNOWLEDGE_GAME_DETECTION_METHOD_FILE_VERSION_STRING;
+  detection->confidence = KNOWLEDGE_GAME_DETECTION_CONFIDENCE_CONFIRMED;
 
 free_file_version_str:
   free(file_version_str);
 
-  return running_game_version;
+  return 1;
 }
@@ -35,9 +35,11 @@
 
 #include "../game_version.h"
 
-enum GameVersion Hellfire_FindGameVersion(
-    const wchar_t* hellfire_file_path,
-    size_t hellfire_file_path_len
+/* Returns zero if the game files could not be read. */
+int Hellfire_FindGameVersion(
+    const struct GameFileSource* source,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
 );
 
 #endif /* SGGLDKL_HELLFIRE_HELLFIRE_GAME_VERSION_H_ */
@@ -42,6 +42,7 @@ static char* ConvertWideToChar(
 ) {
   int num_chars;
   int converted_chars;
+  char* allocated_string;
 
   /* Determine the number of characters needed. */
   num_chars = WideCharToMultiByte(
@@ -56,21 +57,28 @@ static char* ConvertWideToChar(
   );
 
   if (num_chars == 0) {
-    ExitOnWindowsFunctionFailureWithLastError(
+    RecordWindowsFunctionFailureWithLastError(
         L"WideCharToMultiByte",
         GetLastError()
     );
+
+    return NULL;
   }
 
   /* Allocate space if the char string is NULL. */
+  allocated_string = NULL;
+
   if (char_string == NULL) {
-    char_string = (char*) malloc(
-        num_chars * sizeof(char_string[0])
+    allocated_string = (char*) malloc(
+        num_chars * sizeof(allocated_string[0])
     );
 
-    if (char_string == NULL) {
-      ExitOnAllocationFailure();
+    if (allocated_string == NULL) {
+      RecordAllocationFailure();
+      return NULL;
     }
+
+    char_string = allocated_string;
   }
 
   /*
@@ -88,19 +96,216 @@ static char* ConvertWideToChar(
   );
 
   if (converted_chars == 0) {
-    ExitOnWindowsFunctionFailureWithLastError(
+    RecordWindowsFunctionFailureWithLastError(
         L"WideCharToMultiByte",
         GetLastError()
     );
+
+    goto free_allocated_string;
   } else if (converted_chars < num_chars) {
-    ExitOnGeneralFailure(
+    RecordGeneralFailure(
         L"The number of converted characters is less than the intended "
         L"count.",
         L"String Conversion Failed"
     );
+
+    goto free_allocated_string;
   }
 
   return char_string;
+
+free_allocated_string:
+  free(allocated_string);
+
+  return NULL;
+}
+
+/*
+* Checks four characters per iteration, combining them with OR so that
+* only one comparison is needed for each block.
+*/
+static int IsWideAscii(const wchar_t* wide_string, size_t wide_len) {
+  size_t i;
+  unsigned long combined_chars;
+
+  combined_chars = 0;
+
+  for (i = 0; i + 4 <= wide_len; i += 4) {
+    combined_chars |= wide_string[i]
+        | wide_string[i + 1]
+        | wide_string[i + 2]
+        | wide_string[i + 3];
+
+    if ((combined_chars & ~0x7FUL) != 0) {
+      return 0;
+    }
+  }
+
+  for (; i < wide_len; i += 1) {
+    combined_chars |= wide_string[i];
+  }
+
+  return (combined_chars & ~0x7FUL) == 0;
+}
+
+/* Copies the ASCII string, including the null-terminator. */
+static void NarrowWideAscii(
+    char* char_string,
+    const wchar_t* wide_string,
+    size_t wide_len
+) {
+  size_t i;
+
+  for (i = 0; i + 4 <= wide_len; i += 4) {
+    char_string[i] = (char) wide_string[i];
+    char_string[i + 1] = (char) wide_string[i + 1];
+    char_string[i + 2] = (char) wide_string[i + 2];
+    char_string[i + 3] = (char) wide_string[i + 3];
+  }
+
+  for (; i < wide_len; i += 1) {
+    char_string[i] = (char) wide_string[i];
+  }
+
+  char_string[wide_len] = '\0';
+}
+
+static char* AllocateFallbackString(
+    struct ConvertedString* converted_string,
+    size_t num_chars
+) {
+  converted_string->fallback_str = (char*) malloc(
+      num_chars * sizeof(converted_string->fallback_str[0])
+  );
+
+  if (converted_string->fallback_str == NULL) {
+    RecordAllocationFailure();
+  }
+
+  return converted_string->fallback_str;
+}
+
+static size_t ConvertWideToCharInBuffer(
+    struct ConvertedString* converted_string,
+    char* buffer,
+    size_t buffer_size,
+    const wchar_t* wide_string,
+    unsigned int code_page
+) {
+  size_t wide_len;
+  int num_chars;
+  int converted_chars;
+
+  converted_string->fallback_str = NULL;
+
+  wide_len = wcslen(wide_string);
+
+  /* ASCII is encoded the same in every supported code page. */
+  if (IsWideAscii(wide_string, wide_len)) {
+    converted_string->str = (wide_len < buffer_size)
+        ? buffer
+        : AllocateFallbackString(converted_string, wide_len + 1);
+
+    if (converted_string->str == NULL) {
+      goto fail;
+    }
+
+    NarrowWideAscii(converted_string->str, wide_string, wide_len);
+    converted_string->len = wide_len;
+
+    return converted_string->len;
+  }
+
+  /*
+  * Try to convert directly into the buffer, so that the number of
+  * characters does not need to be determined in a separate pass. Each
+  * wide character is converted to at least one char, so the attempt is
+  * skipped if the buffer cannot fit the string.
+  */
+  if (wide_len < buffer_size) {
+    converted_chars = WideCharToMultiByte(
+        code_page,
+        0,
+        wide_string,
+        -1,
+        buffer,
+        (int) buffer_size,
+        NULL,
+        NULL
+    );
+
+    if (converted_chars != 0) {
+      converted_string->str = buffer;
+      converted_string->len = converted_chars - 1;
+
+      return converted_string->len;
+    }
+
+    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+      RecordWindowsFunctionFailureWithLastError(
+          L"WideCharToMultiByte",
+          GetLastError()
+      );
+
+      goto fail;
+    }
+  }
+
+  /* The buffer is too small, so fall back to the heap. */
+  num_chars = WideCharToMultiByte(
+      code_page,
+      0,
+      wide_string,
+      -1,
+      NULL,
+      0,
+      NULL,
+      NULL
+  );
+
+  if (num_chars == 0) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"WideCharToMultiByte",
+        GetLastError()
+    );
+
+    goto fail;
+  }
+
+  converted_string->str = AllocateFallbackString(converted_string, num_chars);
+
+  if (converted_string->str == NULL) {
+    goto fail;
+  }
+
+  converted_chars = WideCharToMultiByte(
+      code_page,
+      0,
+      wide_string,
+      -1,
+      converted_string->str,
+      num_chars,
+      NULL,
+      NULL
+  );
+
+  if (converted_chars == 0) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"WideCharToMultiByte",
+        GetLastError()
+    );
+
+    goto fail;
+  }
+
+  converted_string->len = converted_chars - 1;
+
+  return converted_string->len;
+
+fail:
+  ConvertedString_Deinit(converted_string);
+
+  return 0;
 }
 
 static wchar_t* ConvertCharToWide(
@@ -110,6 +315,7 @@ static wchar_t* ConvertCharToWide(
 ) {
   int num_wide_chars;
   int converted_chars;
+  wchar_t* allocated_string;
 
   /* Determine the number of characters needed. */
   num_wide_chars = MultiByteToWideChar(
@@ -122,21 +328,28 @@ static wchar_t* ConvertCharToWide(
   );
 
   if (num_wide_chars == 0) {
-    ExitOnWindowsFunctionFailureWithLastError(
+    RecordWindowsFunctionFailureWithLastError(
         L"MultiByteToWideChar",
         GetLastError()
     );
+
+    return NULL;
   }
 
   /* Allocate space if the wide_string is NULL. */
+  allocated_string = NULL;
+
   if (wide_string == NULL) {
-    wide_string = (wchar_t*) malloc(
-        num_wide_chars * sizeof(wide_string[0])
+    allocated_string = (wchar_t*) malloc(
+        num_wide_chars * sizeof(allocated_string[0])
     );
 
-    if (wide_string == NULL) {
-      ExitOnAllocationFailure();
+    if (allocated_string == NULL) {
+      RecordAllocationFailure();
+      return NULL;
     }
+
+    wide_string = allocated_string;
   }
 
   /*
@@ -152,19 +365,28 @@ static wchar_t* ConvertCharToWide(
   );
 
   if (converted_chars == 0) {
-    ExitOnWindowsFunctionFailureWithLastError(
+    RecordWindowsFunctionFailureWithLastError(
         L"MultiByteToWideChar",
         GetLastError()
     );
+
+    goto free_allocated_string;
   } else if (converted_chars < num_wide_chars) {
-    ExitOnGeneralFailure(
+    RecordGeneralFailure(
         L"The number of converted characters is less than the intended "
         L"count.",
         L"String Conversion Failed"
     );
+
+    goto free_allocated_string;
   }
 
   return wide_string;
+
+free_allocated_string:
+  free(allocated_string);
+
+  return NULL;
 }
 
 wchar_t* ConvertUtf8ToWide(
@@ -210,3 +432,41 @@ char* ConvertWideToMultibyte(
       CP_ACP
   );
 }
+
+size_t ConvertWideToUtf8InBuffer(
+    struct ConvertedString* converted_string,
+    char* buffer,
+    size_t buffer_size,
+    const wchar_t* wide_string
+) {
+  return ConvertWideToCharInBuffer(
+      converted_string,
+      buffer,
+      buffer_size,
+      wide_string,
+      CP_UTF8
+  );
+}
+
+size_t ConvertWideToMultibyteInBuffer(
+    struct ConvertedString* converted_string,
+    char* buffer,
+    size_t buffer_size,
+    const wchar_t* wide_string
+) {
+  return ConvertWideToCharInBuffer(
+      converted_string,
+      buffer,
+      buffer_size,
+      wide_string,
+      CP_ACP
+  );
+}
+
+void ConvertedString_Deinit(struct ConvertedString* converted_string) {
+  free(converted_string->fallback_str);
+
+  converted_string->fallback_str = NULL;
+  converted_string->str = NULL;
+  converted_string->len = 0;
+}
@@ -30,8 +30,26 @@
 #ifndef SGGLDKL_ENCODING_H_
 #define SGGLDKL_ENCODING_H_
 
+#include <stddef.h>
 #include <wchar.h>
 
+/*
+* The result of a conversion into a caller-provided buffer. If the
+* buffer is too small, then the string is written into a fallback heap
+* allocation instead, which is freed by ConvertedString_Deinit.
+*/
+struct ConvertedString {
+  char* str;
+  size_t len;
+
+  char* fallback_str;
+};
+
+/*
+* If the destination string is NULL, then the converted string is
+* allocated, and must be freed. Returns NULL on failure.
+*/
+
 wchar_t* ConvertUtf8ToWide(
     wchar_t* wide_string,
     const char* utf8_string
@@ -52,4 +70,26 @@ char* ConvertWideToMultibyte(
     const wchar_t* wide_string
 );
 
+/*
+* Converts the string, using the buffer if it is large enough. Strings
+* that are entirely ASCII are narrowed directly, without calling into
+* the OS. Returns the length of the converted string. On failure, the
+* converted string is set to NULL.
+*/
+size_t ConvertWideToUtf8InBuffer(
+    struct ConvertedString* converted_string,
+    char* buffer,
+    size_t buffer_size,
+    const wchar_t* wide_string
+);
+
+size_t ConvertWideToMultibyteInBuffer(
+    struct ConvertedString* converted_string,
+    char* buffer,
+    size_t buffer_size,
+    const wchar_t* wide_string
+);
+
+void ConvertedString_Deinit(struct ConvertedString* converted_string);
+
 #endif /* SGGLDKL_ENCODING_H_ */
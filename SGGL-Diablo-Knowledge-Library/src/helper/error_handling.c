@@ -47,6 +47,306 @@ static const wchar_t* kFunctionFailErrorFormat =
 static const wchar_t* kGeneralFailErrorFormat =
     L"%ls";
 
+static const wchar_t* kFunctionFailCaptionFormat =
+    L"%ls Failed";
+
+/*
+* Each thread's last error is only ever accessed by its owning thread.
+* A detail is freed when its thread exits. The list only exists so that
+* the details of threads still running can be freed on deinit.
+*/
+struct ThreadErrorDetail {
+  struct ThreadErrorDetail* next;
+  struct KnowledgeErrorDetail error_detail;
+};
+
+/*
+* Set as the thread's detail if it could not be allocated, so that the
+* failure is still reported.
+*/
+static struct ThreadErrorDetail out_of_memory_detail = {
+    NULL,
+    {
+        KNOWLEDGE_ERROR_ALLOCATION,
+        0,
+        L"",
+        L"Allocation function failed.",
+        L"Memory Allocation Failed"
+    }
+};
+
+static volatile int is_exit_on_failure_enabled = 0;
+
+static DWORD detail_tls_index = TLS_OUT_OF_INDEXES;
+
+/* Guards the list of details, which only changes once per thread. */
+static CRITICAL_SECTION details_critical_section;
+static struct ThreadErrorDetail* details_head = NULL;
+
+static struct KnowledgeErrorDetail* GetCurrentThreadErrorDetail(void) {
+  struct ThreadErrorDetail* detail;
+
+  if (detail_tls_index == TLS_OUT_OF_INDEXES) {
+    return NULL;
+  }
+
+  detail = TlsGetValue(detail_tls_index);
+
+  if (detail != NULL && detail != &out_of_memory_detail) {
+    return &detail->error_detail;
+  }
+
+  detail = malloc(sizeof(*detail));
+
+  if (detail == NULL) {
+    TlsSetValue(detail_tls_index, &out_of_memory_detail);
+    return NULL;
+  }
+
+  detail->error_detail.kind = KNOWLEDGE_ERROR_NONE;
+
+  EnterCriticalSection(&details_critical_section);
+  detail->next = details_head;
+  details_head = detail;
+  LeaveCriticalSection(&details_critical_section);
+
+  TlsSetValue(detail_tls_index, detail);
+
+  return &detail->error_detail;
+}
+
+static void CopyTruncatedString(
+    wchar_t* dest,
+    size_t dest_capacity,
+    const wchar_t* src
+) {
+  wcsncpy(dest, src, dest_capacity - 1);
+  dest[dest_capacity - 1] = L'\0';
+}
+
+void ErrorHandling_Init(void) {
+  InitializeCriticalSection(&details_critical_section);
+
+  detail_tls_index = TlsAlloc();
+}
+
+void ErrorHandling_Deinit(void) {
+  struct ThreadErrorDetail* detail;
+  struct ThreadErrorDetail* next_detail;
+
+  for (detail = details_head; detail != NULL; detail = next_detail) {
+    next_detail = detail->next;
+    free(detail);
+  }
+
+  details_head = NULL;
+
+  if (detail_tls_index != TLS_OUT_OF_INDEXES) {
+    TlsFree(detail_tls_index);
+    detail_tls_index = TLS_OUT_OF_INDEXES;
+  }
+
+  DeleteCriticalSection(&details_critical_section);
+}
+
+void ErrorHandling_DeinitThread(void) {
+  struct ThreadErrorDetail* detail;
+  struct ThreadErrorDetail** detail_link;
+
+  if (detail_tls_index == TLS_OUT_OF_INDEXES) {
+    return;
+  }
+
+  detail = TlsGetValue(detail_tls_index);
+
+  if (detail == NULL) {
+    return;
+  }
+
+  TlsSetValue(detail_tls_index, NULL);
+
+  if (detail == &out_of_memory_detail) {
+    return;
+  }
+
+  EnterCriticalSection(&details_critical_section);
+
+  for (detail_link = &details_head;
+      *detail_link != NULL;
+      detail_link = &(*detail_link)->next) {
+    if (*detail_link == detail) {
+      *detail_link = detail->next;
+      break;
+    }
+  }
+
+  LeaveCriticalSection(&details_critical_section);
+
+  free(detail);
+}
+
+void ErrorHandling_SetExitOnFailureEnabled(int is_enabled) {
+  is_exit_on_failure_enabled = is_enabled;
+}
+
+int ErrorHandling_GetLastErrorDetail(
+    struct KnowledgeErrorDetail* error_detail
+) {
+  struct ThreadErrorDetail* detail;
+
+  error_detail->kind = KNOWLEDGE_ERROR_NONE;
+  error_detail->last_error = 0;
+  error_detail->function_name[0] = L'\0';
+  error_detail->message[0] = L'\0';
+  error_detail->caption[0] = L'\0';
+
+  if (detail_tls_index == TLS_OUT_OF_INDEXES) {
+    return 0;
+  }
+
+  detail = TlsGetValue(detail_tls_index);
+
+  if (detail == NULL || detail->error_detail.kind == KNOWLEDGE_ERROR_NONE) {
+    return 0;
+  }
+
+  *error_detail = detail->error_detail;
+
+  return 1;
+}
+
+void ErrorHandling_ClearLastErrorDetail(void) {
+  struct ThreadErrorDetail* detail;
+
+  if (detail_tls_index == TLS_OUT_OF_INDEXES) {
+    return;
+  }
+
+  detail = TlsGetValue(detail_tls_index);
+
+  if (detail == NULL || detail == &out_of_memory_detail) {
+    return;
+  }
+
+  detail->error_detail.kind = KNOWLEDGE_ERROR_NONE;
+}
+
+void ErrorHandling_SetLastErrorDetail(
+    const struct KnowledgeErrorDetail* error_detail
+) {
+  struct KnowledgeErrorDetail* current_error_detail;
+
+  current_error_detail = GetCurrentThreadErrorDetail();
+
+  if (current_error_detail == NULL) {
+    return;
+  }
+
+  *current_error_detail = *error_detail;
+}
+
+static void StoreErrorDetail(
+    enum KnowledgeErrorKind kind,
+    DWORD last_error,
+    const wchar_t* function_name,
+    const wchar_t* message,
+    const wchar_t* caption
+) {
+  struct KnowledgeErrorDetail* error_detail;
+
+  error_detail = GetCurrentThreadErrorDetail();
+
+  if (error_detail == NULL) {
+    return;
+  }
+
+  error_detail->kind = kind;
+  error_detail->last_error = last_error;
+
+  CopyTruncatedString(
+      error_detail->function_name,
+      sizeof(error_detail->function_name)
+          / sizeof(error_detail->function_name[0]),
+      function_name
+  );
+
+  CopyTruncatedString(
+      error_detail->message,
+      sizeof(error_detail->message) / sizeof(error_detail->message[0]),
+      message
+  );
+
+  CopyTruncatedString(
+      error_detail->caption,
+      sizeof(error_detail->caption) / sizeof(error_detail->caption[0]),
+      caption
+  );
+}
+
+void RecordGeneralFailure(
+    const wchar_t* message,
+    const wchar_t* caption
+) {
+  if (is_exit_on_failure_enabled) {
+    ExitOnGeneralFailure(message, caption);
+  }
+
+  StoreErrorDetail(KNOWLEDGE_ERROR_GENERAL, 0, L"", message, caption);
+}
+
+void RecordAllocationFailure(void) {
+  if (is_exit_on_failure_enabled) {
+    ExitOnAllocationFailure();
+  }
+
+  StoreErrorDetail(
+      KNOWLEDGE_ERROR_ALLOCATION,
+      0,
+      L"",
+      L"Allocation function failed.",
+      L"Memory Allocation Failed"
+  );
+}
+
+void RecordWindowsFunctionFailureWithLastError(
+    const wchar_t* function_name,
+    DWORD last_error
+) {
+  wchar_t full_message[KNOWLEDGE_ERROR_MESSAGE_LENGTH];
+  wchar_t caption[KNOWLEDGE_ERROR_CAPTION_LENGTH];
+
+  if (is_exit_on_failure_enabled) {
+    ExitOnWindowsFunctionFailureWithLastError(function_name, last_error);
+  }
+
+  _snwprintf(
+      full_message,
+      sizeof(full_message) / sizeof(full_message[0]),
+      kFunctionFailErrorFormat,
+      function_name,
+      last_error
+  );
+
+  full_message[sizeof(full_message) / sizeof(full_message[0]) - 1] = L'\0';
+
+  _snwprintf(
+      caption,
+      sizeof(caption) / sizeof(caption[0]),
+      kFunctionFailCaptionFormat,
+      function_name
+  );
+
+  caption[sizeof(caption) / sizeof(caption[0]) - 1] = L'\0';
+
+  StoreErrorDetail(
+      KNOWLEDGE_ERROR_WINDOWS_FUNCTION,
+      last_error,
+      function_name,
+      full_message,
+      caption
+  );
+}
+
 void ExitOnGeneralFailure(
     const wchar_t* message,
     const wchar_t* caption
@@ -98,7 +398,7 @@ void ExitOnWindowsFunctionFailureWithLastError(
   _snwprintf(
       message_box_caption,
       sizeof(message_box_caption) / sizeof(message_box_caption[0]),
-      L"%ls Failed",
+      kFunctionFailCaptionFormat,
       function_name
   );
 
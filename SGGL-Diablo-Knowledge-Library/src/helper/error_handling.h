@@ -33,6 +33,59 @@
 #include <wchar.h>
 #include <windows.h>
 
+#include "../../include/error_detail.h"
+
+void ErrorHandling_Init(void);
+
+void ErrorHandling_Deinit(void);
+
+/* Frees the last error of the calling thread, which is exiting. */
+void ErrorHandling_DeinitThread(void);
+
+/*
+* Enables or disables exiting the process when a failure is recorded,
+* instead of returning the failure to the caller. Disabled by default.
+*/
+void ErrorHandling_SetExitOnFailureEnabled(int is_enabled);
+
+/*
+* Copies the last failure recorded on the calling thread. Returns zero
+* if no failure has been recorded on the thread.
+*/
+int ErrorHandling_GetLastErrorDetail(
+    struct KnowledgeErrorDetail* error_detail
+);
+
+/* Forgets the last failure recorded on the calling thread. */
+void ErrorHandling_ClearLastErrorDetail(void);
+
+/*
+* Sets the last error of the calling thread to a copy of a failure,
+* which is used to pass a failure recorded on a worker thread back to
+* the thread that waited for it.
+*/
+void ErrorHandling_SetLastErrorDetail(
+    const struct KnowledgeErrorDetail* error_detail
+);
+
+/*
+* The Record functions store the failure as the calling thread's last
+* error, so that the caller can return a status. If exiting on failure
+* is enabled, then they behave like their ExitOn counterparts instead.
+*/
+
+void RecordGeneralFailure(
+    const wchar_t* message,
+    const wchar_t* caption
+);
+
+void RecordAllocationFailure(void);
+
+void RecordWindowsFunctionFailureWithLastError(
+    const wchar_t* function_name,
+    DWORD last_error
+);
+
 void ExitOnGeneralFailure(
     const wchar_t* message,
     const wchar_t* caption
@@ -0,0 +1,128 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#include "file_identity.h"
+
+#include "encoding.h"
+#include "error_handling.h"
+
+void FileIdentity_InitFromInformation(
+    struct FileIdentity* identity,
+    const BY_HANDLE_FILE_INFORMATION* file_information
+) {
+  identity->volume_serial_number = file_information->dwVolumeSerialNumber;
+  identity->file_index_high = file_information->nFileIndexHigh;
+  identity->file_index_low = file_information->nFileIndexLow;
+  identity->file_size_high = file_information->nFileSizeHigh;
+  identity->file_size_low = file_information->nFileSizeLow;
+  identity->last_write_time = file_information->ftLastWriteTime;
+}
+
+int FileIdentity_InitFromPath(
+    struct FileIdentity* identity,
+    const wchar_t* file_path
+) {
+  char file_path_mb_buffer[MAX_PATH];
+  struct ConvertedString file_path_mb;
+  HANDLE file_handle;
+  BY_HANDLE_FILE_INFORMATION file_information;
+  int is_success;
+
+  is_success = 0;
+
+  /*
+  * The multibyte path is used, as CreateFileW is not implemented on
+  * Windows 9X.
+  */
+  ConvertWideToMultibyteInBuffer(
+      &file_path_mb,
+      file_path_mb_buffer,
+      sizeof(file_path_mb_buffer),
+      file_path
+  );
+
+  if (file_path_mb.str == NULL) {
+    return 0;
+  }
+
+  file_handle = CreateFileA(
+      file_path_mb.str,
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      NULL,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL,
+      NULL
+  );
+
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"CreateFileA",
+        GetLastError()
+    );
+
+    goto deinit_file_path_mb;
+  }
+
+  if (!GetFileInformationByHandle(file_handle, &file_information)) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"GetFileInformationByHandle",
+        GetLastError()
+    );
+
+    goto close_file_handle;
+  }
+
+  FileIdentity_InitFromInformation(identity, &file_information);
+  is_success = 1;
+
+close_file_handle:
+  CloseHandle(file_handle);
+
+deinit_file_path_mb:
+  ConvertedString_Deinit(&file_path_mb);
+
+  return is_success;
+}
+
+int FileIdentity_Equals(
+    const struct FileIdentity* identity1,
+    const struct FileIdentity* identity2
+) {
+  return identity1->volume_serial_number == identity2->volume_serial_number
+      && identity1->file_index_high == identity2->file_index_high
+      && identity1->file_index_low == identity2->file_index_low
+      && identity1->file_size_high == identity2->file_size_high
+      && identity1->file_size_low == identity2->file_size_low
+      && CompareFileTime(
+          &identity1->last_write_time,
+          &identity2->last_write_time
+      ) == 0;
+}
@@ -0,0 +1,66 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#ifndef SGGLDKL_HELPER_FILE_IDENTITY_H_
+#define SGGLDKL_HELPER_FILE_IDENTITY_H_
+
+#include <wchar.h>
+#include <windows.h>
+
+/*
+* Identifies the contents of a file. Any change to the file is expected
+* to change its size or last write time.
+*/
+struct FileIdentity {
+  DWORD volume_serial_number;
+  DWORD file_index_high;
+  DWORD file_index_low;
+  DWORD file_size_high;
+  DWORD file_size_low;
+  FILETIME last_write_time;
+};
+
+void FileIdentity_InitFromInformation(
+    struct FileIdentity* identity,
+    const BY_HANDLE_FILE_INFORMATION* file_information
+);
+
+/* Returns zero on failure. */
+int FileIdentity_InitFromPath(
+    struct FileIdentity* identity,
+    const wchar_t* file_path
+);
+
+int FileIdentity_Equals(
+    const struct FileIdentity* identity1,
+    const struct FileIdentity* identity2
+);
+
+#endif /* SGGLDKL_HELPER_FILE_IDENTITY_H_ */
@@ -29,15 +29,20 @@
 
 #include "file_info.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "error_handling.h"
 
+static const DWORD kFixedFileInfoSignature = 0xFEEF04BD;
+
 /* Struct taken from Microsoft's example. */
 struct LANGANDCODEPAGE {
   WORD wLanguage;
   WORD wCodePage;
 };
 
-void ExtractFileInfo(
+int ExtractFileInfo(
     VS_FIXEDFILEINFO* file_info,
     const wchar_t* file_path
 ) {
@@ -52,6 +57,10 @@ void ExtractFileInfo(
   VS_FIXEDFILEINFO* temp_file_info;
   UINT temp_file_info_size;
 
+  int is_success;
+
+  is_success = 0;
+
   /* Check version size. */
   file_version_info_size = GetFileVersionInfoSizeW(
       file_path,
@@ -59,17 +68,20 @@ void ExtractFileInfo(
   );
 
   if (file_version_info_size == 0) {
-    ExitOnWindowsFunctionFailureWithLastError(
+    RecordWindowsFunctionFailureWithLastError(
         L"GetFileVersionInfoSizeW",
         GetLastError()
     );
+
+    return 0;
   }
 
   /* Get the file version info.*/
   file_version_info = malloc(file_version_info_size);
 
   if (file_version_info == NULL) {
-    ExitOnAllocationFailure();
+    RecordAllocationFailure();
+    return 0;
   }
 
   is_get_file_version_info_success = GetFileVersionInfoW(
@@ -80,10 +92,12 @@ void ExtractFileInfo(
   );
 
   if (!is_get_file_version_info_success) {
-    ExitOnWindowsFunctionFailureWithLastError(
+    RecordWindowsFunctionFailureWithLastError(
         L"GetFileVersionInfoW",
         GetLastError()
     );
+
+    goto free_file_version_info;
   }
 
   /* Gather all of the information into the specified buffer. */
@@ -95,17 +109,32 @@ void ExtractFileInfo(
   );
 
   if (!is_ver_query_value_success) {
-    ExitOnWindowsFunctionFailureWithLastError(
+    RecordWindowsFunctionFailureWithLastError(
         L"VerQueryValueW",
         GetLastError()
     );
+
+    goto free_file_version_info;
+  }
+
+  if (temp_file_info_size < sizeof(*temp_file_info)
+      || temp_file_info->dwSignature != kFixedFileInfoSignature) {
+    RecordGeneralFailure(
+        L"The fixed file info in the version resource is malformed.",
+        L"Invalid Version Info"
+    );
+
+    goto free_file_version_info;
   }
 
   /* Copy the file info into the parameter. */
   *file_info = *temp_file_info;
+  is_success = 1;
 
 free_file_version_info:
   free(file_version_info);
+
+  return is_success;
 }
 
 wchar_t* ExtractFileStringValue(
@@ -131,8 +160,11 @@ wchar_t* ExtractFileStringValue(
   UINT file_string_value_size;
 
   wchar_t* file_string_sub_block;
+  wchar_t* resized_file_string_sub_block;
   size_t file_string_sub_block_capacity;
 
+  file_string_value = NULL;
+
   /* Check version size. */
   file_version_info_size = GetFileVersionInfoSizeW(
       game_path,
@@ -140,17 +172,20 @@ wchar_t* ExtractFileStringValue(
   );
 
   if (file_version_info_size == 0) {
-    ExitOnWindowsFunctionFailureWithLastError(
+    RecordWindowsFunctionFailureWithLastError(
         L"GetFileVersionInfoSizeW",
         GetLastError()
     );
+
+    return NULL;
   }
 
   /* Get the file version info.*/
   file_version_info = malloc(file_version_info_size);
 
   if (file_version_info == NULL) {
-    ExitOnAllocationFailure();
+    RecordAllocationFailure();
+    return NULL;
   }
 
   is_get_file_version_info_success = GetFileVersionInfoW(
@@ -161,10 +196,12 @@ wchar_t* ExtractFileStringValue(
   );
 
   if (!is_get_file_version_info_success) {
-    ExitOnWindowsFunctionFailureWithLastError(
+    RecordWindowsFunctionFailureWithLastError(
         L"GetFileVersionInfoW",
         GetLastError()
     );
+
+    goto free_file_version_info;
   }
 
   /* Gather all of the information into the specified buffer. */
@@ -176,10 +213,21 @@ wchar_t* ExtractFileStringValue(
   );
 
   if (!is_ver_query_value_success) {
-    ExitOnWindowsFunctionFailureWithLastError(
+    RecordWindowsFunctionFailureWithLastError(
         L"VerQueryValueW",
         GetLastError()
     );
+
+    goto free_file_version_info;
+  }
+
+  if (lang_buffer_size < sizeof(lang_buffer[0])) {
+    RecordGeneralFailure(
+        L"The version resource does not list any translations.",
+        L"Invalid Version Info"
+    );
+
+    goto free_file_version_info;
   }
 
   /* Format text into the file string sub block. */
@@ -189,16 +237,19 @@ wchar_t* ExtractFileStringValue(
 
   do {
     file_string_sub_block_capacity *= 2;
-    file_string_sub_block = realloc(
+    resized_file_string_sub_block = realloc(
         file_string_sub_block,
         file_string_sub_block_capacity * sizeof(file_string_sub_block[0])
     );
 
 
-    if (file_string_sub_block == NULL) {
-      ExitOnAllocationFailure();
+    if (resized_file_string_sub_block == NULL) {
+      RecordAllocationFailure();
+      goto free_file_string_sub_block;
     }
 
+    file_string_sub_block = resized_file_string_sub_block;
+
     snwprintf_result = _snwprintf(
         file_string_sub_block,
         file_string_sub_block_capacity,
@@ -219,20 +270,34 @@ wchar_t* ExtractFileStringValue(
   );
 
   if (!is_ver_query_value_success) {
-    ExitOnWindowsFunctionFailureWithLastError(
+    RecordWindowsFunctionFailureWithLastError(
         L"VerQueryValueW",
         GetLastError()
     );
+
+    goto free_file_string_sub_block;
   }
 
-  /* Return a copy of the file string value. */
-  file_string_value = malloc(file_string_value_size * sizeof(temp_file_string_value[0]));
+  /*
+  * Return a copy of the file string value. The value is not trusted to
+  * be null-terminated within its reported size.
+  */
+  file_string_value = malloc(
+      (file_string_value_size + 1) * sizeof(file_string_value[0])
+  );
 
   if (file_string_value == NULL) {
-    ExitOnAllocationFailure();
+    RecordAllocationFailure();
+    goto free_file_string_sub_block;
   }
 
-  wcscpy(file_string_value, temp_file_string_value);
+  memcpy(
+      file_string_value,
+      temp_file_string_value,
+      file_string_value_size * sizeof(file_string_value[0])
+  );
+
+  file_string_value[file_string_value_size] = L'\0';
 
 free_file_string_sub_block:
   free(file_string_sub_block);
@@ -34,11 +34,16 @@
 #include <wchar.h>
 #include <windows.h>
 
-void ExtractFileInfo(
+/* Returns zero on failure. */
+int ExtractFileInfo(
     VS_FIXEDFILEINFO* file_info,
     const wchar_t* file_path
 );
 
+/*
+* Returns a copy of the string value, which must be freed, or NULL on
+* failure.
+*/
 wchar_t* ExtractFileStringValue(
     const wchar_t* game_path,
     const wchar_t* string_name,
@@ -29,33 +29,169 @@
 
 #include "file_path.h"
 
-#include <stdlib.h>
-#include <windows.h>
-/* Must include after windows.h. */
-#include <shlwapi.h>
+#include <string.h>
 
 #include "error_handling.h"
 
-wchar_t* GetAdjacentFilePath(
-    const wchar_t* diablo_file_path,
-    size_t diablo_file_path_len,
-    const wchar_t* adjacent_file_name,
-    size_t adjacent_file_name_len
+/*
+* Returns the length of the directory prefix, including the trailing
+* separator, or zero if the path has no directory.
+*/
+static size_t GetDirPathLen(const wchar_t* file_path, size_t file_path_len) {
+  size_t i;
+
+  for (i = file_path_len; i > 0; i -= 1) {
+    if (file_path[i - 1] == L'\\'
+        || file_path[i - 1] == L'/'
+        || file_path[i - 1] == L':') {
+      return i;
+    }
+  }
+
+  return 0;
+}
+
+int GamePathContext_Init(
+    struct GamePathContext* path_context,
+    const wchar_t* game_path,
+    size_t game_path_len
 ) {
-  wchar_t* adjacent_file_path;
+  path_context->dir_path_len = GetDirPathLen(game_path, game_path_len);
+
+  if (path_context->dir_path_len >= MAX_PATH) {
+    RecordGeneralFailure(
+        L"The game path is too long.",
+        L"Path Too Long"
+    );
 
-  adjacent_file_path = malloc(
-      (diablo_file_path_len + adjacent_file_name_len + 2)
-          * sizeof(adjacent_file_path[0])
+    return 0;
+  }
+
+  memcpy(
+      path_context->dir_path,
+      game_path,
+      path_context->dir_path_len * sizeof(path_context->dir_path[0])
   );
 
-  if (adjacent_file_path == NULL) {
-    ExitOnAllocationFailure();
+  path_context->dir_path[path_context->dir_path_len] = L'\0';
+
+  path_context->sibling_path[0] = L'\0';
+  path_context->num_companions = 0;
+
+  return 1;
+}
+
+const wchar_t* GamePathContext_JoinSibling(
+    struct GamePathContext* path_context,
+    const wchar_t* file_name,
+    size_t file_name_len
+) {
+  if (path_context->dir_path_len + file_name_len >= MAX_PATH) {
+    RecordGeneralFailure(
+        L"The sibling file path is too long.",
+        L"Path Too Long"
+    );
+
+    return NULL;
   }
 
-  wcscpy(adjacent_file_path, diablo_file_path);
-  PathRemoveFileSpecW(adjacent_file_path);
-  PathAppendW(adjacent_file_path, adjacent_file_name);
+  memcpy(
+      path_context->sibling_path,
+      path_context->dir_path,
+      path_context->dir_path_len * sizeof(path_context->sibling_path[0])
+  );
+
+  memcpy(
+      &path_context->sibling_path[path_context->dir_path_len],
+      file_name,
+      file_name_len * sizeof(path_context->sibling_path[0])
+  );
+
+  path_context->sibling_path[path_context->dir_path_len + file_name_len] =
+      L'\0';
+
+  return path_context->sibling_path;
+}
+
+const wchar_t* GamePathContext_GetCompanionPath(
+    struct GamePathContext* path_context,
+    const wchar_t* file_name,
+    size_t file_name_len
+) {
+  size_t i_companion;
+  struct CompanionFilePath* companion;
+  const wchar_t* sibling_path;
+  DWORD file_attributes;
+  DWORD full_path_len;
+
+  for (i_companion = 0;
+      i_companion < path_context->num_companions;
+      i_companion += 1) {
+    companion = &path_context->companions[i_companion];
+
+    if (_wcsicmp(companion->file_name, file_name) == 0) {
+      return companion->path;
+    }
+  }
+
+  sibling_path = GamePathContext_JoinSibling(
+      path_context,
+      file_name,
+      file_name_len
+  );
+
+  if (sibling_path == NULL) {
+    return NULL;
+  }
+
+  file_attributes = GetFileAttributesW(sibling_path);
+
+  if (file_attributes == (DWORD) -1) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"GetFileAttributesW",
+        GetLastError()
+    );
+
+    return NULL;
+  }
+
+  if ((file_attributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+    RecordGeneralFailure(
+        L"The companion file is a directory.",
+        L"File Could Not Be Found"
+    );
+
+    return NULL;
+  }
+
+  /* Without space in the cache, the joined path is returned as is. */
+  if (path_context->num_companions >= GAME_PATH_CONTEXT_MAX_COMPANIONS) {
+    return sibling_path;
+  }
+
+  companion = &path_context->companions[path_context->num_companions];
+
+  full_path_len = GetFullPathNameW(
+      sibling_path,
+      MAX_PATH,
+      companion->path,
+      NULL
+  );
+
+  if (full_path_len == 0 || full_path_len >= MAX_PATH) {
+    return sibling_path;
+  }
+
+  memcpy(
+      companion->file_name,
+      file_name,
+      file_name_len * sizeof(companion->file_name[0])
+  );
+
+  companion->file_name[file_name_len] = L'\0';
+  companion->path_len = full_path_len;
+
+  path_context->num_companions += 1;
 
-  return adjacent_file_path;
+  return companion->path;
 }
@@ -32,12 +32,61 @@
 
 #include <stddef.h>
 #include <wchar.h>
+#include <windows.h>
 
-wchar_t* GetAdjacentFilePath(
-    const wchar_t* diablo_file_path,
-    size_t diablo_file_path_len,
-    const wchar_t* adjacent_file_name,
-    size_t adjacent_file_name_len
+enum {
+  GAME_PATH_CONTEXT_MAX_COMPANIONS = 8
+};
+
+struct CompanionFilePath {
+  wchar_t file_name[MAX_PATH];
+  wchar_t path[MAX_PATH];
+  size_t path_len;
+};
+
+/*
+* The paths of the files adjacent to a game executable. The directory
+* prefix is computed once, and sibling names are joined into a buffer
+* that is reused, so no call allocates. The absolute paths of the
+* companion files that have been found are cached.
+*/
+struct GamePathContext {
+  wchar_t dir_path[MAX_PATH];
+  size_t dir_path_len;
+
+  wchar_t sibling_path[MAX_PATH];
+
+  size_t num_companions;
+  struct CompanionFilePath companions[GAME_PATH_CONTEXT_MAX_COMPANIONS];
+};
+
+/* Returns zero if the game path is too long. */
+int GamePathContext_Init(
+    struct GamePathContext* path_context,
+    const wchar_t* game_path,
+    size_t game_path_len
+);
+
+/*
+* Returns the path of the file in the game's directory, or NULL if the
+* path is too long. The path is only valid until the next call on the
+* same context.
+*/
+const wchar_t* GamePathContext_JoinSibling(
+    struct GamePathContext* path_context,
+    const wchar_t* file_name,
+    size_t file_name_len
+);
+
+/*
+* Returns the absolute path of the companion file in the game's
+* directory, or NULL if the file does not exist. Found paths are
+* cached, and remain valid for the lifetime of the context.
+*/
+const wchar_t* GamePathContext_GetCompanionPath(
+    struct GamePathContext* path_context,
+    const wchar_t* file_name,
+    size_t file_name_len
 );
 
 #endif /* SGGLDKL_HELPER_FILE_PATH_H_ */
@@ -0,0 +1,253 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "game_file_source.h"
+
+#include <stdio.h>
+
+#include "encoding.h"
+#include "error_handling.h"
+#include "file_info.h"
+#include "file_path.h"
+
+/* Returns the path of the game executable or companion file. */
+static const wchar_t* GetFilePath(
+    struct GameFilePaths* file_paths,
+    const wchar_t* file_name,
+    size_t file_name_len
+) {
+  if (file_name == NULL) {
+    return file_paths->game_path;
+  }
+
+  return GamePathContext_GetCompanionPath(
+      file_paths->path_context,
+      file_name,
+      file_name_len
+  );
+}
+
+static int FileSystemExtractFileInfo(
+    void* context,
+    const wchar_t* file_name,
+    size_t file_name_len,
+    VS_FIXEDFILEINFO* file_info
+) {
+  const wchar_t* file_path;
+
+  file_path = GetFilePath(
+      (struct GameFilePaths*) context,
+      file_name,
+      file_name_len
+  );
+
+  if (file_path == NULL) {
+    return 0;
+  }
+
+  return ExtractFileInfo(file_info, file_path);
+}
+
+static wchar_t* FileSystemExtractStringValue(
+    void* context,
+    const wchar_t* string_name,
+    size_t string_name_len
+) {
+  struct GameFilePaths* file_paths;
+
+  file_paths = (struct GameFilePaths*) context;
+
+  return ExtractFileStringValue(
+      file_paths->game_path,
+      string_name,
+      string_name_len
+  );
+}
+
+static int FileSystemReadBytes(
+    void* context,
+    const wchar_t* file_name,
+    size_t file_name_len,
+    long offset,
+    unsigned char* buffer,
+    size_t size
+) {
+  const wchar_t* file_path;
+  char file_path_mb_buffer[MAX_PATH];
+  struct ConvertedString file_path_mb;
+  FILE* file_stream;
+
+  int is_fseek_fail;
+  int is_fclose_fail;
+  size_t num_bytes_read;
+  int is_success;
+
+  file_path = GetFilePath(
+      (struct GameFilePaths*) context,
+      file_name,
+      file_name_len
+  );
+
+  if (file_path == NULL) {
+    return 0;
+  }
+
+  /*
+  * The multibyte path is used, as _wfopen is not implemented on
+  * Windows 9X.
+  */
+  ConvertWideToMultibyteInBuffer(
+      &file_path_mb,
+      file_path_mb_buffer,
+      sizeof(file_path_mb_buffer),
+      file_path
+  );
+
+  if (file_path_mb.str == NULL) {
+    return 0;
+  }
+
+  file_stream = fopen(file_path_mb.str, "rb");
+
+  ConvertedString_Deinit(&file_path_mb);
+
+  if (file_stream == NULL) {
+    RecordGeneralFailure(
+        L"Could not open file for reading.",
+        L"File Could Not Be Opened"
+    );
+
+    return 0;
+  }
+
+  is_success = 0;
+
+  /* Seek to the pos */
+  is_fseek_fail = fseek(file_stream, offset, SEEK_SET);
+
+  if (is_fseek_fail) {
+    RecordGeneralFailure(
+        L"Cannot seek to the file's target offset.",
+        L"Game Version Check Failure"
+    );
+
+    goto close_file_stream;
+  }
+
+  /* Read the bytes that will be checked. */
+  num_bytes_read = fread(buffer, sizeof(buffer[0]), size, file_stream);
+
+  if (num_bytes_read != size) {
+    RecordGeneralFailure(
+        L"Number of check bytes does not match.",
+        L"Game Version Check Failure"
+    );
+
+    goto close_file_stream;
+  }
+
+  is_success = 1;
+
+close_file_stream:
+  is_fclose_fail = fclose(file_stream);
+
+  if (is_fclose_fail) {
+    RecordGeneralFailure(
+        L"Failed to close the file stream.",
+        L"File Stream Failure"
+    );
+
+    return 0;
+  }
+
+  return is_success;
+}
+
+static const struct GameFileSourceOps kFileSystemGameFileSourceOps = {
+  &FileSystemExtractFileInfo,
+  &FileSystemExtractStringValue,
+  &FileSystemReadBytes
+};
+
+const struct GameFileSourceOps* GameFileSourceOps_GetFileSystem(void) {
+  return &kFileSystemGameFileSourceOps;
+}
+
+void GameFileSource_Init(
+    struct GameFileSource* source,
+    const struct GameFileSourceOps* ops,
+    void* ops_context
+) {
+  source->ops = ops;
+  source->ops_context = ops_context;
+}
+
+int GameFileSource_ExtractFileInfo(
+    const struct GameFileSource* source,
+    const wchar_t* file_name,
+    size_t file_name_len,
+    VS_FIXEDFILEINFO* file_info
+) {
+  return source->ops->extract_file_info_func_ptr(
+      source->ops_context,
+      file_name,
+      file_name_len,
+      file_info
+  );
+}
+
+wchar_t* GameFileSource_ExtractStringValue(
+    const struct GameFileSource* source,
+    const wchar_t* string_name,
+    size_t string_name_len
+) {
+  return source->ops->extract_string_value_func_ptr(
+      source->ops_context,
+      string_name,
+      string_name_len
+  );
+}
+
+int GameFileSource_ReadBytes(
+    const struct GameFileSource* source,
+    const wchar_t* file_name,
+    size_t file_name_len,
+    long offset,
+    unsigned char* buffer,
+    size_t size
+) {
+  return source->ops->read_bytes_func_ptr(
+      source->ops_context,
+      file_name,
+      file_name_len,
+      offset,
+      buffer,
+      size
+  );
+}
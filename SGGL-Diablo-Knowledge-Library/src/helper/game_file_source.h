@@ -0,0 +1,122 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_HELPER_GAME_FILE_SOURCE_H_
+#define SGGLDKL_HELPER_GAME_FILE_SOURCE_H_
+
+#include <stddef.h>
+#include <wchar.h>
+#include <windows.h>
+
+struct GamePathContext;
+
+/*
+* The operations used to read the game executable and its companion
+* files while detecting the game version, so that the version tables
+* are shared by every place the files can be read from. Each operation
+* returns zero or NULL on failure, after recording the failure.
+*
+* Companion files are identified by their file name, such as
+* "storm.dll". A NULL file name refers to the game executable.
+*/
+struct GameFileSourceOps {
+  int (*extract_file_info_func_ptr)(
+      void* context,
+      const wchar_t* file_name,
+      size_t file_name_len,
+      VS_FIXEDFILEINFO* file_info
+  );
+
+  /*
+  * Returns a copy of the string value from the version resource of the
+  * game executable, which must be freed.
+  */
+  wchar_t* (*extract_string_value_func_ptr)(
+      void* context,
+      const wchar_t* string_name,
+      size_t string_name_len
+  );
+
+  int (*read_bytes_func_ptr)(
+      void* context,
+      const wchar_t* file_name,
+      size_t file_name_len,
+      long offset,
+      unsigned char* buffer,
+      size_t size
+  );
+};
+
+/*
+* The game files, paired with the operations used to read them. The
+* operations are not owned, and must outlive the source.
+*/
+struct GameFileSource {
+  const struct GameFileSourceOps* ops;
+  void* ops_context;
+};
+
+/* The context of the operations that read the files on disk. */
+struct GameFilePaths {
+  const wchar_t* game_path;
+  struct GamePathContext* path_context;
+};
+
+/* The operations that read the files on disk, from GameFilePaths. */
+const struct GameFileSourceOps* GameFileSourceOps_GetFileSystem(void);
+
+void GameFileSource_Init(
+    struct GameFileSource* source,
+    const struct GameFileSourceOps* ops,
+    void* ops_context
+);
+
+int GameFileSource_ExtractFileInfo(
+    const struct GameFileSource* source,
+    const wchar_t* file_name,
+    size_t file_name_len,
+    VS_FIXEDFILEINFO* file_info
+);
+
+wchar_t* GameFileSource_ExtractStringValue(
+    const struct GameFileSource* source,
+    const wchar_t* string_name,
+    size_t string_name_len
+);
+
+int GameFileSource_ReadBytes(
+    const struct GameFileSource* source,
+    const wchar_t* file_name,
+    size_t file_name_len,
+    long offset,
+    unsigned char* buffer,
+    size_t size
+);
+
+#endif /* SGGLDKL_HELPER_GAME_FILE_SOURCE_H_ */
@@ -37,9 +37,10 @@
 
 struct ProductNameAndFindGameVersionFunctionEntry {
   const wchar_t* product_name;
-  enum GameVersion (*game_version_find_func_ptr)(
-      const wchar_t* diablo_file_path,
-      size_t diablo_file_path_len
+  int (*game_version_find_func_ptr)(
+      const struct GameFileSource* source,
+      struct KnowledgeGameDetection* detection,
+      enum GameVersion* game_version
   );
 };
 
@@ -29,33 +29,42 @@
 
 #include "short_version.h"
 
+/*
+* The fields are unsigned, so their differences cannot be returned
+* directly without wrapping around.
+*/
+static int CompareField(unsigned long field1, unsigned long field2) {
+  if (field1 < field2) {
+    return -1;
+  } else if (field1 > field2) {
+    return 1;
+  }
+
+  return 0;
+}
+
 int ShortVersion_CompareAll(
     const struct ShortVersion* version1,
     const struct ShortVersion* version2
 ) {
-  struct ShortVersion diff = { 0 };
-
-  diff.major_left = version1->major_left - version2->major_left;
-  if (diff.major_left != 0) {
-    return diff.major_left;
-  }
+  int diff;
 
-  diff.major_right = version1->major_right - version2->major_right;
-  if (diff.major_right != 0) {
-    return diff.major_right;
+  diff = CompareField(version1->major_left, version2->major_left);
+  if (diff != 0) {
+    return diff;
   }
 
-  diff.minor_left = version1->minor_left - version2->minor_left;
-  if (diff.minor_left != 0) {
-    return diff.minor_left;
+  diff = CompareField(version1->major_right, version2->major_right);
+  if (diff != 0) {
+    return diff;
   }
 
-  diff.minor_right = version1->minor_right - version2->minor_right;
-  if (diff.minor_right != 0) {
-    return diff.minor_right;
+  diff = CompareField(version1->minor_left, version2->minor_left);
+  if (diff != 0) {
+    return diff;
   }
 
-  return 0;
+  return CompareField(version1->minor_right, version2->minor_right);
 }
 
 int ShortVersion_CompareAsVoidAll(
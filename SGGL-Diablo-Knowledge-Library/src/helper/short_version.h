@@ -31,15 +31,14 @@
 #define SGGLDKL_HELPER_SHORT_VERSION_H_
 
 #include <wchar.h>
-#include <windows.h>
 
 #include "../game_version.h"
 
 struct ShortVersion {
-  DWORD major_left;
-  DWORD major_right;
-  DWORD minor_left;
-  DWORD minor_right;
+  unsigned long major_left;
+  unsigned long major_right;
+  unsigned long minor_left;
+  unsigned long minor_right;
 };
 
 struct ShortVersionString {
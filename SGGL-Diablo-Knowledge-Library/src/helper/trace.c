@@ -0,0 +1,186 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "trace.h"
+
+#include <stdio.h>
+
+enum {
+  TRACE_RING_CAPACITY = 4096
+};
+
+struct TraceEvent {
+  const char* name;
+  char phase;
+  DWORD process_id;
+  DWORD thread_id;
+  LARGE_INTEGER timestamp;
+  unsigned long arg;
+};
+
+static volatile int is_trace_enabled = 0;
+
+static LARGE_INTEGER base_timestamp;
+static LARGE_INTEGER timestamp_frequency;
+
+/*
+* All threads record into one ring, so no memory is held per thread.
+* The ring is guarded by the critical section, which is only entered
+* while tracing is enabled.
+*/
+static CRITICAL_SECTION ring_critical_section;
+static struct TraceEvent ring_events[TRACE_RING_CAPACITY];
+static unsigned long ring_num_written = 0;
+
+static void RecordEvent(
+    const char* name,
+    char phase,
+    DWORD process_id,
+    unsigned long arg
+) {
+  struct TraceEvent* event;
+
+  EnterCriticalSection(&ring_critical_section);
+
+  event = &ring_events[ring_num_written % TRACE_RING_CAPACITY];
+
+  event->name = name;
+  event->phase = phase;
+  event->process_id = process_id;
+  event->thread_id = GetCurrentThreadId();
+  event->arg = arg;
+  QueryPerformanceCounter(&event->timestamp);
+
+  ring_num_written += 1;
+
+  LeaveCriticalSection(&ring_critical_section);
+}
+
+void Trace_Init(void) {
+  InitializeCriticalSection(&ring_critical_section);
+
+  ring_num_written = 0;
+
+  QueryPerformanceFrequency(&timestamp_frequency);
+  QueryPerformanceCounter(&base_timestamp);
+}
+
+void Trace_Deinit(void) {
+  is_trace_enabled = 0;
+
+  DeleteCriticalSection(&ring_critical_section);
+}
+
+void Trace_SetEnabled(int is_enabled) {
+  is_trace_enabled = is_enabled;
+}
+
+void Trace_BeginEvent(
+    const char* name,
+    DWORD process_id,
+    unsigned long arg
+) {
+  if (!is_trace_enabled) {
+    return;
+  }
+
+  RecordEvent(name, 'B', process_id, arg);
+}
+
+void Trace_EndEvent(
+    const char* name,
+    DWORD process_id,
+    unsigned long arg
+) {
+  if (!is_trace_enabled) {
+    return;
+  }
+
+  RecordEvent(name, 'E', process_id, arg);
+}
+
+int Trace_ExportChromeJson(const wchar_t* output_path) {
+  FILE* output_stream;
+  const struct TraceEvent* event;
+
+  unsigned long i_event;
+  int is_first_event;
+  double timestamp_us;
+
+  int is_fclose_fail;
+
+  output_stream = _wfopen(output_path, L"w");
+
+  if (output_stream == NULL) {
+    return 0;
+  }
+
+  fprintf(output_stream, "{\"traceEvents\":[\n");
+
+  is_first_event = 1;
+
+  EnterCriticalSection(&ring_critical_section);
+
+  /* Only the latest events are kept once the ring wraps around. */
+  i_event = (ring_num_written > TRACE_RING_CAPACITY)
+      ? ring_num_written - TRACE_RING_CAPACITY
+      : 0;
+
+  for (; i_event < ring_num_written; i_event += 1) {
+    event = &ring_events[i_event % TRACE_RING_CAPACITY];
+
+    timestamp_us = (double) (
+        event->timestamp.QuadPart - base_timestamp.QuadPart
+    ) * 1000000.0 / (double) timestamp_frequency.QuadPart;
+
+    fprintf(
+        output_stream,
+        "%s{\"name\":\"%s\",\"cat\":\"injection\",\"ph\":\"%c\","
+            "\"ts\":%.3f,\"pid\":%lu,\"tid\":%lu,"
+            "\"args\":{\"value\":%lu}}",
+        (is_first_event) ? "" : ",\n",
+        event->name,
+        event->phase,
+        timestamp_us,
+        (unsigned long) event->process_id,
+        (unsigned long) event->thread_id,
+        event->arg
+    );
+
+    is_first_event = 0;
+  }
+
+  LeaveCriticalSection(&ring_critical_section);
+
+  fprintf(output_stream, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+  is_fclose_fail = fclose(output_stream);
+
+  return !is_fclose_fail;
+}
@@ -0,0 +1,67 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_HELPER_TRACE_H_
+#define SGGLDKL_HELPER_TRACE_H_
+
+#include <wchar.h>
+#include <windows.h>
+
+/*
+* Records timestamped begin and end events into a ring buffer shared by
+* all threads, which can later be exported in the Chrome
+* trace-event JSON format. Recording is a single flag check when
+* tracing is disabled.
+*
+* The event names must be string literals, as only the pointer is
+* stored.
+*/
+
+void Trace_Init(void);
+
+void Trace_Deinit(void);
+
+void Trace_SetEnabled(int is_enabled);
+
+void Trace_BeginEvent(
+    const char* name,
+    DWORD process_id,
+    unsigned long arg
+);
+
+void Trace_EndEvent(
+    const char* name,
+    DWORD process_id,
+    unsigned long arg
+);
+
+/* Returns zero if the file could not be written. */
+int Trace_ExportChromeJson(const wchar_t* output_path);
+
+#endif /* SGGLDKL_HELPER_TRACE_H_ */
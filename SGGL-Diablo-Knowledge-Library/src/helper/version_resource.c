@@ -0,0 +1,374 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "version_resource.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "error_handling.h"
+
+enum Constant {
+  /* The wLength, wValueLength and wType fields that begin each node. */
+  NODE_HEADER_SIZE = 3 * sizeof(WORD),
+
+  NODE_TYPE_TEXT = 1,
+
+  /* The language and code page, as eight hexadecimal digits. */
+  TRANSLATION_KEY_LEN = 8
+};
+
+static const DWORD kFixedFileInfoSignature = 0xFEEF04BD;
+
+static const wchar_t kRootKey[] = L"VS_VERSION_INFO";
+static const wchar_t kStringFileInfoKey[] = L"StringFileInfo";
+static const wchar_t kVarFileInfoKey[] = L"VarFileInfo";
+static const wchar_t kTranslationKey[] = L"Translation";
+
+/* The offsets of a node's parts, from the start of the block. */
+struct VersionNode {
+  size_t end_offset;
+
+  size_t key_offset;
+  size_t key_len;
+
+  size_t value_offset;
+  size_t value_size;
+
+  size_t children_offset;
+};
+
+static size_t AlignOffset(size_t offset) {
+  return (offset + 3) & ~((size_t) 3);
+}
+
+static WORD ReadWord(const unsigned char* block, size_t offset) {
+  WORD value;
+
+  memcpy(&value, block + offset, sizeof(value));
+
+  return value;
+}
+
+static wchar_t ToLowerAscii(wchar_t ch) {
+  return (ch >= L'A' && ch <= L'Z') ? ch - L'A' + L'a' : ch;
+}
+
+/*
+* Parses the node at the offset, which must end within its parent.
+* Returns zero if the node is malformed.
+*/
+static int ParseNode(
+    struct VersionNode* node,
+    const unsigned char* block,
+    size_t offset,
+    size_t parent_end_offset
+) {
+  WORD length;
+  WORD value_length;
+  WORD type;
+
+  size_t key_end_offset;
+
+  if (parent_end_offset < NODE_HEADER_SIZE
+      || offset > parent_end_offset - NODE_HEADER_SIZE) {
+    return 0;
+  }
+
+  length = ReadWord(block, offset);
+  value_length = ReadWord(block, offset + sizeof(WORD));
+  type = ReadWord(block, offset + 2 * sizeof(WORD));
+
+  if (length < NODE_HEADER_SIZE || length > parent_end_offset - offset) {
+    return 0;
+  }
+
+  node->end_offset = offset + length;
+  node->key_offset = offset + NODE_HEADER_SIZE;
+
+  /* The key must be null-terminated within the node. */
+  for (key_end_offset = node->key_offset;
+      ;
+      key_end_offset += sizeof(WCHAR)) {
+    if (key_end_offset + sizeof(WCHAR) > node->end_offset) {
+      return 0;
+    }
+
+    if (ReadWord(block, key_end_offset) == 0) {
+      break;
+    }
+  }
+
+  node->key_len = (key_end_offset - node->key_offset) / sizeof(WCHAR);
+  node->value_offset = AlignOffset(key_end_offset + sizeof(WCHAR));
+
+  /* The length of a text value is in characters, rather than bytes. */
+  node->value_size = (type == NODE_TYPE_TEXT)
+      ? value_length * sizeof(WCHAR)
+      : value_length;
+
+  if (node->value_size == 0) {
+    node->children_offset = node->value_offset;
+
+    return 1;
+  }
+
+  if (node->value_offset > node->end_offset
+      || node->value_size > node->end_offset - node->value_offset) {
+    return 0;
+  }
+
+  node->children_offset = AlignOffset(node->value_offset + node->value_size);
+
+  return 1;
+}
+
+/* Keys are compared without case, in the same way as VerQueryValueW. */
+static int IsNodeKey(
+    const struct VersionNode* node,
+    const unsigned char* block,
+    const wchar_t* key,
+    size_t key_len
+) {
+  size_t i;
+  wchar_t node_key_char;
+
+  if (node->key_len != key_len) {
+    return 0;
+  }
+
+  for (i = 0; i < key_len; i += 1) {
+    node_key_char = ReadWord(block, node->key_offset + i * sizeof(WCHAR));
+
+    if (ToLowerAscii(node_key_char) != ToLowerAscii(key[i])) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/* Returns zero if no child has the key, or a child is malformed. */
+static int FindChildNode(
+    struct VersionNode* child,
+    const unsigned char* block,
+    const struct VersionNode* parent,
+    const wchar_t* key,
+    size_t key_len
+) {
+  size_t offset;
+
+  for (offset = parent->children_offset;
+      offset < parent->end_offset;
+      offset = AlignOffset(child->end_offset)) {
+    if (!ParseNode(child, block, offset, parent->end_offset)) {
+      return 0;
+    }
+
+    if (IsNodeKey(child, block, key, key_len)) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static int ParseRootNode(
+    struct VersionNode* root,
+    const unsigned char* block,
+    size_t block_size
+) {
+  if (!ParseNode(root, block, 0, block_size)
+      || !IsNodeKey(
+          root,
+          block,
+          kRootKey,
+          (sizeof(kRootKey) / sizeof(kRootKey[0])) - 1
+      )) {
+    RecordGeneralFailure(
+        L"The version resource is truncated or malformed.",
+        L"Invalid Version Info"
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+static void FormatTranslationKey(
+    wchar_t* translation_key,
+    WORD language,
+    WORD code_page
+) {
+  static const wchar_t kHexDigits[] = L"0123456789abcdef";
+
+  DWORD translation;
+  size_t i;
+
+  translation = ((DWORD) language << 16) | code_page;
+
+  for (i = 0; i < TRANSLATION_KEY_LEN; i += 1) {
+    translation_key[TRANSLATION_KEY_LEN - 1 - i] =
+        kHexDigits[(translation >> (i * 4)) & 0xF];
+  }
+
+  translation_key[TRANSLATION_KEY_LEN] = L'\0';
+}
+
+int VersionResource_ParseFileInfo(
+    VS_FIXEDFILEINFO* file_info,
+    const unsigned char* block,
+    size_t block_size
+) {
+  struct VersionNode root;
+
+  if (!ParseRootNode(&root, block, block_size)) {
+    return 0;
+  }
+
+  if (root.value_size < sizeof(*file_info)) {
+    goto fail;
+  }
+
+  memcpy(file_info, block + root.value_offset, sizeof(*file_info));
+
+  if (file_info->dwSignature != kFixedFileInfoSignature) {
+    goto fail;
+  }
+
+  return 1;
+
+fail:
+  RecordGeneralFailure(
+      L"The fixed file info in the version resource is malformed.",
+      L"Invalid Version Info"
+  );
+
+  return 0;
+}
+
+wchar_t* VersionResource_ExtractStringValue(
+    const unsigned char* block,
+    size_t block_size,
+    const wchar_t* string_name,
+    size_t string_name_len
+) {
+  struct VersionNode root;
+  struct VersionNode var_file_info;
+  struct VersionNode translation;
+  struct VersionNode string_file_info;
+  struct VersionNode string_table;
+  struct VersionNode string_node;
+
+  wchar_t translation_key[TRANSLATION_KEY_LEN + 1];
+  size_t string_value_len;
+  wchar_t* string_value;
+
+  if (!ParseRootNode(&root, block, block_size)) {
+    return NULL;
+  }
+
+  if (!FindChildNode(
+      &var_file_info,
+      block,
+      &root,
+      kVarFileInfoKey,
+      (sizeof(kVarFileInfoKey) / sizeof(kVarFileInfoKey[0])) - 1
+  ) || !FindChildNode(
+      &translation,
+      block,
+      &var_file_info,
+      kTranslationKey,
+      (sizeof(kTranslationKey) / sizeof(kTranslationKey[0])) - 1
+  ) || translation.value_size < 2 * sizeof(WORD)) {
+    RecordGeneralFailure(
+        L"The version resource does not list any translations.",
+        L"Invalid Version Info"
+    );
+
+    return NULL;
+  }
+
+  FormatTranslationKey(
+      translation_key,
+      ReadWord(block, translation.value_offset),
+      ReadWord(block, translation.value_offset + sizeof(WORD))
+  );
+
+  if (!FindChildNode(
+      &string_file_info,
+      block,
+      &root,
+      kStringFileInfoKey,
+      (sizeof(kStringFileInfoKey) / sizeof(kStringFileInfoKey[0])) - 1
+  ) || !FindChildNode(
+      &string_table,
+      block,
+      &string_file_info,
+      translation_key,
+      TRANSLATION_KEY_LEN
+  ) || !FindChildNode(
+      &string_node,
+      block,
+      &string_table,
+      string_name,
+      string_name_len
+  )) {
+    RecordGeneralFailure(
+        L"The string value is not in the version resource.",
+        L"Invalid Version Info"
+    );
+
+    return NULL;
+  }
+
+  /*
+  * Return a copy of the string value. The value is not trusted to be
+  * null-terminated within its reported size.
+  */
+  string_value_len = string_node.value_size / sizeof(string_value[0]);
+
+  string_value = malloc((string_value_len + 1) * sizeof(string_value[0]));
+
+  if (string_value == NULL) {
+    RecordAllocationFailure();
+    return NULL;
+  }
+
+  memcpy(
+      string_value,
+      block + string_node.value_offset,
+      string_value_len * sizeof(string_value[0])
+  );
+
+  string_value[string_value_len] = L'\0';
+
+  return string_value;
+}
@@ -0,0 +1,62 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_HELPER_VERSION_RESOURCE_H_
+#define SGGLDKL_HELPER_VERSION_RESOURCE_H_
+
+#include <stddef.h>
+#include <wchar.h>
+#include <windows.h>
+
+/*
+* Parses a VS_VERSIONINFO block, the data of a version resource, in the
+* same way as VerQueryValueW, but without needing the block to come
+* from GetFileVersionInfoW. The block does not need to be aligned, and
+* every read is checked against its size.
+*/
+
+/* Returns zero on failure. */
+int VersionResource_ParseFileInfo(
+    VS_FIXEDFILEINFO* file_info,
+    const unsigned char* block,
+    size_t block_size
+);
+
+/*
+* Returns a copy of the string value for the first translation, which
+* must be freed, or NULL on failure.
+*/
+wchar_t* VersionResource_ExtractStringValue(
+    const unsigned char* block,
+    size_t block_size,
+    const wchar_t* string_name,
+    size_t string_name_len
+);
+
+#endif /* SGGLDKL_HELPER_VERSION_RESOURCE_H_ */
@@ -0,0 +1,621 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "image_file_source.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "helper/error_handling.h"
+#include "helper/version_resource.h"
+#include "patch_helper/pe_header.h"
+
+enum Constant {
+  PE_HEADER_PTR_OFFSET = 0x3C,
+
+  /* The headers of the game files fit well within this size. */
+  MAX_NT_HEADERS_END = 4096,
+
+  RESOURCE_DIRECTORY_SIZE = 16,
+  RESOURCE_DIRECTORY_NUM_NAMED_ENTRIES_OFFSET = 12,
+  RESOURCE_DIRECTORY_NUM_ID_ENTRIES_OFFSET = 14,
+  RESOURCE_DIRECTORY_ENTRY_SIZE = 8,
+
+  /*
+  * The number of entries read with each resource directory, which is
+  * enough that the directories of the game files are read at once.
+  */
+  RESOURCE_DIRECTORY_READ_ENTRIES = 16,
+
+  /* The type, name and language levels of the resource tree. */
+  RESOURCE_DIRECTORY_LEVELS = 3,
+
+  RESOURCE_TYPE_VERSION = 16,
+
+  /* The length of a version block is stored in a WORD. */
+  MAX_VERSION_BLOCK_SIZE = 0xFFFF
+};
+
+static const DWORD kResourceSubdirectoryFlag = 0x80000000;
+
+static int ImageFile_Read(
+    const struct ImageFile* image_file,
+    DWORD rva,
+    void* buffer,
+    size_t size
+) {
+  return image_file->reader.read_func_ptr(
+      image_file->reader.context,
+      image_file->reader.image,
+      image_file->reader.image_size,
+      rva,
+      buffer,
+      size
+  );
+}
+
+/* Returns NULL if the reader cannot view the image. */
+static const void* ImageFile_View(
+    const struct ImageFile* image_file,
+    DWORD rva,
+    size_t size
+) {
+  if (image_file->reader.view_func_ptr == NULL) {
+    return NULL;
+  }
+
+  return image_file->reader.view_func_ptr(
+      image_file->reader.context,
+      image_file->reader.image,
+      image_file->reader.image_size,
+      rva,
+      size
+  );
+}
+
+static void ImageFile_Init(
+    struct ImageFile* image_file,
+    const struct ImageReader* reader
+) {
+  image_file->reader = *reader;
+
+  image_file->is_headers_read = 0;
+  image_file->size_of_headers = 0;
+  image_file->resource_directory.VirtualAddress = 0;
+  image_file->resource_directory.Size = 0;
+
+  image_file->version_block = NULL;
+  image_file->version_block_size = 0;
+  image_file->allocated_version_block = NULL;
+}
+
+static void ImageFile_Deinit(struct ImageFile* image_file) {
+  free(image_file->allocated_version_block);
+  image_file->allocated_version_block = NULL;
+
+  image_file->version_block = NULL;
+  image_file->version_block_size = 0;
+}
+
+static int ImageFile_ReadHeaders(struct ImageFile* image_file) {
+  unsigned char dos_header[sizeof(IMAGE_DOS_HEADER)];
+  LONG e_lfanew;
+
+  const unsigned char* header_view;
+  unsigned char* header_buffer;
+  size_t header_buffer_size;
+  IMAGE_NT_HEADERS nt_headers;
+  int is_success;
+
+  if (image_file->is_headers_read) {
+    return 1;
+  }
+
+  /*
+  * The DOS header is read first, so that the headers can be read up to
+  * the end of the NT headers without reading past a short image.
+  */
+  if (!ImageFile_Read(image_file, 0, dos_header, sizeof(dos_header))) {
+    return 0;
+  }
+
+  memcpy(&e_lfanew, dos_header + PE_HEADER_PTR_OFFSET, sizeof(e_lfanew));
+
+  if (e_lfanew < (LONG) sizeof(dos_header)
+      || (size_t) e_lfanew > MAX_NT_HEADERS_END - sizeof(nt_headers)) {
+    goto fail_malformed;
+  }
+
+  header_buffer_size = e_lfanew + sizeof(nt_headers);
+
+  if (image_file->reader.view_func_ptr != NULL) {
+    header_view = ImageFile_View(image_file, 0, header_buffer_size);
+
+    is_success = header_view != NULL && PeHeader_ParseNtHeaders(
+        &nt_headers,
+        header_view,
+        header_buffer_size
+    );
+  } else {
+    header_buffer = malloc(header_buffer_size);
+
+    if (header_buffer == NULL) {
+      RecordAllocationFailure();
+      return 0;
+    }
+
+    is_success = ImageFile_Read(
+        image_file,
+        0,
+        header_buffer,
+        header_buffer_size
+    ) && PeHeader_ParseNtHeaders(
+        &nt_headers,
+        header_buffer,
+        header_buffer_size
+    );
+
+    free(header_buffer);
+  }
+
+  if (!is_success) {
+    goto fail_malformed;
+  }
+
+  image_file->size_of_headers = nt_headers.OptionalHeader.SizeOfHeaders;
+  image_file->resource_directory = nt_headers.OptionalHeader.DataDirectory[
+      IMAGE_DIRECTORY_ENTRY_RESOURCE
+  ];
+
+  image_file->is_headers_read = 1;
+
+  return 1;
+
+fail_malformed:
+  RecordGeneralFailure(
+      L"The PE header of the game file is truncated or malformed.",
+      L"Invalid PE Header"
+  );
+
+  return 0;
+}
+
+/*
+* Outputs the data of the resource directory entry with the ID, or of
+* the first entry if is_id_matched is zero.
+*/
+static int ImageFile_FindResourceEntry(
+    const struct ImageFile* image_file,
+    DWORD directory_offset,
+    int is_id_matched,
+    WORD id,
+    DWORD* entry_data
+) {
+  const IMAGE_DATA_DIRECTORY* resource_directory;
+
+  unsigned char directory_buffer[
+      RESOURCE_DIRECTORY_SIZE
+          + RESOURCE_DIRECTORY_READ_ENTRIES * RESOURCE_DIRECTORY_ENTRY_SIZE
+  ];
+  size_t directory_read_size;
+
+  WORD num_named_entries;
+  WORD num_id_entries;
+  size_t num_entries;
+  size_t i_entry;
+
+  unsigned char entry[RESOURCE_DIRECTORY_ENTRY_SIZE];
+  DWORD entry_name;
+
+  resource_directory = &image_file->resource_directory;
+
+  if (directory_offset > resource_directory->Size
+      || resource_directory->Size - directory_offset
+          < RESOURCE_DIRECTORY_SIZE) {
+    goto fail_malformed;
+  }
+
+  directory_read_size = resource_directory->Size - directory_offset;
+
+  if (directory_read_size > sizeof(directory_buffer)) {
+    directory_read_size = sizeof(directory_buffer);
+  }
+
+  if (!ImageFile_Read(
+      image_file,
+      resource_directory->VirtualAddress + directory_offset,
+      directory_buffer,
+      directory_read_size
+  )) {
+    return 0;
+  }
+
+  memcpy(
+      &num_named_entries,
+      directory_buffer + RESOURCE_DIRECTORY_NUM_NAMED_ENTRIES_OFFSET,
+      sizeof(num_named_entries)
+  );
+
+  memcpy(
+      &num_id_entries,
+      directory_buffer + RESOURCE_DIRECTORY_NUM_ID_ENTRIES_OFFSET,
+      sizeof(num_id_entries)
+  );
+
+  num_entries = (size_t) num_named_entries + num_id_entries;
+
+  if ((resource_directory->Size - directory_offset - RESOURCE_DIRECTORY_SIZE)
+      / RESOURCE_DIRECTORY_ENTRY_SIZE < num_entries) {
+    goto fail_malformed;
+  }
+
+  /* The entries with names come before the entries with IDs. */
+  for (i_entry = is_id_matched ? num_named_entries : 0;
+      i_entry < num_entries;
+      i_entry += 1) {
+    if (i_entry < RESOURCE_DIRECTORY_READ_ENTRIES) {
+      memcpy(
+          entry,
+          directory_buffer
+              + RESOURCE_DIRECTORY_SIZE
+              + i_entry * RESOURCE_DIRECTORY_ENTRY_SIZE,
+          sizeof(entry)
+      );
+    } else if (!ImageFile_Read(
+        image_file,
+        resource_directory->VirtualAddress
+            + directory_offset
+            + RESOURCE_DIRECTORY_SIZE
+            + i_entry * RESOURCE_DIRECTORY_ENTRY_SIZE,
+        entry,
+        sizeof(entry)
+    )) {
+      return 0;
+    }
+
+    memcpy(&entry_name, entry, sizeof(entry_name));
+
+    if (!is_id_matched || entry_name == id) {
+      memcpy(entry_data, entry + sizeof(entry_name), sizeof(*entry_data));
+
+      return 1;
+    }
+  }
+
+  RecordGeneralFailure(
+      L"The game file does not have a version resource.",
+      L"Invalid Version Info"
+  );
+
+  return 0;
+
+fail_malformed:
+  RecordGeneralFailure(
+      L"The resource directory of the game file is malformed.",
+      L"Invalid Version Info"
+  );
+
+  return 0;
+}
+
+/*
+* Reads the version resource, by following the first name and language
+* under the version type, in the same way as GetFileVersionInfoW.
+*/
+static int ImageFile_ReadVersionBlock(struct ImageFile* image_file) {
+  DWORD entry_data;
+  size_t i_level;
+  int is_subdirectory;
+  IMAGE_RESOURCE_DATA_ENTRY data_entry;
+
+  if (image_file->version_block != NULL) {
+    return 1;
+  }
+
+  if (!ImageFile_ReadHeaders(image_file)) {
+    return 0;
+  }
+
+  if (image_file->resource_directory.Size == 0) {
+    RecordGeneralFailure(
+        L"The game file does not have a version resource.",
+        L"Invalid Version Info"
+    );
+
+    return 0;
+  }
+
+  entry_data = 0;
+
+  for (i_level = 0; i_level < RESOURCE_DIRECTORY_LEVELS; i_level += 1) {
+    if (!ImageFile_FindResourceEntry(
+        image_file,
+        entry_data & ~kResourceSubdirectoryFlag,
+        i_level == 0,
+        RESOURCE_TYPE_VERSION,
+        &entry_data
+    )) {
+      return 0;
+    }
+
+    /* Only the language level points to the data entry. */
+    is_subdirectory = (entry_data & kResourceSubdirectoryFlag) != 0;
+
+    if (is_subdirectory != (i_level < RESOURCE_DIRECTORY_LEVELS - 1)) {
+      goto fail_malformed;
+    }
+  }
+
+  if (entry_data > image_file->resource_directory.Size
+      || image_file->resource_directory.Size - entry_data
+          < sizeof(data_entry)) {
+    goto fail_malformed;
+  }
+
+  if (!ImageFile_Read(
+      image_file,
+      image_file->resource_directory.VirtualAddress + entry_data,
+      &data_entry,
+      sizeof(data_entry)
+  )) {
+    return 0;
+  }
+
+  if (data_entry.Size == 0 || data_entry.Size > MAX_VERSION_BLOCK_SIZE) {
+    goto fail_malformed;
+  }
+
+  if (image_file->reader.view_func_ptr != NULL) {
+    image_file->version_block = ImageFile_View(
+        image_file,
+        data_entry.OffsetToData,
+        data_entry.Size
+    );
+
+    if (image_file->version_block == NULL) {
+      return 0;
+    }
+  } else {
+    image_file->allocated_version_block = malloc(data_entry.Size);
+
+    if (image_file->allocated_version_block == NULL) {
+      RecordAllocationFailure();
+      return 0;
+    }
+
+    if (!ImageFile_Read(
+        image_file,
+        data_entry.OffsetToData,
+        image_file->allocated_version_block,
+        data_entry.Size
+    )) {
+      ImageFile_Deinit(image_file);
+
+      return 0;
+    }
+
+    image_file->version_block = image_file->allocated_version_block;
+  }
+
+  image_file->version_block_size = data_entry.Size;
+
+  return 1;
+
+fail_malformed:
+  RecordGeneralFailure(
+      L"The resource directory of the game file is malformed.",
+      L"Invalid Version Info"
+  );
+
+  return 0;
+}
+
+/* Returns the image of the game executable or companion file. */
+static struct ImageFile* ImageFileSource_GetImageFile(
+    struct ImageFileSource* image_source,
+    const wchar_t* file_name,
+    size_t file_name_len
+) {
+  size_t i_companion;
+  struct ImageFileCompanion* companion;
+  struct ImageReader reader;
+
+  if (file_name == NULL) {
+    return &image_source->game_file;
+  }
+
+  for (i_companion = 0;
+      i_companion < image_source->num_companions;
+      i_companion += 1) {
+    companion = &image_source->companions[i_companion];
+
+    if (wcslen(companion->file_name) == file_name_len
+        && _wcsnicmp(companion->file_name, file_name, file_name_len) == 0) {
+      return &companion->image_file;
+    }
+  }
+
+  if (image_source->num_companions >= IMAGE_FILE_SOURCE_MAX_COMPANIONS
+      || file_name_len >= MAX_PATH) {
+    RecordGeneralFailure(
+        L"The companion file could not be tracked.",
+        L"Too Many Companion Files"
+    );
+
+    return NULL;
+  }
+
+  if (!image_source->find_companion_func_ptr(
+      image_source->find_companion_context,
+      file_name,
+      file_name_len,
+      &reader
+  )) {
+    return NULL;
+  }
+
+  companion = &image_source->companions[image_source->num_companions];
+
+  memcpy(
+      companion->file_name,
+      file_name,
+      file_name_len * sizeof(companion->file_name[0])
+  );
+
+  companion->file_name[file_name_len] = L'\0';
+
+  ImageFile_Init(&companion->image_file, &reader);
+
+  image_source->num_companions += 1;
+
+  return &companion->image_file;
+}
+
+static int ImageExtractFileInfo(
+    void* context,
+    const wchar_t* file_name,
+    size_t file_name_len,
+    VS_FIXEDFILEINFO* file_info
+) {
+  struct ImageFile* image_file;
+
+  image_file = ImageFileSource_GetImageFile(
+      (struct ImageFileSource*) context,
+      file_name,
+      file_name_len
+  );
+
+  if (image_file == NULL || !ImageFile_ReadVersionBlock(image_file)) {
+    return 0;
+  }
+
+  return VersionResource_ParseFileInfo(
+      file_info,
+      image_file->version_block,
+      image_file->version_block_size
+  );
+}
+
+static wchar_t* ImageExtractStringValue(
+    void* context,
+    const wchar_t* string_name,
+    size_t string_name_len
+) {
+  struct ImageFileSource* image_source;
+
+  image_source = (struct ImageFileSource*) context;
+
+  if (!ImageFile_ReadVersionBlock(&image_source->game_file)) {
+    return NULL;
+  }
+
+  return VersionResource_ExtractStringValue(
+      image_source->game_file.version_block,
+      image_source->game_file.version_block_size,
+      string_name,
+      string_name_len
+  );
+}
+
+static int ImageReadBytes(
+    void* context,
+    const wchar_t* file_name,
+    size_t file_name_len,
+    long offset,
+    unsigned char* buffer,
+    size_t size
+) {
+  struct ImageFile* image_file;
+
+  image_file = ImageFileSource_GetImageFile(
+      (struct ImageFileSource*) context,
+      file_name,
+      file_name_len
+  );
+
+  if (image_file == NULL || !ImageFile_ReadHeaders(image_file)) {
+    return 0;
+  }
+
+  if (offset < 0
+      || (DWORD) offset > image_file->size_of_headers
+      || image_file->size_of_headers - offset < size) {
+    RecordGeneralFailure(
+        L"The file offset is outside of the image headers.",
+        L"Game Version Check Failure"
+    );
+
+    return 0;
+  }
+
+  return ImageFile_Read(image_file, (DWORD) offset, buffer, size);
+}
+
+static const struct GameFileSourceOps kImageGameFileSourceOps = {
+  &ImageExtractFileInfo,
+  &ImageExtractStringValue,
+  &ImageReadBytes
+};
+
+void ImageFileSource_Init(
+    struct ImageFileSource* image_source,
+    const struct ImageReader* game_reader,
+    int (*find_companion_func_ptr)(
+        void* context,
+        const wchar_t* file_name,
+        size_t file_name_len,
+        struct ImageReader* reader
+    ),
+    void* find_companion_context
+) {
+  ImageFile_Init(&image_source->game_file, game_reader);
+
+  image_source->find_companion_func_ptr = find_companion_func_ptr;
+  image_source->find_companion_context = find_companion_context;
+
+  image_source->num_companions = 0;
+}
+
+void ImageFileSource_Deinit(struct ImageFileSource* image_source) {
+  size_t i_companion;
+
+  for (i_companion = 0;
+      i_companion < image_source->num_companions;
+      i_companion += 1) {
+    ImageFile_Deinit(&image_source->companions[i_companion].image_file);
+  }
+
+  image_source->num_companions = 0;
+
+  ImageFile_Deinit(&image_source->game_file);
+}
+
+const struct GameFileSourceOps* GameFileSourceOps_GetImage(void) {
+  return &kImageGameFileSourceOps;
+}
@@ -0,0 +1,138 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_IMAGE_FILE_SOURCE_H_
+#define SGGLDKL_IMAGE_FILE_SOURCE_H_
+
+#include <stddef.h>
+#include <wchar.h>
+#include <windows.h>
+
+#include "helper/game_file_source.h"
+
+enum {
+  IMAGE_FILE_SOURCE_MAX_COMPANIONS = 4
+};
+
+/*
+* Reads from a PE image by relative virtual address. The read function
+* returns zero on failure, after recording the failure. The image and
+* its size are only interpreted by the functions.
+*
+* The view function is NULL if the image is not in the memory of this
+* process. Otherwise, it returns a pointer to the data in the image,
+* so that the data is used without being copied, or NULL on failure.
+*/
+struct ImageReader {
+  int (*read_func_ptr)(
+      void* context,
+      const void* image,
+      size_t image_size,
+      DWORD rva,
+      void* buffer,
+      size_t size
+  );
+
+  const void* (*view_func_ptr)(
+      void* context,
+      const void* image,
+      size_t image_size,
+      DWORD rva,
+      size_t size
+  );
+
+  void* context;
+  const void* image;
+  size_t image_size;
+};
+
+/*
+* A PE image, with its headers and version resource read on first use.
+* Only the headers can be read by file offset, as they are the only
+* part of an image at the same offsets as in the file.
+*/
+struct ImageFile {
+  struct ImageReader reader;
+
+  int is_headers_read;
+  DWORD size_of_headers;
+  IMAGE_DATA_DIRECTORY resource_directory;
+
+  const unsigned char* version_block;
+  size_t version_block_size;
+
+  /* NULL if the version block is viewed in the image. */
+  unsigned char* allocated_version_block;
+};
+
+struct ImageFileCompanion {
+  wchar_t file_name[MAX_PATH];
+  struct ImageFile image_file;
+};
+
+/*
+* The game files, read from PE images rather than from disk. Companion
+* images are found on first use by the find function, which outputs
+* their reader, and returns zero after recording the failure if the
+* image could not be found.
+*/
+struct ImageFileSource {
+  struct ImageFile game_file;
+
+  int (*find_companion_func_ptr)(
+      void* context,
+      const wchar_t* file_name,
+      size_t file_name_len,
+      struct ImageReader* reader
+  );
+
+  void* find_companion_context;
+
+  size_t num_companions;
+  struct ImageFileCompanion companions[IMAGE_FILE_SOURCE_MAX_COMPANIONS];
+};
+
+void ImageFileSource_Init(
+    struct ImageFileSource* image_source,
+    const struct ImageReader* game_reader,
+    int (*find_companion_func_ptr)(
+        void* context,
+        const wchar_t* file_name,
+        size_t file_name_len,
+        struct ImageReader* reader
+    ),
+    void* find_companion_context
+);
+
+void ImageFileSource_Deinit(struct ImageFileSource* image_source);
+
+/* The operations that read the images, from ImageFileSource. */
+const struct GameFileSourceOps* GameFileSourceOps_GetImage(void);
+
+#endif /* SGGLDKL_IMAGE_FILE_SOURCE_H_ */
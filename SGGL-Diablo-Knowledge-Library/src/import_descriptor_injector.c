@@ -0,0 +1,519 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "import_descriptor_injector.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "helper/encoding.h"
+#include "helper/error_handling.h"
+#include "helper/windows_version.h"
+
+/* Each library gets an import name table and an import address table. */
+enum Constant {
+  NUM_THUNKS_PER_LIBRARY = 2,
+  IMPORTED_ORDINAL = 1,
+
+  LIBRARIES_BOUND_POLL_MILLISECONDS = 1,
+
+  /*
+  * How long the loader is waited on to bind every library. It is only
+  * expected to take long if a library hangs in its DllMain.
+  */
+  LIBRARIES_BOUND_TIMEOUT_MILLISECONDS = 60000
+};
+
+static const DWORD kImportedOrdinalThunk =
+    IMAGE_ORDINAL_FLAG | IMPORTED_ORDINAL;
+
+/*
+* The layout of the block copied into the game process. The extended
+* descriptor table comes first, followed by the thunks of each library,
+* and then their names.
+*/
+struct ImportBlockLayout {
+  size_t num_original_descriptors;
+  size_t num_libraries;
+
+  size_t thunks_offset;
+  size_t names_offset;
+  size_t size;
+};
+
+static void ImportBlockLayout_Init(
+    struct ImportBlockLayout* layout,
+    size_t num_original_descriptors,
+    size_t num_libraries,
+    size_t names_size
+) {
+  layout->num_original_descriptors = num_original_descriptors;
+  layout->num_libraries = num_libraries;
+
+  /* One more descriptor is needed for the null-terminator. */
+  layout->thunks_offset = (num_original_descriptors + num_libraries + 1)
+      * sizeof(IMAGE_IMPORT_DESCRIPTOR);
+
+  layout->names_offset = layout->thunks_offset
+      + num_libraries * 2 * NUM_THUNKS_PER_LIBRARY * sizeof(DWORD);
+
+  layout->size = layout->names_offset + names_size;
+}
+
+/* The offset of the import address table of the library. */
+static size_t ImportBlockLayout_GetIatOffset(
+    const struct ImportBlockLayout* layout,
+    size_t i_library
+) {
+  return layout->thunks_offset
+      + (i_library * 2 + 1) * NUM_THUNKS_PER_LIBRARY * sizeof(DWORD);
+}
+
+/*
+* Reads the game's import descriptors, up to their null-terminator.
+* Outputs NULL if the game has none.
+*/
+static int ReadOriginalDescriptors(
+    const struct RemoteProcess* remote_process,
+    const struct PeHeader* pe_header,
+    IMAGE_IMPORT_DESCRIPTOR** descriptors,
+    size_t* num_descriptors
+) {
+  const IMAGE_DATA_DIRECTORY* import_directory;
+  size_t max_num_descriptors;
+  unsigned char* image_base;
+
+  *descriptors = NULL;
+  *num_descriptors = 0;
+
+  import_directory = PeHeader_GetDataDirectory(
+      pe_header,
+      IMAGE_DIRECTORY_ENTRY_IMPORT
+  );
+
+  max_num_descriptors = import_directory->Size
+      / sizeof(IMAGE_IMPORT_DESCRIPTOR);
+
+  if (import_directory->VirtualAddress == 0 || max_num_descriptors == 0) {
+    return 1;
+  }
+
+  *descriptors = malloc(max_num_descriptors * sizeof((*descriptors)[0]));
+
+  if (*descriptors == NULL) {
+    RecordAllocationFailure();
+    return 0;
+  }
+
+  image_base = (unsigned char*) pe_header->nt_headers.OptionalHeader.ImageBase;
+
+  if (!RemoteProcess_ReadMemory(
+      remote_process,
+      image_base + import_directory->VirtualAddress,
+      *descriptors,
+      max_num_descriptors * sizeof((*descriptors)[0]),
+      NULL
+  )) {
+    free(*descriptors);
+    *descriptors = NULL;
+
+    return 0;
+  }
+
+  while (*num_descriptors < max_num_descriptors
+      && ((*descriptors)[*num_descriptors].Name != 0
+          || (*descriptors)[*num_descriptors].FirstThunk != 0)) {
+    *num_descriptors += 1;
+  }
+
+  return 1;
+}
+
+/*
+* Fills the block that is copied into the game process. The RVAs are
+* relative to the game's image base.
+*/
+static void FillImportBlock(
+    unsigned char* block,
+    const struct ImportBlockLayout* layout,
+    DWORD block_rva,
+    const IMAGE_IMPORT_DESCRIPTOR* original_descriptors,
+    const struct ConvertedString* library_names
+) {
+  size_t i_library;
+
+  IMAGE_IMPORT_DESCRIPTOR descriptor;
+  DWORD thunks[NUM_THUNKS_PER_LIBRARY];
+  size_t name_offset;
+  size_t descriptor_offset;
+  size_t int_offset;
+  size_t iat_offset;
+
+  memset(block, 0, layout->size);
+
+  memcpy(
+      block,
+      original_descriptors,
+      layout->num_original_descriptors * sizeof(descriptor)
+  );
+
+  /* The ordinal thunk is followed by the null-terminator. */
+  thunks[0] = kImportedOrdinalThunk;
+  thunks[1] = 0;
+
+  name_offset = layout->names_offset;
+
+  for (i_library = 0; i_library < layout->num_libraries; i_library += 1) {
+    iat_offset = ImportBlockLayout_GetIatOffset(layout, i_library);
+    int_offset = iat_offset - sizeof(thunks);
+
+    memcpy(&block[int_offset], thunks, sizeof(thunks));
+    memcpy(&block[iat_offset], thunks, sizeof(thunks));
+
+    memcpy(
+        &block[name_offset],
+        library_names[i_library].str,
+        library_names[i_library].len + 1
+    );
+
+    memset(&descriptor, 0, sizeof(descriptor));
+    descriptor.OriginalFirstThunk = block_rva + int_offset;
+    descriptor.Name = block_rva + name_offset;
+    descriptor.FirstThunk = block_rva + iat_offset;
+
+    descriptor_offset = (layout->num_original_descriptors + i_library)
+        * sizeof(descriptor);
+
+    memcpy(&block[descriptor_offset], &descriptor, sizeof(descriptor));
+
+    name_offset += library_names[i_library].len + 1;
+  }
+}
+
+/* Writes the import directory entry in the headers of the game image. */
+static int WriteImportDirectory(
+    const struct RemoteProcess* remote_process,
+    const struct PeHeader* pe_header,
+    const IMAGE_DATA_DIRECTORY* import_directory
+) {
+  void* import_directory_address;
+  DWORD old_protect;
+  int is_success;
+
+  import_directory_address = PeHeader_GetHardDataDirectoryAddress(
+      pe_header,
+      IMAGE_DIRECTORY_ENTRY_IMPORT
+  );
+
+  /* The headers are mapped read-only. */
+  if (!RemoteProcess_ProtectMemory(
+      remote_process,
+      import_directory_address,
+      sizeof(*import_directory),
+      PAGE_READWRITE,
+      &old_protect
+  )) {
+    return 0;
+  }
+
+  is_success = RemoteProcess_WriteMemory(
+      remote_process,
+      import_directory_address,
+      import_directory,
+      sizeof(*import_directory),
+      NULL
+  );
+
+  if (!RemoteProcess_ProtectMemory(
+      remote_process,
+      import_directory_address,
+      sizeof(*import_directory),
+      old_protect,
+      &old_protect
+  )) {
+    is_success = 0;
+  }
+
+  return is_success;
+}
+
+/*
+* Waits until the loader has bound the ordinal of every library, which
+* means that every library has been loaded. If a library cannot be
+* loaded, the loader terminates the game instead. Fails if the
+* libraries are not bound within a minute.
+*/
+static int WaitForLibrariesBound(
+    const struct RemoteProcess* remote_process,
+    const struct ImportBlockLayout* layout,
+    unsigned char* remote_block
+) {
+  size_t i_library;
+  DWORD iat_thunk;
+  DWORD start_tick;
+  int is_game_exited;
+
+  start_tick = GetTickCount();
+
+  for (i_library = 0; i_library < layout->num_libraries; i_library += 1) {
+    for (;;) {
+      if (!RemoteProcess_ReadMemory(
+          remote_process,
+          &remote_block[ImportBlockLayout_GetIatOffset(layout, i_library)],
+          &iat_thunk,
+          sizeof(iat_thunk),
+          NULL
+      )) {
+        return 0;
+      }
+
+      if (iat_thunk != kImportedOrdinalThunk) {
+        break;
+      }
+
+      if (!RemoteProcess_WaitForExit(
+          remote_process,
+          LIBRARIES_BOUND_POLL_MILLISECONDS,
+          &is_game_exited
+      )) {
+        return 0;
+      }
+
+      if (is_game_exited) {
+        RecordGeneralFailure(
+            L"The game exited while loading the libraries.",
+            L"Library Load Failed"
+        );
+
+        return 0;
+      }
+
+      if (GetTickCount() - start_tick
+          >= LIBRARIES_BOUND_TIMEOUT_MILLISECONDS) {
+        RecordGeneralFailure(
+            L"The libraries were not loaded in time.",
+            L"Library Load Timed Out"
+        );
+
+        return 0;
+      }
+    }
+  }
+
+  return 1;
+}
+
+int ImportDescriptorInjector_IsSupported(void) {
+  return WindowsVersion_IsNt();
+}
+
+int ImportDescriptorInjector_InjectLibraries(
+    const struct RemoteProcess* remote_process,
+    const struct PeHeader* pe_header,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries
+) {
+  size_t i_library;
+
+  IMAGE_IMPORT_DESCRIPTOR* original_descriptors;
+  size_t num_original_descriptors;
+  IMAGE_DATA_DIRECTORY original_import_directory;
+  IMAGE_DATA_DIRECTORY new_import_directory;
+
+  struct ConvertedString* library_names;
+  size_t num_library_names;
+  size_t names_size;
+
+  struct ImportBlockLayout layout;
+  unsigned char* block;
+  unsigned char* remote_block;
+  unsigned char* image_base;
+
+  DWORD previous_suspend_count;
+  int is_success;
+
+  is_success = 0;
+
+  if (!ImportDescriptorInjector_IsSupported()) {
+    RecordGeneralFailure(
+        L"Import descriptor injection requires Windows NT.",
+        L"Unsupported Operation"
+    );
+
+    return 0;
+  }
+
+  image_base = (unsigned char*) pe_header->nt_headers.OptionalHeader.ImageBase;
+  original_import_directory = *PeHeader_GetDataDirectory(
+      pe_header,
+      IMAGE_DIRECTORY_ENTRY_IMPORT
+  );
+
+  if (!ReadOriginalDescriptors(
+      remote_process,
+      pe_header,
+      &original_descriptors,
+      &num_original_descriptors
+  )) {
+    return 0;
+  }
+
+  /* The import names are multibyte strings. */
+  library_names = malloc((num_libraries + 1) * sizeof(library_names[0]));
+
+  if (library_names == NULL) {
+    RecordAllocationFailure();
+    goto free_original_descriptors;
+  }
+
+  names_size = 0;
+
+  for (num_library_names = 0;
+      num_library_names < num_libraries;
+      num_library_names += 1) {
+    ConvertWideToMultibyteInBuffer(
+        &library_names[num_library_names],
+        NULL,
+        0,
+        libraries_to_inject[num_library_names]
+    );
+
+    if (library_names[num_library_names].str == NULL) {
+      goto deinit_library_names;
+    }
+
+    names_size += library_names[num_library_names].len + 1;
+  }
+
+  ImportBlockLayout_Init(
+      &layout,
+      num_original_descriptors,
+      num_libraries,
+      names_size
+  );
+
+  block = malloc(layout.size);
+
+  if (block == NULL) {
+    RecordAllocationFailure();
+    goto deinit_library_names;
+  }
+
+  /*
+  * RVAs are unsigned, so the block must be above the image. A plain
+  * allocation is usually placed below it, as the image is at the
+  * bottom of the address space.
+  */
+  if (!RemoteProcess_AllocateMemory(
+      remote_process,
+      image_base + pe_header->nt_headers.OptionalHeader.SizeOfImage,
+      layout.size,
+      PAGE_READWRITE,
+      (void**) &remote_block
+  )) {
+    goto free_block;
+  }
+
+  if (remote_block < image_base) {
+    RecordGeneralFailure(
+        L"The import table could not be placed above the game image.",
+        L"Unsupported Memory Layout"
+    );
+
+    RemoteProcess_FreeMemory(remote_process, remote_block);
+    goto free_block;
+  }
+
+  FillImportBlock(
+      block,
+      &layout,
+      (DWORD) (remote_block - image_base),
+      original_descriptors,
+      library_names
+  );
+
+  if (!RemoteProcess_WriteMemory(
+      remote_process,
+      remote_block,
+      block,
+      layout.size,
+      NULL
+  )) {
+    RemoteProcess_FreeMemory(remote_process, remote_block);
+    goto free_block;
+  }
+
+  new_import_directory.VirtualAddress = (DWORD) (remote_block - image_base);
+  new_import_directory.Size = (DWORD) layout.thunks_offset;
+
+  if (!WriteImportDirectory(
+      remote_process,
+      pe_header,
+      &new_import_directory
+  )) {
+    RemoteProcess_FreeMemory(remote_process, remote_block);
+    goto free_block;
+  }
+
+  /*
+  * The loader reads the extended table as the main thread starts. The
+  * table is left allocated, as the loader could still hold on to it.
+  */
+  if (!RemoteProcess_ResumeThread(remote_process, &previous_suspend_count)
+      || !WaitForLibrariesBound(remote_process, &layout, remote_block)) {
+    goto free_block;
+  }
+
+  /* Hide the extended table again, now that the loader is done with it. */
+  if (!WriteImportDirectory(
+      remote_process,
+      pe_header,
+      &original_import_directory
+  )) {
+    goto free_block;
+  }
+
+  is_success = 1;
+
+free_block:
+  free(block);
+
+deinit_library_names:
+  for (i_library = 0; i_library < num_library_names; i_library += 1) {
+    ConvertedString_Deinit(&library_names[i_library]);
+  }
+
+  free(library_names);
+
+free_original_descriptors:
+  free(original_descriptors);
+
+  return is_success;
+}
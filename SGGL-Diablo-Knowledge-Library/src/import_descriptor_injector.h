@@ -0,0 +1,63 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_IMPORT_DESCRIPTOR_INJECTOR_H_
+#define SGGLDKL_IMPORT_DESCRIPTOR_INJECTOR_H_
+
+#include <stddef.h>
+#include <wchar.h>
+
+#include "patch_helper/pe_header.h"
+#include "patch_helper/remote_process.h"
+
+/*
+* Returns nonzero if memory can be allocated in another process, which
+* is the case on Windows NT.
+*/
+int ImportDescriptorInjector_IsSupported(void);
+
+/*
+* Extends the import directory of the game process with one descriptor
+* for each library, so that the Windows loader loads the libraries while
+* the process initializes. Each library is imported by ordinal 1, which
+* it must export, as checked by the preflight. The game's main thread
+* must never have run.
+*
+* The main thread is resumed, and once every library has been bound,
+* the original import directory entry is restored. The extended table
+* is left in the game process.
+*/
+int ImportDescriptorInjector_InjectLibraries(
+    const struct RemoteProcess* remote_process,
+    const struct PeHeader* pe_header,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries
+);
+
+#endif /* SGGLDKL_IMPORT_DESCRIPTOR_INJECTOR_H_ */
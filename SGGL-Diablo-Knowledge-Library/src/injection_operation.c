@@ -0,0 +1,374 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "injection_operation.h"
+
+#include <process.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "helper/error_handling.h"
+
+struct KnowledgeInjectionOperation {
+  struct LibraryInjector* library_injector;
+
+  /* Copied at the start, as the caller may change the settings later. */
+  struct LibraryInjectorSettings settings;
+
+  size_t num_libraries;
+  const wchar_t** libraries_to_inject;
+  wchar_t* library_paths_buffer;
+
+  size_t num_instances;
+  PROCESS_INFORMATION* processes_infos;
+  struct InjectionStatus* statuses;
+  struct KnowledgeLibraryLoadResult* load_results;
+
+  InjectionOperationCallback callback;
+  void* callback_context;
+
+  volatile LONG is_cancel_requested;
+  volatile LONG is_complete;
+  int result;
+  struct KnowledgeErrorDetail error_detail;
+
+  HANDLE thread_handle;
+};
+
+static unsigned __stdcall RunInjection(void* param) {
+  struct KnowledgeInjectionOperation* operation;
+
+  operation = param;
+
+  operation->result = LibraryInjector_InjectLibrariesToProcessesWithStatus(
+      operation->library_injector,
+      &operation->settings,
+      operation->libraries_to_inject,
+      operation->num_libraries,
+      operation->processes_infos,
+      operation->num_instances,
+      operation->statuses,
+      operation->load_results,
+      &operation->is_cancel_requested
+  );
+
+  /* The failure is recorded on this thread, so keep it for the caller. */
+  if (!operation->result) {
+    ErrorHandling_GetLastErrorDetail(&operation->error_detail);
+  }
+
+  InterlockedExchange(&operation->is_complete, 1);
+
+  if (operation->callback != NULL) {
+    operation->callback(
+        operation,
+        operation->result,
+        operation->callback_context
+    );
+  }
+
+  return 0;
+}
+
+/*
+* Copies the library paths into a single buffer, so that the caller's
+* strings do not need to outlive the call. Returns zero on failure.
+*/
+static int CopyLibraryPaths(
+    struct KnowledgeInjectionOperation* operation,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries
+) {
+  size_t i_library;
+  size_t library_paths_buffer_len;
+  size_t library_path_len;
+  wchar_t* library_path;
+
+  operation->num_libraries = num_libraries;
+
+  library_paths_buffer_len = 0;
+
+  for (i_library = 0; i_library < num_libraries; i_library += 1) {
+    library_paths_buffer_len += wcslen(libraries_to_inject[i_library]) + 1;
+  }
+
+  operation->libraries_to_inject = malloc(
+      (num_libraries + 1) * sizeof(operation->libraries_to_inject[0])
+  );
+
+  if (operation->libraries_to_inject == NULL) {
+    RecordAllocationFailure();
+    return 0;
+  }
+
+  operation->library_paths_buffer = malloc(
+      (library_paths_buffer_len + 1)
+          * sizeof(operation->library_paths_buffer[0])
+  );
+
+  if (operation->library_paths_buffer == NULL) {
+    RecordAllocationFailure();
+    free(operation->libraries_to_inject);
+
+    return 0;
+  }
+
+  library_path = operation->library_paths_buffer;
+
+  for (i_library = 0; i_library < num_libraries; i_library += 1) {
+    library_path_len = wcslen(libraries_to_inject[i_library]);
+
+    memcpy(
+        library_path,
+        libraries_to_inject[i_library],
+        (library_path_len + 1) * sizeof(library_path[0])
+    );
+
+    operation->libraries_to_inject[i_library] = library_path;
+    library_path += library_path_len + 1;
+  }
+
+  return 1;
+}
+
+struct KnowledgeInjectionOperation* InjectionOperation_Start(
+    struct LibraryInjector* library_injector,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    InjectionOperationCallback callback,
+    void* callback_context
+) {
+  struct KnowledgeInjectionOperation* operation;
+  size_t i_instance;
+  unsigned int thread_id;
+
+  operation = malloc(sizeof(*operation));
+
+  if (operation == NULL) {
+    RecordAllocationFailure();
+    return NULL;
+  }
+
+  operation->library_injector = library_injector;
+  operation->settings = library_injector->settings;
+
+  if (!CopyLibraryPaths(operation, libraries_to_inject, num_libraries)) {
+    goto free_operation;
+  }
+
+  /* Copy the process infos and init the progress of each instance. */
+  operation->num_instances = num_instances;
+
+  operation->processes_infos = malloc(
+      (num_instances + 1) * sizeof(operation->processes_infos[0])
+  );
+
+  if (operation->processes_infos == NULL) {
+    RecordAllocationFailure();
+    goto free_library_paths;
+  }
+
+  memcpy(
+      operation->processes_infos,
+      processes_infos,
+      num_instances * sizeof(operation->processes_infos[0])
+  );
+
+  operation->statuses = malloc(
+      (num_instances + 1) * sizeof(operation->statuses[0])
+  );
+
+  if (operation->statuses == NULL) {
+    RecordAllocationFailure();
+    goto free_processes_infos;
+  }
+
+  for (i_instance = 0; i_instance < num_instances; i_instance += 1) {
+    operation->statuses[i_instance].phase = KNOWLEDGE_INJECTION_PHASE_PENDING;
+    operation->statuses[i_instance].num_libs_loaded = 0;
+  }
+
+  /* The results are inited by the injection. */
+  operation->load_results = malloc(
+      (num_instances * num_libraries + 1)
+          * sizeof(operation->load_results[0])
+  );
+
+  if (operation->load_results == NULL) {
+    RecordAllocationFailure();
+    goto free_statuses;
+  }
+
+  operation->callback = callback;
+  operation->callback_context = callback_context;
+
+  operation->is_cancel_requested = 0;
+  operation->is_complete = 0;
+  operation->result = 0;
+  operation->error_detail.kind = KNOWLEDGE_ERROR_NONE;
+
+  /*
+  * _beginthreadex is used instead of CreateThread, as the injection
+  * uses the C runtime.
+  */
+  operation->thread_handle = (HANDLE) _beginthreadex(
+      NULL,
+      0,
+      &RunInjection,
+      operation,
+      0,
+      &thread_id
+  );
+
+  if (operation->thread_handle == NULL) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"_beginthreadex",
+        GetLastError()
+    );
+
+    goto free_load_results;
+  }
+
+  return operation;
+
+free_load_results:
+  free(operation->load_results);
+
+free_statuses:
+  free(operation->statuses);
+
+free_processes_infos:
+  free(operation->processes_infos);
+
+free_library_paths:
+  free(operation->library_paths_buffer);
+  free(operation->libraries_to_inject);
+
+free_operation:
+  free(operation);
+
+  return NULL;
+}
+
+int InjectionOperation_Wait(
+    struct KnowledgeInjectionOperation* operation,
+    DWORD timeout_ms
+) {
+  DWORD wait_result;
+
+  wait_result = WaitForSingleObject(operation->thread_handle, timeout_ms);
+
+  if (wait_result == WAIT_FAILED) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"WaitForSingleObject",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  return wait_result == WAIT_OBJECT_0;
+}
+
+int InjectionOperation_IsComplete(
+    const struct KnowledgeInjectionOperation* operation
+) {
+  return operation->is_complete != 0;
+}
+
+int InjectionOperation_GetResult(
+    const struct KnowledgeInjectionOperation* operation
+) {
+  return operation->result;
+}
+
+int InjectionOperation_GetErrorDetail(
+    const struct KnowledgeInjectionOperation* operation,
+    struct KnowledgeErrorDetail* error_detail
+) {
+  *error_detail = operation->error_detail;
+
+  return error_detail->kind != KNOWLEDGE_ERROR_NONE;
+}
+
+void InjectionOperation_Cancel(struct KnowledgeInjectionOperation* operation) {
+  InterlockedExchange(&operation->is_cancel_requested, 1);
+}
+
+int InjectionOperation_GetProgress(
+    const struct KnowledgeInjectionOperation* operation,
+    size_t i_instance,
+    struct KnowledgeInjectionProgress* progress
+) {
+  const struct InjectionStatus* status;
+
+  if (i_instance >= operation->num_instances) {
+    return 0;
+  }
+
+  status = &operation->statuses[i_instance];
+
+  progress->phase = (enum KnowledgeInjectionPhase) status->phase;
+  progress->num_libs_loaded = status->num_libs_loaded;
+
+  return 1;
+}
+
+int InjectionOperation_GetLibraryLoadResult(
+    const struct KnowledgeInjectionOperation* operation,
+    size_t i_instance,
+    size_t i_library,
+    struct KnowledgeLibraryLoadResult* load_result
+) {
+  if (i_instance >= operation->num_instances
+      || i_library >= operation->num_libraries) {
+    return 0;
+  }
+
+  *load_result = operation->load_results[
+      i_instance * operation->num_libraries + i_library
+  ];
+
+  return 1;
+}
+
+void InjectionOperation_Close(struct KnowledgeInjectionOperation* operation) {
+  InjectionOperation_Wait(operation, INFINITE);
+
+  CloseHandle(operation->thread_handle);
+
+  free(operation->load_results);
+  free(operation->statuses);
+  free(operation->processes_infos);
+  free(operation->library_paths_buffer);
+  free(operation->libraries_to_inject);
+  free(operation);
+}
@@ -0,0 +1,132 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_INJECTION_OPERATION_H_
+#define SGGLDKL_INJECTION_OPERATION_H_
+
+#include <stddef.h>
+#include <wchar.h>
+#include <windows.h>
+
+#include "../include/error_detail.h"
+#include "../include/injection_progress.h"
+#include "../include/library_load_result.h"
+#include "library_injector.h"
+
+struct KnowledgeInjectionOperation;
+
+/*
+* Called on the operation's worker thread once the injection has
+* finished. The callback must not wait on or close the operation.
+*/
+typedef void (*InjectionOperationCallback)(
+    struct KnowledgeInjectionOperation* operation,
+    int result,
+    void* context
+);
+
+/*
+* Runs the injection on a worker thread, returning immediately. The
+* library paths and process information are copied, so the caller's
+* arrays do not need to outlive this call. The library injector must
+* outlive the operation. Returns NULL if the operation could not be
+* started.
+*/
+struct KnowledgeInjectionOperation* InjectionOperation_Start(
+    struct LibraryInjector* library_injector,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    InjectionOperationCallback callback,
+    void* callback_context
+);
+
+/*
+* Waits for the injection to finish, for up to timeout_ms
+* milliseconds. Returns nonzero if it has finished.
+*/
+int InjectionOperation_Wait(
+    struct KnowledgeInjectionOperation* operation,
+    DWORD timeout_ms
+);
+
+int InjectionOperation_IsComplete(
+    const struct KnowledgeInjectionOperation* operation
+);
+
+/*
+* Returns the result of the injection, which is only valid once the
+* operation has finished.
+*/
+int InjectionOperation_GetResult(
+    const struct KnowledgeInjectionOperation* operation
+);
+
+/*
+* Copies the failure that stopped the injection, which is recorded on
+* the worker thread. Only valid once the operation has finished.
+* Returns zero if the injection did not fail.
+*/
+int InjectionOperation_GetErrorDetail(
+    const struct KnowledgeInjectionOperation* operation,
+    struct KnowledgeErrorDetail* error_detail
+);
+
+/*
+* Requests that no further libraries are loaded. The game instances
+* are still resumed, so the operation must still be waited on.
+*/
+void InjectionOperation_Cancel(struct KnowledgeInjectionOperation* operation);
+
+/* Returns zero if i_instance is out of range. */
+int InjectionOperation_GetProgress(
+    const struct KnowledgeInjectionOperation* operation,
+    size_t i_instance,
+    struct KnowledgeInjectionProgress* progress
+);
+
+/*
+* Copies the load result of one library in one instance. Only valid
+* once the operation has finished. Returns zero if i_instance or
+* i_library is out of range.
+*/
+int InjectionOperation_GetLibraryLoadResult(
+    const struct KnowledgeInjectionOperation* operation,
+    size_t i_instance,
+    size_t i_library,
+    struct KnowledgeLibraryLoadResult* load_result
+);
+
+/*
+* Waits for the injection to finish, and then frees the operation.
+*/
+void InjectionOperation_Close(struct KnowledgeInjectionOperation* operation);
+
+#endif /* SGGLDKL_INJECTION_OPERATION_H_ */
@@ -0,0 +1,318 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "install_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "helper/error_handling.h"
+#include "helper/file_path.h"
+
+/* Guards the list of entries and their references. */
+static CRITICAL_SECTION entries_critical_section;
+static struct InstallCacheEntry* entries_head = NULL;
+
+static int IsEntryForPath(
+    const struct InstallCacheEntry* entry,
+    const wchar_t* game_path,
+    size_t game_path_len
+) {
+  return entry->game_path_len == game_path_len
+      && _wcsicmp(entry->game_path, game_path) == 0;
+}
+
+/* Superseded entries are only kept until they are released. */
+static struct InstallCacheEntry* FindEntry(
+    const wchar_t* game_path,
+    size_t game_path_len,
+    const struct FileIdentity* game_file_identity
+) {
+  struct InstallCacheEntry* entry;
+
+  for (entry = entries_head; entry != NULL; entry = entry->next) {
+    if (!entry->is_superseded
+        && IsEntryForPath(entry, game_path, game_path_len)
+        && FileIdentity_Equals(
+            &entry->game_file_identity,
+            game_file_identity
+        )) {
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+static void UnlinkEntry(struct InstallCacheEntry* entry) {
+  struct InstallCacheEntry** link;
+
+  for (link = &entries_head; *link != NULL; link = &(*link)->next) {
+    if (*link == entry) {
+      *link = entry->next;
+      entry->next = NULL;
+
+      return;
+    }
+  }
+}
+
+static struct InstallCacheEntry* CreateEntry(
+    const wchar_t* game_path,
+    size_t game_path_len,
+    const struct FileIdentity* game_file_identity
+) {
+  struct InstallCacheEntry* entry;
+
+  /* Only needed during the detection, so it is not kept in the entry. */
+  struct GamePathContext path_context;
+
+  entry = malloc(sizeof(*entry));
+
+  if (entry == NULL) {
+    RecordAllocationFailure();
+    return NULL;
+  }
+
+  entry->next = NULL;
+  entry->num_references = 0;
+  entry->is_superseded = 0;
+
+  entry->game_file_identity = *game_file_identity;
+  entry->game_path_len = game_path_len;
+  entry->game_path = malloc(
+      (game_path_len + 1) * sizeof(entry->game_path[0])
+  );
+
+  if (entry->game_path == NULL) {
+    RecordAllocationFailure();
+    goto free_entry;
+  }
+
+  memcpy(
+      entry->game_path,
+      game_path,
+      (game_path_len + 1) * sizeof(entry->game_path[0])
+  );
+
+  if (!GamePathContext_Init(
+      &path_context,
+      game_path,
+      game_path_len
+  )) {
+    goto free_game_path;
+  }
+
+  if (!GameVersion_DetectRunningGameVersion(
+      game_path,
+      game_path_len,
+      &path_context,
+      &entry->detection,
+      &entry->game_version
+  )) {
+    goto free_game_path;
+  }
+
+  if (PeHeader_Init(&entry->pe_header, game_path, game_path_len) == NULL) {
+    goto free_game_path;
+  }
+
+  if (InjectorPatchImages_Init(
+      &entry->patch_images,
+      &entry->pe_header,
+      entry->game_version
+  ) == NULL) {
+    goto deinit_pe_header;
+  }
+
+  return entry;
+
+deinit_pe_header:
+  PeHeader_Deinit(&entry->pe_header);
+
+free_game_path:
+  free(entry->game_path);
+
+free_entry:
+  free(entry);
+
+  return NULL;
+}
+
+static void DestroyEntry(struct InstallCacheEntry* entry) {
+  InjectorPatchImages_Deinit(&entry->patch_images);
+  PeHeader_Deinit(&entry->pe_header);
+
+  free(entry->game_path);
+  free(entry);
+}
+
+void InstallCache_Init(void) {
+  InitializeCriticalSection(&entries_critical_section);
+}
+
+void InstallCache_Deinit(void) {
+  struct InstallCacheEntry* entry;
+  struct InstallCacheEntry* next_entry;
+
+  for (entry = entries_head; entry != NULL; entry = next_entry) {
+    next_entry = entry->next;
+    DestroyEntry(entry);
+  }
+
+  entries_head = NULL;
+
+  DeleteCriticalSection(&entries_critical_section);
+}
+
+const struct InstallCacheEntry* InstallCache_Get(
+    const wchar_t* game_path,
+    size_t game_path_len
+) {
+  struct FileIdentity game_file_identity;
+  struct InstallCacheEntry* entry;
+  struct InstallCacheEntry* new_entry;
+  struct InstallCacheEntry* old_entry;
+  struct InstallCacheEntry* next_entry;
+  struct InstallCacheEntry* unreferenced_head;
+
+  /*
+  * The identity is read before the information is determined, so that
+  * a game file that changes in the meantime is detected on the next
+  * use.
+  */
+  if (!FileIdentity_InitFromPath(&game_file_identity, game_path)) {
+    return NULL;
+  }
+
+  EnterCriticalSection(&entries_critical_section);
+
+  entry = FindEntry(game_path, game_path_len, &game_file_identity);
+
+  if (entry != NULL) {
+    entry->num_references += 1;
+  }
+
+  LeaveCriticalSection(&entries_critical_section);
+
+  if (entry != NULL) {
+    return entry;
+  }
+
+  /*
+  * Determining the information reads the game files, so it is done
+  * outside of the lock to not block contexts of other installs.
+  */
+  new_entry = CreateEntry(game_path, game_path_len, &game_file_identity);
+
+  /* Failures are not cached, so that the install can be retried. */
+  if (new_entry == NULL) {
+    return NULL;
+  }
+
+  unreferenced_head = NULL;
+
+  EnterCriticalSection(&entries_critical_section);
+
+  /* Another thread could have added the same install in the meantime. */
+  entry = FindEntry(game_path, game_path_len, &game_file_identity);
+
+  if (entry == NULL) {
+    /*
+    * The older entries of the path describe a game file that is no
+    * longer on disk. Referenced ones are kept until they are released.
+    */
+    for (old_entry = entries_head;
+        old_entry != NULL;
+        old_entry = next_entry) {
+      next_entry = old_entry->next;
+
+      if (!IsEntryForPath(old_entry, game_path, game_path_len)) {
+        continue;
+      }
+
+      old_entry->is_superseded = 1;
+
+      if (old_entry->num_references == 0) {
+        UnlinkEntry(old_entry);
+
+        old_entry->next = unreferenced_head;
+        unreferenced_head = old_entry;
+      }
+    }
+
+    new_entry->next = entries_head;
+    entries_head = new_entry;
+
+    entry = new_entry;
+    new_entry = NULL;
+  }
+
+  entry->num_references += 1;
+
+  LeaveCriticalSection(&entries_critical_section);
+
+  if (new_entry != NULL) {
+    DestroyEntry(new_entry);
+  }
+
+  for (old_entry = unreferenced_head;
+      old_entry != NULL;
+      old_entry = next_entry) {
+    next_entry = old_entry->next;
+    DestroyEntry(old_entry);
+  }
+
+  return entry;
+}
+
+void InstallCache_Release(const struct InstallCacheEntry* entry) {
+  struct InstallCacheEntry* mutable_entry;
+  int is_destroyed;
+
+  mutable_entry = (struct InstallCacheEntry*) entry;
+
+  EnterCriticalSection(&entries_critical_section);
+
+  mutable_entry->num_references -= 1;
+
+  is_destroyed = (mutable_entry->num_references == 0)
+      && mutable_entry->is_superseded;
+
+  if (is_destroyed) {
+    UnlinkEntry(mutable_entry);
+  }
+
+  LeaveCriticalSection(&entries_critical_section);
+
+  if (is_destroyed) {
+    DestroyEntry(mutable_entry);
+  }
+}
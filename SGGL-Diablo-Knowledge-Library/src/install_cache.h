@@ -0,0 +1,85 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_INSTALL_CACHE_H_
+#define SGGLDKL_INSTALL_CACHE_H_
+
+#include <stddef.h>
+#include <wchar.h>
+
+#include "game_version.h"
+#include "helper/file_identity.h"
+#include "patch_helper/injector_patches.h"
+#include "patch_helper/pe_header.h"
+
+/*
+* The immutable information about a game install, shared by every
+* context that uses the same game file. The information is never
+* modified after the entry is added to the cache, so it can be read
+* without locking.
+*/
+struct InstallCacheEntry {
+  /* Guarded by the cache's lock. */
+  struct InstallCacheEntry* next;
+  size_t num_references;
+  int is_superseded;
+
+  wchar_t* game_path;
+  size_t game_path_len;
+  struct FileIdentity game_file_identity;
+
+  enum GameVersion game_version;
+  struct KnowledgeGameDetection detection;
+  struct PeHeader pe_header;
+  struct InjectorPatchImages patch_images;
+};
+
+void InstallCache_Init(void);
+
+void InstallCache_Deinit(void);
+
+/*
+* Returns a reference to the entry for the game file as it currently is
+* on disk, determining its information if it is not yet cached. A game
+* file that was replaced or modified since it was cached gets a new
+* entry. Returns NULL if the information could not be determined.
+*/
+const struct InstallCacheEntry* InstallCache_Get(
+    const wchar_t* game_path,
+    size_t game_path_len
+);
+
+/*
+* Releases a reference returned by InstallCache_Get. An entry that was
+* superseded by a newer one for the same game path is destroyed once it
+* is no longer referenced.
+*/
+void InstallCache_Release(const struct InstallCacheEntry* entry);
+
+#endif /* SGGLDKL_INSTALL_CACHE_H_ */
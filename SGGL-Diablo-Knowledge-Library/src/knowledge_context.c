@@ -0,0 +1,198 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "knowledge_context.h"
+
+#include <process.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "helper/error_handling.h"
+
+static unsigned __stdcall RunPrefetch(void* param) {
+  KnowledgeContext_GetInstall(param);
+
+  return 0;
+}
+
+struct KnowledgeContext* KnowledgeContext_Create(
+    const wchar_t* game_path,
+    size_t game_path_len
+) {
+  struct KnowledgeContext* context;
+
+  context = malloc(sizeof(*context));
+
+  if (context == NULL) {
+    RecordAllocationFailure();
+    return NULL;
+  }
+
+  context->game_path_len = game_path_len;
+  context->game_path = malloc(
+      (game_path_len + 1) * sizeof(context->game_path[0])
+  );
+
+  if (context->game_path == NULL) {
+    RecordAllocationFailure();
+    free(context);
+
+    return NULL;
+  }
+
+  memcpy(
+      context->game_path,
+      game_path,
+      (game_path_len + 1) * sizeof(context->game_path[0])
+  );
+
+  InitializeCriticalSection(&context->install_critical_section);
+  context->is_install_resolved = 0;
+  context->install = NULL;
+
+  context->prefetch_thread_handle = NULL;
+
+  /* The game is set once the install is resolved. */
+  LibraryInjector_Init(
+      &context->library_injector,
+      NULL,
+      NULL,
+      VERSION_UNKNOWN
+  );
+
+  return context;
+}
+
+void KnowledgeContext_Destroy(struct KnowledgeContext* context) {
+  if (context->prefetch_thread_handle != NULL) {
+    WaitForSingleObject(context->prefetch_thread_handle, INFINITE);
+    CloseHandle(context->prefetch_thread_handle);
+  }
+
+  LibraryInjector_Deinit(&context->library_injector);
+
+  if (context->install != NULL) {
+    InstallCache_Release(context->install);
+  }
+
+  DeleteCriticalSection(&context->install_critical_section);
+
+  free(context->game_path);
+  free(context);
+}
+
+const struct InstallCacheEntry* KnowledgeContext_GetInstall(
+    struct KnowledgeContext* context
+) {
+  /*
+  * The flag is only set after the install is stored, with a full
+  * barrier, so a set flag means the install can be read without
+  * locking.
+  */
+  if (context->is_install_resolved) {
+    return context->install;
+  }
+
+  EnterCriticalSection(&context->install_critical_section);
+
+  /* A failure is not memoised, so that the next use retries it. */
+  if (!context->is_install_resolved) {
+    context->install = InstallCache_Get(
+        context->game_path,
+        context->game_path_len
+    );
+
+    if (context->install != NULL) {
+      LibraryInjector_SetGame(
+          &context->library_injector,
+          &context->install->pe_header,
+          &context->install->patch_images,
+          context->install->game_version
+      );
+
+      InterlockedExchange(&context->is_install_resolved, 1);
+    }
+  }
+
+  LeaveCriticalSection(&context->install_critical_section);
+
+  return context->install;
+}
+
+struct LibraryInjector* KnowledgeContext_GetLibraryInjector(
+    struct KnowledgeContext* context
+) {
+  if (KnowledgeContext_GetInstall(context) == NULL) {
+    return NULL;
+  }
+
+  return &context->library_injector;
+}
+
+int KnowledgeContext_StartPrefetch(struct KnowledgeContext* context) {
+  unsigned int thread_id;
+  int is_success;
+
+  is_success = 1;
+
+  /*
+  * The handle is checked and set under the install lock, so that
+  * concurrent calls start at most one thread. The thread takes the same
+  * lock to resolve the install, so it waits until this returns.
+  */
+  EnterCriticalSection(&context->install_critical_section);
+
+  if (context->prefetch_thread_handle != NULL
+      || context->is_install_resolved) {
+    goto leave_install_critical_section;
+  }
+
+  context->prefetch_thread_handle = (HANDLE) _beginthreadex(
+      NULL,
+      0,
+      &RunPrefetch,
+      context,
+      0,
+      &thread_id
+  );
+
+  if (context->prefetch_thread_handle == NULL) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"_beginthreadex",
+        GetLastError()
+    );
+
+    is_success = 0;
+  }
+
+leave_install_critical_section:
+  LeaveCriticalSection(&context->install_critical_section);
+
+  return is_success;
+}
@@ -0,0 +1,101 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_KNOWLEDGE_CONTEXT_H_
+#define SGGLDKL_KNOWLEDGE_CONTEXT_H_
+
+#include <stddef.h>
+#include <wchar.h>
+#include <windows.h>
+
+#include "install_cache.h"
+#include "library_injector.h"
+
+/*
+* The state for one game install. Distinct contexts share no mutable
+* state, so they can be used concurrently from different threads. The
+* information about the install is shared through the install cache.
+*
+* Creating a context only records the game path. The game version and
+* PE header are determined on first use, or in the background if a
+* prefetch was started. They then stay fixed for the life of the
+* context; a game file changed afterwards is detected by a new context.
+*/
+struct KnowledgeContext {
+  wchar_t* game_path;
+  size_t game_path_len;
+
+  /*
+  * Guards the lazy init of the install, which only happens once, and
+  * the start of the prefetch thread.
+  */
+  CRITICAL_SECTION install_critical_section;
+  volatile LONG is_install_resolved;
+  const struct InstallCacheEntry* install;
+
+  HANDLE prefetch_thread_handle;
+
+  struct LibraryInjector library_injector;
+};
+
+/* Returns NULL on failure. */
+struct KnowledgeContext* KnowledgeContext_Create(
+    const wchar_t* game_path,
+    size_t game_path_len
+);
+
+/* Waits for any running prefetch to finish before destroying. */
+void KnowledgeContext_Destroy(struct KnowledgeContext* context);
+
+/*
+* Returns the install information, determining it if this has not yet
+* been done. Returns NULL if the information could not be determined,
+* in which case it is determined again on the next call.
+*/
+const struct InstallCacheEntry* KnowledgeContext_GetInstall(
+    struct KnowledgeContext* context
+);
+
+/*
+* Returns the library injector, determining the install information
+* if needed. Returns NULL if the information could not be determined.
+*/
+struct LibraryInjector* KnowledgeContext_GetLibraryInjector(
+    struct KnowledgeContext* context
+);
+
+/*
+* Starts determining the install information on a worker thread, so
+* that it can overlap with the caller's work. Does nothing if a
+* prefetch was already started. Returns zero if the worker thread could
+* not be started.
+*/
+int KnowledgeContext_StartPrefetch(struct KnowledgeContext* context);
+
+#endif /* SGGLDKL_KNOWLEDGE_CONTEXT_H_ */
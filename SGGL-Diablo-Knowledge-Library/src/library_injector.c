@@ -30,20 +30,37 @@
 #include "library_injector.h"
 
 #include <stdio.h>
+#include <string.h>
 
+#include "apc_injector.h"
 #include "game_version.h"
 #include "helper/encoding.h"
 #include "helper/error_handling.h"
+#include "helper/trace.h"
+#include "import_descriptor_injector.h"
+#include "library_read_ahead.h"
 #include "patch_helper/buffer_patch.h"
 #include "patch_helper/entry_hijack_patch.h"
 #include "patch_helper/game_address.h"
 #include "patch_helper/injector_patches.h"
 #include "patch_helper/pe_header.h"
+#include "patch_helper/remote_process.h"
+#include "patch_helper/shared_control_block.h"
 #include "patch_helper/stack_data.h"
+#include "remote_thread_injector.h"
 
-static void WaitForProcessSuspend(const PROCESS_INFORMATION* process_info) {
-  DWORD suspend_thread_result;
-  DWORD resume_thread_result;
+/* Returns zero if the thread could not be suspended or resumed. */
+static int WaitForProcessSuspend(
+    const struct RemoteProcess* remote_process
+) {
+  const PROCESS_INFORMATION* process_info;
+  DWORD previous_suspend_count;
+  unsigned long num_polls;
+  int is_success;
+
+  process_info = remote_process->process_info;
+
+  Trace_BeginEvent("WaitForProcessSuspend", process_info->dwProcessId, 0);
 
 #if !NDEBUG
   printf(
@@ -53,30 +70,39 @@ static void WaitForProcessSuspend(const PROCESS_INFORMATION* process_info) {
   );
 #endif /* !NDEBUG */
 
+  num_polls = 0;
+  is_success = 1;
+
   do {
     /*
     * Reduce CPU usage and give the thread some time to execute code.
     */
     Sleep(15);
 
-    suspend_thread_result = SuspendThread(process_info->hThread);
-
-    if (suspend_thread_result == -1) {
-      ExitOnWindowsFunctionFailureWithLastError(
-          L"SuspendThread",
-          GetLastError()
-      );
+    num_polls += 1;
+
+    if (!RemoteProcess_SuspendThread(
+            remote_process,
+            &previous_suspend_count
+        )
+        || !RemoteProcess_ResumeThread(
+            remote_process,
+            &previous_suspend_count
+        )) {
+      is_success = 0;
+      break;
     }
+  } while (previous_suspend_count == 1);
 
-    resume_thread_result = ResumeThread(process_info->hThread);
+  Trace_EndEvent(
+      "WaitForProcessSuspend",
+      process_info->dwProcessId,
+      num_polls
+  );
 
-    if (resume_thread_result == -1) {
-      ExitOnWindowsFunctionFailureWithLastError(
-          L"ResumeThread",
-          GetLastError()
-      );
-    }
-  } while (resume_thread_result == 1);
+  if (!is_success) {
+    return 0;
+  }
 
 #if !NDEBUG
   printf(
@@ -85,14 +111,173 @@ static void WaitForProcessSuspend(const PROCESS_INFORMATION* process_info) {
       process_info->dwThreadId
   );
 #endif /* !NDEBUG */
+
+  return 1;
+}
+
+/*
+* Waits for the payload to park itself, which is done by suspending its
+* own thread, or by spinning on the shared control block if that
+* transport is used.
+*/
+static int WaitForPayloadPark(
+    const struct RemoteProcess* remote_process,
+    struct SharedControlBlock* shared_control_block
+) {
+  DWORD process_id;
+  int is_parked;
+
+  if (shared_control_block != NULL) {
+    process_id = remote_process->process_info->dwProcessId;
+
+    Trace_BeginEvent("WaitForSharedPark", process_id, 0);
+
+    is_parked = SharedControlBlock_WaitForPark(
+        shared_control_block,
+        remote_process->process_info->hProcess
+    );
+
+    Trace_EndEvent("WaitForSharedPark", process_id, 0);
+
+    return is_parked;
+  }
+
+  return WaitForProcessSuspend(remote_process);
+}
+
+static int ResumeGameThread(const struct RemoteProcess* remote_process) {
+  DWORD previous_suspend_count;
+
+  return RemoteProcess_ResumeThread(remote_process, &previous_suspend_count);
+}
+
+static int ReleasePayload(
+    const struct RemoteProcess* remote_process,
+    struct SharedControlBlock* shared_control_block
+) {
+  if (shared_control_block != NULL) {
+    SharedControlBlock_Release(shared_control_block);
+    return 1;
+  }
+
+  return ResumeGameThread(remote_process);
+}
+
+static void SetInjectionPhase(
+    struct InjectionStatus* status,
+    enum KnowledgeInjectionPhase phase
+) {
+  if (status == NULL) {
+    return;
+  }
+
+  InterlockedExchange(&status->phase, phase);
+}
+
+static void AddLoadedLibrary(struct InjectionStatus* status) {
+  if (status == NULL) {
+    return;
+  }
+
+  InterlockedIncrement(&status->num_libs_loaded);
+}
+
+static void InitLoadResults(
+    struct KnowledgeLibraryLoadResult* load_results,
+    size_t num_libraries
+) {
+  size_t i_library;
+
+  if (load_results == NULL) {
+    return;
+  }
+
+  for (i_library = 0; i_library < num_libraries; i_library += 1) {
+    load_results[i_library].is_attempted = 0;
+    load_results[i_library].module = NULL;
+    load_results[i_library].last_error = 0;
+    load_results[i_library].load_start_tick = 0;
+    load_results[i_library].load_end_tick = 0;
+  }
+}
+
+/*
+* Reads the result of the library that the payload has just loaded. It
+* is only valid while the payload is parked.
+*/
+static int ReadLoadResult(
+    struct StackData* stack_data,
+    const struct StackDataLocation* location,
+    struct KnowledgeLibraryLoadResult* load_result
+) {
+  if (load_result == NULL) {
+    return 1;
+  }
+
+  if (!StackData_ReadFields(
+      stack_data,
+      lib_load_end_tick,
+      lib_module,
+      location
+  )) {
+    return 0;
+  }
+
+  load_result->is_attempted = 1;
+  load_result->module = stack_data->lib_module;
+  load_result->last_error = stack_data->lib_last_error;
+  load_result->load_start_tick = stack_data->lib_load_start_tick;
+  load_result->load_end_tick = stack_data->lib_load_end_tick;
+
+#if !NDEBUG
+  printf(
+      "Library loaded: %p, error %lu, %lu ms \n",
+      (void*) load_result->module,
+      load_result->last_error,
+      load_result->load_end_tick - load_result->load_start_tick
+  );
+#endif /* !NDEBUG */
+
+  return 1;
+}
+
+/*
+* Begins a traced step of the injection. Only one step is in progress
+* at a time, so that a failure can end it from the cleanup code.
+*/
+static void BeginTraceStep(
+    const char** trace_step_name,
+    const char* name,
+    DWORD process_id,
+    unsigned long arg
+) {
+  *trace_step_name = name;
+  Trace_BeginEvent(name, process_id, arg);
+}
+
+static void EndTraceStep(
+    const char** trace_step_name,
+    DWORD process_id,
+    unsigned long arg
+) {
+  Trace_EndEvent(*trace_step_name, process_id, arg);
+  *trace_step_name = NULL;
+}
+
+static int IsCancelRequested(const volatile LONG* is_cancel_requested) {
+  return is_cancel_requested != NULL && *is_cancel_requested != 0;
 }
 
 static int InjectLibrariesToProcess(
     struct LibraryInjector* library_injector,
+    const struct LibraryInjectorSettings* settings,
     const PROCESS_INFORMATION* process_info,
     size_t num_libraries,
     const wchar_t** libraries_to_inject,
-    const size_t* libraries_to_inject_lens
+    const size_t* libraries_to_inject_lens,
+    struct InjectionStatus* status,
+    struct KnowledgeLibraryLoadResult* load_results,
+    const volatile LONG* is_cancel_requested
 ) {
   enum FuncConstant {
     VIRTUAL_PROTECT_REGION_SIZE = 2048
@@ -100,28 +285,75 @@ static int InjectLibrariesToProcess(
 
   size_t i_library;
 
+  struct RemoteProcess remote_process;
+
   void* entry_point_address;
   DWORD old_entry_point_protect;
 
   void* stack_data_address;
+  struct StackDataLocation stack_data_location;
+
+  struct SharedControlBlockMapping shared_control_block_mapping;
+  int is_shared_control_block_mapped;
+  struct SharedControlBlock* shared_control_block;
 
   struct StackData stack_data_copy;
   struct StackData compare_stack_data_copy;
   int compare_stack_data_result;
+  struct StackDataTransferCounters transfer_counters;
 
-  char* library_to_inject_mb;
-  size_t library_to_inject_mb_size;
+  int is_lib_path_wide;
+  int is_cancelled;
+  int is_success;
+  const void* lib_path_to_write;
+  size_t lib_path_to_write_size;
+  char library_to_inject_mb_buffer[MAX_PATH];
+  struct ConvertedString library_to_inject_mb;
 
   struct InjectorPatches injector_patches;
 
-  DWORD resume_thread_result;
-  BOOL is_read_process_memory_success;
-  BOOL is_write_process_memory_success;
-  SIZE_T num_bytes_read_write_process_memory;
-  BOOL is_virtual_protect_ex_success;
+  size_t num_bytes_read_process_memory;
+  int is_protect_memory_success;
+
+  const char* trace_step_name;
+
+  StackDataTransferCounters_Init(&transfer_counters);
+
+  is_success = 0;
+  is_cancelled = 0;
+  is_shared_control_block_mapped = 0;
+  library_to_inject_mb.fallback_str = NULL;
+  trace_step_name = NULL;
+
+  RemoteProcess_Init(
+      &remote_process,
+      settings->remote_process_ops,
+      settings->remote_process_ops_context,
+      process_info
+  );
+
+  /* Patching address 0 would only crash the game. */
+  if (library_injector->patch_images->entry_hijack_image.position == NULL) {
+    RecordGeneralFailure(
+        L"The entry hijack is not supported for this game version.",
+        L"Unsupported Game Version"
+    );
+
+    SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_FAILED);
+
+    return 0;
+  }
+
+  Trace_BeginEvent(
+      "InjectLibrariesToProcess",
+      process_info->dwProcessId,
+      num_libraries
+  );
+
+  SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_PATCHING);
 
   entry_point_address = PeHeader_GetHardEntryPointAddress(
-      &library_injector->pe_header
+      library_injector->pe_header
   );
 
   /*
@@ -133,35 +365,52 @@ static int InjectLibrariesToProcess(
   printf("Changing entry point memory access permissions. \n");
 #endif /* NDEBUG */
 
-  is_virtual_protect_ex_success = VirtualProtectEx(
-      process_info->hProcess,
+  BeginTraceStep(
+      &trace_step_name,
+      "ChangeProtection",
+      process_info->dwProcessId,
+      0
+  );
+
+  if (!RemoteProcess_ProtectMemory(
+      &remote_process,
       entry_point_address,
       VIRTUAL_PROTECT_REGION_SIZE,
       PAGE_EXECUTE_READWRITE,
       &old_entry_point_protect
-  );
-
-  if (!is_virtual_protect_ex_success) {
-    ExitOnWindowsFunctionFailureWithLastError(
-        L"VirtualProtectEx",
-        GetLastError()
-    );
+  )) {
+    goto end_trace;
   }
 
+  EndTraceStep(&trace_step_name, process_info->dwProcessId, 0);
+
 #if !NDEBUG
   printf("Successfully changed entry point memory access permissions. \n");
 #endif /* NDEBUG */
 
-  InjectorPatches_Init(
-      &injector_patches,
-      &library_injector->pe_header,
-      process_info,
-      library_injector->game_version
+  BeginTraceStep(
+      &trace_step_name,
+      "ApplyPatches",
+      process_info->dwProcessId,
+      0
   );
 
+  /* Only the original data is read, as the patch images are shared. */
+  if (InjectorPatches_Init(
+      &injector_patches,
+      library_injector->patch_images,
+      &remote_process
+  ) == NULL) {
+    goto restore_entry_point_protect;
+  }
+
   /* Patch the entry function and add the payload to the game. */
-  BufferPatch_Apply(&injector_patches.entry_hijack_patch);
-  BufferPatch_Apply(&injector_patches.payload_patch);
+  if (!BufferPatch_Apply(&injector_patches.entry_hijack_patch)
+      || !BufferPatch_Apply(&injector_patches.payload_patch)) {
+    goto deinit_injector_patches;
+  }
+
+  EndTraceStep(&trace_step_name, process_info->dwProcessId, 0);
 
 #if !NDEBUG
   printf("Attach a debugger to the game process and then press enter. \n");
@@ -169,67 +418,106 @@ static int InjectLibrariesToProcess(
 #endif /* !NDEBUG */
 
   /* Resume game thread to get the game to the payload checkpoint. */
-  resume_thread_result = ResumeThread(process_info->hThread);
-
-  if (resume_thread_result == -1) {
-    ExitOnWindowsFunctionFailureWithLastError(
-        L"ResumeThread",
-        GetLastError()
-    );
+  if (!ResumeGameThread(&remote_process)) {
+    goto deinit_injector_patches;
   }
 
   /*
   * Get the stack address. Runs in an spinlock because SuspendThread
   * is not yet available in the payload function.
   */
+  BeginTraceStep(
+      &trace_step_name,
+      "WaitForStackDataAddress",
+      process_info->dwProcessId,
+      0
+  );
+
   stack_data_address = NULL;
   do {
-    is_read_process_memory_success = ReadProcessMemory(
-        process_info->hProcess,
+    if (!RemoteProcess_ReadMemory(
+        &remote_process,
         EntryHijackPatch_GetFreeSpaceAddress(
-            &injector_patches.entry_hijack_patch
+            &library_injector->patch_images->entry_hijack_image
         ),
         &stack_data_address,
         sizeof(stack_data_address),
-        &num_bytes_read_write_process_memory
-    );
-
-    if (!is_read_process_memory_success) {
-      printf("Read: %zu \n", num_bytes_read_write_process_memory);
+        &num_bytes_read_process_memory
+    )) {
+      printf("Read: %zu \n", num_bytes_read_process_memory);
 
-      ExitOnWindowsFunctionFailureWithLastError(
-          L"ReadProcessMemory",
-          GetLastError()
-      );
+      goto deinit_injector_patches;
     }
   } while (stack_data_address == NULL);
 
+  EndTraceStep(&trace_step_name, process_info->dwProcessId, 0);
+
 #if !NDEBUG
   printf("Stack data address: %p \n", stack_data_address);
 #endif /* NDEBUG */
 
-  /* Read the initial stack data. */
-  StackData_ReadFromProcess(
-      &stack_data_copy,
-      process_info,
-      stack_data_address
+  /*
+  * Init the stack data. Only the fields owned by SGGL are written, so
+  * that the values set by the payload are left untouched.
+  */
+  BeginTraceStep(
+      &trace_step_name,
+      "InitStackData",
+      process_info->dwProcessId,
+      0
   );
 
-  /* Init the stack data. */
+  stack_data_location.remote_process = &remote_process;
+  stack_data_location.remote_address = stack_data_address;
+  stack_data_location.shared_stack_data = NULL;
+  stack_data_location.transfer_counters = &transfer_counters;
+
+  /*
+  * Optionally give the payload a file mapping, so that the handshake
+  * can be done through shared memory.
+  */
+  is_shared_control_block_mapped =
+      settings->is_shared_memory_transport_enabled
+      && SharedControlBlockMapping_Init(
+          &shared_control_block_mapping,
+          process_info
+      );
+
+  stack_data_copy.shared_mapping_handle = (is_shared_control_block_mapped)
+      ? shared_control_block_mapping.remote_mapping_handle
+      : NULL;
+
   stack_data_copy.num_libs = num_libraries;
   StackData_InitFuncs(&stack_data_copy);
 
-  StackData_WriteToProcess(
-      &stack_data_copy,
-      process_info,
-      stack_data_address
-  );
+  is_lib_path_wide = (stack_data_copy.LoadLibraryW_ptr != NULL);
+
+  if (!StackData_WriteField(
+          &stack_data_copy,
+          num_libs,
+          &stack_data_location
+      )
+      || !StackData_WriteField(
+          &stack_data_copy,
+          shared_mapping_handle,
+          &stack_data_location
+      )
+      || !StackData_WriteFields(
+          &stack_data_copy,
+          GetLastError_ptr,
+          VirtualFree_ptr,
+          &stack_data_location
+      )) {
+    goto deinit_shared_control_block_mapping;
+  }
 
   /*
   * Apply the cleanup patch, now that the game process is no longer in
   * the vanilla code space.
   */
-  BufferPatch_Apply(&injector_patches.cleanup_patch);
+  if (!BufferPatch_Apply(&injector_patches.cleanup_patch)) {
+    goto deinit_shared_control_block_mapping;
+  }
 
   /*
   * End spinlock, which will resume execution. This needs to happen
@@ -238,76 +526,170 @@ static int InjectLibrariesToProcess(
   */
   stack_data_copy.is_ready_to_execute = 1;
 
-  StackData_WriteToProcess(
+  if (!StackData_WriteField(
       &stack_data_copy,
-      process_info,
-      stack_data_address
-  );
+      is_ready_to_execute,
+      &stack_data_location
+  )) {
+    goto deinit_shared_control_block_mapping;
+  }
+
+  EndTraceStep(&trace_step_name, process_info->dwProcessId, 0);
+
+  /*
+  * If a file mapping was provided, the payload suspends once to
+  * announce whether it moved the stack data into shared memory.
+  */
+  shared_control_block = NULL;
+
+  if (is_shared_control_block_mapped) {
+    if (!WaitForProcessSuspend(&remote_process)) {
+      goto deinit_shared_control_block_mapping;
+    }
+
+    if (!StackData_ReadField(
+        &stack_data_copy,
+        shared_control_block,
+        &stack_data_location
+    )) {
+      goto deinit_shared_control_block_mapping;
+    }
+
+    if (stack_data_copy.shared_control_block != NULL) {
+      shared_control_block =
+          shared_control_block_mapping.shared_control_block;
+
+      stack_data_location.shared_stack_data =
+          &shared_control_block->stack_data;
+    }
 
-  /* Inject every library. */
+#if !NDEBUG
+    printf(
+        "Shared control block in use: %d \n",
+        shared_control_block != NULL
+    );
+#endif /* !NDEBUG */
+
+    if (!ResumeGameThread(&remote_process)) {
+      goto deinit_shared_control_block_mapping;
+    }
+  }
+
+  SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_LOADING_LIBRARIES);
+
+  /*
+  * Inject every library. Cancellation is only checked between
+  * libraries, while the payload is not loading one.
+  */
   for (i_library = 0; i_library < num_libraries; i_library += 1) {
+    if (IsCancelRequested(is_cancel_requested)) {
+      is_cancelled = 1;
+      break;
+    }
 
 #if !NDEBUG
     printf("Injecting: %ls \n", libraries_to_inject[i_library]);
 #endif /* NDEBUG */
 
-    /* Since LoadLibraryA is being used, convert the string to multibyte. */
-    library_to_inject_mb = ConvertWideToMultibyte(
-        NULL,
-        libraries_to_inject[i_library]
-    );
+    /*
+    * LoadLibraryW takes the path as is. Otherwise, LoadLibraryA is
+    * being used, so convert the string to multibyte.
+    */
+    if (is_lib_path_wide) {
+      library_to_inject_mb.fallback_str = NULL;
+
+      lib_path_to_write = libraries_to_inject[i_library];
+      lib_path_to_write_size = (libraries_to_inject_lens[i_library] + 1)
+          * sizeof(libraries_to_inject[i_library][0]);
+    } else {
+      ConvertWideToMultibyteInBuffer(
+          &library_to_inject_mb,
+          library_to_inject_mb_buffer,
+          sizeof(library_to_inject_mb_buffer),
+          libraries_to_inject[i_library]
+      );
+
+      if (library_to_inject_mb.str == NULL) {
+        goto deinit_shared_control_block_mapping;
+      }
 
 #if !NDEBUG
-    printf("Converted string: %s \n", library_to_inject_mb);
+      printf("Converted string: %s \n", library_to_inject_mb.str);
 #endif /* NDEBUG */
 
-    /* Check that the process has suspended itself. */
-    WaitForProcessSuspend(process_info);
+      lib_path_to_write = library_to_inject_mb.str;
+      lib_path_to_write_size = (library_to_inject_mb.len + 1)
+          * sizeof(library_to_inject_mb.str[0]);
+    }
 
-    /* If the buffer size is insufficient, then force the data to resize. */
-    library_to_inject_mb_size = (libraries_to_inject_lens[i_library] + 1)
-        * sizeof(library_to_inject_mb[0]);
+    /* Check that the payload has parked itself. */
+    if (!WaitForPayloadPark(&remote_process, shared_control_block)) {
+      goto deinit_shared_control_block_mapping;
+    }
 
-    StackData_ReadFromProcess(
-        &stack_data_copy,
-        process_info,
-        stack_data_address
+    if (i_library > 0) {
+      EndTraceStep(&trace_step_name, process_info->dwProcessId, i_library - 1);
+      AddLoadedLibrary(status);
+
+      if (!ReadLoadResult(
+          &stack_data_copy,
+          &stack_data_location,
+          (load_results != NULL) ? &load_results[i_library - 1] : NULL
+      )) {
+        goto deinit_shared_control_block_mapping;
+      }
+    }
+
+    BeginTraceStep(
+        &trace_step_name,
+        "WriteLibPath",
+        process_info->dwProcessId,
+        i_library
     );
 
-    while (stack_data_copy.lib_path_size < library_to_inject_mb_size) {
+    /* If the buffer size is insufficient, then force the data to resize. */
+    if (!StackData_ReadField(
+        &stack_data_copy,
+        lib_path_size,
+        &stack_data_location
+    )) {
+      goto deinit_shared_control_block_mapping;
+    }
+
+    while (stack_data_copy.lib_path_size < lib_path_to_write_size) {
 
 #if !NDEBUG
       printf(
           "Requesting lib path resize; requires size of %u, got %u \n",
-          library_to_inject_mb_size,
+          lib_path_to_write_size,
           stack_data_copy.lib_path_size
       );
 #endif /* NDEBUG */
 
       stack_data_copy.is_lib_resize_needed = 1;
 
-      StackData_WriteToProcess(
-          &stack_data_copy,
-          process_info,
-          stack_data_address
-      );
-
-      resume_thread_result = ResumeThread(process_info->hThread);
-
-      if (resume_thread_result == -1) {
-        ExitOnWindowsFunctionFailureWithLastError(
-            L"ResumeThread",
-            GetLastError()
-        );
+      if (!StackData_WriteField(
+              &stack_data_copy,
+              is_lib_resize_needed,
+              &stack_data_location
+          )
+          || !ReleasePayload(&remote_process, shared_control_block)
+          || !WaitForPayloadPark(&remote_process, shared_control_block)
+          || !StackData_ReadField(
+              &stack_data_copy,
+              lib_path_size,
+              &stack_data_location
+          )) {
+        goto deinit_shared_control_block_mapping;
       }
+    }
 
-      WaitForProcessSuspend(process_info);
-
-      StackData_ReadFromProcess(
-          &stack_data_copy,
-          process_info,
-          stack_data_address
-      );
+    if (!StackData_ReadField(
+        &stack_data_copy,
+        lib_path,
+        &stack_data_location
+    )) {
+      goto deinit_shared_control_block_mapping;
     }
 
 #if !NDEBUG
@@ -324,77 +706,114 @@ static int InjectLibrariesToProcess(
     printf("Writing to VirtualAlloc memory. \n");
 #endif /* !NDEBUG */
 
-    is_write_process_memory_success = WriteProcessMemory(
-        process_info->hProcess,
+    if (!RemoteProcess_WriteMemory(
+        &remote_process,
         stack_data_copy.lib_path,
-        library_to_inject_mb,
-        library_to_inject_mb_size,
+        lib_path_to_write,
+        lib_path_to_write_size,
         NULL
-    );
-
-    if (!is_write_process_memory_success) {
-      ExitOnWindowsFunctionFailureWithLastError(
-          L"WriteProcessMemory",
-          GetLastError()
-      );
+    )) {
+      goto deinit_shared_control_block_mapping;
     }
 
 #if !NDEBUG
     printf("Successfully written to VirtualAlloc memory. \n");
 #endif /* !NDEBUG */
 
-free_library_to_inject_mb:
-    free(library_to_inject_mb);
+    ConvertedString_Deinit(&library_to_inject_mb);
 
-    /* Library path has been copied, so resume the thread. */
-    resume_thread_result = ResumeThread(process_info->hThread);
+    EndTraceStep(&trace_step_name, process_info->dwProcessId, i_library);
 
-    if (resume_thread_result == -1) {
-      ExitOnWindowsFunctionFailureWithLastError(
-          L"ResumeThread",
-          GetLastError()
-      );
+    /* Library path has been copied, so release the payload. */
+    BeginTraceStep(
+        &trace_step_name,
+        "LoadLibrary",
+        process_info->dwProcessId,
+        i_library
+    );
+
+    if (!ReleasePayload(&remote_process, shared_control_block)) {
+      goto deinit_shared_control_block_mapping;
     }
   }
 
   /*
-  * Wait for process to make one suspend stop, then wait for process
-  * to jump to the cleanup func space.
+  * Wait for payload to make one park stop, then wait for process
+  * to jump to the cleanup func space, which always suspends.
   */
-  WaitForProcessSuspend(process_info);
+  if (!WaitForPayloadPark(&remote_process, shared_control_block)) {
+    goto deinit_shared_control_block_mapping;
+  }
 
-  resume_thread_result = ResumeThread(process_info->hThread);
+  if (i_library > 0) {
+    EndTraceStep(&trace_step_name, process_info->dwProcessId, i_library - 1);
+    AddLoadedLibrary(status);
 
-  if (resume_thread_result == -1) {
-    ExitOnWindowsFunctionFailureWithLastError(
-        L"ResumeThread",
-        GetLastError()
-    );
+    if (!ReadLoadResult(
+        &stack_data_copy,
+        &stack_data_location,
+        (load_results != NULL) ? &load_results[i_library - 1] : NULL
+    )) {
+      goto deinit_shared_control_block_mapping;
+    }
   }
 
-  WaitForProcessSuspend(process_info);
+  /* If cancelled, then make the payload skip the remaining libraries. */
+  if (is_cancelled) {
+    stack_data_copy.num_libs = 0;
 
-  /* Read the current state of the stack for a later comparison. */
-  StackData_ReadFromProcess(
-      &stack_data_copy,
-      process_info,
-      stack_data_address
+    if (!StackData_WriteField(
+        &stack_data_copy,
+        num_libs,
+        &stack_data_location
+    )) {
+      goto deinit_shared_control_block_mapping;
+    }
+  }
+
+  SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_CLEANING_UP);
+
+  if (!ReleasePayload(&remote_process, shared_control_block)
+      || !WaitForProcessSuspend(&remote_process)) {
+    goto deinit_shared_control_block_mapping;
+  }
+
+  BeginTraceStep(
+      &trace_step_name,
+      "RestorePatches",
+      process_info->dwProcessId,
+      0
   );
 
+  /*
+  * Read the current state of the stack for a later comparison. The
+  * whole struct is needed here, as any of its bytes could be the first
+  * to be overwritten once the game code resumes.
+  */
+  if (!StackData_ReadFromProcess(&stack_data_copy, &stack_data_location)) {
+    goto deinit_shared_control_block_mapping;
+  }
+
   /* Restore the original code of the entry hijack and the payload. */
-  BufferPatch_Remove(&injector_patches.payload_patch);
-  BufferPatch_Remove(&injector_patches.entry_hijack_patch);
+  if (!BufferPatch_Remove(&injector_patches.payload_patch)
+      || !BufferPatch_Remove(&injector_patches.entry_hijack_patch)) {
+    goto deinit_shared_control_block_mapping;
+  }
 
   /* Resume game thread, which will allow the game to continue like normal. */
-  resume_thread_result = ResumeThread(process_info->hThread);
-
-  if (resume_thread_result == -1) {
-    ExitOnWindowsFunctionFailureWithLastError(
-        L"ResumeThread",
-        GetLastError()
-    );
+  if (!ResumeGameThread(&remote_process)) {
+    goto deinit_shared_control_block_mapping;
   }
 
+  EndTraceStep(&trace_step_name, process_info->dwProcessId, 0);
+
+  BeginTraceStep(
+      &trace_step_name,
+      "WaitForCleanupExit",
+      process_info->dwProcessId,
+      0
+  );
+
   /*
   * Infinite loop read the stack values and determine if the values
   * are no longer the same. This guarantees that the program is no
@@ -402,11 +821,12 @@ free_library_to_inject_mb:
   * restored.
   */
   do {
-    StackData_ReadFromProcess(
+    if (!StackData_ReadFromProcess(
         &compare_stack_data_copy,
-        process_info,
-        stack_data_address
-    );
+        &stack_data_location
+    )) {
+      goto deinit_shared_control_block_mapping;
+    }
 
     compare_stack_data_result = memcmp(
         &compare_stack_data_copy,
@@ -415,64 +835,415 @@ free_library_to_inject_mb:
     );
   } while (compare_stack_data_result == 0);
 
-  BufferPatch_Remove(&injector_patches.cleanup_patch);
+  EndTraceStep(&trace_step_name, process_info->dwProcessId, 0);
+
+  if (!BufferPatch_Remove(&injector_patches.cleanup_patch)) {
+    goto deinit_shared_control_block_mapping;
+  }
+
+  is_success = 1;
 
+#if !NDEBUG
+  printf(
+      "Stack data transfers: %u reads (%u bytes), %u writes (%u bytes) \n",
+      transfer_counters.num_reads,
+      transfer_counters.num_bytes_read,
+      transfer_counters.num_writes,
+      transfer_counters.num_bytes_written
+  );
+#endif /* !NDEBUG */
+
+  /*
+  * On failure, the cleanup below is still done. The game instance is
+  * then left as is, so that the caller can decide how to handle it.
+  */
+deinit_shared_control_block_mapping:
+  ConvertedString_Deinit(&library_to_inject_mb);
+
+  if (is_shared_control_block_mapped) {
+    SharedControlBlockMapping_Deinit(&shared_control_block_mapping);
+  }
+
+deinit_injector_patches:
   /* Cleanup the patches. */
   InjectorPatches_Deinit(&injector_patches);
 
+restore_entry_point_protect:
   /* Restore the access protection of the entry point. */
 
 #if !NDEBUG
   printf("Restoring entry point memory access permissions. \n");
 #endif /* !NDEBUG */
 
-  is_virtual_protect_ex_success = VirtualProtectEx(
-      process_info->hProcess,
+  is_protect_memory_success = RemoteProcess_ProtectMemory(
+      &remote_process,
       entry_point_address,
       VIRTUAL_PROTECT_REGION_SIZE,
       old_entry_point_protect,
       &old_entry_point_protect
   );
 
-  if (!is_virtual_protect_ex_success) {
-    ExitOnWindowsFunctionFailureWithLastError(
-        L"VirtualProtectEx",
-        GetLastError()
-    );
+  if (!is_protect_memory_success) {
+    is_success = 0;
   }
 
 #if !NDEBUG
-  printf("Successfully restored entry point memory access permissions. \n");
+  if (is_protect_memory_success) {
+    printf("Successfully restored entry point memory access permissions. \n");
+  }
 #endif /* !NDEBUG */
 
-  return 1;
+end_trace:
+  /* End the step that was interrupted by a failure, if any. */
+  if (trace_step_name != NULL) {
+    EndTraceStep(&trace_step_name, process_info->dwProcessId, 0);
+  }
+
+  Trace_EndEvent(
+      "InjectLibrariesToProcess",
+      process_info->dwProcessId,
+      num_libraries
+  );
+
+  if (!is_success) {
+    SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_FAILED);
+    return 0;
+  }
+
+  SetInjectionPhase(
+      status,
+      (is_cancelled)
+          ? KNOWLEDGE_INJECTION_PHASE_CANCELLED
+          : KNOWLEDGE_INJECTION_PHASE_COMPLETE
+  );
+
+  return !is_cancelled;
 }
 
-void LibraryInjector_Init(
+static int InjectLibrariesToProcessWithApc(
     struct LibraryInjector* library_injector,
-    const wchar_t* game_path,
-    size_t game_path_len,
-    enum GameVersion game_version
+    const struct LibraryInjectorSettings* settings,
+    const PROCESS_INFORMATION* process_info,
+    size_t num_libraries,
+    const wchar_t** libraries_to_inject,
+    const size_t* libraries_to_inject_lens,
+    struct InjectionStatus* status,
+    const volatile LONG* is_cancel_requested
+) {
+  struct RemoteProcess remote_process;
+  DWORD previous_suspend_count;
+  int is_success;
+
+  RemoteProcess_Init(
+      &remote_process,
+      settings->remote_process_ops,
+      settings->remote_process_ops_context,
+      process_info
+  );
+
+  /* Nothing has been queued yet, so the game can simply be resumed. */
+  if (IsCancelRequested(is_cancel_requested)) {
+    if (!RemoteProcess_ResumeThread(
+        &remote_process,
+        &previous_suspend_count
+    )) {
+      SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_FAILED);
+      return 0;
+    }
+
+    SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_CANCELLED);
+    return 0;
+  }
+
+  Trace_BeginEvent(
+      "QueueLibraryApcs",
+      process_info->dwProcessId,
+      num_libraries
+  );
+
+  SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_LOADING_LIBRARIES);
+
+  is_success = ApcInjector_InjectLibraries(
+      &remote_process,
+      libraries_to_inject,
+      libraries_to_inject_lens,
+      num_libraries
+  );
+
+  Trace_EndEvent("QueueLibraryApcs", process_info->dwProcessId, num_libraries);
+
+  SetInjectionPhase(
+      status,
+      (is_success)
+          ? KNOWLEDGE_INJECTION_PHASE_COMPLETE
+          : KNOWLEDGE_INJECTION_PHASE_FAILED
+  );
+
+  return is_success;
+}
+
+static int InjectLibrariesToProcessWithRemoteThread(
+    struct LibraryInjector* library_injector,
+    const struct LibraryInjectorSettings* settings,
+    const PROCESS_INFORMATION* process_info,
+    size_t num_libraries,
+    const wchar_t** libraries_to_inject,
+    const size_t* libraries_to_inject_lens,
+    struct InjectionStatus* status,
+    struct KnowledgeLibraryLoadResult* load_results,
+    const volatile LONG* is_cancel_requested
 ) {
-  library_injector->game_path_len = 0;
+  struct RemoteProcess remote_process;
+  DWORD previous_suspend_count;
+  int is_success;
+
+  RemoteProcess_Init(
+      &remote_process,
+      settings->remote_process_ops,
+      settings->remote_process_ops_context,
+      process_info
+  );
 
-  library_injector->game_path = malloc(
-      game_path_len * sizeof(library_injector->game_path[0])
+  /* Nothing has been loaded yet, so the game can simply be resumed. */
+  if (IsCancelRequested(is_cancel_requested)) {
+    if (!RemoteProcess_ResumeThread(
+        &remote_process,
+        &previous_suspend_count
+    )) {
+      SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_FAILED);
+      return 0;
+    }
+
+    SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_CANCELLED);
+    return 0;
+  }
+
+  Trace_BeginEvent("RunLoaderThread", process_info->dwProcessId, num_libraries);
+
+  SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_LOADING_LIBRARIES);
+
+  is_success = RemoteThreadInjector_InjectLibraries(
+      &remote_process,
+      libraries_to_inject,
+      libraries_to_inject_lens,
+      num_libraries,
+      load_results
   );
 
-  if (library_injector->game_path == NULL) {
-    ExitOnAllocationFailure();
+  Trace_EndEvent("RunLoaderThread", process_info->dwProcessId, num_libraries);
+
+  if (is_success && status != NULL) {
+    InterlockedExchange(&status->num_libs_loaded, (LONG) num_libraries);
   }
 
-  library_injector->game_version = game_version;
+  SetInjectionPhase(
+      status,
+      (is_success)
+          ? KNOWLEDGE_INJECTION_PHASE_COMPLETE
+          : KNOWLEDGE_INJECTION_PHASE_FAILED
+  );
 
-  PeHeader_Init(&library_injector->pe_header, game_path, game_path_len);
+  return is_success;
+}
+
+static int InjectLibrariesToProcessWithImportDescriptors(
+    struct LibraryInjector* library_injector,
+    const struct LibraryInjectorSettings* settings,
+    const PROCESS_INFORMATION* process_info,
+    size_t num_libraries,
+    const wchar_t** libraries_to_inject,
+    struct InjectionStatus* status,
+    const volatile LONG* is_cancel_requested
+) {
+  struct RemoteProcess remote_process;
+  DWORD previous_suspend_count;
+  int is_success;
+
+  RemoteProcess_Init(
+      &remote_process,
+      settings->remote_process_ops,
+      settings->remote_process_ops_context,
+      process_info
+  );
+
+  /* Nothing has been changed yet, so the game can simply be resumed. */
+  if (IsCancelRequested(is_cancel_requested)) {
+    if (!RemoteProcess_ResumeThread(
+        &remote_process,
+        &previous_suspend_count
+    )) {
+      SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_FAILED);
+      return 0;
+    }
+
+    SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_CANCELLED);
+    return 0;
+  }
+
+  Trace_BeginEvent(
+      "ExtendImportDirectory",
+      process_info->dwProcessId,
+      num_libraries
+  );
+
+  SetInjectionPhase(status, KNOWLEDGE_INJECTION_PHASE_LOADING_LIBRARIES);
+
+  is_success = ImportDescriptorInjector_InjectLibraries(
+      &remote_process,
+      library_injector->pe_header,
+      libraries_to_inject,
+      num_libraries
+  );
+
+  Trace_EndEvent(
+      "ExtendImportDirectory",
+      process_info->dwProcessId,
+      num_libraries
+  );
+
+  if (is_success && status != NULL) {
+    InterlockedExchange(&status->num_libs_loaded, (LONG) num_libraries);
+  }
+
+  SetInjectionPhase(
+      status,
+      (is_success)
+          ? KNOWLEDGE_INJECTION_PHASE_COMPLETE
+          : KNOWLEDGE_INJECTION_PHASE_FAILED
+  );
+
+  return is_success;
+}
+
+/*
+* The entry hijack is used wherever the game version has one, so that
+* the shared memory transport and the load results stay available. The
+* game versions that have no entry hijack use the remote thread. The
+* early bird APC is only used if selected.
+*/
+static enum KnowledgeInjectionStrategy SelectInjectionStrategy(
+    const struct LibraryInjector* library_injector,
+    const struct LibraryInjectorSettings* settings
+) {
+  if (settings->injection_strategy != KNOWLEDGE_INJECTION_STRATEGY_AUTO) {
+    return settings->injection_strategy;
+  }
+
+  if (library_injector->patch_images->entry_hijack_image.position == NULL
+      && RemoteThreadInjector_IsSupported()) {
+    return KNOWLEDGE_INJECTION_STRATEGY_REMOTE_THREAD;
+  }
+
+  return KNOWLEDGE_INJECTION_STRATEGY_ENTRY_HIJACK;
+}
+
+void LibraryInjector_Init(
+    struct LibraryInjector* library_injector,
+    const struct PeHeader* pe_header,
+    const struct InjectorPatchImages* patch_images,
+    enum GameVersion game_version
+) {
+  library_injector->game_version = game_version;
+  library_injector->pe_header = pe_header;
+  library_injector->patch_images = patch_images;
+  library_injector->settings.is_shared_memory_transport_enabled = 0;
+  library_injector->settings.is_read_ahead_enabled = 1;
+  library_injector->settings.injection_strategy =
+      KNOWLEDGE_INJECTION_STRATEGY_AUTO;
+  library_injector->settings.remote_process_ops =
+      RemoteProcessOps_GetWindows();
+  library_injector->settings.remote_process_ops_context = NULL;
+
+  LibraryPreflightCache_Init(&library_injector->preflight_cache);
 }
 
 void LibraryInjector_Deinit(struct LibraryInjector* library_injector) {
-  library_injector->game_path_len = 0;
-  free(library_injector->game_path);
-  PeHeader_Deinit(&library_injector->pe_header);
+  library_injector->pe_header = NULL;
+  library_injector->patch_images = NULL;
+
+  LibraryPreflightCache_Deinit(&library_injector->preflight_cache);
+}
+
+void LibraryInjector_SetGame(
+    struct LibraryInjector* library_injector,
+    const struct PeHeader* pe_header,
+    const struct InjectorPatchImages* patch_images,
+    enum GameVersion game_version
+) {
+  library_injector->game_version = game_version;
+  library_injector->pe_header = pe_header;
+  library_injector->patch_images = patch_images;
+}
+
+void LibraryInjector_SetSharedMemoryTransportEnabled(
+    struct LibraryInjector* library_injector,
+    int is_enabled
+) {
+  library_injector->settings.is_shared_memory_transport_enabled = is_enabled;
+}
+
+void LibraryInjector_SetReadAheadEnabled(
+    struct LibraryInjector* library_injector,
+    int is_enabled
+) {
+  library_injector->settings.is_read_ahead_enabled = is_enabled;
+}
+
+void LibraryInjector_SetInjectionStrategy(
+    struct LibraryInjector* library_injector,
+    enum KnowledgeInjectionStrategy injection_strategy
+) {
+  library_injector->settings.injection_strategy = injection_strategy;
+}
+
+void LibraryInjector_SetRemoteProcessOps(
+    struct LibraryInjector* library_injector,
+    const struct RemoteProcessOps* ops,
+    void* ops_context
+) {
+  library_injector->settings.remote_process_ops = ops;
+  library_injector->settings.remote_process_ops_context = ops_context;
+}
+
+static int PreflightLibraries(
+    struct LibraryInjector* library_injector,
+    const struct LibraryInjectorSettings* settings,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    struct KnowledgeLibraryPreflight* preflights
+) {
+  /*
+  * The import descriptor strategy imports ordinal 1 from every library,
+  * and the game is terminated by the loader if one does not export it.
+  */
+  return LibraryPreflight_CheckLibraries(
+      &library_injector->preflight_cache,
+      library_injector->pe_header->file_path,
+      libraries_to_inject,
+      num_libraries,
+      SelectInjectionStrategy(library_injector, settings)
+          == KNOWLEDGE_INJECTION_STRATEGY_IMPORT_DESCRIPTOR,
+      preflights
+  );
+}
+
+int LibraryInjector_PreflightLibraries(
+    struct LibraryInjector* library_injector,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    struct KnowledgeLibraryPreflight* preflights
+) {
+  struct LibraryInjectorSettings settings;
+
+  settings = library_injector->settings;
+
+  return PreflightLibraries(
+      library_injector,
+      &settings,
+      libraries_to_inject,
+      num_libraries,
+      preflights
+  );
 }
 
 int LibraryInjector_InjectLibrariesToProcesses(
@@ -481,22 +1252,105 @@ int LibraryInjector_InjectLibrariesToProcesses(
     size_t num_libraries,
     const PROCESS_INFORMATION* processes_infos,
     size_t num_instances
+) {
+  return LibraryInjector_InjectLibrariesToProcessesWithStatus(
+      library_injector,
+      &library_injector->settings,
+      libraries_to_inject,
+      num_libraries,
+      processes_infos,
+      num_instances,
+      NULL,
+      NULL,
+      NULL
+  );
+}
+
+int LibraryInjector_InjectLibrariesToProcessesWithStatus(
+    struct LibraryInjector* library_injector,
+    const struct LibraryInjectorSettings* injection_settings,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    struct InjectionStatus* statuses,
+    struct KnowledgeLibraryLoadResult* load_results,
+    const volatile LONG* is_cancel_requested
 ) {
   size_t i_library;
   size_t i_process;
 
   size_t* libraries_to_inject_lens;
+  struct KnowledgeLibraryPreflight* preflights;
+  struct LibraryReadAhead read_ahead;
+  struct LibraryInjectorSettings settings;
+  enum KnowledgeInjectionStrategy injection_strategy;
 
   unsigned char is_all_success;
   unsigned char is_current_success;
 
+  /* The settings are copied, so that they stay the same throughout. */
+  settings = *injection_settings;
+
+  InitLoadResults(load_results, num_libraries * num_instances);
+
+  /*
+  * Start reading the libraries into the file cache, so that the reads
+  * overlap with the preflight and the patching of the game processes.
+  */
+  read_ahead.thread_handle = NULL;
+  read_ahead.is_error_recorded = 0;
+
+  if (settings.is_read_ahead_enabled) {
+    LibraryReadAhead_Start(&read_ahead, libraries_to_inject, num_libraries);
+  }
+
+  /*
+  * Check the libraries first, so that a library that cannot be loaded
+  * fails the injection before any game process is touched.
+  */
+  is_all_success = 0;
+
+  preflights = malloc(num_libraries * sizeof(preflights[0]));
+
+  if (preflights == NULL && num_libraries > 0) {
+    RecordAllocationFailure();
+    goto stop_read_ahead;
+  }
+
+  is_all_success = PreflightLibraries(
+      library_injector,
+      &settings,
+      libraries_to_inject,
+      num_libraries,
+      preflights
+  );
+
+  free(preflights);
+
+  if (!is_all_success) {
+    if (statuses != NULL) {
+      for (i_process = 0; i_process < num_instances; i_process += 1) {
+        SetInjectionPhase(
+            &statuses[i_process],
+            KNOWLEDGE_INJECTION_PHASE_FAILED
+        );
+      }
+    }
+
+    goto stop_read_ahead;
+  }
+
   /* Determine the lengths of the libraries to inject. */
+  is_all_success = 0;
+
   libraries_to_inject_lens = malloc(
       num_libraries * sizeof(libraries_to_inject_lens[0])
   );
 
   if (libraries_to_inject_lens == NULL) {
-    return 0;
+    RecordAllocationFailure();
+    goto stop_read_ahead;
   }
 
   for (i_library = 0; i_library < num_libraries; i_library += 1) {
@@ -508,14 +1362,75 @@ int LibraryInjector_InjectLibrariesToProcesses(
   /* Inject libraries into each process. */
   is_all_success = 1;
 
+  injection_strategy = SelectInjectionStrategy(library_injector, &settings);
+
   for (i_process = 0; i_process < num_instances; i_process += 1) {
-    is_current_success = InjectLibrariesToProcess(
-        library_injector,
-        &processes_infos[i_process],
-        num_libraries,
-        libraries_to_inject,
-        libraries_to_inject_lens
-    );
+    switch (injection_strategy) {
+      case KNOWLEDGE_INJECTION_STRATEGY_EARLY_BIRD_APC: {
+        is_current_success = InjectLibrariesToProcessWithApc(
+            library_injector,
+            &settings,
+            &processes_infos[i_process],
+            num_libraries,
+            libraries_to_inject,
+            libraries_to_inject_lens,
+            (statuses != NULL) ? &statuses[i_process] : NULL,
+            is_cancel_requested
+        );
+
+        break;
+      }
+
+      case KNOWLEDGE_INJECTION_STRATEGY_REMOTE_THREAD: {
+        is_current_success = InjectLibrariesToProcessWithRemoteThread(
+            library_injector,
+            &settings,
+            &processes_infos[i_process],
+            num_libraries,
+            libraries_to_inject,
+            libraries_to_inject_lens,
+            (statuses != NULL) ? &statuses[i_process] : NULL,
+            (load_results != NULL)
+                ? &load_results[i_process * num_libraries]
+                : NULL,
+            is_cancel_requested
+        );
+
+        break;
+      }
+
+      case KNOWLEDGE_INJECTION_STRATEGY_IMPORT_DESCRIPTOR: {
+        is_current_success = InjectLibrariesToProcessWithImportDescriptors(
+            library_injector,
+            &settings,
+            &processes_infos[i_process],
+            num_libraries,
+            libraries_to_inject,
+            (statuses != NULL) ? &statuses[i_process] : NULL,
+            is_cancel_requested
+        );
+
+        break;
+      }
+
+      default: {
+        is_current_success = InjectLibrariesToProcess(
+            library_injector,
+            &settings,
+            &processes_infos[i_process],
+            num_libraries,
+            libraries_to_inject,
+            libraries_to_inject_lens,
+            (statuses != NULL) ? &statuses[i_process] : NULL,
+            (load_results != NULL)
+                ? &load_results[i_process * num_libraries]
+                : NULL,
+            is_cancel_requested
+        );
+
+        break;
+      }
+    }
 
     is_all_success = is_all_success && is_current_success;
   }
@@ -523,5 +1438,17 @@ int LibraryInjector_InjectLibrariesToProcesses(
 free_libraries_to_inject_lens:
   free(libraries_to_inject_lens);
 
-  return 1;
+stop_read_ahead:
+  /* The libraries belong to the caller, so the reads must end here. */
+  LibraryReadAhead_Stop(&read_ahead);
+
+  /*
+  * The read-ahead is only an optimization, so its failure is only
+  * passed on if it does not replace the failure of the injection.
+  */
+  if (is_all_success && read_ahead.is_error_recorded) {
+    ErrorHandling_SetLastErrorDetail(&read_ahead.error_detail);
+  }
+
+  return is_all_success;
 }
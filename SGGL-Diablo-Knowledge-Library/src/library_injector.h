@@ -34,27 +34,118 @@
 #include <wchar.h>
 #include <windows.h>
 
+#include "../include/injection_progress.h"
+#include "../include/injection_strategy.h"
+#include "../include/library_load_result.h"
+#include "../include/library_preflight_result.h"
 #include "game_version.h"
+#include "library_preflight.h"
+#include "patch_helper/injector_patches.h"
 #include "patch_helper/pe_header.h"
+#include "patch_helper/remote_process.h"
 
-struct LibraryInjector {
-  size_t game_path_len;
-  wchar_t* game_path;
+/*
+* The settings of the library injector. An injection copies them when
+* it starts, so that changing them does not affect the injections that
+* are already running.
+*/
+struct LibraryInjectorSettings {
+  int is_shared_memory_transport_enabled;
+  int is_read_ahead_enabled;
+  enum KnowledgeInjectionStrategy injection_strategy;
+
+  const struct RemoteProcessOps* remote_process_ops;
+  void* remote_process_ops_context;
+};
 
+/*
+* The PE header and patch images are not owned by the library injector,
+* and must outlive it. This allows them to be shared by several
+* injectors.
+*/
+struct LibraryInjector {
   enum GameVersion game_version;
 
-  struct PeHeader pe_header;
+  const struct PeHeader* pe_header;
+  const struct InjectorPatchImages* patch_images;
+
+  struct LibraryInjectorSettings settings;
+
+  struct LibraryPreflightCache preflight_cache;
+};
+
+/*
+* The progress of the injection into one game instance. The fields are
+* updated with interlocked operations, so that they can be polled from
+* another thread.
+*/
+struct InjectionStatus {
+  volatile LONG phase;
+  volatile LONG num_libs_loaded;
 };
 
 void LibraryInjector_Init(
     struct LibraryInjector* library_injector,
-    const wchar_t* game_path,
-    size_t game_path_len,
+    const struct PeHeader* pe_header,
+    const struct InjectorPatchImages* patch_images,
     enum GameVersion game_version
 );
 
 void LibraryInjector_Deinit(struct LibraryInjector* library_injector);
 
+void LibraryInjector_SetGame(
+    struct LibraryInjector* library_injector,
+    const struct PeHeader* pe_header,
+    const struct InjectorPatchImages* patch_images,
+    enum GameVersion game_version
+);
+
+void LibraryInjector_SetSharedMemoryTransportEnabled(
+    struct LibraryInjector* library_injector,
+    int is_enabled
+);
+
+/*
+* Enables or disables reading the libraries into the file cache while
+* the game processes are patched. Enabled by default.
+*/
+void LibraryInjector_SetReadAheadEnabled(
+    struct LibraryInjector* library_injector,
+    int is_enabled
+);
+
+/*
+* Sets how the libraries are loaded into the game processes. This is
+* KNOWLEDGE_INJECTION_STRATEGY_AUTO by default.
+*/
+void LibraryInjector_SetInjectionStrategy(
+    struct LibraryInjector* library_injector,
+    enum KnowledgeInjectionStrategy injection_strategy
+);
+
+/*
+* Sets the operations used to access the game processes. These are the
+* Windows operations by default. The operations and their context are
+* not owned, and must outlive the library injector.
+*/
+void LibraryInjector_SetRemoteProcessOps(
+    struct LibraryInjector* library_injector,
+    const struct RemoteProcessOps* ops,
+    void* ops_context
+);
+
+/*
+* Checks the libraries to inject, without touching any game process.
+* One result is output for each library. Returns zero if any library is
+* not valid. This is also done at the start of every injection.
+*/
+int LibraryInjector_PreflightLibraries(
+    struct LibraryInjector* library_injector,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    struct KnowledgeLibraryPreflight* preflights
+);
+
 int LibraryInjector_InjectLibrariesToProcesses(
     struct LibraryInjector* library_injector,
     const wchar_t** libraries_to_inject,
@@ -63,4 +154,28 @@ int LibraryInjector_InjectLibrariesToProcesses(
     size_t num_instances
 );
 
+/*
+* Same as LibraryInjector_InjectLibrariesToProcesses, but reports the
+* progress of each instance into statuses, if it is not NULL. Once
+* is_cancel_requested is set, no further libraries are loaded, and the
+* remaining instances are resumed without them.
+*
+* If load_results is not NULL, it receives num_libraries results for
+* each instance, in instance order.
+*
+* The injection uses a copy of the settings, which are usually the
+* library injector's own, or a copy taken when an operation started.
+*/
+int LibraryInjector_InjectLibrariesToProcessesWithStatus(
+    struct LibraryInjector* library_injector,
+    const struct LibraryInjectorSettings* injection_settings,
+    const wchar_t** libraries_to_inject,
+    size_t num_libraries,
+    const PROCESS_INFORMATION* processes_infos,
+    size_t num_instances,
+    struct InjectionStatus* statuses,
+    struct KnowledgeLibraryLoadResult* load_results,
+    const volatile LONG* is_cancel_requested
+);
+
 #endif /* SGGLDKL_LIBRARY_INJECTOR_H_ */
@@ -0,0 +1,1010 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "library_preflight.h"
+
+#include <process.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/error_detail.h"
+#include "helper/encoding.h"
+#include "helper/error_handling.h"
+#include "helper/trace.h"
+#include "patch_helper/pe_header.h"
+
+enum Constant {
+  PREFLIGHT_MAX_THREADS = 4,
+
+  /* The headers of the libraries are expected to fit in this size. */
+  HEADER_READ_SIZE = 4096,
+
+  /* The PE format limits the number of sections to this count. */
+  MAX_NUM_SECTIONS = 96,
+
+  MAX_NUM_IMPORT_DESCRIPTORS = 1024
+};
+
+/* The libraries checked by one thread, which are every stride-th one. */
+struct PreflightWork {
+  struct LibraryPreflightCache* cache;
+  const char* game_dir_path;
+  const wchar_t** libraries;
+  size_t num_libraries;
+  struct KnowledgeLibraryPreflight* preflights;
+  int is_ordinal_1_required;
+
+  size_t i_first_library;
+  size_t stride;
+
+  /*
+  * The failure recorded while reading the first unreadable library of
+  * a worker thread, which is copied back to the calling thread.
+  */
+  int is_error_recorded;
+  size_t i_error_library;
+  struct KnowledgeErrorDetail error_detail;
+};
+
+/*
+* Entries are never changed or removed until the cache is deinitialized,
+* so the import names of a found entry can be used outside of the lock.
+*/
+static int FindCachedFileFacts(
+    struct LibraryPreflightCache* cache,
+    const struct FileIdentity* file_identity,
+    struct LibraryFileFacts* facts
+) {
+  struct LibraryPreflightCacheEntry* entry;
+  int is_found;
+
+  is_found = 0;
+
+  EnterCriticalSection(&cache->critical_section);
+
+  for (entry = cache->head; entry != NULL; entry = entry->next) {
+    if (FileIdentity_Equals(&entry->file_identity, file_identity)) {
+      *facts = entry->facts;
+      is_found = 1;
+
+      break;
+    }
+  }
+
+  LeaveCriticalSection(&cache->critical_section);
+
+  return is_found;
+}
+
+/*
+* Returns nonzero if the facts were added, in which case the cache owns
+* their import names. The cache is only an optimization, so a failed
+* allocation is ignored.
+*/
+static int AddCachedFileFacts(
+    struct LibraryPreflightCache* cache,
+    const struct FileIdentity* file_identity,
+    const struct LibraryFileFacts* facts
+) {
+  struct LibraryPreflightCacheEntry* entry;
+
+  entry = malloc(sizeof(*entry));
+
+  if (entry == NULL) {
+    return 0;
+  }
+
+  entry->file_identity = *file_identity;
+  entry->facts = *facts;
+
+  EnterCriticalSection(&cache->critical_section);
+
+  entry->next = cache->head;
+  cache->head = entry;
+
+  LeaveCriticalSection(&cache->critical_section);
+
+  return 1;
+}
+
+static int ReadFileAt(
+    HANDLE file_handle,
+    DWORD offset,
+    void* buffer,
+    DWORD size,
+    DWORD* num_bytes_read
+) {
+  DWORD set_file_pointer_result;
+
+  set_file_pointer_result = SetFilePointer(
+      file_handle,
+      (LONG) offset,
+      NULL,
+      FILE_BEGIN
+  );
+
+  if (set_file_pointer_result == (DWORD) -1
+      && GetLastError() != NO_ERROR) {
+    return 0;
+  }
+
+  return ReadFile(file_handle, buffer, size, num_bytes_read, NULL);
+}
+
+static int RvaToFileOffset(
+    DWORD* file_offset,
+    const IMAGE_SECTION_HEADER* sections,
+    WORD num_sections,
+    DWORD rva
+) {
+  WORD i_section;
+  DWORD section_size;
+
+  for (i_section = 0; i_section < num_sections; i_section += 1) {
+    section_size = sections[i_section].Misc.VirtualSize;
+
+    if (section_size < sections[i_section].SizeOfRawData) {
+      section_size = sections[i_section].SizeOfRawData;
+    }
+
+    if (rva >= sections[i_section].VirtualAddress
+        && rva - sections[i_section].VirtualAddress < section_size) {
+      *file_offset = sections[i_section].PointerToRawData
+          + (rva - sections[i_section].VirtualAddress);
+
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/*
+* A path is absolute if it starts from the root of a drive or a share.
+* Any other path is resolved by the loader, not against the current
+* directory of this process.
+*/
+static int IsPathAbsolute(const wchar_t* path) {
+  if (path[0] == L'\\' || path[0] == L'/') {
+    return 1;
+  }
+
+  return path[0] != L'\0'
+      && path[1] == L':'
+      && (path[2] == L'\\' || path[2] == L'/');
+}
+
+/*
+* Searches for a file as the loader of the game does, first in the
+* game's directory and then in the search path.
+*/
+static int SearchLibraryPath(
+    const struct PreflightWork* work,
+    const char* file_name,
+    char* found_path,
+    size_t found_path_size
+) {
+  DWORD found_path_len;
+
+  if (work->game_dir_path != NULL) {
+    found_path_len = SearchPathA(
+        work->game_dir_path,
+        file_name,
+        NULL,
+        found_path_size,
+        found_path,
+        NULL
+    );
+
+    if (found_path_len != 0 && found_path_len < found_path_size) {
+      return 1;
+    }
+  }
+
+  found_path_len = SearchPathA(
+      NULL,
+      file_name,
+      NULL,
+      found_path_size,
+      found_path,
+      NULL
+  );
+
+  return found_path_len != 0 && found_path_len < found_path_size;
+}
+
+/*
+* An import is available if it is one of the libraries, which are
+* loaded in order and are then matched by name, or if the loader can
+* find it from the game's directory or the search path.
+*/
+static int IsImportAvailable(
+    const struct PreflightWork* work,
+    const char* import_name
+) {
+  wchar_t wide_import_name[KNOWLEDGE_LIBRARY_IMPORT_NAME_LENGTH];
+  char found_path[MAX_PATH];
+  const wchar_t* library;
+  const wchar_t* library_name;
+  size_t i_library;
+
+  if (MultiByteToWideChar(
+      CP_ACP,
+      0,
+      import_name,
+      -1,
+      wide_import_name,
+      KNOWLEDGE_LIBRARY_IMPORT_NAME_LENGTH
+  ) != 0) {
+    for (i_library = 0; i_library < work->num_libraries; i_library += 1) {
+      library = work->libraries[i_library];
+      library_name = library + wcslen(library);
+
+      while (library_name > library
+          && library_name[-1] != L'\\'
+          && library_name[-1] != L'/'
+          && library_name[-1] != L':') {
+        library_name -= 1;
+      }
+
+      if (_wcsicmp(library_name, wide_import_name) == 0) {
+        return 1;
+      }
+    }
+  }
+
+  return SearchLibraryPath(
+      work,
+      import_name,
+      found_path,
+      sizeof(found_path)
+  );
+}
+
+static int AppendImportName(
+    struct LibraryFileFacts* facts,
+    size_t* import_names_capacity,
+    const char* import_name
+) {
+  size_t import_name_size;
+  size_t new_capacity;
+  char* new_import_names;
+
+  import_name_size = strlen(import_name) + 1;
+
+  if (facts->import_names_size + import_name_size > *import_names_capacity) {
+    new_capacity = (*import_names_capacity * 2 > import_name_size)
+        ? *import_names_capacity * 2
+        : import_name_size;
+
+    new_import_names = realloc(facts->import_names, new_capacity);
+
+    if (new_import_names == NULL) {
+      RecordAllocationFailure();
+      return 0;
+    }
+
+    facts->import_names = new_import_names;
+    *import_names_capacity = new_capacity;
+  }
+
+  memcpy(
+      &facts->import_names[facts->import_names_size],
+      import_name,
+      import_name_size
+  );
+
+  facts->import_names_size += import_name_size;
+
+  return 1;
+}
+
+static enum KnowledgeLibraryStatus ReadImportNames(
+    HANDLE file_handle,
+    const IMAGE_SECTION_HEADER* sections,
+    WORD num_sections,
+    const IMAGE_NT_HEADERS* nt_headers,
+    struct LibraryFileFacts* facts
+) {
+  const IMAGE_DATA_DIRECTORY* import_directory;
+
+  DWORD descriptor_offset;
+  IMAGE_IMPORT_DESCRIPTOR descriptor;
+  size_t i_descriptor;
+  DWORD name_offset;
+  char import_name[KNOWLEDGE_LIBRARY_IMPORT_NAME_LENGTH];
+  size_t import_names_capacity;
+  DWORD num_bytes_read;
+
+  import_directory = &nt_headers->OptionalHeader.DataDirectory[
+      IMAGE_DIRECTORY_ENTRY_IMPORT
+  ];
+
+  if (import_directory->VirtualAddress == 0
+      || import_directory->Size == 0) {
+    return KNOWLEDGE_LIBRARY_VALID;
+  }
+
+  if (!RvaToFileOffset(
+      &descriptor_offset,
+      sections,
+      num_sections,
+      import_directory->VirtualAddress
+  )) {
+    return KNOWLEDGE_LIBRARY_NOT_PE;
+  }
+
+  import_names_capacity = 0;
+
+  /* The descriptors end with one that is zeroed. */
+  for (i_descriptor = 0;
+      i_descriptor < MAX_NUM_IMPORT_DESCRIPTORS;
+      i_descriptor += 1) {
+    if (!ReadFileAt(
+            file_handle,
+            descriptor_offset + i_descriptor * sizeof(descriptor),
+            &descriptor,
+            sizeof(descriptor),
+            &num_bytes_read
+        )
+        || num_bytes_read != sizeof(descriptor)) {
+      return KNOWLEDGE_LIBRARY_READ_FAILED;
+    }
+
+    if (descriptor.Name == 0) {
+      break;
+    }
+
+    if (!RvaToFileOffset(&name_offset, sections, num_sections, descriptor.Name)
+        || !ReadFileAt(
+            file_handle,
+            name_offset,
+            import_name,
+            sizeof(import_name) - 1,
+            &num_bytes_read
+        )
+        || num_bytes_read == 0) {
+      return KNOWLEDGE_LIBRARY_NOT_PE;
+    }
+
+    import_name[num_bytes_read] = '\0';
+
+    if (!AppendImportName(facts, &import_names_capacity, import_name)) {
+      return KNOWLEDGE_LIBRARY_READ_FAILED;
+    }
+  }
+
+  return KNOWLEDGE_LIBRARY_VALID;
+}
+
+/*
+* Outputs whether the library exports a function by ordinal 1, which
+* the import descriptor strategy imports from every library.
+*/
+static enum KnowledgeLibraryStatus CheckOrdinal1Export(
+    HANDLE file_handle,
+    const IMAGE_SECTION_HEADER* sections,
+    WORD num_sections,
+    const IMAGE_NT_HEADERS* nt_headers,
+    int* is_ordinal_1_exported
+) {
+  const IMAGE_DATA_DIRECTORY* export_directory_entry;
+  IMAGE_EXPORT_DIRECTORY export_directory;
+  DWORD export_directory_offset;
+  DWORD functions_offset;
+  DWORD function_rva;
+  DWORD num_bytes_read;
+
+  *is_ordinal_1_exported = 0;
+
+  export_directory_entry = &nt_headers->OptionalHeader.DataDirectory[
+      IMAGE_DIRECTORY_ENTRY_EXPORT
+  ];
+
+  if (export_directory_entry->VirtualAddress == 0
+      || export_directory_entry->Size == 0) {
+    return KNOWLEDGE_LIBRARY_VALID;
+  }
+
+  if (!RvaToFileOffset(
+      &export_directory_offset,
+      sections,
+      num_sections,
+      export_directory_entry->VirtualAddress
+  )) {
+    return KNOWLEDGE_LIBRARY_NOT_PE;
+  }
+
+  if (!ReadFileAt(
+          file_handle,
+          export_directory_offset,
+          &export_directory,
+          sizeof(export_directory),
+          &num_bytes_read
+      )
+      || num_bytes_read != sizeof(export_directory)) {
+    return KNOWLEDGE_LIBRARY_READ_FAILED;
+  }
+
+  /* Ordinals are numbered from the base of the function table. */
+  if (export_directory.Base > 1
+      || 1 - export_directory.Base >= export_directory.NumberOfFunctions) {
+    return KNOWLEDGE_LIBRARY_VALID;
+  }
+
+  if (!RvaToFileOffset(
+      &functions_offset,
+      sections,
+      num_sections,
+      export_directory.AddressOfFunctions
+  )) {
+    return KNOWLEDGE_LIBRARY_NOT_PE;
+  }
+
+  if (!ReadFileAt(
+          file_handle,
+          functions_offset
+              + (1 - export_directory.Base) * sizeof(function_rva),
+          &function_rva,
+          sizeof(function_rva),
+          &num_bytes_read
+      )
+      || num_bytes_read != sizeof(function_rva)) {
+    return KNOWLEDGE_LIBRARY_READ_FAILED;
+  }
+
+  /* Unused entries of the function table are zeroed. */
+  *is_ordinal_1_exported = (function_rva != 0);
+
+  return KNOWLEDGE_LIBRARY_VALID;
+}
+
+static enum KnowledgeLibraryStatus ReadSectionFacts(
+    HANDLE file_handle,
+    const unsigned char* header_buffer,
+    const IMAGE_NT_HEADERS* nt_headers,
+    struct LibraryFileFacts* facts
+) {
+  LONG nt_headers_offset;
+  DWORD section_table_offset;
+  WORD num_sections;
+  IMAGE_SECTION_HEADER* sections;
+  DWORD num_bytes_read;
+
+  enum KnowledgeLibraryStatus status;
+
+  /* The NT headers offset was validated by the parser. */
+  memcpy(
+      &nt_headers_offset,
+      header_buffer + offsetof(IMAGE_DOS_HEADER, e_lfanew),
+      sizeof(nt_headers_offset)
+  );
+
+  section_table_offset = nt_headers_offset
+      + offsetof(IMAGE_NT_HEADERS, OptionalHeader)
+      + nt_headers->FileHeader.SizeOfOptionalHeader;
+
+  num_sections = nt_headers->FileHeader.NumberOfSections;
+
+  if (num_sections == 0 || num_sections > MAX_NUM_SECTIONS) {
+    return KNOWLEDGE_LIBRARY_NOT_PE;
+  }
+
+  sections = malloc(num_sections * sizeof(sections[0]));
+
+  if (sections == NULL) {
+    RecordAllocationFailure();
+    return KNOWLEDGE_LIBRARY_READ_FAILED;
+  }
+
+  if (!ReadFileAt(
+          file_handle,
+          section_table_offset,
+          sections,
+          num_sections * sizeof(sections[0]),
+          &num_bytes_read
+      )
+      || num_bytes_read != num_sections * sizeof(sections[0])) {
+    status = KNOWLEDGE_LIBRARY_READ_FAILED;
+    goto free_sections;
+  }
+
+  status = CheckOrdinal1Export(
+      file_handle,
+      sections,
+      num_sections,
+      nt_headers,
+      &facts->is_ordinal_1_exported
+  );
+
+  if (status != KNOWLEDGE_LIBRARY_VALID) {
+    goto free_sections;
+  }
+
+  status = ReadImportNames(
+      file_handle,
+      sections,
+      num_sections,
+      nt_headers,
+      facts
+  );
+
+free_sections:
+  free(sections);
+
+  return status;
+}
+
+/*
+* Reads the facts that only depend on the contents of the file. The
+* import names are allocated, and must be freed by the caller.
+*/
+static void ReadLibraryFileFacts(
+    HANDLE file_handle,
+    struct LibraryFileFacts* facts
+) {
+  unsigned char* header_buffer;
+  DWORD num_bytes_read;
+  WORD machine;
+  IMAGE_NT_HEADERS nt_headers;
+
+  facts->is_ordinal_1_exported = 0;
+  facts->import_names = NULL;
+  facts->import_names_size = 0;
+
+  header_buffer = malloc(HEADER_READ_SIZE);
+
+  if (header_buffer == NULL) {
+    RecordAllocationFailure();
+    facts->status = KNOWLEDGE_LIBRARY_READ_FAILED;
+
+    return;
+  }
+
+  /* A short read is left for the parser to reject. */
+  if (!ReadFileAt(
+      file_handle,
+      0,
+      header_buffer,
+      HEADER_READ_SIZE,
+      &num_bytes_read
+  )) {
+    facts->status = KNOWLEDGE_LIBRARY_READ_FAILED;
+  } else if (!PeHeader_ParseMachine(
+      &machine,
+      header_buffer,
+      num_bytes_read
+  )) {
+    facts->status = KNOWLEDGE_LIBRARY_NOT_PE;
+  } else if (machine != IMAGE_FILE_MACHINE_I386) {
+    facts->status = KNOWLEDGE_LIBRARY_WRONG_MACHINE;
+  } else if (!PeHeader_ParseNtHeaders(
+      &nt_headers,
+      header_buffer,
+      num_bytes_read
+  )) {
+    facts->status = KNOWLEDGE_LIBRARY_NOT_PE;
+  } else {
+    facts->status = ReadSectionFacts(
+        file_handle,
+        header_buffer,
+        &nt_headers,
+        facts
+    );
+  }
+
+  free(header_buffer);
+
+  /* Only a valid file has a complete list of imports. */
+  if (facts->status != KNOWLEDGE_LIBRARY_VALID) {
+    free(facts->import_names);
+    facts->import_names = NULL;
+    facts->import_names_size = 0;
+  }
+}
+
+/*
+* Checks the facts of the file against the game's directory, the search
+* path and the other libraries, which can change without the file
+* changing, and so are checked every time.
+*/
+static enum KnowledgeLibraryStatus CheckLibraryFileFacts(
+    const struct PreflightWork* work,
+    const struct LibraryFileFacts* facts,
+    struct KnowledgeLibraryPreflight* preflight
+) {
+  const char* import_name;
+  size_t import_name_len;
+
+  if (facts->status != KNOWLEDGE_LIBRARY_VALID) {
+    return facts->status;
+  }
+
+  for (import_name = facts->import_names;
+      import_name < facts->import_names + facts->import_names_size;
+      import_name += import_name_len + 1) {
+    import_name_len = strlen(import_name);
+
+    if (!IsImportAvailable(work, import_name)) {
+      strcpy(preflight->missing_import_name, import_name);
+      return KNOWLEDGE_LIBRARY_MISSING_IMPORT;
+    }
+  }
+
+  if (work->is_ordinal_1_required && !facts->is_ordinal_1_exported) {
+    return KNOWLEDGE_LIBRARY_NO_ORDINAL_1_EXPORT;
+  }
+
+  return KNOWLEDGE_LIBRARY_VALID;
+}
+
+static void CheckLibrary(
+    const struct PreflightWork* work,
+    size_t i_library
+) {
+  char library_mb_buffer[MAX_PATH];
+  struct ConvertedString library_mb;
+  char found_path[MAX_PATH];
+  const char* library_path;
+  HANDLE file_handle;
+  BY_HANDLE_FILE_INFORMATION file_information;
+  struct FileIdentity file_identity;
+  struct LibraryFileFacts facts;
+  int is_facts_cached;
+  struct KnowledgeLibraryPreflight* preflight;
+
+  preflight = &work->preflights[i_library];
+  preflight->status = KNOWLEDGE_LIBRARY_READ_FAILED;
+  preflight->missing_import_name[0] = '\0';
+
+  /*
+  * The multibyte path is used, as CreateFileW is not implemented on
+  * Windows 9X.
+  */
+  ConvertWideToMultibyteInBuffer(
+      &library_mb,
+      library_mb_buffer,
+      sizeof(library_mb_buffer),
+      work->libraries[i_library]
+  );
+
+  if (library_mb.str == NULL) {
+    return;
+  }
+
+  library_path = library_mb.str;
+
+  if (!IsPathAbsolute(work->libraries[i_library])) {
+    if (!SearchLibraryPath(
+        work,
+        library_mb.str,
+        found_path,
+        sizeof(found_path)
+    )) {
+      preflight->status = KNOWLEDGE_LIBRARY_NOT_FOUND;
+      goto deinit_library_mb;
+    }
+
+    library_path = found_path;
+  }
+
+  file_handle = CreateFileA(
+      library_path,
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      NULL,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL,
+      NULL
+  );
+
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    preflight->status = KNOWLEDGE_LIBRARY_NOT_FOUND;
+    goto deinit_library_mb;
+  }
+
+  if (!GetFileInformationByHandle(file_handle, &file_information)) {
+    goto close_file_handle;
+  }
+
+  FileIdentity_InitFromInformation(&file_identity, &file_information);
+
+  is_facts_cached = FindCachedFileFacts(
+      work->cache,
+      &file_identity,
+      &facts
+  );
+
+  if (!is_facts_cached) {
+    ReadLibraryFileFacts(file_handle, &facts);
+
+    is_facts_cached = (facts.status != KNOWLEDGE_LIBRARY_READ_FAILED)
+        && AddCachedFileFacts(work->cache, &file_identity, &facts);
+  }
+
+  preflight->status = CheckLibraryFileFacts(work, &facts, preflight);
+
+  if (!is_facts_cached) {
+    free(facts.import_names);
+  }
+
+close_file_handle:
+  CloseHandle(file_handle);
+
+deinit_library_mb:
+  ConvertedString_Deinit(&library_mb);
+}
+
+static unsigned __stdcall RunPreflightWork(void* param) {
+  const struct PreflightWork* work;
+  size_t i_library;
+
+  work = param;
+
+  for (i_library = work->i_first_library;
+      i_library < work->num_libraries;
+      i_library += work->stride) {
+    CheckLibrary(work, i_library);
+  }
+
+  return 0;
+}
+
+static unsigned __stdcall RunPreflightWorkerThread(void* param) {
+  struct PreflightWork* work;
+  size_t i_library;
+
+  work = param;
+
+  for (i_library = work->i_first_library;
+      i_library < work->num_libraries;
+      i_library += work->stride) {
+    ErrorHandling_ClearLastErrorDetail();
+
+    CheckLibrary(work, i_library);
+
+    if (!work->is_error_recorded
+        && work->preflights[i_library].status
+            == KNOWLEDGE_LIBRARY_READ_FAILED) {
+      work->is_error_recorded = ErrorHandling_GetLastErrorDetail(
+          &work->error_detail
+      );
+      work->i_error_library = i_library;
+    }
+  }
+
+  return 0;
+}
+
+static void RecordPreflightFailure(
+    const wchar_t* library,
+    const struct KnowledgeLibraryPreflight* preflight
+) {
+  static const wchar_t* const kStatusReasons[] = {
+    L"valid",
+    L"not found",
+    L"not readable",
+    L"not a PE file",
+    L"not built for x86",
+    L"missing an import",
+    L"not exporting ordinal 1"
+  };
+
+  wchar_t message[KNOWLEDGE_ERROR_MESSAGE_LENGTH];
+
+  if (preflight->status == KNOWLEDGE_LIBRARY_MISSING_IMPORT) {
+    _snwprintf(
+        message,
+        KNOWLEDGE_ERROR_MESSAGE_LENGTH,
+        L"The library %ls imports %hs, which could not be found.",
+        library,
+        preflight->missing_import_name
+    );
+  } else {
+    _snwprintf(
+        message,
+        KNOWLEDGE_ERROR_MESSAGE_LENGTH,
+        L"The library %ls is %ls.",
+        library,
+        kStatusReasons[preflight->status]
+    );
+  }
+
+  message[KNOWLEDGE_ERROR_MESSAGE_LENGTH - 1] = L'\0';
+
+  RecordGeneralFailure(message, L"Library Check Failed");
+}
+
+void LibraryPreflightCache_Init(struct LibraryPreflightCache* cache) {
+  InitializeCriticalSection(&cache->critical_section);
+  cache->head = NULL;
+}
+
+void LibraryPreflightCache_Deinit(struct LibraryPreflightCache* cache) {
+  struct LibraryPreflightCacheEntry* entry;
+  struct LibraryPreflightCacheEntry* next_entry;
+
+  for (entry = cache->head; entry != NULL; entry = next_entry) {
+    next_entry = entry->next;
+
+    free(entry->facts.import_names);
+    free(entry);
+  }
+
+  cache->head = NULL;
+
+  DeleteCriticalSection(&cache->critical_section);
+}
+
+int LibraryPreflight_CheckLibraries(
+    struct LibraryPreflightCache* cache,
+    const wchar_t* game_file_path,
+    const wchar_t** libraries,
+    size_t num_libraries,
+    int is_ordinal_1_required,
+    struct KnowledgeLibraryPreflight* preflights
+) {
+  wchar_t game_dir_path[MAX_PATH];
+  size_t game_dir_path_len;
+  char game_dir_path_mb_buffer[MAX_PATH];
+  struct ConvertedString game_dir_path_mb;
+
+  struct PreflightWork works[PREFLIGHT_MAX_THREADS];
+  HANDLE thread_handles[PREFLIGHT_MAX_THREADS];
+  size_t num_threads;
+  size_t num_started_threads;
+  size_t i_thread;
+  unsigned int thread_id;
+
+  size_t i_library;
+  int is_all_valid;
+
+  /* Only the directory of the game file is searched for imports. */
+  game_dir_path_len = wcslen(game_file_path);
+
+  while (game_dir_path_len > 0
+      && game_file_path[game_dir_path_len - 1] != L'\\'
+      && game_file_path[game_dir_path_len - 1] != L'/'
+      && game_file_path[game_dir_path_len - 1] != L':') {
+    game_dir_path_len -= 1;
+  }
+
+  game_dir_path_mb.str = NULL;
+  game_dir_path_mb.fallback_str = NULL;
+
+  if (game_dir_path_len > 0 && game_dir_path_len < MAX_PATH) {
+    memcpy(
+        game_dir_path,
+        game_file_path,
+        game_dir_path_len * sizeof(game_dir_path[0])
+    );
+
+    game_dir_path[game_dir_path_len] = L'\0';
+
+    ConvertWideToMultibyteInBuffer(
+        &game_dir_path_mb,
+        game_dir_path_mb_buffer,
+        sizeof(game_dir_path_mb_buffer),
+        game_dir_path
+    );
+  }
+
+  Trace_BeginEvent("PreflightLibraries", GetCurrentProcessId(), num_libraries);
+
+  num_threads = (num_libraries < PREFLIGHT_MAX_THREADS)
+      ? num_libraries
+      : PREFLIGHT_MAX_THREADS;
+
+  for (i_thread = 0; i_thread < num_threads; i_thread += 1) {
+    works[i_thread].cache = cache;
+    works[i_thread].game_dir_path = game_dir_path_mb.str;
+    works[i_thread].libraries = libraries;
+    works[i_thread].num_libraries = num_libraries;
+    works[i_thread].preflights = preflights;
+    works[i_thread].is_ordinal_1_required = is_ordinal_1_required;
+    works[i_thread].i_first_library = i_thread;
+    works[i_thread].stride = num_threads;
+    works[i_thread].is_error_recorded = 0;
+  }
+
+  /*
+  * The first share is checked on the calling thread. A share whose
+  * thread could not be started is also checked here, afterwards.
+  */
+  num_started_threads = 0;
+
+  for (i_thread = 1; i_thread < num_threads; i_thread += 1) {
+    thread_handles[num_started_threads] = (HANDLE) _beginthreadex(
+        NULL,
+        0,
+        &RunPreflightWorkerThread,
+        &works[i_thread],
+        0,
+        &thread_id
+    );
+
+    if (thread_handles[num_started_threads] == NULL) {
+      break;
+    }
+
+    num_started_threads += 1;
+  }
+
+  if (num_threads > 0) {
+    RunPreflightWork(&works[0]);
+  }
+
+  for (i_thread = num_started_threads + 1;
+      i_thread < num_threads;
+      i_thread += 1) {
+    RunPreflightWork(&works[i_thread]);
+  }
+
+  if (num_started_threads > 0) {
+    WaitForMultipleObjects(
+        (DWORD) num_started_threads,
+        thread_handles,
+        TRUE,
+        INFINITE
+    );
+  }
+
+  for (i_thread = 0; i_thread < num_started_threads; i_thread += 1) {
+    CloseHandle(thread_handles[i_thread]);
+  }
+
+  Trace_EndEvent("PreflightLibraries", GetCurrentProcessId(), num_libraries);
+
+  ConvertedString_Deinit(&game_dir_path_mb);
+
+  is_all_valid = 1;
+
+  for (i_library = 0; i_library < num_libraries; i_library += 1) {
+    if (preflights[i_library].status != KNOWLEDGE_LIBRARY_VALID) {
+      RecordPreflightFailure(libraries[i_library], &preflights[i_library]);
+      is_all_valid = 0;
+
+      /*
+      * A library that could not be read on a worker thread reports the
+      * failure that caused it instead.
+      */
+      i_thread = i_library % num_threads;
+
+      if (works[i_thread].is_error_recorded
+          && works[i_thread].i_error_library == i_library) {
+        ErrorHandling_SetLastErrorDetail(&works[i_thread].error_detail);
+      }
+
+      break;
+    }
+  }
+
+  return is_all_valid;
+}
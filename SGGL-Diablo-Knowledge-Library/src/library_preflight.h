@@ -0,0 +1,95 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_LIBRARY_PREFLIGHT_H_
+#define SGGLDKL_LIBRARY_PREFLIGHT_H_
+
+#include <stddef.h>
+#include <wchar.h>
+#include <windows.h>
+
+#include "../include/library_preflight_result.h"
+#include "helper/file_identity.h"
+
+/*
+* The facts about a library that only depend on the contents of its
+* file. Whether its imports can be found is not included, as that
+* depends on the game's directory and the search path.
+*/
+struct LibraryFileFacts {
+  /* Any status other than valid is final. */
+  enum KnowledgeLibraryStatus status;
+  int is_ordinal_1_exported;
+
+  /* The names of the imported DLLs, each null-terminated, in order. */
+  char* import_names;
+  size_t import_names_size;
+};
+
+struct LibraryPreflightCacheEntry {
+  struct LibraryPreflightCacheEntry* next;
+
+  struct FileIdentity file_identity;
+  struct LibraryFileFacts facts;
+};
+
+/* The facts of previously checked libraries, by file identity. */
+struct LibraryPreflightCache {
+  CRITICAL_SECTION critical_section;
+  struct LibraryPreflightCacheEntry* head;
+};
+
+void LibraryPreflightCache_Init(struct LibraryPreflightCache* cache);
+
+void LibraryPreflightCache_Deinit(struct LibraryPreflightCache* cache);
+
+/*
+* Checks that every library exists, is an x86 PE file, and only imports
+* DLLs that can be found from the game's directory or the search path,
+* or that are among the libraries. If is_ordinal_1_required is nonzero,
+* then every library must also export ordinal 1. A library that is not
+* an absolute path is searched for in the same way as an import. The
+* libraries are checked in parallel, and one result is output for each
+* of them.
+*
+* Returns zero if any library is not valid, in which case a failure is
+* recorded for the first one. If that library could not be read, then
+* the failure that caused it is recorded, even if it occurred on a
+* worker thread.
+*/
+int LibraryPreflight_CheckLibraries(
+    struct LibraryPreflightCache* cache,
+    const wchar_t* game_file_path,
+    const wchar_t** libraries,
+    size_t num_libraries,
+    int is_ordinal_1_required,
+    struct KnowledgeLibraryPreflight* preflights
+);
+
+#endif /* SGGLDKL_LIBRARY_PREFLIGHT_H_ */
@@ -0,0 +1,171 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "library_read_ahead.h"
+
+#include <process.h>
+#include <stdlib.h>
+
+#include "helper/encoding.h"
+#include "helper/error_handling.h"
+#include "helper/trace.h"
+
+enum Constant {
+  READ_AHEAD_CHUNK_SIZE = 64 * 1024
+};
+
+static void ReadAheadLibrary(
+    struct LibraryReadAhead* read_ahead,
+    const wchar_t* library,
+    unsigned char* chunk
+) {
+  char library_mb_buffer[MAX_PATH];
+  struct ConvertedString library_mb;
+  HANDLE file_handle;
+  BOOL is_read_file_success;
+  DWORD num_bytes_read;
+
+  /*
+  * The multibyte path is used, as CreateFileW is not implemented on
+  * Windows 9X.
+  */
+  ConvertWideToMultibyteInBuffer(
+      &library_mb,
+      library_mb_buffer,
+      sizeof(library_mb_buffer),
+      library
+  );
+
+  if (library_mb.str == NULL) {
+    return;
+  }
+
+  /* Sequential scan makes the system read ahead of each chunk. */
+  file_handle = CreateFileA(
+      library_mb.str,
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      NULL,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+      NULL
+  );
+
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    goto deinit_library_mb;
+  }
+
+  do {
+    is_read_file_success = ReadFile(
+        file_handle,
+        chunk,
+        READ_AHEAD_CHUNK_SIZE,
+        &num_bytes_read,
+        NULL
+    );
+  } while (is_read_file_success
+      && num_bytes_read > 0
+      && !read_ahead->is_stop_requested);
+
+  CloseHandle(file_handle);
+
+deinit_library_mb:
+  ConvertedString_Deinit(&library_mb);
+}
+
+static unsigned __stdcall RunReadAhead(void* param) {
+  struct LibraryReadAhead* read_ahead;
+  unsigned char* chunk;
+  size_t i_library;
+
+  read_ahead = param;
+
+  chunk = malloc(READ_AHEAD_CHUNK_SIZE);
+
+  if (chunk == NULL) {
+    goto capture_error_detail;
+  }
+
+  for (i_library = 0;
+      i_library < read_ahead->num_libraries
+          && !read_ahead->is_stop_requested;
+      i_library += 1) {
+    Trace_BeginEvent("ReadAheadLibrary", GetCurrentProcessId(), i_library);
+
+    ReadAheadLibrary(read_ahead, read_ahead->libraries[i_library], chunk);
+
+    Trace_EndEvent("ReadAheadLibrary", GetCurrentProcessId(), i_library);
+  }
+
+  free(chunk);
+
+capture_error_detail:
+  read_ahead->is_error_recorded = ErrorHandling_GetLastErrorDetail(
+      &read_ahead->error_detail
+  );
+
+  return 0;
+}
+
+int LibraryReadAhead_Start(
+    struct LibraryReadAhead* read_ahead,
+    const wchar_t** libraries,
+    size_t num_libraries
+) {
+  unsigned int thread_id;
+
+  read_ahead->is_stop_requested = 0;
+  read_ahead->libraries = libraries;
+  read_ahead->num_libraries = num_libraries;
+  read_ahead->is_error_recorded = 0;
+
+  read_ahead->thread_handle = (HANDLE) _beginthreadex(
+      NULL,
+      0,
+      &RunReadAhead,
+      read_ahead,
+      0,
+      &thread_id
+  );
+
+  return read_ahead->thread_handle != NULL;
+}
+
+void LibraryReadAhead_Stop(struct LibraryReadAhead* read_ahead) {
+  if (read_ahead->thread_handle == NULL) {
+    return;
+  }
+
+  InterlockedExchange(&read_ahead->is_stop_requested, 1);
+
+  WaitForSingleObject(read_ahead->thread_handle, INFINITE);
+  CloseHandle(read_ahead->thread_handle);
+
+  read_ahead->thread_handle = NULL;
+}
@@ -0,0 +1,76 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_LIBRARY_READ_AHEAD_H_
+#define SGGLDKL_LIBRARY_READ_AHEAD_H_
+
+#include <stddef.h>
+#include <wchar.h>
+#include <windows.h>
+
+#include "../include/error_detail.h"
+
+/*
+* Reads the libraries to inject on a worker thread, so that they are in
+* the system's file cache by the time the payload loads them. The read
+* data is discarded.
+*/
+struct LibraryReadAhead {
+  HANDLE thread_handle;
+  volatile LONG is_stop_requested;
+
+  const wchar_t** libraries;
+  size_t num_libraries;
+
+  /* The last failure recorded on the worker thread, if any. */
+  int is_error_recorded;
+  struct KnowledgeErrorDetail error_detail;
+};
+
+/*
+* Starts reading the libraries, which must outlive the read-ahead. The
+* read-ahead is only an optimization, so no failure is recorded if the
+* worker thread could not be started, and zero is returned.
+*/
+int LibraryReadAhead_Start(
+    struct LibraryReadAhead* read_ahead,
+    const wchar_t** libraries,
+    size_t num_libraries
+);
+
+/*
+* Stops the read-ahead if it is still reading, and waits for its worker
+* thread to exit. Does nothing if the read-ahead was not started.
+*
+* A failure recorded on the worker thread is kept in the read-ahead, so
+* that the caller can decide whether to report it.
+*/
+void LibraryReadAhead_Stop(struct LibraryReadAhead* read_ahead);
+
+#endif /* SGGLDKL_LIBRARY_READ_AHEAD_H_ */
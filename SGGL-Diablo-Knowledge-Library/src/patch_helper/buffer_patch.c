@@ -30,118 +30,122 @@
 #include "buffer_patch.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "../helper/error_handling.h"
 
-struct BufferPatch* BufferPatch_Init(
-    struct BufferPatch* buffer_patch,
+struct PatchImage* PatchImage_Init(
+    struct PatchImage* patch_image,
     void* position,
     size_t buffer_size,
-    const unsigned char* patch_buffer,
-    const PROCESS_INFORMATION* process_info
+    const unsigned char* patch_buffer
 ) {
-  BOOL is_read_process_memory_success;
-
-  buffer_patch->position = position;
-  buffer_patch->is_patched = 0;
-  buffer_patch->buffer_size = buffer_size;
-  buffer_patch->process_info = process_info;
+  patch_image->position = position;
+  patch_image->buffer_size = buffer_size;
 
-  /*Make a copy of the patch buffer. */
-  buffer_patch->patch_buffer = malloc(buffer_size);
+  patch_image->patch_buffer = malloc(buffer_size);
 
-  if (buffer_patch->patch_buffer == NULL) {
-    ExitOnAllocationFailure();
+  if (patch_image->patch_buffer == NULL) {
+    RecordAllocationFailure();
+    return NULL;
   }
 
-  memcpy(buffer_patch->patch_buffer, patch_buffer, buffer_size);
+  memcpy(patch_image->patch_buffer, patch_buffer, buffer_size);
+
+  return patch_image;
+}
+
+void PatchImage_Deinit(struct PatchImage* patch_image) {
+  patch_image->position = NULL;
+  patch_image->buffer_size = 0;
+
+  free(patch_image->patch_buffer);
+  patch_image->patch_buffer = NULL;
+}
+
+struct BufferPatch* BufferPatch_Init(
+    struct BufferPatch* buffer_patch,
+    const struct PatchImage* image,
+    const struct RemoteProcess* remote_process
+) {
+  buffer_patch->image = image;
+  buffer_patch->is_patched = 0;
+  buffer_patch->remote_process = remote_process;
 
   /* Make a copy of the original data before modification. */
-  buffer_patch->original_buffer = malloc(buffer_size);
+  buffer_patch->original_buffer = malloc(image->buffer_size);
 
   if (buffer_patch->original_buffer == NULL) {
-    ExitOnAllocationFailure();
+    RecordAllocationFailure();
+    return NULL;
   }
 
-  is_read_process_memory_success = ReadProcessMemory(
-      process_info->hProcess,
-      position,
+  if (!RemoteProcess_ReadMemory(
+      remote_process,
+      image->position,
       buffer_patch->original_buffer,
-      buffer_size,
+      image->buffer_size,
       NULL
-  );
-
-  if (!is_read_process_memory_success) {
-    ExitOnWindowsFunctionFailureWithLastError(
-        L"ReadProcessMemory",
-        GetLastError()
-    );
+  )) {
+    goto free_original_buffer;
   }
 
   return buffer_patch;
+
+free_original_buffer:
+  free(buffer_patch->original_buffer);
+  buffer_patch->original_buffer = NULL;
+
+  return NULL;
 }
 
 void BufferPatch_Deinit(struct BufferPatch* buffer_patch) {
   BufferPatch_Remove(buffer_patch);
 
-  buffer_patch->position = NULL;
+  buffer_patch->image = NULL;
   buffer_patch->is_patched = 0;
-  buffer_patch->buffer_size = 0;
-  buffer_patch->process_info = NULL;
+  buffer_patch->remote_process = NULL;
 
-  free(buffer_patch->patch_buffer);
   free(buffer_patch->original_buffer);
-
-  buffer_patch->patch_buffer = NULL;
   buffer_patch->original_buffer = NULL;
 }
 
-void BufferPatch_Apply(struct BufferPatch* buffer_patch) {
-  BOOL is_write_process_memory_success;
-
+int BufferPatch_Apply(struct BufferPatch* buffer_patch) {
   if (buffer_patch->is_patched) {
-    return;
+    return 1;
   }
 
-  is_write_process_memory_success = WriteProcessMemory(
-      buffer_patch->process_info->hProcess,
-      buffer_patch->position,
-      buffer_patch->patch_buffer,
-      buffer_patch->buffer_size,
+  if (!RemoteProcess_WriteMemory(
+      buffer_patch->remote_process,
+      buffer_patch->image->position,
+      buffer_patch->image->patch_buffer,
+      buffer_patch->image->buffer_size,
       NULL
-  );
-
-  if (!is_write_process_memory_success) {
-    ExitOnWindowsFunctionFailureWithLastError(
-        L"WriteProcessMemory",
-        GetLastError()
-    );
+  )) {
+    return 0;
   }
 
   buffer_patch->is_patched = 1;
-}
 
-void BufferPatch_Remove(struct BufferPatch* buffer_patch) {
-  BOOL is_write_process_memory_success;
+  return 1;
+}
 
+int BufferPatch_Remove(struct BufferPatch* buffer_patch) {
   if (!buffer_patch->is_patched) {
-    return;
+    return 1;
   }
 
-  is_write_process_memory_success = WriteProcessMemory(
-      buffer_patch->process_info->hProcess,
-      buffer_patch->position,
+  if (!RemoteProcess_WriteMemory(
+      buffer_patch->remote_process,
+      buffer_patch->image->position,
       buffer_patch->original_buffer,
-      buffer_patch->buffer_size,
+      buffer_patch->image->buffer_size,
       NULL
-  );
-
-  if (!is_write_process_memory_success) {
-    ExitOnWindowsFunctionFailureWithLastError(
-        L"WriteProcessMemory",
-        GetLastError()
-    );
+  )) {
+    return 0;
   }
 
   buffer_patch->is_patched = 0;
+
+  return 1;
 }
@@ -33,27 +33,60 @@
 #include <stddef.h>
 #include <windows.h>
 
-struct BufferPatch {
+#include "remote_process.h"
+
+/*
+* The bytes to write at a position in the game process. An image does
+* not depend on the process, so it is built once for a game build and
+* is then only read, allowing it to be shared by concurrent injections.
+*/
+struct PatchImage {
   void* position;
-  unsigned char is_patched;
   size_t buffer_size;
   unsigned char* patch_buffer;
-  const PROCESS_INFORMATION* process_info;
+};
+
+/*
+* A patch image applied to one game process, along with the original
+* data that it replaces.
+*/
+struct BufferPatch {
+  const struct PatchImage* image;
+  unsigned char is_patched;
+  const struct RemoteProcess* remote_process;
   unsigned char* original_buffer;
 };
 
-struct BufferPatch* BufferPatch_Init(
-    struct BufferPatch* buffer_patch,
+/*
+* Makes a copy of the patch buffer, which the caller may then modify
+* before the image is shared. Returns NULL if the copy could not be
+* allocated, in which case nothing needs to be deinited.
+*/
+struct PatchImage* PatchImage_Init(
+    struct PatchImage* patch_image,
     void* position,
     size_t buffer_size,
-    const unsigned char* patch_buffer,
-    const PROCESS_INFORMATION* process_info
+    const unsigned char* patch_buffer
+);
+
+void PatchImage_Deinit(struct PatchImage* patch_image);
+
+/*
+* Returns NULL if the original data could not be read, in which case
+* nothing needs to be deinited. The patch image and the remote process
+* must outlive the buffer patch.
+*/
+struct BufferPatch* BufferPatch_Init(
+    struct BufferPatch* buffer_patch,
+    const struct PatchImage* image,
+    const struct RemoteProcess* remote_process
 );
 
 void BufferPatch_Deinit(struct BufferPatch* buffer_patch);
 
-void BufferPatch_Apply(struct BufferPatch* buffer_patch);
+/* Returns zero if the process memory could not be written. */
+int BufferPatch_Apply(struct BufferPatch* buffer_patch);
 
-void BufferPatch_Remove(struct BufferPatch* buffer_patch);
+int BufferPatch_Remove(struct BufferPatch* buffer_patch);
 
 #endif /* SGGLDKL_PATCH_HELPER_BUFFER_PATCH_H_ */
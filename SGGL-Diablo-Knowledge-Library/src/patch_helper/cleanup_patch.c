@@ -78,24 +78,20 @@ static void InitFuncSize(size_t* func_size) {
   *func_size -= 1;
 }
 
-struct BufferPatch* CleanupPatch_Init(
-    struct BufferPatch* cleanup_patch,
-    void* (*patch_address)(void),
-    const PROCESS_INFORMATION* process_info
+struct PatchImage* CleanupPatch_InitImage(
+    struct PatchImage* cleanup_image,
+    void* (*patch_address)(void)
 ) {
-  BufferPatch_Init(
-      cleanup_patch,
+  return PatchImage_Init(
+      cleanup_image,
       (void*) patch_address,
       CleanupPatch_GetSize(),
-      (void*) &CleanupFunc,
-      process_info
+      (void*) &CleanupFunc
   );
-
-  return cleanup_patch;
 }
 
-void CleanupPatch_Deinit(struct BufferPatch* cleanup_patch) {
-  BufferPatch_Deinit(cleanup_patch);
+void CleanupPatch_DeinitImage(struct PatchImage* cleanup_image) {
+  PatchImage_Deinit(cleanup_image);
 }
 
 size_t CleanupPatch_GetSize(void) {
@@ -35,13 +35,12 @@
 
 #include "buffer_patch.h"
 
-struct BufferPatch* CleanupPatch_Init(
-    struct BufferPatch* cleanup_patch,
-    void* (*patch_address)(void),
-    const PROCESS_INFORMATION* process_info
+struct PatchImage* CleanupPatch_InitImage(
+    struct PatchImage* cleanup_image,
+    void* (*patch_address)(void)
 );
 
-void CleanupPatch_Deinit(struct BufferPatch* cleanup_patch);
+void CleanupPatch_DeinitImage(struct PatchImage* cleanup_image);
 
 size_t CleanupPatch_GetSize(void);
 
@@ -55,50 +55,52 @@ static const unsigned char kEntryHijackBytes[] = {
   0x4D, 0x69, 0x72, 0x44
 };
 
-struct BufferPatch* EntryHijackPatch_Init(
-    struct BufferPatch* entry_hijack_patch,
-    void* (*patch_address)(void),
-    const PROCESS_INFORMATION* process_info,
-    const struct PeHeader* pe_header
+struct PatchImage* EntryHijackPatch_InitImage(
+    struct PatchImage* entry_hijack_image,
+    void* (*patch_address)(void)
 ) {
   unsigned char* free_space_address;
 
-  BufferPatch_Init(
-      entry_hijack_patch,
+  entry_hijack_image = PatchImage_Init(
+      entry_hijack_image,
       (void*) patch_address,
       EntryHijackPatch_GetSize(),
-      kEntryHijackBytes,
-      process_info
+      kEntryHijackBytes
   );
 
+  if (entry_hijack_image == NULL) {
+    return NULL;
+  }
+
   free_space_address = (unsigned char*) patch_address
       + EntryHijackPatch_GetFreeSpaceOffset();
 
   memcpy(
-      &entry_hijack_patch->patch_buffer[1],
+      &entry_hijack_image->patch_buffer[1],
       &free_space_address,
       sizeof(free_space_address)
   );
 
+  /* The free space holds the pointer to the stack data. */
   memset(
-      &entry_hijack_patch->patch_buffer[
+      &entry_hijack_image->patch_buffer[
           EntryHijackPatch_GetFreeSpaceOffset()
       ],
       0,
-      sizeof(free_space_address)
+      sizeof(void*)
   );
 
-  return entry_hijack_patch;
+  return entry_hijack_image;
 }
 
-void EntryHijackPatch_Deinit(struct BufferPatch* entry_hijack_patch) {
-  BufferPatch_Deinit(entry_hijack_patch);
+void EntryHijackPatch_DeinitImage(struct PatchImage* entry_hijack_image) {
+  PatchImage_Deinit(entry_hijack_image);
 }
 
 void* EntryHijackPatch_GetFreeSpaceAddress(
-    const struct BufferPatch* entry_hijack_patch
+    const struct PatchImage* entry_hijack_image
 ) {
-  return (unsigned char*) entry_hijack_patch->position
+  return (unsigned char*) entry_hijack_image->position
       + EntryHijackPatch_GetFreeSpaceOffset();
 }
 
@@ -34,19 +34,16 @@
 #include <windows.h>
 
 #include "buffer_patch.h"
-#include "pe_header.h"
 
-struct BufferPatch* EntryHijackPatch_Init(
-    struct BufferPatch* entry_hijack_patch,
-    void* (*patch_address)(void),
-    const PROCESS_INFORMATION* process_info,
-    const struct PeHeader* pe_header
+struct PatchImage* EntryHijackPatch_InitImage(
+    struct PatchImage* entry_hijack_image,
+    void* (*patch_address)(void)
 );
 
-void EntryHijackPatch_Deinit(struct BufferPatch* entry_hijack_patch);
+void EntryHijackPatch_DeinitImage(struct PatchImage* entry_hijack_image);
 
 void* EntryHijackPatch_GetFreeSpaceAddress(
-    const struct BufferPatch* entry_hijack_patch
+    const struct PatchImage* entry_hijack_image
 );
 
 size_t EntryHijackPatch_GetSize(void);
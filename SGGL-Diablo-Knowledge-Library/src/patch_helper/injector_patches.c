@@ -37,10 +37,9 @@
 #include "payload_patch.h"
 #include "pe_header.h"
 
-struct InjectorPatches* InjectorPatches_Init(
-    struct InjectorPatches* injector_patches,
+struct InjectorPatchImages* InjectorPatchImages_Init(
+    struct InjectorPatchImages* patch_images,
     const struct PeHeader* pe_header,
-    const PROCESS_INFORMATION* process_info,
     enum GameVersion game_version
 ) {
   void* (*cleanup_patch_address)(void);
@@ -48,14 +47,21 @@ struct InjectorPatches* InjectorPatches_Init(
   unsigned char* entry_hijack_patch_address;
   unsigned char* payload_patch_address;
 
+  struct PatchImage* cleanup_image;
+  struct PatchImage* entry_hijack_image;
+  struct PatchImage* payload_image;
+
   cleanup_patch_address = PeHeader_GetHardEntryPointAddress(pe_header);
 
-  CleanupPatch_Init(
-      &injector_patches->cleanup_patch,
-      cleanup_patch_address,
-      process_info
+  cleanup_image = CleanupPatch_InitImage(
+      &patch_images->cleanup_image,
+      cleanup_patch_address
   );
 
+  if (cleanup_image == NULL) {
+    return NULL;
+  }
+
   entry_hijack_patch_address = GetEntryHijackPatchAddress(
       pe_header,
       game_version
@@ -65,29 +71,98 @@ struct InjectorPatches* InjectorPatches_Init(
   printf("Entry hijack patch address: %p \n", entry_hijack_patch_address);
 #endif /* !NDEBUG */
 
-  EntryHijackPatch_Init(
-      &injector_patches->entry_hijack_patch,
-      (void* (*)(void)) entry_hijack_patch_address,
-      process_info,
-      pe_header
+  entry_hijack_image = EntryHijackPatch_InitImage(
+      &patch_images->entry_hijack_image,
+      (void* (*)(void)) entry_hijack_patch_address
   );
 
+  if (entry_hijack_image == NULL) {
+    goto deinit_cleanup_image;
+  }
+
   payload_patch_address =
-      (unsigned char*) injector_patches->entry_hijack_patch.position
+      (unsigned char*) patch_images->entry_hijack_image.position
           + EntryHijackPatch_GetSize();
 
-  PayloadPatch_Init(
-      &injector_patches->payload_patch,
+  payload_image = PayloadPatch_InitImage(
+      &patch_images->payload_image,
       (void* (*)(void)) payload_patch_address,
-      cleanup_patch_address,
-      process_info
+      cleanup_patch_address
   );
 
+  if (payload_image == NULL) {
+    goto deinit_entry_hijack_image;
+  }
+
+  return patch_images;
+
+deinit_entry_hijack_image:
+  EntryHijackPatch_DeinitImage(&patch_images->entry_hijack_image);
+
+deinit_cleanup_image:
+  CleanupPatch_DeinitImage(&patch_images->cleanup_image);
+
+  return NULL;
+}
+
+void InjectorPatchImages_Deinit(struct InjectorPatchImages* patch_images) {
+  PayloadPatch_DeinitImage(&patch_images->payload_image);
+  EntryHijackPatch_DeinitImage(&patch_images->entry_hijack_image);
+  CleanupPatch_DeinitImage(&patch_images->cleanup_image);
+}
+
+struct InjectorPatches* InjectorPatches_Init(
+    struct InjectorPatches* injector_patches,
+    const struct InjectorPatchImages* patch_images,
+    const struct RemoteProcess* remote_process
+) {
+  struct BufferPatch* cleanup_patch;
+  struct BufferPatch* entry_hijack_patch;
+  struct BufferPatch* payload_patch;
+
+  cleanup_patch = BufferPatch_Init(
+      &injector_patches->cleanup_patch,
+      &patch_images->cleanup_image,
+      remote_process
+  );
+
+  if (cleanup_patch == NULL) {
+    return NULL;
+  }
+
+  entry_hijack_patch = BufferPatch_Init(
+      &injector_patches->entry_hijack_patch,
+      &patch_images->entry_hijack_image,
+      remote_process
+  );
+
+  if (entry_hijack_patch == NULL) {
+    goto deinit_cleanup_patch;
+  }
+
+  payload_patch = BufferPatch_Init(
+      &injector_patches->payload_patch,
+      &patch_images->payload_image,
+      remote_process
+  );
+
+  if (payload_patch == NULL) {
+    goto deinit_entry_hijack_patch;
+  }
+
   return injector_patches;
+
+deinit_entry_hijack_patch:
+  BufferPatch_Deinit(&injector_patches->entry_hijack_patch);
+
+deinit_cleanup_patch:
+  BufferPatch_Deinit(&injector_patches->cleanup_patch);
+
+  return NULL;
 }
 
 void InjectorPatches_Deinit(struct InjectorPatches* injector_patches) {
-  PayloadPatch_Deinit(&injector_patches->payload_patch);
-  EntryHijackPatch_Deinit(&injector_patches->entry_hijack_patch);
-  CleanupPatch_Deinit(&injector_patches->cleanup_patch);
+  BufferPatch_Deinit(&injector_patches->payload_patch);
+  BufferPatch_Deinit(&injector_patches->entry_hijack_patch);
+  BufferPatch_Deinit(&injector_patches->cleanup_patch);
 }
@@ -35,6 +35,18 @@
 #include "../game_version.h"
 #include "buffer_patch.h"
 #include "pe_header.h"
+#include "remote_process.h"
+
+/*
+* The patch images for one game build. The hard addresses are the same
+* for every instance of a build, so the images are built once and are
+* then shared by every injection into that build.
+*/
+struct InjectorPatchImages {
+  struct PatchImage entry_hijack_image;
+  struct PatchImage payload_image;
+  struct PatchImage cleanup_image;
+};
 
 struct InjectorPatches {
   struct BufferPatch entry_hijack_patch;
@@ -42,13 +54,25 @@ struct InjectorPatches {
   struct BufferPatch cleanup_patch;
 };
 
-struct InjectorPatches* InjectorPatches_Init(
-    struct InjectorPatches* injector_patches,
+/* Returns NULL on failure, in which case nothing needs to be deinited. */
+struct InjectorPatchImages* InjectorPatchImages_Init(
+    struct InjectorPatchImages* patch_images,
     const struct PeHeader* pe_header,
-    const PROCESS_INFORMATION* process_info,
     enum GameVersion game_version
 );
 
+void InjectorPatchImages_Deinit(struct InjectorPatchImages* patch_images);
+
+/*
+* Reads the original data that the images replace in one game process.
+* Returns NULL on failure, in which case nothing needs to be deinited.
+*/
+struct InjectorPatches* InjectorPatches_Init(
+    struct InjectorPatches* injector_patches,
+    const struct InjectorPatchImages* patch_images,
+    const struct RemoteProcess* remote_process
+);
+
 void InjectorPatches_Deinit(struct InjectorPatches* injector_patches);
 
 #endif /* SGGLDKL_PATCH_HELPER_INJECTOR_PATCHES_H_ */
@@ -0,0 +1,158 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "load_library_thread.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "../asm_x86_macro.h"
+
+static const unsigned char kFuncEnd[] = {
+  0x90, 0x90, 0x90, 0x90, 0x90, 0x90, 0x90, 0x90
+};
+
+__declspec(naked) static DWORD __stdcall LoadLibraryThreadFunc(
+    struct LoadLibraryThreadData* data
+) {
+  /* Function prologue */
+  ASM_X86_01(push ebx);
+  ASM_X86_01(push esi);
+  ASM_X86_01(push edi);
+
+  /*
+  * Stack:
+  * 16: data
+  * 12: return address
+  * 8 to 0: saved registers
+  *
+  * ebx points to the data, esi points to the current entry, and edi
+  * counts the libraries.
+  */
+  ASM_X86_02(mov ebx, dword ptr [esp + 16]);
+  ASM_X86_02(lea esi, [ebx + 16]);
+  ASM_X86_02(xor edi, edi);
+
+ASM_X86_LABEL(LoadLibraryThreadFunc_CheckNextLibrary)
+  ASM_X86_02(cmp edi, dword ptr [ebx + 12]);
+  ASM_X86_01(jae LoadLibraryThreadFunc_End);
+
+  /* lib_load_start_tick = GetTickCount(); */
+  ASM_X86_01(call dword ptr [ebx + 8]);
+  ASM_X86_02(mov dword ptr [esi + 12], eax);
+
+  /* lib_module = LoadLibraryW(lib_path); */
+  ASM_X86_01(push dword ptr [esi]);
+  ASM_X86_01(call dword ptr [ebx]);
+  ASM_X86_02(mov dword ptr [esi + 4], eax);
+
+  /* lib_last_error = GetLastError(); */
+  ASM_X86_01(call dword ptr [ebx + 4]);
+  ASM_X86_02(mov dword ptr [esi + 8], eax);
+
+  /* lib_load_end_tick = GetTickCount(); */
+  ASM_X86_01(call dword ptr [ebx + 8]);
+  ASM_X86_02(mov dword ptr [esi + 16], eax);
+
+  ASM_X86_01(inc edi);
+  ASM_X86_02(add esi, 20);
+  ASM_X86_01(jmp LoadLibraryThreadFunc_CheckNextLibrary);
+
+ASM_X86_LABEL(LoadLibraryThreadFunc_End)
+  /* Exit with the number of libraries. */
+  ASM_X86_02(mov eax, edi);
+
+  /* Function epilogue */
+  ASM_X86_01(pop edi);
+  ASM_X86_01(pop esi);
+  ASM_X86_01(pop ebx);
+  ASM_X86_01(ret 4);
+
+  /* Hex for 8 0x90, which is used to detect the end of the function. */
+  ASM_X86_01(nop);
+  ASM_X86_01(nop);
+  ASM_X86_01(nop);
+  ASM_X86_01(nop);
+  ASM_X86_01(nop);
+  ASM_X86_01(nop);
+  ASM_X86_01(nop);
+  ASM_X86_01(nop);
+}
+
+static void InitFuncSize(size_t* func_size) {
+  const unsigned char* func_bytes;
+  int memcmp_result;
+
+  func_bytes = (const unsigned char*) &LoadLibraryThreadFunc;
+
+  do {
+    memcmp_result = memcmp(
+        &func_bytes[*func_size],
+        kFuncEnd,
+        sizeof(kFuncEnd)
+    );
+
+    *func_size += 1;
+  } while (memcmp_result != 0);
+
+  *func_size -= 1;
+}
+
+int LoadLibraryThread_InitFuncs(struct LoadLibraryThreadData* data) {
+  HMODULE kernel32_module;
+
+  /*
+  * The addresses are taken directly from kernel32, which is mapped at
+  * the same address in the game process.
+  */
+  kernel32_module = GetModuleHandleA("kernel32.dll");
+
+  data->LoadLibraryW_ptr = (HMODULE (WINAPI*)(LPCWSTR)) GetProcAddress(
+      kernel32_module,
+      "LoadLibraryW"
+  );
+  data->GetLastError_ptr = &GetLastError;
+  data->GetTickCount_ptr = &GetTickCount;
+
+  return data->LoadLibraryW_ptr != NULL;
+}
+
+const unsigned char* LoadLibraryThread_GetCode(void) {
+  return (const unsigned char*) &LoadLibraryThreadFunc;
+}
+
+size_t LoadLibraryThread_GetCodeSize(void) {
+  static size_t func_size = 0;
+
+  if (func_size == 0) {
+    InitFuncSize(&func_size);
+  }
+
+  return func_size;
+}
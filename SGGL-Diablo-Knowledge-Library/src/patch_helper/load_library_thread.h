@@ -0,0 +1,87 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_PATCH_HELPER_LOAD_LIBRARY_THREAD_H_
+#define SGGLDKL_PATCH_HELPER_LOAD_LIBRARY_THREAD_H_
+
+#include <stddef.h>
+#include <windows.h>
+
+/*
+* This struct must be completely synced with the data accessed in
+* load_library_thread->LoadLibraryThreadFunc. The thread function
+* receives a pointer to the data, which is immediately followed by
+* num_libs entries.
+*
+* 0: LoadLibraryW
+* 4: GetLastError
+* 8: GetTickCount
+* 12: num_libs
+* 16: the entries, 20 bytes each
+*/
+#pragma pack(push, 1)
+struct LoadLibraryThreadData {
+  HMODULE (WINAPI *LoadLibraryW_ptr)(LPCWSTR);
+  DWORD (WINAPI *GetLastError_ptr)(void);
+  DWORD (WINAPI *GetTickCount_ptr)(void);
+  size_t num_libs;
+};
+
+/*
+* 0: lib_path, needs to be inited by SGGL
+* 4: lib_module, can be read by SGGL
+* 8: lib_last_error, can be read by SGGL
+* 12: lib_load_start_tick, can be read by SGGL
+* 16: lib_load_end_tick, can be read by SGGL
+*/
+struct LoadLibraryThreadEntry {
+  const wchar_t* lib_path;
+  HMODULE lib_module;
+  DWORD lib_last_error;
+  DWORD lib_load_start_tick;
+  DWORD lib_load_end_tick;
+};
+#pragma pack(pop)
+
+/*
+* Sets the Windows function pointers used by the thread function.
+* Returns zero if LoadLibraryW is not implemented.
+*/
+int LoadLibraryThread_InitFuncs(struct LoadLibraryThreadData* data);
+
+/*
+* The code of the thread function, which loads every library in order
+* and exits with the number of libraries it went through. The code is
+* position independent, so it can be copied as is into a game process.
+*/
+const unsigned char* LoadLibraryThread_GetCode(void);
+
+size_t LoadLibraryThread_GetCodeSize(void);
+
+#endif /* SGGLDKL_PATCH_HELPER_LOAD_LIBRARY_THREAD_H_ */
@@ -54,101 +54,205 @@ __declspec(naked) static void __stdcall PayloadFunc(void** top_of_stack) {
   * -20: lib_path_ptr, data inside can be modified by SGGL
   * -24: is_ready_to_execute, can be modified by SGGL
   * -28: is_ready_to_exit, can be modified by SGGL
-  * -32 to -64: reserved, for variables
+  * -32: shared_mapping_handle, needs to be inited by SGGL
+  * -36: shared_control_block, can be read by SGGL
+  * -40: lib_module, can be read by SGGL
+  * -44: lib_last_error, can be read by SGGL
+  * -48: lib_load_start_tick, can be read by SGGL
+  * -52: lib_load_end_tick, can be read by SGGL
+  * -56 to -64: reserved, for variables
   * -68: VirtualFree
   * -72: VirtualAlloc
   * -76: SuspendThread
   * -80: GetCurrentThread
   * -84: LoadLibraryA
-  * -88 to -128: reserved, for kernel functions
+  * -88: MapViewOfFile
+  * -92: UnmapViewOfFile
+  * -96: Sleep
+  * -100: LoadLibraryW, NULL if the path is multibyte
+  * -104: GetTickCount
+  * -108: GetLastError
+  * -112 to -128: reserved, for kernel functions
   * -132 to -192: reserved, for local jump offsets
+  *
+  * The stack data is accessed through ebx, which points to -192. This
+  * allows the stack data to be moved into the shared control block,
+  * where park_count is at +192 and release_count is at +196.
   */
   ASM_X86_02(sub esp, 192);
+  ASM_X86_02(mov ebx, esp);
 
   /*
   * This must occur before the *top_of_stack is init to prevent
   * infinite loop race condition!
   */
-  ASM_X86_02(mov dword ptr [ebp - 24], 0);
+  ASM_X86_02(mov dword ptr [ebx + 168], 0);
 
   /* *top_of_stack = esp; */
   ASM_X86_02(mov esi, dword ptr [ebp + 36]);
   ASM_X86_02(mov dword ptr [esi], esp);
 
 ASM_X86_LABEL(SpinlockWaitForInitReady)
-  ASM_X86_02(cmp dword ptr [ebp - 24], 0);
+  ASM_X86_02(cmp dword ptr [ebx + 168], 0);
   ASM_X86_01(je SpinlockWaitForInitReady);
 
   /* is_lib_resize_needed = 1; */
-  ASM_X86_02(mov dword ptr [ebp - 12], 1);
+  ASM_X86_02(mov dword ptr [ebx + 180], 1);
 
   /* is_ready_to_exit = 0; */
-  ASM_X86_02(mov dword ptr [ebp - 28], 0);
+  ASM_X86_02(mov dword ptr [ebx + 164], 0);
 
   /* current_thread_handle = GetCurrentThread(); */
-  ASM_X86_01(call dword ptr [ebp - 80]);
-  ASM_X86_02(mov dword ptr [ebp - 8], eax);
+  ASM_X86_01(call dword ptr [ebx + 112]);
+  ASM_X86_02(mov dword ptr [ebx + 184], eax);
 
   /* lib_path_size = 32; */
-  ASM_X86_02(mov dword ptr [ebp - 16], 32);
+  ASM_X86_02(mov dword ptr [ebx + 176], 32);
+
+  /* shared_control_block = NULL; */
+  ASM_X86_02(mov dword ptr [ebx + 156], 0);
+
+  /* Use the stack transport if SGGL did not provide a file mapping. */
+  ASM_X86_02(cmp dword ptr [ebx + 160], 0);
+  ASM_X86_01(je PayloadFunc_AllocPath);
+
+  ASM_X86_01(push 0);
+  ASM_X86_01(push 0);
+  ASM_X86_01(push 0);
+  ASM_X86_01(push 0x00000002);             /* FILE_MAP_WRITE */
+  ASM_X86_01(push dword ptr [ebx + 160]);  /* shared_mapping_handle */
+  ASM_X86_01(call dword ptr [ebx + 104]);  /* MapViewOfFile(...); */
+
+  ASM_X86_02(test eax, eax);
+  ASM_X86_01(jz PayloadFunc_AnnounceTransport);
+
+  /* shared_control_block = MapViewOfFile(...); */
+  ASM_X86_02(mov dword ptr [ebx + 156], eax);
+
+  /* Move the stack data into the shared control block. */
+  ASM_X86_02(mov edi, eax);
+  ASM_X86_02(mov esi, ebx);
+  ASM_X86_02(mov ecx, 48);                 /* 192 / 4 */
+  ASM_X86_01(cld);
+  ASM_X86_01(rep movsd);
+  ASM_X86_02(mov ebx, eax);
+
+  /*
+  * Suspend once, so that SGGL can determine which transport is used
+  * by reading shared_control_block from the stack.
+  */
+ASM_X86_LABEL(PayloadFunc_AnnounceTransport)
+  ASM_X86_01(push dword ptr [ebp - 8]);
+  ASM_X86_01(call dword ptr [ebp - 76]);   /* SuspendThread(...); */
 
   ASM_X86_01(jmp PayloadFunc_AllocPath);
 
 ASM_X86_LABEL(PayloadFunc_ReallocPath)
   /* Free lib_path_ptr for reallocation. */
-  ASM_X86_01(push 0x00000800);             /* MEM_RELEASE */
+  ASM_X86_01(push 0x00008000);             /* MEM_RELEASE */
   ASM_X86_01(push 0);
-  ASM_X86_01(push dword ptr [ebp - 20]);   /* lib_path_ptr */
-  ASM_X86_01(call dword ptr [ebp - 68]);   /* VirtualFree(...); */
+  ASM_X86_01(push dword ptr [ebx + 172]);  /* lib_path_ptr */
+  ASM_X86_01(call dword ptr [ebx + 124]);  /* VirtualFree(...); */
 
   /* lib_path_size *= 2; */
-  ASM_X86_02(shl dword ptr [ebp - 16], 1);
+  ASM_X86_02(shl dword ptr [ebx + 176], 1);
 
   /* Allocate space for the path. */
 ASM_X86_LABEL(PayloadFunc_AllocPath)
   ASM_X86_01(push 0x00000004);             /* PAGE_READWRITE */
   ASM_X86_01(push 0x00003000);             /* MEM_COMMIT | MEM_RESERVE */
-  ASM_X86_01(push dword ptr [ebp - 16]);   /* lib_path_size */
+  ASM_X86_01(push dword ptr [ebx + 176]);  /* lib_path_size */
   ASM_X86_01(push 0);                      /* NULL */
-  ASM_X86_01(call dword ptr [ebp - 72]);   /* VirtualAlloc(...); */
+  ASM_X86_01(call dword ptr [ebx + 120]);  /* VirtualAlloc(...); */
 
   /* lib_path_ptr = VirtualAlloc(...); */
-  ASM_X86_02(mov dword ptr [ebp - 20], eax);
+  ASM_X86_02(mov dword ptr [ebx + 172], eax);
 
   /* is_lib_resize_needed = 0; */
-  ASM_X86_02(mov dword ptr [ebp - 12], 0);
+  ASM_X86_02(mov dword ptr [ebx + 180], 0);
 
-  /* Suspend current thread until SGGL wakes it up. */
+  /* Wait until SGGL wakes up the thread. */
 ASM_X86_LABEL(PayloadFunc_WaitForNextIteration)
-  ASM_X86_01(push dword ptr [ebp - 8]);
-  ASM_X86_01(call dword ptr [ebp - 76]);   /* SuspendThread(...); */
+  ASM_X86_02(cmp dword ptr [ebx + 156], 0);
+  ASM_X86_01(jne PayloadFunc_ParkShared);
+
+  ASM_X86_01(push dword ptr [ebx + 184]);
+  ASM_X86_01(call dword ptr [ebx + 116]);  /* SuspendThread(...); */
 
+  ASM_X86_01(jmp PayloadFunc_CheckNextIteration);
+
+  /* Park on the shared control block: ++park_count. */
+ASM_X86_LABEL(PayloadFunc_ParkShared)
+  ASM_X86_01(lock inc dword ptr [ebx + 192]);
+
+  /* Spin until release_count == park_count. */
+ASM_X86_LABEL(PayloadFunc_SpinShared)
+  ASM_X86_01(push 0);
+  ASM_X86_01(call dword ptr [ebx + 96]);   /* Sleep(0); */
+
+  ASM_X86_02(mov eax, dword ptr [ebx + 192]);
+  ASM_X86_02(cmp eax, dword ptr [ebx + 196]);
+  ASM_X86_01(jne PayloadFunc_SpinShared);
+
+ASM_X86_LABEL(PayloadFunc_CheckNextIteration)
   /* Check if reallocation is needed. */
-  ASM_X86_02(cmp dword ptr [ebp - 12], 0);
+  ASM_X86_02(cmp dword ptr [ebx + 180], 0);
   ASM_X86_01(jne PayloadFunc_ReallocPath);
 
   /* Check num_libs and exit if no more libs left. */
-  ASM_X86_02(cmp dword ptr [ebp - 4], 0);
+  ASM_X86_02(cmp dword ptr [ebx + 188], 0);
   ASM_X86_01(je PayloadFunc_End);
 
-  /* Load library. */
-  ASM_X86_01(push dword ptr [ebp - 20]);
-  ASM_X86_01(call dword ptr [ebp - 84]);   /* LoadLibraryA(...); */
+  /* lib_load_start_tick = GetTickCount(); */
+  ASM_X86_01(call dword ptr [ebx + 88]);
+  ASM_X86_02(mov dword ptr [ebx + 144], eax);
+
+  /* Load library, using LoadLibraryW if SGGL provided it. */
+  ASM_X86_01(push dword ptr [ebx + 172]);
+
+  ASM_X86_02(cmp dword ptr [ebx + 92], 0);
+  ASM_X86_01(je PayloadFunc_LoadLibraryA);
+
+  ASM_X86_01(call dword ptr [ebx + 92]);   /* LoadLibraryW(...); */
+  ASM_X86_01(jmp PayloadFunc_LibraryLoaded);
 
-  ASM_X86_01(dec dword ptr [ebp - 4]);
+ASM_X86_LABEL(PayloadFunc_LoadLibraryA)
+  ASM_X86_01(call dword ptr [ebx + 108]);  /* LoadLibraryA(...); */
+
+ASM_X86_LABEL(PayloadFunc_LibraryLoaded)
+  /* lib_module = LoadLibrary(...); */
+  ASM_X86_02(mov dword ptr [ebx + 152], eax);
+
+  /* lib_last_error = GetLastError(); */
+  ASM_X86_01(call dword ptr [ebx + 84]);
+  ASM_X86_02(mov dword ptr [ebx + 148], eax);
+
+  /* lib_load_end_tick = GetTickCount(); */
+  ASM_X86_01(call dword ptr [ebx + 88]);
+  ASM_X86_02(mov dword ptr [ebx + 140], eax);
+
+  ASM_X86_01(dec dword ptr [ebx + 188]);
   ASM_X86_01(jmp PayloadFunc_WaitForNextIteration);
 
 ASM_X86_LABEL(PayloadFunc_End)
   /* Free lib_path_ptr. */
-  ASM_X86_01(push 0x00000800);             /* MEM_RELEASE */
+  ASM_X86_01(push 0x00008000);             /* MEM_RELEASE */
   ASM_X86_01(push 0);
-  ASM_X86_01(push dword ptr [ebp - 20]);   /* lib_path_ptr */
-  ASM_X86_01(call dword ptr [ebp - 68]);   /* VirtualFree(...); */
+  ASM_X86_01(push dword ptr [ebx + 172]);  /* lib_path_ptr */
+  ASM_X86_01(call dword ptr [ebx + 124]);  /* VirtualFree(...); */
+
+  /* Unmap the shared control block, if it is used. */
+  ASM_X86_02(cmp dword ptr [ebx + 156], 0);
+  ASM_X86_01(je PayloadFunc_JumpToCleanup);
+
+  ASM_X86_01(push ebx);
+  ASM_X86_01(call dword ptr [ebx + 100]);  /* UnmapViewOfFile(...); */
 
   /*
   * Jump to the cleanup function. These are 5 bytes of dummies to
   * ensure there is space for the 4 byte jump op.
   */
+ASM_X86_LABEL(PayloadFunc_JumpToCleanup)
   ASM_X86_01(int 3);
   ASM_X86_01(int 3);
   ASM_X86_01(int 3);
@@ -185,43 +289,45 @@ static void InitFuncSize(size_t* func_size) {
   *func_size -= 1;
 }
 
-struct BufferPatch* PayloadPatch_Init(
-    struct BufferPatch* payload_patch,
+struct PatchImage* PayloadPatch_InitImage(
+    struct PatchImage* payload_image,
     void* (*patch_address)(void),
-    void* (*cleanup_func_address)(void),
-    const PROCESS_INFORMATION* process_info
+    void* (*cleanup_func_address)(void)
 ) {
   unsigned char* cleanup_func_offset;
   size_t i_end_jmp_op;
 
-  BufferPatch_Init(
-      payload_patch,
+  payload_image = PatchImage_Init(
+      payload_image,
       (void*) patch_address,
       PayloadPatch_GetSize(),
-      (void*) &PayloadFunc,
-      process_info
+      (void*) &PayloadFunc
   );
 
+  if (payload_image == NULL) {
+    return NULL;
+  }
+
   /* Set the last bytes of the ppatch buffer to jump to the cleanup function. */
   i_end_jmp_op = PayloadPatch_GetSize() - sizeof(void*) - 1;
 
-  payload_patch->patch_buffer[i_end_jmp_op] = 0xE9;
+  payload_image->patch_buffer[i_end_jmp_op] = 0xE9;
 
   cleanup_func_offset = (unsigned char*) cleanup_func_address
       - (size_t) patch_address
       - PayloadPatch_GetSize();
 
   memcpy(
-      &payload_patch->patch_buffer[i_end_jmp_op + 1],
+      &payload_image->patch_buffer[i_end_jmp_op + 1],
       &cleanup_func_offset,
       sizeof(cleanup_func_offset)
   );
 
-  return payload_patch;
+  return payload_image;
 }
 
-void PayloadPatch_Deinit(struct BufferPatch* payload_patch) {
-  BufferPatch_Deinit(payload_patch);
+void PayloadPatch_DeinitImage(struct PatchImage* payload_image) {
+  PatchImage_Deinit(payload_image);
 }
 
 size_t PayloadPatch_GetSize(void) {
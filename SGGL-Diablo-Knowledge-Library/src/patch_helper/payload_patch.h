@@ -35,14 +35,13 @@
 
 #include "buffer_patch.h"
 
-struct BufferPatch* PayloadPatch_Init(
-    struct BufferPatch* payload_patch,
+struct PatchImage* PayloadPatch_InitImage(
+    struct PatchImage* payload_image,
     void* (*patch_address)(void),
-    void* (*cleanup_func_address)(void),
-    const PROCESS_INFORMATION* process_info
+    void* (*cleanup_func_address)(void)
 );
 
-void PayloadPatch_Deinit(struct BufferPatch* payload_patch);
+void PayloadPatch_DeinitImage(struct PatchImage* payload_image);
 
 size_t PayloadPatch_GetSize(void);
 
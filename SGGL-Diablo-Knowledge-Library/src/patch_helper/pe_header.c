@@ -29,23 +29,169 @@
 
 #include "pe_header.h"
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "../helper/encoding.h"
 #include "../helper/error_handling.h"
 
 enum Constant {
   PE_HEADER_PTR_OFFSET = 0x3C,
-  ENTRY_POINT_ADDRESS_OFFSET = 0x28
+  ENTRY_POINT_ADDRESS_OFFSET = 0x28,
+
+  /* The headers of the game executables fit well within this size. */
+  PE_HEADER_READ_SIZE = 4096
 };
 
+/*
+* Outputs the offset of the NT headers, checking that a header of the
+* specified size fits in the buffer from that offset.
+*/
+static int FindNtHeadersOffset(
+    size_t* nt_headers_offset,
+    const unsigned char* buffer,
+    size_t buffer_size,
+    size_t header_size
+) {
+  WORD dos_signature;
+  LONG e_lfanew;
+
+  if (buffer_size < sizeof(IMAGE_DOS_HEADER)) {
+    return 0;
+  }
+
+  /* The fields are copied out, as the buffer might not be aligned. */
+  memcpy(&dos_signature, buffer, sizeof(dos_signature));
+
+  if (dos_signature != IMAGE_DOS_SIGNATURE) {
+    return 0;
+  }
+
+  memcpy(&e_lfanew, buffer + PE_HEADER_PTR_OFFSET, sizeof(e_lfanew));
+
+  if (e_lfanew < 0
+      || buffer_size < header_size
+      || (size_t) e_lfanew > buffer_size - header_size) {
+    return 0;
+  }
+
+  *nt_headers_offset = e_lfanew;
+
+  return 1;
+}
+
+int PeHeader_ParseMachine(
+    WORD* machine,
+    const unsigned char* buffer,
+    size_t buffer_size
+) {
+  size_t nt_headers_offset;
+  DWORD nt_signature;
+  IMAGE_FILE_HEADER file_header;
+
+  if (!FindNtHeadersOffset(
+      &nt_headers_offset,
+      buffer,
+      buffer_size,
+      sizeof(nt_signature) + sizeof(file_header)
+  )) {
+    return 0;
+  }
+
+  memcpy(&nt_signature, buffer + nt_headers_offset, sizeof(nt_signature));
+
+  if (nt_signature != IMAGE_NT_SIGNATURE) {
+    return 0;
+  }
+
+  memcpy(
+      &file_header,
+      buffer + nt_headers_offset + sizeof(nt_signature),
+      sizeof(file_header)
+  );
+
+  *machine = file_header.Machine;
+
+  return 1;
+}
+
+int PeHeader_ParseNtHeaders(
+    IMAGE_NT_HEADERS* nt_headers,
+    const unsigned char* buffer,
+    size_t buffer_size
+) {
+  size_t nt_headers_offset;
+  IMAGE_OPTIONAL_HEADER* optional_header;
+  DWORD num_valid_data_directories;
+  DWORD num_data_directories_in_header;
+  DWORD i_data_directory;
+
+  if (!FindNtHeadersOffset(
+      &nt_headers_offset,
+      buffer,
+      buffer_size,
+      sizeof(*nt_headers)
+  )) {
+    return 0;
+  }
+
+  memcpy(nt_headers, buffer + nt_headers_offset, sizeof(*nt_headers));
+
+  if (nt_headers->Signature != IMAGE_NT_SIGNATURE
+      || nt_headers->FileHeader.SizeOfOptionalHeader
+          < offsetof(IMAGE_OPTIONAL_HEADER, DataDirectory)) {
+    return 0;
+  }
+
+  optional_header = &nt_headers->OptionalHeader;
+
+  if (optional_header->Magic != IMAGE_NT_OPTIONAL_HDR32_MAGIC
+      || optional_header->AddressOfEntryPoint >= optional_header->SizeOfImage
+      || optional_header->BaseOfData >= optional_header->SizeOfImage) {
+    return 0;
+  }
+
+  /*
+  * A shorter optional header leaves some of the copied data
+  * directories holding the bytes of the section table. Only the
+  * directories that are both counted and inside the optional header
+  * are kept.
+  */
+  num_data_directories_in_header = (DWORD) (
+      (nt_headers->FileHeader.SizeOfOptionalHeader
+          - offsetof(IMAGE_OPTIONAL_HEADER, DataDirectory))
+      / sizeof(IMAGE_DATA_DIRECTORY)
+  );
+
+  num_valid_data_directories = (optional_header->NumberOfRvaAndSizes
+      < num_data_directories_in_header)
+      ? optional_header->NumberOfRvaAndSizes
+      : num_data_directories_in_header;
+
+  for (i_data_directory = num_valid_data_directories;
+      i_data_directory < IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+      i_data_directory += 1) {
+    optional_header->DataDirectory[i_data_directory].VirtualAddress = 0;
+    optional_header->DataDirectory[i_data_directory].Size = 0;
+  }
+
+  return 1;
+}
+
 struct PeHeader* PeHeader_Init(
     struct PeHeader* pe_header,
     const wchar_t* file_path,
     size_t file_path_len
 ) {
-  char* mb_file_path;
-  LOADED_IMAGE* loaded_image;
+  char mb_file_path_buffer[MAX_PATH];
+  struct ConvertedString mb_file_path;
+  FILE* game_file_stream;
+  unsigned char* header_buffer;
+  size_t header_buffer_size;
+  struct PeHeader* result;
+
+  result = NULL;
 
   pe_header->file_path_len = file_path_len;
 
@@ -54,29 +200,95 @@ struct PeHeader* PeHeader_Init(
   );
 
   if (pe_header->file_path == NULL) {
-    ExitOnAllocationFailure();
+    RecordAllocationFailure();
+    return NULL;
+  }
+
+  wcscpy(pe_header->file_path, file_path);
+
+  header_buffer = malloc(PE_HEADER_READ_SIZE);
+
+  if (header_buffer == NULL) {
+    RecordAllocationFailure();
+    goto free_file_path;
   }
 
-  mb_file_path = ConvertWideToMultibyte(
-      NULL,
+  /*
+  * The multibyte path is used, as _wfopen is not implemented on
+  * Windows 9X.
+  */
+  ConvertWideToMultibyteInBuffer(
+      &mb_file_path,
+      mb_file_path_buffer,
+      sizeof(mb_file_path_buffer),
       file_path
   );
 
-  loaded_image = ImageLoad(mb_file_path, NULL);
+  if (mb_file_path.str == NULL) {
+    goto free_header_buffer;
+  }
 
-  memcpy(
+  game_file_stream = fopen(mb_file_path.str, "rb");
+
+  if (game_file_stream == NULL) {
+    RecordGeneralFailure(
+        L"The game file could not be opened.",
+        L"Could Not Open File"
+    );
+
+    goto free_mb_file_path;
+  }
+
+  /* A short read is left for the parser to reject. */
+  header_buffer_size = fread(
+      header_buffer,
+      sizeof(header_buffer[0]),
+      PE_HEADER_READ_SIZE,
+      game_file_stream
+  );
+
+  if (!PeHeader_ParseNtHeaders(
       &pe_header->nt_headers,
-      loaded_image->FileHeader,
+      header_buffer,
+      header_buffer_size
+  )) {
+    RecordGeneralFailure(
+        L"The PE header of the game file is truncated or malformed.",
+        L"Invalid PE Header"
+    );
+
+    goto close_game_file_stream;
+  }
+
+  /* The parser has already checked the offset. */
+  pe_header->nt_headers_offset = 0;
+
+  FindNtHeadersOffset(
+      &pe_header->nt_headers_offset,
+      header_buffer,
+      header_buffer_size,
       sizeof(pe_header->nt_headers)
   );
 
-unload_image:
-  ImageUnload(loaded_image);
+  result = pe_header;
+
+close_game_file_stream:
+  fclose(game_file_stream);
 
 free_mb_file_path:
-  free(mb_file_path);
+  ConvertedString_Deinit(&mb_file_path);
+
+free_header_buffer:
+  free(header_buffer);
+
+  if (result != NULL) {
+    return result;
+  }
+
+free_file_path:
+  PeHeader_Deinit(pe_header);
 
-  return pe_header;
+  return NULL;
 }
 
 void PeHeader_Deinit(struct PeHeader* pe_header) {
@@ -86,6 +298,26 @@ void PeHeader_Deinit(struct PeHeader* pe_header) {
   pe_header->file_path = NULL;
 }
 
+const IMAGE_DATA_DIRECTORY* PeHeader_GetDataDirectory(
+    const struct PeHeader* pe_header,
+    size_t i_data_directory
+) {
+  return &pe_header->nt_headers.OptionalHeader.DataDirectory[
+      i_data_directory
+  ];
+}
+
+void* PeHeader_GetHardDataDirectoryAddress(
+    const struct PeHeader* pe_header,
+    size_t i_data_directory
+) {
+  return (unsigned char*) pe_header->nt_headers.OptionalHeader.ImageBase
+      + pe_header->nt_headers_offset
+      + offsetof(IMAGE_NT_HEADERS, OptionalHeader)
+      + offsetof(IMAGE_OPTIONAL_HEADER, DataDirectory)
+      + i_data_directory * sizeof(IMAGE_DATA_DIRECTORY);
+}
+
 void* PeHeader_GetHardDataAddress(
     const struct PeHeader* pe_header
 ) {
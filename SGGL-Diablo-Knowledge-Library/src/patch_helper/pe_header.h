@@ -33,15 +33,17 @@
 #include <stddef.h>
 #include <wchar.h>
 #include <windows.h>
-#include <imagehlp.h>  /* This has to appear after windows.h */
 
 struct PeHeader {
   wchar_t* file_path;
   size_t file_path_len;
 
+  /* The offset of the NT headers from the start of the file. */
+  size_t nt_headers_offset;
   IMAGE_NT_HEADERS nt_headers;
 };
 
+/* Returns NULL on failure, in which case nothing needs to be deinited. */
 struct PeHeader* PeHeader_Init(
     struct PeHeader* pe_header,
     const wchar_t* file_path,
@@ -50,6 +52,43 @@ struct PeHeader* PeHeader_Init(
 
 void PeHeader_Deinit(struct PeHeader* pe_header);
 
+/*
+* Parses the NT headers from a buffer holding the start of a 32-bit PE
+* file. Every offset is checked against the buffer size, and the
+* entries past the number of data directories are zeroed. Returns zero
+* if the headers are truncated or malformed.
+*/
+int PeHeader_ParseNtHeaders(
+    IMAGE_NT_HEADERS* nt_headers,
+    const unsigned char* buffer,
+    size_t buffer_size
+);
+
+/*
+* Parses only the machine type from a buffer holding the start of a PE
+* file, so that the files of other architectures can be told apart from
+* malformed ones. Returns zero if the headers are truncated or malformed.
+*/
+int PeHeader_ParseMachine(
+    WORD* machine,
+    const unsigned char* buffer,
+    size_t buffer_size
+);
+
+const IMAGE_DATA_DIRECTORY* PeHeader_GetDataDirectory(
+    const struct PeHeader* pe_header,
+    size_t i_data_directory
+);
+
+/*
+* The address of the data directory entry in the headers of the loaded
+* image, for modifying the headers in the game process.
+*/
+void* PeHeader_GetHardDataDirectoryAddress(
+    const struct PeHeader* pe_header,
+    size_t i_data_directory
+);
+
 void* PeHeader_GetHardDataAddress(
     const struct PeHeader* pe_header
 );
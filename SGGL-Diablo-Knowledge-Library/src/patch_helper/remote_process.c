@@ -0,0 +1,703 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "remote_process.h"
+
+#include "../helper/error_handling.h"
+
+enum Constant {
+  /*
+  * How long a thread run in the game process is waited on. It is only
+  * expected to take long if a library hangs in its DllMain.
+  */
+  RUN_THREAD_TIMEOUT_MILLISECONDS = 60000
+};
+
+static int WindowsReadMemory(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    const void* address,
+    void* buffer,
+    size_t size,
+    size_t* num_bytes_read
+) {
+  BOOL is_read_process_memory_success;
+  SIZE_T num_bytes_read_process_memory;
+
+  is_read_process_memory_success = ReadProcessMemory(
+      process_info->hProcess,
+      address,
+      buffer,
+      size,
+      &num_bytes_read_process_memory
+  );
+
+  if (num_bytes_read != NULL) {
+    *num_bytes_read = num_bytes_read_process_memory;
+  }
+
+  if (!is_read_process_memory_success) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"ReadProcessMemory",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+static int WindowsWriteMemory(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* address,
+    const void* buffer,
+    size_t size,
+    size_t* num_bytes_written
+) {
+  BOOL is_write_process_memory_success;
+  SIZE_T num_bytes_written_process_memory;
+
+  is_write_process_memory_success = WriteProcessMemory(
+      process_info->hProcess,
+      address,
+      buffer,
+      size,
+      &num_bytes_written_process_memory
+  );
+
+  if (num_bytes_written != NULL) {
+    *num_bytes_written = num_bytes_written_process_memory;
+  }
+
+  if (!is_write_process_memory_success) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"WriteProcessMemory",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+static int WindowsProtectMemory(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* address,
+    size_t size,
+    DWORD new_protect,
+    DWORD* old_protect
+) {
+  BOOL is_virtual_protect_ex_success;
+
+  is_virtual_protect_ex_success = VirtualProtectEx(
+      process_info->hProcess,
+      address,
+      size,
+      new_protect,
+      old_protect
+  );
+
+  if (!is_virtual_protect_ex_success) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"VirtualProtectEx",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+static int WindowsSuspendThread(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    DWORD* previous_suspend_count
+) {
+  *previous_suspend_count = SuspendThread(process_info->hThread);
+
+  if (*previous_suspend_count == (DWORD) -1) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"SuspendThread",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+static int WindowsResumeThread(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    DWORD* previous_suspend_count
+) {
+  *previous_suspend_count = ResumeThread(process_info->hThread);
+
+  if (*previous_suspend_count == (DWORD) -1) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"ResumeThread",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+/*
+* Returns the address of a kernel32 function that is not implemented
+* on every version of Windows, so that it is not imported statically.
+* Records a failure if it is not found.
+*/
+static FARPROC GetOptionalKernelFunc(const char* func_name) {
+  FARPROC func;
+
+  func = GetProcAddress(GetModuleHandleA("kernel32.dll"), func_name);
+
+  if (func == NULL) {
+    RecordGeneralFailure(
+        L"The operation is not supported on this version of Windows.",
+        L"Unsupported Operation"
+    );
+  }
+
+  return func;
+}
+
+typedef void* (WINAPI *VirtualAllocExFunc)(
+    HANDLE,
+    void*,
+    SIZE_T,
+    DWORD,
+    DWORD
+);
+
+/*
+* Walks the regions at and above min_address, in the same way as
+* Detours, and allocates the first free one that is large enough. The
+* game process could take a region between the query and the
+* allocation, so the walk continues if the allocation fails.
+*/
+static void* AllocateMemoryAbove(
+    VirtualAllocExFunc virtual_alloc_ex,
+    HANDLE process_handle,
+    void* min_address,
+    size_t size,
+    DWORD protect
+) {
+  SYSTEM_INFO system_info;
+  MEMORY_BASIC_INFORMATION memory_info;
+  ULONG_PTR granularity;
+  ULONG_PTR max_address;
+  ULONG_PTR address;
+  ULONG_PTR next_address;
+  ULONG_PTR region_end;
+  void* allocated_address;
+
+  GetSystemInfo(&system_info);
+
+  granularity = system_info.dwAllocationGranularity;
+  max_address = (ULONG_PTR) system_info.lpMaximumApplicationAddress;
+
+  /* Allocations must start on the allocation granularity. */
+  address = ((ULONG_PTR) min_address + granularity - 1)
+      & ~(granularity - 1);
+
+  while (address < max_address) {
+    if (VirtualQueryEx(
+        process_handle,
+        (void*) address,
+        &memory_info,
+        sizeof(memory_info)
+    ) == 0) {
+      break;
+    }
+
+    region_end = (ULONG_PTR) memory_info.BaseAddress
+        + memory_info.RegionSize;
+
+    if (memory_info.State == MEM_FREE && region_end - address >= size) {
+      allocated_address = virtual_alloc_ex(
+          process_handle,
+          (void*) address,
+          size,
+          MEM_COMMIT | MEM_RESERVE,
+          protect
+      );
+
+      if (allocated_address != NULL) {
+        return allocated_address;
+      }
+    }
+
+    next_address = (region_end + granularity - 1) & ~(granularity - 1);
+
+    /* The end of the address space wraps around. */
+    if (next_address <= address) {
+      break;
+    }
+
+    address = next_address;
+  }
+
+  return NULL;
+}
+
+static int WindowsAllocateMemory(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* min_address,
+    size_t size,
+    DWORD protect,
+    void** address
+) {
+  VirtualAllocExFunc virtual_alloc_ex;
+
+  virtual_alloc_ex = (VirtualAllocExFunc) GetOptionalKernelFunc(
+      "VirtualAllocEx"
+  );
+
+  if (virtual_alloc_ex == NULL) {
+    return 0;
+  }
+
+  if (min_address != NULL) {
+    *address = AllocateMemoryAbove(
+        virtual_alloc_ex,
+        process_info->hProcess,
+        min_address,
+        size,
+        protect
+    );
+
+    if (*address == NULL) {
+      RecordGeneralFailure(
+          L"No free memory was found above the requested address.",
+          L"Allocation Failed"
+      );
+
+      return 0;
+    }
+
+    return 1;
+  }
+
+  *address = virtual_alloc_ex(
+      process_info->hProcess,
+      NULL,
+      size,
+      MEM_COMMIT | MEM_RESERVE,
+      protect
+  );
+
+  if (*address == NULL) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"VirtualAllocEx",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+static int WindowsFreeMemory(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* address
+) {
+  typedef BOOL (WINAPI *VirtualFreeExFunc)(HANDLE, void*, SIZE_T, DWORD);
+
+  VirtualFreeExFunc virtual_free_ex;
+
+  virtual_free_ex = (VirtualFreeExFunc) GetOptionalKernelFunc(
+      "VirtualFreeEx"
+  );
+
+  if (virtual_free_ex == NULL) {
+    return 0;
+  }
+
+  if (!virtual_free_ex(process_info->hProcess, address, 0, MEM_RELEASE)) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"VirtualFreeEx",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+static int WindowsQueueApc(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* func,
+    ULONG_PTR param
+) {
+  typedef DWORD (WINAPI *QueueUserApcFunc)(
+      PAPCFUNC,
+      HANDLE,
+      ULONG_PTR
+  );
+
+  QueueUserApcFunc queue_user_apc;
+
+  queue_user_apc = (QueueUserApcFunc) GetOptionalKernelFunc(
+      "QueueUserAPC"
+  );
+
+  if (queue_user_apc == NULL) {
+    return 0;
+  }
+
+  if (!queue_user_apc((PAPCFUNC) func, process_info->hThread, param)) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"QueueUserAPC",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+static int WindowsRunThread(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* func,
+    void* param,
+    DWORD* exit_code
+) {
+  typedef HANDLE (WINAPI *CreateRemoteThreadFunc)(
+      HANDLE,
+      SECURITY_ATTRIBUTES*,
+      SIZE_T,
+      LPTHREAD_START_ROUTINE,
+      void*,
+      DWORD,
+      DWORD*
+  );
+
+  CreateRemoteThreadFunc create_remote_thread;
+  HANDLE thread_handle;
+  DWORD thread_id;
+  HANDLE wait_handles[2];
+  DWORD wait_result;
+  int is_success;
+
+  create_remote_thread = (CreateRemoteThreadFunc) GetOptionalKernelFunc(
+      "CreateRemoteThread"
+  );
+
+  if (create_remote_thread == NULL) {
+    return 0;
+  }
+
+  thread_handle = create_remote_thread(
+      process_info->hProcess,
+      NULL,
+      0,
+      (LPTHREAD_START_ROUTINE) func,
+      param,
+      0,
+      &thread_id
+  );
+
+  if (thread_handle == NULL) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"CreateRemoteThread",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  is_success = 0;
+
+  /*
+  * The game process is waited on as well, so that a crash while the
+  * thread runs is not mistaken for a hang.
+  */
+  wait_handles[0] = thread_handle;
+  wait_handles[1] = process_info->hProcess;
+
+  wait_result = WaitForMultipleObjects(
+      2,
+      wait_handles,
+      FALSE,
+      RUN_THREAD_TIMEOUT_MILLISECONDS
+  );
+
+  if (wait_result == WAIT_FAILED) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"WaitForMultipleObjects",
+        GetLastError()
+    );
+
+    goto close_thread_handle;
+  } else if (wait_result == WAIT_TIMEOUT) {
+    RecordGeneralFailure(
+        L"The thread in the game process did not exit in time.",
+        L"Remote Thread Timed Out"
+    );
+
+    goto close_thread_handle;
+  } else if (wait_result != WAIT_OBJECT_0) {
+    RecordGeneralFailure(
+        L"The game exited while the thread in it was running.",
+        L"Game Exited"
+    );
+
+    goto close_thread_handle;
+  }
+
+  if (!GetExitCodeThread(thread_handle, exit_code)) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"GetExitCodeThread",
+        GetLastError()
+    );
+
+    goto close_thread_handle;
+  }
+
+  is_success = 1;
+
+close_thread_handle:
+  CloseHandle(thread_handle);
+
+  return is_success;
+}
+
+static int WindowsWaitForExit(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    DWORD timeout_milliseconds,
+    int* is_exited
+) {
+  DWORD wait_result;
+
+  wait_result = WaitForSingleObject(
+      process_info->hProcess,
+      timeout_milliseconds
+  );
+
+  if (wait_result == WAIT_FAILED) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"WaitForSingleObject",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  *is_exited = (wait_result == WAIT_OBJECT_0);
+
+  return 1;
+}
+
+static const struct RemoteProcessOps kWindowsRemoteProcessOps = {
+  &WindowsReadMemory,
+  &WindowsWriteMemory,
+  &WindowsProtectMemory,
+  &WindowsSuspendThread,
+  &WindowsResumeThread,
+  &WindowsAllocateMemory,
+  &WindowsFreeMemory,
+  &WindowsQueueApc,
+  &WindowsRunThread,
+  &WindowsWaitForExit
+};
+
+const struct RemoteProcessOps* RemoteProcessOps_GetWindows(void) {
+  return &kWindowsRemoteProcessOps;
+}
+
+void RemoteProcess_Init(
+    struct RemoteProcess* remote_process,
+    const struct RemoteProcessOps* ops,
+    void* ops_context,
+    const PROCESS_INFORMATION* process_info
+) {
+  remote_process->ops = ops;
+  remote_process->ops_context = ops_context;
+  remote_process->process_info = process_info;
+}
+
+int RemoteProcess_ReadMemory(
+    const struct RemoteProcess* remote_process,
+    const void* address,
+    void* buffer,
+    size_t size,
+    size_t* num_bytes_read
+) {
+  return remote_process->ops->read_memory_func_ptr(
+      remote_process->ops_context,
+      remote_process->process_info,
+      address,
+      buffer,
+      size,
+      num_bytes_read
+  );
+}
+
+int RemoteProcess_WriteMemory(
+    const struct RemoteProcess* remote_process,
+    void* address,
+    const void* buffer,
+    size_t size,
+    size_t* num_bytes_written
+) {
+  return remote_process->ops->write_memory_func_ptr(
+      remote_process->ops_context,
+      remote_process->process_info,
+      address,
+      buffer,
+      size,
+      num_bytes_written
+  );
+}
+
+int RemoteProcess_ProtectMemory(
+    const struct RemoteProcess* remote_process,
+    void* address,
+    size_t size,
+    DWORD new_protect,
+    DWORD* old_protect
+) {
+  return remote_process->ops->protect_memory_func_ptr(
+      remote_process->ops_context,
+      remote_process->process_info,
+      address,
+      size,
+      new_protect,
+      old_protect
+  );
+}
+
+int RemoteProcess_SuspendThread(
+    const struct RemoteProcess* remote_process,
+    DWORD* previous_suspend_count
+) {
+  return remote_process->ops->suspend_thread_func_ptr(
+      remote_process->ops_context,
+      remote_process->process_info,
+      previous_suspend_count
+  );
+}
+
+int RemoteProcess_ResumeThread(
+    const struct RemoteProcess* remote_process,
+    DWORD* previous_suspend_count
+) {
+  return remote_process->ops->resume_thread_func_ptr(
+      remote_process->ops_context,
+      remote_process->process_info,
+      previous_suspend_count
+  );
+}
+
+int RemoteProcess_AllocateMemory(
+    const struct RemoteProcess* remote_process,
+    void* min_address,
+    size_t size,
+    DWORD protect,
+    void** address
+) {
+  return remote_process->ops->allocate_memory_func_ptr(
+      remote_process->ops_context,
+      remote_process->process_info,
+      min_address,
+      size,
+      protect,
+      address
+  );
+}
+
+int RemoteProcess_FreeMemory(
+    const struct RemoteProcess* remote_process,
+    void* address
+) {
+  return remote_process->ops->free_memory_func_ptr(
+      remote_process->ops_context,
+      remote_process->process_info,
+      address
+  );
+}
+
+int RemoteProcess_QueueApc(
+    const struct RemoteProcess* remote_process,
+    void* func,
+    ULONG_PTR param
+) {
+  return remote_process->ops->queue_apc_func_ptr(
+      remote_process->ops_context,
+      remote_process->process_info,
+      func,
+      param
+  );
+}
+
+int RemoteProcess_RunThread(
+    const struct RemoteProcess* remote_process,
+    void* func,
+    void* param,
+    DWORD* exit_code
+) {
+  return remote_process->ops->run_thread_func_ptr(
+      remote_process->ops_context,
+      remote_process->process_info,
+      func,
+      param,
+      exit_code
+  );
+}
+
+int RemoteProcess_WaitForExit(
+    const struct RemoteProcess* remote_process,
+    DWORD timeout_milliseconds,
+    int* is_exited
+) {
+  return remote_process->ops->wait_for_exit_func_ptr(
+      remote_process->ops_context,
+      remote_process->process_info,
+      timeout_milliseconds,
+      is_exited
+  );
+}
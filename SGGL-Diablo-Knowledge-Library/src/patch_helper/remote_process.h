@@ -0,0 +1,232 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_PATCH_HELPER_REMOTE_PROCESS_H_
+#define SGGLDKL_PATCH_HELPER_REMOTE_PROCESS_H_
+
+#include <stddef.h>
+#include <windows.h>
+
+/*
+* The operations used to access the memory and the main thread of a
+* game process. Each operation returns zero on failure, after recording
+* the failure. The context is passed through unchanged, so that an
+* implementation other than the Windows one can keep its own state.
+*
+* The suspend and resume operations output the previous suspend count
+* of the thread, in the same way as SuspendThread and ResumeThread.
+*
+* The allocation, APC and thread operations are only implemented on
+* Windows NT, and fail on Windows 9X.
+*/
+struct RemoteProcessOps {
+  int (*read_memory_func_ptr)(
+      void* context,
+      const PROCESS_INFORMATION* process_info,
+      const void* address,
+      void* buffer,
+      size_t size,
+      size_t* num_bytes_read
+  );
+
+  int (*write_memory_func_ptr)(
+      void* context,
+      const PROCESS_INFORMATION* process_info,
+      void* address,
+      const void* buffer,
+      size_t size,
+      size_t* num_bytes_written
+  );
+
+  int (*protect_memory_func_ptr)(
+      void* context,
+      const PROCESS_INFORMATION* process_info,
+      void* address,
+      size_t size,
+      DWORD new_protect,
+      DWORD* old_protect
+  );
+
+  int (*suspend_thread_func_ptr)(
+      void* context,
+      const PROCESS_INFORMATION* process_info,
+      DWORD* previous_suspend_count
+  );
+
+  int (*resume_thread_func_ptr)(
+      void* context,
+      const PROCESS_INFORMATION* process_info,
+      DWORD* previous_suspend_count
+  );
+
+  /*
+  * Allocates memory in the game process. If min_address is not NULL,
+  * then the memory is placed in the first free region at or above it.
+  */
+  int (*allocate_memory_func_ptr)(
+      void* context,
+      const PROCESS_INFORMATION* process_info,
+      void* min_address,
+      size_t size,
+      DWORD protect,
+      void** address
+  );
+
+  int (*free_memory_func_ptr)(
+      void* context,
+      const PROCESS_INFORMATION* process_info,
+      void* address
+  );
+
+  /*
+  * Queues a call to func, which is an address in the game process, on
+  * the main thread.
+  */
+  int (*queue_apc_func_ptr)(
+      void* context,
+      const PROCESS_INFORMATION* process_info,
+      void* func,
+      ULONG_PTR param
+  );
+
+  /*
+  * Runs func, which is an address in the game process, on a new thread
+  * in the game process, and waits for the thread to exit. Fails if the
+  * thread does not exit within a minute, or if the game exits first.
+  * A thread that times out is left running.
+  */
+  int (*run_thread_func_ptr)(
+      void* context,
+      const PROCESS_INFORMATION* process_info,
+      void* func,
+      void* param,
+      DWORD* exit_code
+  );
+
+  /*
+  * Waits up to the timeout for the game process to exit, and outputs
+  * whether it has exited.
+  */
+  int (*wait_for_exit_func_ptr)(
+      void* context,
+      const PROCESS_INFORMATION* process_info,
+      DWORD timeout_milliseconds,
+      int* is_exited
+  );
+};
+
+/*
+* A game process, paired with the operations used to access it. Neither
+* the operations nor the process information are owned, and both must
+* outlive the remote process.
+*/
+struct RemoteProcess {
+  const struct RemoteProcessOps* ops;
+  void* ops_context;
+  const PROCESS_INFORMATION* process_info;
+};
+
+/* The operations implemented with the Windows debugging functions. */
+const struct RemoteProcessOps* RemoteProcessOps_GetWindows(void);
+
+void RemoteProcess_Init(
+    struct RemoteProcess* remote_process,
+    const struct RemoteProcessOps* ops,
+    void* ops_context,
+    const PROCESS_INFORMATION* process_info
+);
+
+/* The number of bytes outputs can be NULL if they are not needed. */
+int RemoteProcess_ReadMemory(
+    const struct RemoteProcess* remote_process,
+    const void* address,
+    void* buffer,
+    size_t size,
+    size_t* num_bytes_read
+);
+
+int RemoteProcess_WriteMemory(
+    const struct RemoteProcess* remote_process,
+    void* address,
+    const void* buffer,
+    size_t size,
+    size_t* num_bytes_written
+);
+
+int RemoteProcess_ProtectMemory(
+    const struct RemoteProcess* remote_process,
+    void* address,
+    size_t size,
+    DWORD new_protect,
+    DWORD* old_protect
+);
+
+int RemoteProcess_SuspendThread(
+    const struct RemoteProcess* remote_process,
+    DWORD* previous_suspend_count
+);
+
+int RemoteProcess_ResumeThread(
+    const struct RemoteProcess* remote_process,
+    DWORD* previous_suspend_count
+);
+
+int RemoteProcess_AllocateMemory(
+    const struct RemoteProcess* remote_process,
+    void* min_address,
+    size_t size,
+    DWORD protect,
+    void** address
+);
+
+int RemoteProcess_FreeMemory(
+    const struct RemoteProcess* remote_process,
+    void* address
+);
+
+int RemoteProcess_QueueApc(
+    const struct RemoteProcess* remote_process,
+    void* func,
+    ULONG_PTR param
+);
+
+int RemoteProcess_RunThread(
+    const struct RemoteProcess* remote_process,
+    void* func,
+    void* param,
+    DWORD* exit_code
+);
+
+int RemoteProcess_WaitForExit(
+    const struct RemoteProcess* remote_process,
+    DWORD timeout_milliseconds,
+    int* is_exited
+);
+
+#endif /* SGGLDKL_PATCH_HELPER_REMOTE_PROCESS_H_ */
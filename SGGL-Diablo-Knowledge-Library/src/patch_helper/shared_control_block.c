@@ -0,0 +1,187 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "shared_control_block.h"
+
+#include <stdio.h>
+
+#include "../helper/error_handling.h"
+
+enum Constant {
+  /*
+  * The number of spins between checks of whether the game process has
+  * exited, so that the check does not slow down the handshake.
+  */
+  PARK_SPINS_PER_PROCESS_CHECK = 64
+};
+
+int SharedControlBlockMapping_Init(
+    struct SharedControlBlockMapping* mapping,
+    const PROCESS_INFORMATION* process_info
+) {
+  BOOL is_duplicate_handle_success;
+
+  mapping->process_info = process_info;
+  mapping->mapping_handle = NULL;
+  mapping->remote_mapping_handle = NULL;
+  mapping->shared_control_block = NULL;
+
+  /*
+  * Pagefile backed memory is zero initialized. The mapping is unnamed,
+  * as the game process is given a duplicate of the handle.
+  */
+  mapping->mapping_handle = CreateFileMappingA(
+      INVALID_HANDLE_VALUE,
+      NULL,
+      PAGE_READWRITE,
+      0,
+      sizeof(*mapping->shared_control_block),
+      NULL
+  );
+
+  if (mapping->mapping_handle == NULL) {
+    goto fail;
+  }
+
+  mapping->shared_control_block = MapViewOfFile(
+      mapping->mapping_handle,
+      FILE_MAP_WRITE,
+      0,
+      0,
+      0
+  );
+
+  if (mapping->shared_control_block == NULL) {
+    goto fail;
+  }
+
+  is_duplicate_handle_success = DuplicateHandle(
+      GetCurrentProcess(),
+      mapping->mapping_handle,
+      process_info->hProcess,
+      &mapping->remote_mapping_handle,
+      0,
+      FALSE,
+      DUPLICATE_SAME_ACCESS
+  );
+
+  if (!is_duplicate_handle_success) {
+    goto fail;
+  }
+
+#if !NDEBUG
+  printf(
+      "Created shared control block for process %u. \n",
+      process_info->dwProcessId
+  );
+#endif /* !NDEBUG */
+
+  return 1;
+
+fail:
+  SharedControlBlockMapping_Deinit(mapping);
+
+  return 0;
+}
+
+void SharedControlBlockMapping_Deinit(
+    struct SharedControlBlockMapping* mapping
+) {
+  /* Closes the handle in the game process. */
+  if (mapping->remote_mapping_handle != NULL) {
+    DuplicateHandle(
+        mapping->process_info->hProcess,
+        mapping->remote_mapping_handle,
+        NULL,
+        NULL,
+        0,
+        FALSE,
+        DUPLICATE_CLOSE_SOURCE
+    );
+
+    mapping->remote_mapping_handle = NULL;
+  }
+
+  if (mapping->shared_control_block != NULL) {
+    UnmapViewOfFile(mapping->shared_control_block);
+    mapping->shared_control_block = NULL;
+  }
+
+  if (mapping->mapping_handle != NULL) {
+    CloseHandle(mapping->mapping_handle);
+    mapping->mapping_handle = NULL;
+  }
+}
+
+int SharedControlBlock_WaitForPark(
+    struct SharedControlBlock* shared_control_block,
+    HANDLE process_handle
+) {
+  unsigned int num_spins;
+  DWORD wait_result;
+
+  num_spins = 0;
+
+  while (shared_control_block->park_count
+      == shared_control_block->release_count) {
+    num_spins += 1;
+
+    if (num_spins % PARK_SPINS_PER_PROCESS_CHECK == 0) {
+      wait_result = WaitForSingleObject(process_handle, 0);
+
+      if (wait_result == WAIT_OBJECT_0) {
+        RecordGeneralFailure(
+            L"The game exited before the payload parked.",
+            L"Game Exited"
+        );
+
+        return 0;
+      } else if (wait_result == WAIT_FAILED) {
+        RecordWindowsFunctionFailureWithLastError(
+            L"WaitForSingleObject",
+            GetLastError()
+        );
+
+        return 0;
+      }
+    }
+
+    /* Give the game thread some time to execute code. */
+    Sleep(0);
+  }
+
+  return 1;
+}
+
+void SharedControlBlock_Release(
+    struct SharedControlBlock* shared_control_block
+) {
+  /* Acts as a full barrier, so prior stack data writes are visible. */
+  InterlockedIncrement(&shared_control_block->release_count);
+}
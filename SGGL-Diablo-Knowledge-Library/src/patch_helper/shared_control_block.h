@@ -0,0 +1,93 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_PATCH_HELPER_SHARED_CONTROL_BLOCK_H_
+#define SGGLDKL_PATCH_HELPER_SHARED_CONTROL_BLOCK_H_
+
+#include <windows.h>
+
+#include "stack_data.h"
+
+/*
+* Control block that is shared between SGGL and the game process
+* through a file mapping. The payload copies its stack data into it
+* and, instead of suspending itself, parks by incrementing park_count
+* and then spins until SGGL increments release_count to match. This
+* struct must be synced with the offsets used in the PayloadFunc.
+*
+* 0 to 192: stack_data
+* 192: park_count, can be read by SGGL
+* 196: release_count, can be modified by SGGL
+*/
+#pragma pack(push, 1)
+struct SharedControlBlock {
+  struct StackData stack_data;
+  volatile LONG park_count;
+  volatile LONG release_count;
+};
+#pragma pack(pop)
+
+struct SharedControlBlockMapping {
+  const PROCESS_INFORMATION* process_info;
+
+  HANDLE mapping_handle;
+  HANDLE remote_mapping_handle;
+
+  struct SharedControlBlock* shared_control_block;
+};
+
+/*
+* Creates the file mapping and a handle to it that is usable by the
+* game process. Returns zero if the mapping could not be set up, in
+* which case the stack transport should be used instead.
+*/
+int SharedControlBlockMapping_Init(
+    struct SharedControlBlockMapping* mapping,
+    const PROCESS_INFORMATION* process_info
+);
+
+void SharedControlBlockMapping_Deinit(
+    struct SharedControlBlockMapping* mapping
+);
+
+/*
+* Spins until the payload has parked itself. Returns zero if the game
+* process exits first.
+*/
+int SharedControlBlock_WaitForPark(
+    struct SharedControlBlock* shared_control_block,
+    HANDLE process_handle
+);
+
+/* Allows a parked payload to continue execution. */
+void SharedControlBlock_Release(
+    struct SharedControlBlock* shared_control_block
+);
+
+#endif /* SGGLDKL_PATCH_HELPER_SHARED_CONTROL_BLOCK_H_ */
@@ -30,65 +30,174 @@
 #include "stack_data.h"
 
 #include <stdio.h>
+#include <string.h>
 
-#include "../helper/error_handling.h"
+#include "../helper/windows_version.h"
 
 void StackData_InitFuncs(struct StackData* stack_data) {
+  stack_data->Sleep_ptr = &Sleep;
+  stack_data->UnmapViewOfFile_ptr = &UnmapViewOfFile;
+  stack_data->MapViewOfFile_ptr = &MapViewOfFile;
   stack_data->LoadLibraryA_ptr = &LoadLibraryA;
   stack_data->GetCurrentThread_ptr = &GetCurrentThread;
   stack_data->SuspendThread_ptr = &SuspendThread;
   stack_data->VirtualAlloc_ptr = &VirtualAlloc;
   stack_data->VirtualFree_ptr = &VirtualFree;
+  stack_data->GetTickCount_ptr = &GetTickCount;
+  stack_data->GetLastError_ptr = &GetLastError;
+
+  /*
+  * LoadLibraryW is only implemented on Windows NT. The address is
+  * taken directly from kernel32, as the LoadLibraryW symbol can be
+  * redirected by the Unicode layer.
+  */
+  stack_data->LoadLibraryW_ptr = NULL;
+
+  if (WindowsVersion_IsNt()) {
+    stack_data->LoadLibraryW_ptr = (HMODULE (WINAPI*)(LPCWSTR)) GetProcAddress(
+        GetModuleHandleW(L"kernel32.dll"),
+        "LoadLibraryW"
+    );
+  }
 }
 
-void StackData_ReadFromProcess(
+static int ReadRangeFromProcess(
     struct StackData* stack_data,
-    const PROCESS_INFORMATION* process_info,
-    const void* stack_data_address
+    const struct StackDataLocation* location,
+    size_t offset,
+    size_t size
 ) {
-  BOOL is_read_process_memory_success;
-  SIZE_T num_bytes_read;
+  size_t num_bytes_read;
 
-  is_read_process_memory_success = ReadProcessMemory(
-      process_info->hProcess,
-      stack_data_address,
-      stack_data,
-      sizeof(*stack_data),
+  if (!RemoteProcess_ReadMemory(
+      location->remote_process,
+      (const unsigned char*) location->remote_address + offset,
+      (unsigned char*) stack_data + offset,
+      size,
       &num_bytes_read
-  );
+  )) {
+#if !NDEBUG
+    printf("Read: %lu \n", (unsigned long) num_bytes_read);
+#endif /* !NDEBUG */
 
-  if (!is_read_process_memory_success) {
-    printf("Read: %u \n", num_bytes_read);
+    return 0;
+  }
 
-    ExitOnWindowsFunctionFailureWithLastError(
-        L"ReadProcessMemory",
-        GetLastError()
-    );
+  if (location->transfer_counters != NULL) {
+    location->transfer_counters->num_reads += 1;
+    location->transfer_counters->num_bytes_read += num_bytes_read;
   }
+
+  return 1;
 }
 
-void StackData_WriteToProcess(
+static int WriteRangeToProcess(
     const struct StackData* stack_data,
-    const PROCESS_INFORMATION* process_info,
-    void* stack_data_address
+    const struct StackDataLocation* location,
+    size_t offset,
+    size_t size
 ) {
-  BOOL is_write_process_memory_success;
-  SIZE_T num_bytes_written;
+  size_t num_bytes_written;
 
-  is_write_process_memory_success = WriteProcessMemory(
-      process_info->hProcess,
-      stack_data_address,
-      stack_data,
-      sizeof(*stack_data),
+  if (!RemoteProcess_WriteMemory(
+      location->remote_process,
+      (unsigned char*) location->remote_address + offset,
+      (const unsigned char*) stack_data + offset,
+      size,
       &num_bytes_written
+  )) {
+#if !NDEBUG
+    printf("Written: %lu \n", (unsigned long) num_bytes_written);
+#endif /* !NDEBUG */
+
+    return 0;
+  }
+
+  if (location->transfer_counters != NULL) {
+    location->transfer_counters->num_writes += 1;
+    location->transfer_counters->num_bytes_written += num_bytes_written;
+  }
+
+  return 1;
+}
+
+int StackData_ReadFromProcess(
+    struct StackData* stack_data,
+    const struct StackDataLocation* location
+) {
+  return ReadRangeFromProcess(
+      stack_data,
+      location,
+      0,
+      sizeof(*stack_data)
   );
+}
 
-  if (!is_write_process_memory_success) {
-    printf("Written: %u \n", num_bytes_written);
+int StackData_WriteToProcess(
+    const struct StackData* stack_data,
+    const struct StackDataLocation* location
+) {
+  return WriteRangeToProcess(
+      stack_data,
+      location,
+      0,
+      sizeof(*stack_data)
+  );
+}
+
+int StackData_ReadRange(
+    struct StackData* stack_data,
+    const struct StackDataLocation* location,
+    size_t offset,
+    size_t size
+) {
+  if (location->shared_stack_data != NULL) {
+    memcpy(
+        (unsigned char*) stack_data + offset,
+        (const unsigned char*) location->shared_stack_data + offset,
+        size
+    );
+
+    return 1;
+  }
+
+  return ReadRangeFromProcess(
+      stack_data,
+      location,
+      offset,
+      size
+  );
+}
 
-    ExitOnWindowsFunctionFailureWithLastError(
-        L"WriteProcessMemory",
-        GetLastError()
+int StackData_WriteRange(
+    const struct StackData* stack_data,
+    const struct StackDataLocation* location,
+    size_t offset,
+    size_t size
+) {
+  if (location->shared_stack_data != NULL) {
+    memcpy(
+        (unsigned char*) location->shared_stack_data + offset,
+        (const unsigned char*) stack_data + offset,
+        size
     );
+
+    return 1;
   }
+
+  return WriteRangeToProcess(
+      stack_data,
+      location,
+      offset,
+      size
+  );
+}
+
+void StackDataTransferCounters_Init(
+    struct StackDataTransferCounters* transfer_counters
+) {
+  transfer_counters->num_reads = 0;
+  transfer_counters->num_writes = 0;
+  transfer_counters->num_bytes_read = 0;
+  transfer_counters->num_bytes_written = 0;
 }
@@ -33,10 +33,13 @@
 #include <stddef.h>
 #include <windows.h>
 
+#include "remote_process.h"
+
 /*
 * This struct must be completely synced with the stack data in
 * entry_hijack_patch->PayloadFunc. Note these values should be
-* offset +4 from the description.
+* offset +4 from the description. The payload accesses the data
+* relative to ebx, which points to the start of the struct (-192).
 *
 * -4: num_libs, needs to be inited by SGGL
 * -8: current_thread_handle
@@ -45,31 +48,55 @@
 * -20: lib_path_ptr, data inside can be modified by SGGL
 * -24: is_ready_to_execute, can be modified by SGGL
 * -28: is_ready_to_exit, can be modified by SGGL
-* -32 to -64: reserved, for variables
+* -32: shared_mapping_handle, needs to be inited by SGGL
+* -36: shared_control_block, can be read by SGGL
+* -40: lib_module, can be read by SGGL
+* -44: lib_last_error, can be read by SGGL
+* -48: lib_load_start_tick, can be read by SGGL
+* -52: lib_load_end_tick, can be read by SGGL
+* -56 to -64: reserved, for variables
 * -68: VirtualFree
 * -72: VirtualAlloc
 * -76: SuspendThread
 * -80: GetCurrentThread
 * -84: LoadLibraryA
-* -88 to -128: reserved, for kernel functions
+* -88: MapViewOfFile
+* -92: UnmapViewOfFile
+* -96: Sleep
+* -100: LoadLibraryW, NULL if the path is multibyte
+* -104: GetTickCount
+* -108: GetLastError
+* -112 to -128: reserved, for kernel functions
 * -132 to -192: reserved, for local jump offsets
 */
 #pragma pack(push, 1)
 struct StackData {
   unsigned int reserved_local_jump_offsets[(192 - 128) / 4];
-  unsigned int reserved_kernel_func_ptr[(128 - 84) / 4];
+  unsigned int reserved_kernel_func_ptr[(128 - 108) / 4];
 
+  DWORD (WINAPI *GetLastError_ptr)(void);
+  DWORD (WINAPI *GetTickCount_ptr)(void);
+  HMODULE (WINAPI *LoadLibraryW_ptr)(LPCWSTR);
+  void (WINAPI *Sleep_ptr)(DWORD);
+  BOOL (WINAPI *UnmapViewOfFile_ptr)(const void*);
+  void* (WINAPI *MapViewOfFile_ptr)(HANDLE, DWORD, DWORD, DWORD, SIZE_T);
   HMODULE (WINAPI *LoadLibraryA_ptr)(LPCSTR);
   HANDLE (WINAPI *GetCurrentThread_ptr)(void);
   DWORD (WINAPI *SuspendThread_ptr)(HANDLE);
-  void* (WINAPI *VirtualAlloc_ptr)(void*, DWORD, DWORD, DWORD);
-  BOOL (WINAPI *VirtualFree_ptr)(void*, DWORD, DWORD);
+  void* (WINAPI *VirtualAlloc_ptr)(void*, SIZE_T, DWORD, DWORD);
+  BOOL (WINAPI *VirtualFree_ptr)(void*, SIZE_T, DWORD);
 
-  unsigned int reserved_variable_ptr[(64 - 28) / 4];
+  unsigned int reserved_variable_ptr[(64 - 52) / 4];
 
+  DWORD lib_load_end_tick;
+  DWORD lib_load_start_tick;
+  DWORD lib_last_error;
+  HMODULE lib_module;
+  void* shared_control_block;
+  HANDLE shared_mapping_handle;
   int is_ready_to_exit;
   int is_ready_to_execute;
-  char* lib_path;
+  void* lib_path;
   size_t lib_path_size;
   int is_lib_resize_needed;
   DWORD current_thread_handle;
@@ -77,18 +104,121 @@ struct StackData {
 };
 #pragma pack(pop)
 
+/*
+* Counts of the remote transfers performed on the stack data, for
+* diagnosing the cost of the injection handshake. Accesses through
+* shared memory are not counted.
+*/
+struct StackDataTransferCounters {
+  size_t num_reads;
+  size_t num_writes;
+  size_t num_bytes_read;
+  size_t num_bytes_written;
+};
+
+/*
+* Where SGGL can access the payload's stack data. If shared_stack_data
+* is not NULL, then the payload has moved its stack data into shared
+* memory, and the data is accessed locally through that view.
+* Otherwise, the data is accessed on the game thread's stack through
+* the remote process.
+*
+* The remote transfers are counted into transfer_counters, if it is not
+* NULL. Each injection has its own counters, so that concurrent
+* injections do not share any state.
+*/
+struct StackDataLocation {
+  const struct RemoteProcess* remote_process;
+  void* remote_address;
+  struct StackData* shared_stack_data;
+  struct StackDataTransferCounters* transfer_counters;
+};
+
+/*
+* Field-granular accessors, generated from the struct layout. Each one
+* transfers only the bytes of the specified field(s), with at most a
+* single remote read or write, so that the
+* other fields, which could be concurrently updated by the payload,
+* are not clobbered.
+*/
+#define StackData_ReadField(stack_data, field, location) \
+    StackData_ReadRange( \
+        (stack_data), \
+        (location), \
+        offsetof(struct StackData, field), \
+        sizeof((stack_data)->field) \
+    )
+
+/* The fields from first_field up to and including last_field. */
+#define StackData_ReadFields(stack_data, first_field, last_field, location) \
+    StackData_ReadRange( \
+        (stack_data), \
+        (location), \
+        offsetof(struct StackData, first_field), \
+        offsetof(struct StackData, last_field) \
+            + sizeof((stack_data)->last_field) \
+            - offsetof(struct StackData, first_field) \
+    )
+
+#define StackData_WriteField(stack_data, field, location) \
+    StackData_WriteRange( \
+        (stack_data), \
+        (location), \
+        offsetof(struct StackData, field), \
+        sizeof((stack_data)->field) \
+    )
+
+/* The fields from first_field up to and including last_field. */
+#define StackData_WriteFields(stack_data, first_field, last_field, location) \
+    StackData_WriteRange( \
+        (stack_data), \
+        (location), \
+        offsetof(struct StackData, first_field), \
+        offsetof(struct StackData, last_field) \
+            + sizeof((stack_data)->last_field) \
+            - offsetof(struct StackData, first_field) \
+    )
+
+/*
+* Sets the Windows function pointers used by the payload. The
+* LoadLibraryW pointer is left NULL where the library paths must be
+* passed as multibyte strings.
+*/
 void StackData_InitFuncs(struct StackData* stack_data);
 
-void StackData_ReadFromProcess(
+/*
+* Transfers the whole struct on the game thread's stack, regardless of
+* whether the shared stack data is used.
+*
+* The transfer functions return zero if the process memory could not
+* be accessed.
+*/
+int StackData_ReadFromProcess(
+    struct StackData* stack_data,
+    const struct StackDataLocation* location
+);
+
+int StackData_WriteToProcess(
+    const struct StackData* stack_data,
+    const struct StackDataLocation* location
+);
+
+int StackData_ReadRange(
     struct StackData* stack_data,
-    const PROCESS_INFORMATION* process_info,
-    const void* stack_data_address
+    const struct StackDataLocation* location,
+    size_t offset,
+    size_t size
 );
 
-void StackData_WriteToProcess(
+int StackData_WriteRange(
     const struct StackData* stack_data,
-    const PROCESS_INFORMATION* process_info,
-    void* stack_data_address
+    const struct StackDataLocation* location,
+    size_t offset,
+    size_t size
+);
+
+void StackDataTransferCounters_Init(
+    struct StackDataTransferCounters* transfer_counters
 );
 
 #endif /* SGGLDKL_PATCH_HELPER_STACK_DATA_H_ */
@@ -0,0 +1,347 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "process_detection.h"
+
+#include <string.h>
+
+#include "helper/error_handling.h"
+#include "helper/game_file_source.h"
+#include "image_file_source.h"
+#include "patch_helper/remote_process.h"
+
+enum Constant {
+  PROCESS_BASIC_INFORMATION_CLASS = 0,
+
+  PEB_IMAGE_BASE_ADDRESS_OFFSET = 0x08,
+  PEB_LDR_OFFSET = 0x0C,
+  PEB_READ_SIZE = 0x10,
+
+  LDR_IN_LOAD_ORDER_MODULE_LIST_OFFSET = 0x0C,
+
+  /* The in load order links are the first field of each entry. */
+  LDR_ENTRY_FLINK_OFFSET = 0x00,
+  LDR_ENTRY_DLL_BASE_OFFSET = 0x18,
+  LDR_ENTRY_SIZE_OF_IMAGE_OFFSET = 0x20,
+  LDR_ENTRY_BASE_DLL_NAME_LENGTH_OFFSET = 0x2C,
+  LDR_ENTRY_BASE_DLL_NAME_BUFFER_OFFSET = 0x30,
+  LDR_ENTRY_READ_SIZE = 0x34,
+
+  /* Guards against a module list that is corrupt, or being modified. */
+  MAX_LDR_ENTRIES = 1024
+};
+
+/* The game executables are not relocatable, and are linked here. */
+static const DWORD kDefaultImageBase = 0x00400000;
+
+struct ProcessBasicInformation {
+  LONG exit_status;
+  void* peb_base_address;
+  ULONG_PTR affinity_mask;
+  LONG base_priority;
+  ULONG_PTR unique_process_id;
+  ULONG_PTR inherited_from_unique_process_id;
+};
+
+struct ProcessImages {
+  PROCESS_INFORMATION process_info;
+  struct RemoteProcess remote_process;
+
+  /* NULL if the modules cannot be listed. */
+  unsigned char* ldr_address;
+};
+
+static int ReadProcessImage(
+    void* context,
+    const void* image,
+    size_t image_size,
+    DWORD rva,
+    void* buffer,
+    size_t size
+) {
+  return RemoteProcess_ReadMemory(
+      (const struct RemoteProcess*) context,
+      (const unsigned char*) image + rva,
+      buffer,
+      size,
+      NULL
+  );
+}
+
+/*
+* Outputs the image base of the game executable, which is read from the
+* process environment block on Windows NT. Windows 9X does not expose
+* the block, so the default image base is used instead.
+*/
+static int FindGameImageBase(
+    struct ProcessImages* process_images,
+    const void** image_base
+) {
+  typedef LONG (WINAPI *NtQueryInformationProcessFunc)(
+      HANDLE,
+      int,
+      void*,
+      ULONG,
+      ULONG*
+  );
+
+  HMODULE ntdll_module;
+  NtQueryInformationProcessFunc nt_query_information_process;
+  struct ProcessBasicInformation basic_info;
+  LONG status;
+
+  unsigned char peb[PEB_READ_SIZE];
+
+  process_images->ldr_address = NULL;
+
+  ntdll_module = GetModuleHandleA("ntdll.dll");
+
+  nt_query_information_process = (ntdll_module != NULL)
+      ? (NtQueryInformationProcessFunc) GetProcAddress(
+          ntdll_module,
+          "NtQueryInformationProcess"
+      )
+      : NULL;
+
+  if (nt_query_information_process == NULL) {
+    *image_base = (const void*) kDefaultImageBase;
+
+    return 1;
+  }
+
+  status = nt_query_information_process(
+      process_images->process_info.hProcess,
+      PROCESS_BASIC_INFORMATION_CLASS,
+      &basic_info,
+      sizeof(basic_info),
+      NULL
+  );
+
+  if (status < 0) {
+    RecordGeneralFailure(
+        L"The information of the game process could not be queried.",
+        L"Process Query Failed"
+    );
+
+    return 0;
+  }
+
+  if (!RemoteProcess_ReadMemory(
+      &process_images->remote_process,
+      basic_info.peb_base_address,
+      peb,
+      sizeof(peb),
+      NULL
+  )) {
+    return 0;
+  }
+
+  memcpy(
+      (void*) image_base,
+      peb + PEB_IMAGE_BASE_ADDRESS_OFFSET,
+      sizeof(*image_base)
+  );
+
+  memcpy(
+      &process_images->ldr_address,
+      peb + PEB_LDR_OFFSET,
+      sizeof(process_images->ldr_address)
+  );
+
+  return 1;
+}
+
+/*
+* Finds a module of the game process by walking the loader's module
+* list. The list is empty until the game has started running, so a
+* process that was created suspended has no companion modules yet.
+*/
+static int FindProcessModule(
+    void* context,
+    const wchar_t* file_name,
+    size_t file_name_len,
+    struct ImageReader* reader
+) {
+  struct ProcessImages* process_images;
+
+  unsigned char* list_head;
+  unsigned char* link;
+  size_t i_entry;
+
+  unsigned char ldr_entry[LDR_ENTRY_READ_SIZE];
+  WORD module_name_size;
+  const void* module_name_address;
+  wchar_t module_name[MAX_PATH];
+  DWORD size_of_image;
+
+  process_images = (struct ProcessImages*) context;
+
+  if (process_images->ldr_address == NULL) {
+    goto fail_not_found;
+  }
+
+  list_head = process_images->ldr_address
+      + LDR_IN_LOAD_ORDER_MODULE_LIST_OFFSET;
+
+  if (!RemoteProcess_ReadMemory(
+      &process_images->remote_process,
+      list_head,
+      &link,
+      sizeof(link),
+      NULL
+  )) {
+    return 0;
+  }
+
+  for (i_entry = 0;
+      i_entry < MAX_LDR_ENTRIES && link != NULL && link != list_head;
+      i_entry += 1) {
+    if (!RemoteProcess_ReadMemory(
+        &process_images->remote_process,
+        link,
+        ldr_entry,
+        sizeof(ldr_entry),
+        NULL
+    )) {
+      return 0;
+    }
+
+    memcpy(
+        &module_name_size,
+        ldr_entry + LDR_ENTRY_BASE_DLL_NAME_LENGTH_OFFSET,
+        sizeof(module_name_size)
+    );
+
+    memcpy(
+        &module_name_address,
+        ldr_entry + LDR_ENTRY_BASE_DLL_NAME_BUFFER_OFFSET,
+        sizeof(module_name_address)
+    );
+
+    /* Only the names of the same length are read and compared. */
+    if (module_name_size == file_name_len * sizeof(module_name[0])
+        && file_name_len < MAX_PATH) {
+      if (!RemoteProcess_ReadMemory(
+          &process_images->remote_process,
+          module_name_address,
+          module_name,
+          module_name_size,
+          NULL
+      )) {
+        return 0;
+      }
+
+      if (_wcsnicmp(module_name, file_name, file_name_len) == 0) {
+        memcpy(
+            (void*) &reader->image,
+            ldr_entry + LDR_ENTRY_DLL_BASE_OFFSET,
+            sizeof(reader->image)
+        );
+
+        memcpy(
+            &size_of_image,
+            ldr_entry + LDR_ENTRY_SIZE_OF_IMAGE_OFFSET,
+            sizeof(size_of_image)
+        );
+
+        reader->read_func_ptr = &ReadProcessImage;
+        reader->view_func_ptr = NULL;
+        reader->context = &process_images->remote_process;
+        reader->image_size = size_of_image;
+
+        return 1;
+      }
+    }
+
+    memcpy(&link, ldr_entry + LDR_ENTRY_FLINK_OFFSET, sizeof(link));
+  }
+
+fail_not_found:
+  RecordGeneralFailure(
+      L"The companion module is not loaded in the game process.",
+      L"Module Not Found"
+  );
+
+  return 0;
+}
+
+int ProcessDetection_DetectGameVersion(
+    HANDLE process_handle,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
+) {
+  struct ProcessImages process_images;
+  struct ImageReader game_reader;
+  struct ImageFileSource image_source;
+  struct GameFileSource source;
+  int is_success;
+
+  memset(
+      &process_images.process_info,
+      0,
+      sizeof(process_images.process_info)
+  );
+
+  process_images.process_info.hProcess = process_handle;
+
+  RemoteProcess_Init(
+      &process_images.remote_process,
+      RemoteProcessOps_GetWindows(),
+      NULL,
+      &process_images.process_info
+  );
+
+  if (!FindGameImageBase(&process_images, &game_reader.image)) {
+    return 0;
+  }
+
+  game_reader.read_func_ptr = &ReadProcessImage;
+  game_reader.view_func_ptr = NULL;
+  game_reader.context = &process_images.remote_process;
+  game_reader.image_size = 0;
+
+  ImageFileSource_Init(
+      &image_source,
+      &game_reader,
+      &FindProcessModule,
+      &process_images
+  );
+
+  GameFileSource_Init(&source, GameFileSourceOps_GetImage(), &image_source);
+
+  is_success = GameVersion_DetectGameVersionFromSource(
+      &source,
+      detection,
+      game_version
+  );
+
+  ImageFileSource_Deinit(&image_source);
+
+  return is_success;
+}
@@ -0,0 +1,53 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_PROCESS_DETECTION_H_
+#define SGGLDKL_PROCESS_DETECTION_H_
+
+#include <windows.h>
+
+#include "game_version.h"
+
+/*
+* Detects the version of the game running in the process, by reading
+* the version resources and headers of its mapped images with
+* ReadProcessMemory. No game file is read from disk. The versions that
+* are told apart by Storm.dll need it to have been loaded by the game.
+*
+* On Windows 9X, the game executable is read from its default image
+* base, and companion modules cannot be found. Returns zero if the
+* images could not be read, which is distinct from an unknown version.
+*/
+int ProcessDetection_DetectGameVersion(
+    HANDLE process_handle,
+    struct KnowledgeGameDetection* detection,
+    enum GameVersion* game_version
+);
+
+#endif /* SGGLDKL_PROCESS_DETECTION_H_ */
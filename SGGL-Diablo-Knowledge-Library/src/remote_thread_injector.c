@@ -0,0 +1,308 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#include "remote_thread_injector.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "helper/error_handling.h"
+#include "helper/windows_version.h"
+#include "patch_helper/load_library_thread.h"
+
+/*
+* The layout of the block copied into the game process. The code comes
+* first, followed by the thread data, its entries, and the paths.
+*/
+struct RemoteBlockLayout {
+  size_t data_offset;
+  size_t entries_offset;
+  size_t lib_paths_offset;
+  size_t size;
+};
+
+static void RemoteBlockLayout_Init(
+    struct RemoteBlockLayout* layout,
+    size_t num_libraries,
+    size_t lib_paths_len
+) {
+  /* The data is aligned, as the thread function accesses it by DWORD. */
+  layout->data_offset = (LoadLibraryThread_GetCodeSize() + 3) & ~(size_t) 3;
+
+  layout->entries_offset = layout->data_offset
+      + sizeof(struct LoadLibraryThreadData);
+
+  layout->lib_paths_offset = layout->entries_offset
+      + num_libraries * sizeof(struct LoadLibraryThreadEntry);
+
+  layout->size = layout->lib_paths_offset
+      + lib_paths_len * sizeof(wchar_t);
+}
+
+/*
+* Fills the block that is copied into the game process, with the path
+* pointers set to where the paths are in the remote block.
+*/
+static int FillRemoteBlock(
+    unsigned char* block,
+    const struct RemoteBlockLayout* layout,
+    unsigned char* remote_block,
+    const wchar_t** libraries_to_inject,
+    const size_t* libraries_to_inject_lens,
+    size_t num_libraries
+) {
+  size_t i_library;
+
+  struct LoadLibraryThreadData data;
+  struct LoadLibraryThreadEntry entry;
+  size_t lib_path_offset;
+
+  memcpy(
+      block,
+      LoadLibraryThread_GetCode(),
+      LoadLibraryThread_GetCodeSize()
+  );
+
+  if (!LoadLibraryThread_InitFuncs(&data)) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"GetProcAddress",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  data.num_libs = num_libraries;
+
+  memcpy(&block[layout->data_offset], &data, sizeof(data));
+
+  lib_path_offset = layout->lib_paths_offset;
+
+  for (i_library = 0; i_library < num_libraries; i_library += 1) {
+    entry.lib_path = (const wchar_t*) &remote_block[lib_path_offset];
+    entry.lib_module = NULL;
+    entry.lib_last_error = 0;
+    entry.lib_load_start_tick = 0;
+    entry.lib_load_end_tick = 0;
+
+    memcpy(
+        &block[layout->entries_offset + i_library * sizeof(entry)],
+        &entry,
+        sizeof(entry)
+    );
+
+    memcpy(
+        &block[lib_path_offset],
+        libraries_to_inject[i_library],
+        (libraries_to_inject_lens[i_library] + 1) * sizeof(wchar_t)
+    );
+
+    lib_path_offset += (libraries_to_inject_lens[i_library] + 1)
+        * sizeof(wchar_t);
+  }
+
+  return 1;
+}
+
+/* Reads back the entries that the thread function went through. */
+static int ReadLoadResults(
+    const struct RemoteProcess* remote_process,
+    const struct RemoteBlockLayout* layout,
+    unsigned char* remote_block,
+    size_t num_libraries,
+    size_t num_libraries_attempted,
+    struct KnowledgeLibraryLoadResult* load_results
+) {
+  size_t i_library;
+
+  struct LoadLibraryThreadEntry* entries;
+  int is_success;
+
+  entries = malloc((num_libraries + 1) * sizeof(entries[0]));
+
+  if (entries == NULL) {
+    RecordAllocationFailure();
+    return 0;
+  }
+
+  is_success = RemoteProcess_ReadMemory(
+      remote_process,
+      &remote_block[layout->entries_offset],
+      entries,
+      num_libraries * sizeof(entries[0]),
+      NULL
+  );
+
+  if (!is_success) {
+    goto free_entries;
+  }
+
+  for (i_library = 0; i_library < num_libraries; i_library += 1) {
+    load_results[i_library].is_attempted =
+        (i_library < num_libraries_attempted);
+    load_results[i_library].module = entries[i_library].lib_module;
+    load_results[i_library].last_error = entries[i_library].lib_last_error;
+    load_results[i_library].load_start_tick =
+        entries[i_library].lib_load_start_tick;
+    load_results[i_library].load_end_tick =
+        entries[i_library].lib_load_end_tick;
+  }
+
+free_entries:
+  free(entries);
+
+  return is_success;
+}
+
+int RemoteThreadInjector_IsSupported(void) {
+  return WindowsVersion_IsNt();
+}
+
+int RemoteThreadInjector_InjectLibraries(
+    const struct RemoteProcess* remote_process,
+    const wchar_t** libraries_to_inject,
+    const size_t* libraries_to_inject_lens,
+    size_t num_libraries,
+    struct KnowledgeLibraryLoadResult* load_results
+) {
+  size_t i_library;
+
+  struct RemoteBlockLayout layout;
+  size_t lib_paths_len;
+  unsigned char* block;
+  unsigned char* remote_block;
+
+  DWORD num_libraries_attempted;
+  DWORD previous_suspend_count;
+  int is_success;
+
+  is_success = 0;
+
+  if (!RemoteThreadInjector_IsSupported()) {
+    RecordGeneralFailure(
+        L"Remote thread injection requires Windows NT.",
+        L"Unsupported Operation"
+    );
+
+    return 0;
+  }
+
+  lib_paths_len = 0;
+
+  for (i_library = 0; i_library < num_libraries; i_library += 1) {
+    lib_paths_len += libraries_to_inject_lens[i_library] + 1;
+  }
+
+  RemoteBlockLayout_Init(&layout, num_libraries, lib_paths_len);
+
+  block = malloc(layout.size);
+
+  if (block == NULL) {
+    RecordAllocationFailure();
+    return 0;
+  }
+
+  /*
+  * The block is allocated first, as the path pointers in the entries
+  * must point into it. Everything is then written at once.
+  */
+  if (!RemoteProcess_AllocateMemory(
+      remote_process,
+      NULL,
+      layout.size,
+      PAGE_EXECUTE_READWRITE,
+      (void**) &remote_block
+  )) {
+    goto free_block;
+  }
+
+  if (!FillRemoteBlock(
+      block,
+      &layout,
+      remote_block,
+      libraries_to_inject,
+      libraries_to_inject_lens,
+      num_libraries
+  )) {
+    goto free_remote_block;
+  }
+
+  if (!RemoteProcess_WriteMemory(
+      remote_process,
+      remote_block,
+      block,
+      layout.size,
+      NULL
+  )) {
+    goto free_remote_block;
+  }
+
+  /*
+  * The thread is waited on once, instead of polling for suspends. If
+  * the wait fails, the thread could still be running from the block,
+  * so the block is left in the game process.
+  */
+  if (!RemoteProcess_RunThread(
+      remote_process,
+      remote_block,
+      &remote_block[layout.data_offset],
+      &num_libraries_attempted
+  )) {
+    goto free_block;
+  }
+
+  if (load_results != NULL
+      && !ReadLoadResults(
+          remote_process,
+          &layout,
+          remote_block,
+          num_libraries,
+          num_libraries_attempted,
+          load_results
+      )) {
+    goto free_remote_block;
+  }
+
+  if (!RemoteProcess_ResumeThread(remote_process, &previous_suspend_count)) {
+    goto free_remote_block;
+  }
+
+  is_success = 1;
+
+free_remote_block:
+  if (!RemoteProcess_FreeMemory(remote_process, remote_block)) {
+    is_success = 0;
+  }
+
+free_block:
+  free(block);
+
+  return is_success;
+}
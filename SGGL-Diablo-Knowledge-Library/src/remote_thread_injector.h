@@ -0,0 +1,61 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+#ifndef SGGLDKL_REMOTE_THREAD_INJECTOR_H_
+#define SGGLDKL_REMOTE_THREAD_INJECTOR_H_
+
+#include <stddef.h>
+#include <wchar.h>
+
+#include "../include/library_load_result.h"
+#include "patch_helper/remote_process.h"
+
+/*
+* Returns nonzero if threads can be created in another process, which
+* is the case on Windows NT.
+*/
+int RemoteThreadInjector_IsSupported(void);
+
+/*
+* Copies the library paths and a loader thread function into the game
+* process, and runs a single remote thread that loads every library in
+* order. Once the thread exits, the results are read back into
+* load_results, if it is not NULL, the copied data is freed, and the
+* game's main thread is resumed. If the thread does not exit in time, or
+* the game exits, then zero is returned, and the game is left as is.
+*/
+int RemoteThreadInjector_InjectLibraries(
+    const struct RemoteProcess* remote_process,
+    const wchar_t** libraries_to_inject,
+    const size_t* libraries_to_inject_lens,
+    size_t num_libraries,
+    struct KnowledgeLibraryLoadResult* load_results
+);
+
+#endif /* SGGLDKL_REMOTE_THREAD_INJECTOR_H_ */
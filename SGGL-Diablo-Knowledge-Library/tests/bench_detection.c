@@ -0,0 +1,756 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+/*
+* Benchmarks the detection of the game version from the contents of
+* the game files, using a synthetic executable and storm.dll for every
+* game version. Each fixture is checked to be detected as its version
+* before anything is timed. The comparators, the table search and the
+* version resource parsing are also timed on their own, so that a
+* change in the detection latency can be traced to its part.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "../include/file_buffer.h"
+#include "../src/buffer_detection.h"
+#include "../src/diablo_ii/diablo_ii_game_version.h"
+#include "../src/game_version.h"
+#include "../src/helper/error_handling.h"
+#include "../src/helper/file_signature.h"
+#include "../src/helper/short_version.h"
+#include "../src/helper/version_resource.h"
+#include "bench_util.h"
+#include "fixture_pe.h"
+
+#define MAKE_VERSION_MS(major_left, major_right) \
+    (((DWORD) (major_left) << 16) | (major_right))
+
+enum Constant {
+  NUM_GAME_VERSIONS = VERSION_END - (VERSION_RESERVED + 1),
+
+  STORM_CHECK_POSITION = 0xF0,
+  STORM_CHECK_POSITION_1_07 = 0xF8
+};
+
+static const char* const kGameVersionNames[] = {
+#define GAME_VERSION_ENTRY(game_version, game_family, version_text) \
+    #game_version,
+#include "../src/game_version_manifest.inc"
+#undef GAME_VERSION_ENTRY
+};
+
+static const wchar_t kDiabloProductName[] = L"Blizzard Entertainment Diablo";
+static const wchar_t kHellfireProductName[] = L"Synergistic Software Hellfire";
+static const wchar_t kDiabloIIProductName[] = L"Diablo II";
+
+/*
+* The files of a game version. Diablo is told apart by the product
+* version of the game, or by the file version of storm.dll. Hellfire is
+* told apart by its file version string, and Diablo II by the file
+* version of the game and the bytes in the headers of storm.dll.
+*/
+struct DetectionFixtureSpec {
+  enum GameVersion game_version;
+
+  /* Zero if the version cannot be told apart from the others. */
+  int is_detectable;
+
+  const wchar_t* product_name;
+  WORD game_version_parts[4];
+  const wchar_t* file_version_str;
+
+  WORD storm_version_parts[4];
+  long storm_signature_offset;
+  unsigned char storm_signature[4];
+};
+
+static const struct DetectionFixtureSpec kFixtureSpecs[] = {
+    {
+        DIABLO_1_00, 1, kDiabloProductName, { 96, 12, 26, 3 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+
+    /* 1.02 has no entry in the version tables. */
+    {
+        DIABLO_1_02, 0, kDiabloProductName, { 1, 0, 2, 1 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+
+    {
+        DIABLO_1_03, 1, kDiabloProductName, { 97, 4, 1, 1 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_1_04, 1, kDiabloProductName, { 97, 5, 23, 1 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_1_05, 1, kDiabloProductName, { 1, 0, 5, 1 }, NULL,
+        { 1998, 4, 15, 1 }, 0, { 0 }
+    },
+    {
+        DIABLO_1_07, 1, kDiabloProductName, { 1, 0, 7, 1 }, NULL,
+        { 1998, 8, 11, 1 }, 0, { 0 }
+    },
+    {
+        DIABLO_1_08, 1, kDiabloProductName, { 1, 0, 8, 1 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_1_09, 1, kDiabloProductName, { 1, 0, 9, 1 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_1_09B, 1, kDiabloProductName, { 1, 0, 9, 2 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+
+    {
+        HELLFIRE_1_00, 1, kHellfireProductName, { 1, 0, 0, 0 },
+        L"1, 0, 0, 0", { 0 }, 0, { 0 }
+    },
+    {
+        HELLFIRE_1_01, 1, kHellfireProductName, { 1, 0, 1, 0 },
+        L"1, 0, 1, 0", { 0 }, 0, { 0 }
+    },
+
+    {
+        DIABLO_II_BETA_1_02, 1, kDiabloIIProductName, { 1, 0, 0, 1 }, NULL,
+        { 0 }, STORM_CHECK_POSITION, { 0xB7, 0x70, 0xD0, 0x38 }
+    },
+    {
+        DIABLO_II_STRESS_TEST_BETA_1_02, 1, kDiabloIIProductName,
+        { 1, 0, 0, 1 }, NULL,
+        { 0 }, STORM_CHECK_POSITION, { 0x79, 0xBD, 0x20, 0x39 }
+    },
+    {
+        DIABLO_II_1_00, 1, kDiabloIIProductName, { 1, 0, 0, 1 }, NULL,
+        { 0 }, STORM_CHECK_POSITION, { 0xBC, 0xC7, 0x2E, 0x39 }
+    },
+    {
+        DIABLO_II_1_01, 1, kDiabloIIProductName, { 1, 0, 0, 1 }, NULL,
+        { 0 }, STORM_CHECK_POSITION, { 0x25, 0x47, 0x52, 0x39 }
+    },
+    {
+        DIABLO_II_1_02, 1, kDiabloIIProductName, { 1, 0, 2, 0 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_03, 1, kDiabloIIProductName, { 1, 0, 3, 0 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_04, 1, kDiabloIIProductName, { 1, 0, 4, 0 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_04B, 1, kDiabloIIProductName, { 1, 0, 4, 1 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_04C, 1, kDiabloIIProductName, { 1, 0, 4, 2 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_05, 1, kDiabloIIProductName, { 1, 0, 5, 0 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_05B, 1, kDiabloIIProductName, { 1, 0, 5, 1 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_06, 1, kDiabloIIProductName, { 1, 0, 6, 0 }, NULL,
+        { 0 }, STORM_CHECK_POSITION, { 0x43, 0x0C, 0xD6, 0x3A }
+    },
+    {
+        DIABLO_II_1_06B, 1, kDiabloIIProductName, { 1, 0, 6, 0 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_07_BETA, 1, kDiabloIIProductName, { 1, 0, 7, 0 }, NULL,
+        { 0 }, STORM_CHECK_POSITION_1_07, { 0x32, 0xA6, 0xDC, 0x3A }
+    },
+    {
+        DIABLO_II_1_07, 1, kDiabloIIProductName, { 1, 0, 7, 0 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_08, 1, kDiabloIIProductName, { 1, 0, 8, 28 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_09, 1, kDiabloIIProductName, { 1, 0, 9, 19 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_09B, 1, kDiabloIIProductName, { 1, 0, 9, 20 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_09C, 1, kDiabloIIProductName, { 1, 0, 9, 21 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_09D, 1, kDiabloIIProductName, { 1, 0, 9, 22 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_10_BETA, 1, kDiabloIIProductName, { 1, 0, 10, 9 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_10S_BETA, 1, kDiabloIIProductName, { 1, 0, 10, 10 },
+        NULL, { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_10, 1, kDiabloIIProductName, { 1, 0, 10, 39 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_11, 1, kDiabloIIProductName, { 1, 0, 11, 45 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_11B, 1, kDiabloIIProductName, { 1, 0, 11, 46 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_12A, 1, kDiabloIIProductName, { 1, 0, 12, 49 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_13A_PTR, 1, kDiabloIIProductName, { 1, 0, 13, 55 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_13C, 1, kDiabloIIProductName, { 1, 0, 13, 60 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_13D, 1, kDiabloIIProductName, { 1, 0, 13, 64 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_14A, 1, kDiabloIIProductName, { 1, 14, 0, 64 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_14B, 1, kDiabloIIProductName, { 1, 14, 1, 68 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_14C, 1, kDiabloIIProductName, { 1, 14, 2, 70 }, NULL,
+        { 0 }, 0, { 0 }
+    },
+    {
+        DIABLO_II_1_14D, 1, kDiabloIIProductName, { 1, 14, 3, 71 }, NULL,
+        { 0 }, 0, { 0 }
+    }
+};
+
+struct DetectionFixture {
+  const struct DetectionFixtureSpec* spec;
+
+  unsigned char* game_data;
+  size_t game_size;
+
+  struct KnowledgeFileBuffer storm_buffer;
+};
+
+/* The state of a benchmark that cycles through a set of inputs. */
+struct CycleContext {
+  const void* items;
+  size_t num_items;
+  size_t i_item;
+};
+
+struct VersionBlockContext {
+  const unsigned char* block;
+  size_t block_size;
+};
+
+static volatile int sink;
+
+static int DetectionFixture_Init(
+    struct DetectionFixture* fixture,
+    const struct DetectionFixtureSpec* spec
+) {
+  struct FixturePeSpec pe_spec;
+  unsigned char* storm_data;
+  size_t storm_size;
+
+  fixture->spec = spec;
+
+  FixturePeSpec_Init(&pe_spec);
+  pe_spec.product_name = spec->product_name;
+  pe_spec.file_version_str = spec->file_version_str;
+  pe_spec.file_version_ms = MAKE_VERSION_MS(
+      spec->game_version_parts[0],
+      spec->game_version_parts[1]
+  );
+  pe_spec.file_version_ls = MAKE_VERSION_MS(
+      spec->game_version_parts[2],
+      spec->game_version_parts[3]
+  );
+  pe_spec.product_version_ms = pe_spec.file_version_ms;
+  pe_spec.product_version_ls = pe_spec.file_version_ls;
+
+  fixture->game_data = FixturePe_Build(&pe_spec, &fixture->game_size);
+
+  if (fixture->game_data == NULL) {
+    return 0;
+  }
+
+  FixturePeSpec_Init(&pe_spec);
+  pe_spec.characteristics = IMAGE_FILE_DLL;
+  pe_spec.product_name = L"Storm";
+  pe_spec.file_version_ms = MAKE_VERSION_MS(
+      spec->storm_version_parts[0],
+      spec->storm_version_parts[1]
+  );
+  pe_spec.file_version_ls = MAKE_VERSION_MS(
+      spec->storm_version_parts[2],
+      spec->storm_version_parts[3]
+  );
+  pe_spec.product_version_ms = pe_spec.file_version_ms;
+  pe_spec.product_version_ls = pe_spec.file_version_ls;
+  pe_spec.signature_offset = spec->storm_signature_offset;
+  memcpy(
+      pe_spec.signature,
+      spec->storm_signature,
+      sizeof(pe_spec.signature)
+  );
+
+  storm_data = FixturePe_Build(&pe_spec, &storm_size);
+
+  if (storm_data == NULL) {
+    free(fixture->game_data);
+    return 0;
+  }
+
+  fixture->storm_buffer.file_name = L"Storm.dll";
+  fixture->storm_buffer.data = storm_data;
+  fixture->storm_buffer.size = storm_size;
+
+  return 1;
+}
+
+static void DetectionFixture_Deinit(struct DetectionFixture* fixture) {
+  free((void*) fixture->storm_buffer.data);
+  free(fixture->game_data);
+}
+
+static int DetectionFixture_Detect(
+    const struct DetectionFixture* fixture,
+    enum GameVersion* game_version
+) {
+  struct KnowledgeGameDetection detection;
+
+  return BufferDetection_DetectGameVersion(
+      fixture->game_data,
+      fixture->game_size,
+      &fixture->storm_buffer,
+      1,
+      &detection,
+      game_version
+  );
+}
+
+static void RunDetect(void* context) {
+  enum GameVersion game_version;
+
+  DetectionFixture_Detect(context, &game_version);
+
+  sink = game_version;
+}
+
+static void RunDetectAll(void* context) {
+  const struct DetectionFixture* fixtures;
+  enum GameVersion game_version;
+  size_t i_fixture;
+
+  fixtures = context;
+
+  for (i_fixture = 0; i_fixture < NUM_GAME_VERSIONS; i_fixture += 1) {
+    DetectionFixture_Detect(&fixtures[i_fixture], &game_version);
+  }
+
+  sink = game_version;
+}
+
+static void RunExtractFileInfo(void* context) {
+  const struct DetectionFixture* fixture;
+  VS_FIXEDFILEINFO file_info;
+
+  fixture = context;
+
+  sink = BufferDetection_ExtractFileInfo(
+      fixture->game_data,
+      fixture->game_size,
+      &file_info
+  );
+}
+
+static void RunParseFileInfo(void* context) {
+  const struct VersionBlockContext* block_context;
+  VS_FIXEDFILEINFO file_info;
+
+  block_context = context;
+
+  sink = VersionResource_ParseFileInfo(
+      &file_info,
+      block_context->block,
+      block_context->block_size
+  );
+}
+
+static void RunExtractStringValue(void* context) {
+  const struct VersionBlockContext* block_context;
+  wchar_t* product_name;
+
+  block_context = context;
+
+  product_name = VersionResource_ExtractStringValue(
+      block_context->block,
+      block_context->block_size,
+      L"ProductName",
+      (sizeof(L"ProductName") / sizeof(wchar_t)) - 1
+  );
+
+  sink = product_name != NULL;
+
+  free(product_name);
+}
+
+static void RunShortVersionCompare(void* context) {
+  struct CycleContext* cycle_context;
+  const struct ShortVersion* versions;
+  size_t i_next;
+
+  cycle_context = context;
+  versions = cycle_context->items;
+
+  i_next = (cycle_context->i_item + 1) % cycle_context->num_items;
+
+  sink = ShortVersion_CompareAll(
+      &versions[cycle_context->i_item],
+      &versions[i_next]
+  );
+
+  cycle_context->i_item = i_next;
+}
+
+static void RunFileSignatureCompare(void* context) {
+  struct CycleContext* cycle_context;
+  const struct FileSignature* signatures;
+  size_t i_next;
+
+  cycle_context = context;
+  signatures = cycle_context->items;
+
+  i_next = (cycle_context->i_item + 1) % cycle_context->num_items;
+
+  sink = FileSignature_CompareAll(
+      &signatures[cycle_context->i_item],
+      &signatures[i_next]
+  );
+
+  cycle_context->i_item = i_next;
+}
+
+static void RunSearchGameFileVersion(void* context) {
+  struct CycleContext* cycle_context;
+  const VS_FIXEDFILEINFO* file_infos;
+
+  cycle_context = context;
+  file_infos = cycle_context->items;
+
+  sink = Diablo_II_SearchGameFileVersion(
+      &file_infos[cycle_context->i_item]
+  );
+
+  cycle_context->i_item =
+      (cycle_context->i_item + 1) % cycle_context->num_items;
+}
+
+static void MeasureAndReport(
+    const char* name,
+    void (*func)(void* context),
+    void* context
+) {
+  struct BenchResult result;
+
+  BenchUtil_Measure(&result, name, func, context);
+  BenchUtil_ReportResult(&result);
+}
+
+/* Returns zero if any fixture is not detected as its version. */
+static int CheckFixtures(const struct DetectionFixture* fixtures) {
+  size_t i_fixture;
+  const struct DetectionFixtureSpec* spec;
+  enum GameVersion expected_game_version;
+  enum GameVersion game_version;
+  int is_all_detected;
+
+  is_all_detected = 1;
+
+  for (i_fixture = 0; i_fixture < NUM_GAME_VERSIONS; i_fixture += 1) {
+    spec = fixtures[i_fixture].spec;
+
+    expected_game_version = spec->is_detectable
+        ? spec->game_version
+        : VERSION_UNKNOWN;
+
+    if (!DetectionFixture_Detect(&fixtures[i_fixture], &game_version)) {
+      fprintf(
+          stderr,
+          "The fixture of %s could not be read.\n",
+          kGameVersionNames[spec->game_version - 1]
+      );
+
+      is_all_detected = 0;
+    } else if (game_version != expected_game_version) {
+      fprintf(
+          stderr,
+          "The fixture of %s was detected as %s.\n",
+          kGameVersionNames[spec->game_version - 1],
+          (game_version == VERSION_UNKNOWN)
+              ? "VERSION_UNKNOWN"
+              : kGameVersionNames[game_version - 1]
+      );
+
+      is_all_detected = 0;
+    }
+  }
+
+  return is_all_detected;
+}
+
+int main(void) {
+  struct DetectionFixture fixtures[NUM_GAME_VERSIONS];
+  size_t num_fixtures;
+  size_t i_fixture;
+  const struct DetectionFixtureSpec* spec;
+
+  struct ShortVersion short_versions[NUM_GAME_VERSIONS];
+  VS_FIXEDFILEINFO diablo_ii_file_infos[NUM_GAME_VERSIONS];
+  size_t num_diablo_ii_file_infos;
+  struct FileSignature file_signatures[NUM_GAME_VERSIONS];
+  size_t num_file_signatures;
+
+  struct FixturePeSpec pe_spec;
+  struct VersionBlockContext block_context;
+  unsigned char* version_block;
+  struct CycleContext cycle_context;
+  char result_name[128];
+  int exit_status;
+
+  /* A fixture is needed for every version, in the order of the enum. */
+  if (sizeof(kFixtureSpecs) / sizeof(kFixtureSpecs[0]) != NUM_GAME_VERSIONS) {
+    fprintf(stderr, "A game version does not have a fixture.\n");
+    return EXIT_FAILURE;
+  }
+
+  for (i_fixture = 0; i_fixture < NUM_GAME_VERSIONS; i_fixture += 1) {
+    if (kFixtureSpecs[i_fixture].game_version != i_fixture + 1) {
+      fprintf(
+          stderr,
+          "The fixture of %s is out of order.\n",
+          kGameVersionNames[i_fixture]
+      );
+
+      return EXIT_FAILURE;
+    }
+  }
+
+  ErrorHandling_Init();
+
+  exit_status = EXIT_FAILURE;
+
+  for (num_fixtures = 0;
+      num_fixtures < NUM_GAME_VERSIONS;
+      num_fixtures += 1) {
+    if (!DetectionFixture_Init(
+        &fixtures[num_fixtures],
+        &kFixtureSpecs[num_fixtures]
+    )) {
+      fprintf(stderr, "The fixtures could not be built.\n");
+      goto deinit_fixtures;
+    }
+  }
+
+  if (!CheckFixtures(fixtures)) {
+    goto deinit_fixtures;
+  }
+
+  /* The inputs of the parts of the detection, from every fixture. */
+  num_diablo_ii_file_infos = 0;
+  num_file_signatures = 0;
+
+  for (i_fixture = 0; i_fixture < NUM_GAME_VERSIONS; i_fixture += 1) {
+    spec = &kFixtureSpecs[i_fixture];
+
+    short_versions[i_fixture].major_left = spec->game_version_parts[0];
+    short_versions[i_fixture].major_right = spec->game_version_parts[1];
+    short_versions[i_fixture].minor_left = spec->game_version_parts[2];
+    short_versions[i_fixture].minor_right = spec->game_version_parts[3];
+
+    if (spec->product_name == kDiabloIIProductName) {
+      memset(
+          &diablo_ii_file_infos[num_diablo_ii_file_infos],
+          0,
+          sizeof(diablo_ii_file_infos[0])
+      );
+
+      diablo_ii_file_infos[num_diablo_ii_file_infos].dwFileVersionMS =
+          MAKE_VERSION_MS(
+              spec->game_version_parts[0],
+              spec->game_version_parts[1]
+          );
+      diablo_ii_file_infos[num_diablo_ii_file_infos].dwFileVersionLS =
+          MAKE_VERSION_MS(
+              spec->game_version_parts[2],
+              spec->game_version_parts[3]
+          );
+
+      num_diablo_ii_file_infos += 1;
+    }
+
+    if (spec->storm_signature_offset != 0) {
+      file_signatures[num_file_signatures].file_path = L"storm.dll";
+      file_signatures[num_file_signatures].offset =
+          spec->storm_signature_offset;
+      memcpy(
+          file_signatures[num_file_signatures].signature,
+          spec->storm_signature,
+          sizeof(spec->storm_signature)
+      );
+
+      num_file_signatures += 1;
+    }
+  }
+
+  FixturePeSpec_Init(&pe_spec);
+  pe_spec.product_name = kDiabloIIProductName;
+  pe_spec.file_version_str = L"1, 14, 3, 71";
+  pe_spec.file_version_ms = MAKE_VERSION_MS(1, 14);
+  pe_spec.file_version_ls = MAKE_VERSION_MS(3, 71);
+
+  version_block = FixturePe_BuildVersionBlock(
+      &pe_spec,
+      &block_context.block_size
+  );
+
+  if (version_block == NULL) {
+    fprintf(stderr, "The version block could not be built.\n");
+    goto deinit_fixtures;
+  }
+
+  block_context.block = version_block;
+
+  BenchUtil_BeginReport("detection");
+
+  for (i_fixture = 0; i_fixture < NUM_GAME_VERSIONS; i_fixture += 1) {
+    sprintf(
+        result_name,
+        "detect/%s%s",
+        kGameVersionNames[i_fixture],
+        kFixtureSpecs[i_fixture].is_detectable ? "" : "/undetectable"
+    );
+    MeasureAndReport(result_name, &RunDetect, &fixtures[i_fixture]);
+  }
+
+  MeasureAndReport("detect/all_versions", &RunDetectAll, fixtures);
+
+  MeasureAndReport(
+      "buffer_detection/extract_file_info",
+      &RunExtractFileInfo,
+      &fixtures[NUM_GAME_VERSIONS - 1]
+  );
+
+  MeasureAndReport(
+      "version_resource/parse_file_info",
+      &RunParseFileInfo,
+      &block_context
+  );
+
+  MeasureAndReport(
+      "version_resource/extract_string_value",
+      &RunExtractStringValue,
+      &block_context
+  );
+
+  cycle_context.items = short_versions;
+  cycle_context.num_items = NUM_GAME_VERSIONS;
+  cycle_context.i_item = 0;
+  MeasureAndReport(
+      "short_version/compare_all",
+      &RunShortVersionCompare,
+      &cycle_context
+  );
+
+  cycle_context.items = file_signatures;
+  cycle_context.num_items = num_file_signatures;
+  cycle_context.i_item = 0;
+  MeasureAndReport(
+      "file_signature/compare_all",
+      &RunFileSignatureCompare,
+      &cycle_context
+  );
+
+  cycle_context.items = diablo_ii_file_infos;
+  cycle_context.num_items = num_diablo_ii_file_infos;
+  cycle_context.i_item = 0;
+  MeasureAndReport(
+      "diablo_ii/search_game_file_version",
+      &RunSearchGameFileVersion,
+      &cycle_context
+  );
+
+  BenchUtil_EndReport();
+
+  free(version_block);
+
+  exit_status = EXIT_SUCCESS;
+
+deinit_fixtures:
+  for (i_fixture = 0; i_fixture < num_fixtures; i_fixture += 1) {
+    DetectionFixture_Deinit(&fixtures[i_fixture]);
+  }
+
+  ErrorHandling_Deinit();
+
+  return exit_status;
+}
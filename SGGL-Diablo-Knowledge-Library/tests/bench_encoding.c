@@ -0,0 +1,232 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+/*
+* Compares the in-buffer conversions with the two-pass conversions that
+* allocate their result, which they replaced on the hot paths. Both
+* call the same WideCharToMultiByte, so the difference is in the number
+* of passes, the ASCII fast path and the allocations. The outputs are
+* checked to be equal before anything is timed.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "../src/helper/encoding.h"
+#include "../src/helper/error_handling.h"
+#include "bench_util.h"
+
+enum Constant {
+  LONG_PATH_LEN = 400
+};
+
+struct EncodingCase {
+  const char* name;
+  const wchar_t* wide_string;
+};
+
+struct EncodingBenchContext {
+  const wchar_t* wide_string;
+  int is_utf8;
+};
+
+static void RunInBuffer(void* context) {
+  struct EncodingBenchContext* bench_context;
+  struct ConvertedString converted_string;
+  char buffer[MAX_PATH];
+
+  bench_context = context;
+
+  if (bench_context->is_utf8) {
+    ConvertWideToUtf8InBuffer(
+        &converted_string,
+        buffer,
+        sizeof(buffer),
+        bench_context->wide_string
+    );
+  } else {
+    ConvertWideToMultibyteInBuffer(
+        &converted_string,
+        buffer,
+        sizeof(buffer),
+        bench_context->wide_string
+    );
+  }
+
+  ConvertedString_Deinit(&converted_string);
+}
+
+static void RunReference(void* context) {
+  struct EncodingBenchContext* bench_context;
+  char* converted_string;
+
+  bench_context = context;
+
+  converted_string = bench_context->is_utf8
+      ? ConvertWideToUtf8(NULL, bench_context->wide_string)
+      : ConvertWideToMultibyte(NULL, bench_context->wide_string);
+
+  free(converted_string);
+}
+
+/* Returns zero if the in-buffer conversion differs from the reference. */
+static int CheckCase(const struct EncodingBenchContext* bench_context) {
+  struct ConvertedString converted_string;
+  char buffer[MAX_PATH];
+  char* expected_string;
+  int is_equal;
+
+  expected_string = bench_context->is_utf8
+      ? ConvertWideToUtf8(NULL, bench_context->wide_string)
+      : ConvertWideToMultibyte(NULL, bench_context->wide_string);
+
+  if (bench_context->is_utf8) {
+    ConvertWideToUtf8InBuffer(
+        &converted_string,
+        buffer,
+        sizeof(buffer),
+        bench_context->wide_string
+    );
+  } else {
+    ConvertWideToMultibyteInBuffer(
+        &converted_string,
+        buffer,
+        sizeof(buffer),
+        bench_context->wide_string
+    );
+  }
+
+  is_equal = expected_string != NULL
+      && converted_string.str != NULL
+      && converted_string.len == strlen(expected_string)
+      && strcmp(converted_string.str, expected_string) == 0;
+
+  ConvertedString_Deinit(&converted_string);
+  free(expected_string);
+
+  return is_equal;
+}
+
+int main(void) {
+  static const char* const kCodePageNames[] = { "multibyte", "utf8" };
+
+  wchar_t long_ascii_path[LONG_PATH_LEN + 1];
+  wchar_t long_latin1_path[LONG_PATH_LEN + 1];
+  struct EncodingCase cases[5];
+  struct EncodingBenchContext bench_context;
+  struct BenchResult result;
+  char result_name[128];
+  size_t i_case;
+  size_t i;
+  int is_all_equal;
+
+  ErrorHandling_Init();
+
+  for (i = 0; i < LONG_PATH_LEN; i += 1) {
+    long_ascii_path[i] = (i % 16 == 15) ? L'\\' : L'a';
+    long_latin1_path[i] = (i % 16 == 15) ? L'\\' : (wchar_t) 0x00E9;
+  }
+
+  long_ascii_path[LONG_PATH_LEN] = L'\0';
+  long_latin1_path[LONG_PATH_LEN] = L'\0';
+
+  cases[0].name = "ascii_path";
+  cases[0].wide_string = L"C:\\Program Files\\Diablo II\\Game.exe";
+  cases[1].name = "latin1_path";
+  cases[1].wide_string = L"C:\\Jeux\\Diablo II\\Donn\x00E9" L"es\\Game.exe";
+  cases[2].name = "cjk_path";
+  cases[2].wide_string =
+      L"C:\\\x30B2\x30FC\x30E0\\\x30C7\x30A3\x30A2\x30D6\x30ED\\Game.exe";
+  cases[3].name = "long_ascii_path";
+  cases[3].wide_string = long_ascii_path;
+  cases[4].name = "long_latin1_path";
+  cases[4].wide_string = long_latin1_path;
+
+  is_all_equal = 1;
+
+  for (bench_context.is_utf8 = 0;
+      bench_context.is_utf8 <= 1;
+      bench_context.is_utf8 += 1) {
+    for (i_case = 0; i_case < sizeof(cases) / sizeof(cases[0]); i_case += 1) {
+      bench_context.wide_string = cases[i_case].wide_string;
+
+      if (!CheckCase(&bench_context)) {
+        fprintf(
+            stderr,
+            "The %s conversion of %s differs from the reference.\n",
+            kCodePageNames[bench_context.is_utf8],
+            cases[i_case].name
+        );
+
+        is_all_equal = 0;
+      }
+    }
+  }
+
+  if (!is_all_equal) {
+    return EXIT_FAILURE;
+  }
+
+  BenchUtil_BeginReport("encoding");
+
+  for (bench_context.is_utf8 = 0;
+      bench_context.is_utf8 <= 1;
+      bench_context.is_utf8 += 1) {
+    for (i_case = 0; i_case < sizeof(cases) / sizeof(cases[0]); i_case += 1) {
+      bench_context.wide_string = cases[i_case].wide_string;
+
+      sprintf(
+          result_name,
+          "%s/%s/in_buffer",
+          kCodePageNames[bench_context.is_utf8],
+          cases[i_case].name
+      );
+      BenchUtil_Measure(&result, result_name, &RunInBuffer, &bench_context);
+      BenchUtil_ReportResult(&result);
+
+      sprintf(
+          result_name,
+          "%s/%s/reference",
+          kCodePageNames[bench_context.is_utf8],
+          cases[i_case].name
+      );
+      BenchUtil_Measure(&result, result_name, &RunReference, &bench_context);
+      BenchUtil_ReportResult(&result);
+    }
+  }
+
+  BenchUtil_EndReport();
+
+  ErrorHandling_Deinit();
+
+  return EXIT_SUCCESS;
+}
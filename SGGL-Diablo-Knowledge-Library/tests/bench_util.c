@@ -0,0 +1,157 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#include "bench_util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+enum Constant {
+  MIN_MEASURE_NANOSECONDS = 200000000,
+  NANOSECONDS_PER_SECOND = 1000000000
+};
+
+static volatile unsigned long num_allocations = 0;
+static volatile unsigned long num_bytes_allocated = 0;
+
+static int is_first_result;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  __sync_fetch_and_add(&num_allocations, 1);
+  __sync_fetch_and_add(&num_bytes_allocated, size);
+
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  __sync_fetch_and_add(&num_allocations, 1);
+  __sync_fetch_and_add(&num_bytes_allocated, count * size);
+
+  return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  __sync_fetch_and_add(&num_allocations, 1);
+  __sync_fetch_and_add(&num_bytes_allocated, size);
+
+  return __real_realloc(ptr, size);
+}
+
+static double GetNanoseconds(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (double) now.tv_sec * NANOSECONDS_PER_SECOND + now.tv_nsec;
+}
+
+void BenchUtil_Measure(
+    struct BenchResult* result,
+    const char* name,
+    void (*func)(void* context),
+    void* context
+) {
+  unsigned long num_batch_calls;
+  unsigned long i_call;
+  unsigned long start_num_allocations;
+  unsigned long start_num_bytes_allocated;
+  double start_time;
+  double elapsed_time;
+
+  /* Warm up the caches, and any state that is initialized once. */
+  func(context);
+
+  result->name = name;
+  result->num_calls = 0;
+
+  start_num_allocations = num_allocations;
+  start_num_bytes_allocated = num_bytes_allocated;
+  start_time = GetNanoseconds();
+  elapsed_time = 0;
+
+  for (num_batch_calls = 1;
+      elapsed_time < MIN_MEASURE_NANOSECONDS;
+      num_batch_calls *= 2) {
+    for (i_call = 0; i_call < num_batch_calls; i_call += 1) {
+      func(context);
+    }
+
+    result->num_calls += num_batch_calls;
+    elapsed_time = GetNanoseconds() - start_time;
+  }
+
+  result->ns_per_call = elapsed_time / result->num_calls;
+  result->calls_per_second = result->num_calls
+      * (double) NANOSECONDS_PER_SECOND
+      / elapsed_time;
+  result->allocations_per_call =
+      (double) (num_allocations - start_num_allocations) / result->num_calls;
+  result->bytes_allocated_per_call =
+      (double) (num_bytes_allocated - start_num_bytes_allocated)
+          / result->num_calls;
+}
+
+void BenchUtil_BeginReport(const char* suite_name) {
+  printf("{\"suite\":\"%s\",\"results\":[", suite_name);
+
+  is_first_result = 1;
+}
+
+void BenchUtil_ReportResult(const struct BenchResult* result) {
+  printf(
+      "%s\n  {\"name\":\"%s\",\"calls\":%lu,\"ns_per_call\":%.1f,"
+          "\"calls_per_second\":%.0f,\"allocations_per_call\":%.2f,"
+          "\"bytes_allocated_per_call\":%.1f}",
+      is_first_result ? "" : ",",
+      result->name,
+      result->num_calls,
+      result->ns_per_call,
+      result->calls_per_second,
+      result->allocations_per_call,
+      result->bytes_allocated_per_call
+  );
+
+  fflush(stdout);
+
+  is_first_result = 0;
+}
+
+void BenchUtil_EndReport(void) {
+  printf("\n]}\n");
+}
+
+unsigned long BenchUtil_GetNumAllocations(void) {
+  return num_allocations;
+}
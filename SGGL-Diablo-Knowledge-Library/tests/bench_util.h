@@ -0,0 +1,74 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#ifndef SGGLDKL_TESTS_BENCH_UTIL_H_
+#define SGGLDKL_TESTS_BENCH_UTIL_H_
+
+#include <stddef.h>
+
+/*
+* Times a function by calling it in batches until a minimum duration
+* has passed, and counts the heap allocations made by the library
+* during the calls. The results are printed as one JSON report per
+* suite, so that they can be compared across releases.
+*
+* Allocations are counted by wrapping malloc, calloc and realloc with
+* the linker, so the benchmarks must be linked with the wrap flags in
+* the Makefile.
+*/
+
+struct BenchResult {
+  const char* name;
+
+  unsigned long num_calls;
+  double ns_per_call;
+  double calls_per_second;
+  double allocations_per_call;
+  double bytes_allocated_per_call;
+};
+
+void BenchUtil_Measure(
+    struct BenchResult* result,
+    const char* name,
+    void (*func)(void* context),
+    void* context
+);
+
+void BenchUtil_BeginReport(const char* suite_name);
+
+/* Adds a result to the report and prints it as a JSON object. */
+void BenchUtil_ReportResult(const struct BenchResult* result);
+
+void BenchUtil_EndReport(void);
+
+/* Returns the allocations counted since the program started. */
+unsigned long BenchUtil_GetNumAllocations(void);
+
+#endif /* SGGLDKL_TESTS_BENCH_UTIL_H_ */
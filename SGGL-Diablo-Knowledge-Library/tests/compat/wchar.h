@@ -0,0 +1,88 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+/*
+* Wraps the C library's wchar.h, so that the sources that only include
+* wchar.h also get the wide string functions for a 16-bit wchar_t.
+*/
+
+#ifndef SGGLDKL_TESTS_COMPAT_WCHAR_H_
+#define SGGLDKL_TESTS_COMPAT_WCHAR_H_
+
+#include <stddef.h>
+#include <stdio.h>
+#include_next <wchar.h>
+
+/*
+* glibc implements the wide string functions for a 32-bit wchar_t, so
+* they are replaced by ones for the 16-bit wchar_t used by Windows.
+*/
+#define wcslen Compat_wcslen
+#define wcscmp Compat_wcscmp
+#define wcsncmp Compat_wcsncmp
+#define wcscpy Compat_wcscpy
+#define wcsncpy Compat_wcsncpy
+#define wcschr Compat_wcschr
+#define wcsrchr Compat_wcsrchr
+#define _wcsicmp Compat_wcsicmp
+#define _wcsnicmp Compat_wcsnicmp
+#define _snwprintf Compat_snwprintf
+#define _snprintf snprintf
+#define _wfopen Compat_wfopen
+
+size_t Compat_wcslen(const wchar_t* str);
+int Compat_wcscmp(const wchar_t* str1, const wchar_t* str2);
+int Compat_wcsncmp(const wchar_t* str1, const wchar_t* str2, size_t count);
+wchar_t* Compat_wcscpy(wchar_t* dest, const wchar_t* src);
+wchar_t* Compat_wcsncpy(wchar_t* dest, const wchar_t* src, size_t count);
+wchar_t* Compat_wcschr(const wchar_t* str, wchar_t ch);
+wchar_t* Compat_wcsrchr(const wchar_t* str, wchar_t ch);
+int Compat_wcsicmp(const wchar_t* str1, const wchar_t* str2);
+int Compat_wcsnicmp(
+    const wchar_t* str1,
+    const wchar_t* str2,
+    size_t count
+);
+
+/*
+* Supports the flags, width and the c, d, u, x, X, s, hs and ls
+* conversions. As with the Microsoft CRT, %s is a wide string. Returns
+* a negative value if the output was truncated.
+*/
+int Compat_snwprintf(
+    wchar_t* buffer,
+    size_t count,
+    const wchar_t* format,
+    ...
+);
+
+FILE* Compat_wfopen(const wchar_t* path, const wchar_t* mode);
+
+#endif /* SGGLDKL_TESTS_COMPAT_WCHAR_H_ */
@@ -0,0 +1,672 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+/*
+* The subset of the Windows API that is used by the portable parts of
+* the library, implemented on POSIX so that they can be tested and
+* benchmarked on a Linux host. The sources must be compiled with
+* -fshort-wchar, so that wchar_t has the same size as WCHAR.
+*
+* The structs that are read from PE files have the same layout as on
+* Windows. Process and thread access to other processes is not
+* implemented, and always fails with ERROR_NOT_SUPPORTED.
+*/
+
+#ifndef SGGLDKL_TESTS_COMPAT_WINDOWS_H_
+#define SGGLDKL_TESTS_COMPAT_WINDOWS_H_
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+#define WINAPI
+#define CALLBACK
+#define __stdcall
+#define __cdecl
+#define __declspec(x)
+
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef unsigned int DWORD;
+typedef int LONG;
+typedef unsigned int UINT;
+typedef unsigned int ULONG;
+typedef long long LONGLONG;
+typedef unsigned long long ULONGLONG;
+typedef unsigned long ULONG_PTR;
+typedef unsigned long DWORD_PTR;
+typedef size_t SIZE_T;
+typedef char CHAR;
+typedef wchar_t WCHAR;
+
+typedef void* HANDLE;
+typedef void* HMODULE;
+typedef void* HINSTANCE;
+typedef void* HWND;
+typedef void* LPVOID;
+typedef const void* LPCVOID;
+typedef char* LPSTR;
+typedef const char* LPCSTR;
+typedef wchar_t* LPWSTR;
+typedef const wchar_t* LPCWSTR;
+typedef DWORD* LPDWORD;
+typedef int (WINAPI *FARPROC)(void);
+
+typedef DWORD (WINAPI *LPTHREAD_START_ROUTINE)(LPVOID);
+typedef void (WINAPI *PAPCFUNC)(ULONG_PTR);
+
+typedef LONG NTSTATUS;
+
+typedef union _LARGE_INTEGER {
+  struct {
+    DWORD LowPart;
+    LONG HighPart;
+  } u;
+  LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef struct _FILETIME {
+  DWORD dwLowDateTime;
+  DWORD dwHighDateTime;
+} FILETIME;
+
+typedef struct _SECURITY_ATTRIBUTES {
+  DWORD nLength;
+  LPVOID lpSecurityDescriptor;
+  BOOL bInheritHandle;
+} SECURITY_ATTRIBUTES;
+
+typedef struct _PROCESS_INFORMATION {
+  HANDLE hProcess;
+  HANDLE hThread;
+  DWORD dwProcessId;
+  DWORD dwThreadId;
+} PROCESS_INFORMATION;
+
+typedef struct _BY_HANDLE_FILE_INFORMATION {
+  DWORD dwFileAttributes;
+  FILETIME ftCreationTime;
+  FILETIME ftLastAccessTime;
+  FILETIME ftLastWriteTime;
+  DWORD dwVolumeSerialNumber;
+  DWORD nFileSizeHigh;
+  DWORD nFileSizeLow;
+  DWORD nNumberOfLinks;
+  DWORD nFileIndexHigh;
+  DWORD nFileIndexLow;
+} BY_HANDLE_FILE_INFORMATION;
+
+typedef struct _OVERLAPPED {
+  ULONG_PTR Internal;
+  ULONG_PTR InternalHigh;
+  DWORD Offset;
+  DWORD OffsetHigh;
+  HANDLE hEvent;
+} OVERLAPPED;
+
+typedef struct _SYSTEM_INFO {
+  WORD wProcessorArchitecture;
+  WORD wReserved;
+  DWORD dwPageSize;
+  LPVOID lpMinimumApplicationAddress;
+  LPVOID lpMaximumApplicationAddress;
+  DWORD_PTR dwActiveProcessorMask;
+  DWORD dwNumberOfProcessors;
+  DWORD dwProcessorType;
+  DWORD dwAllocationGranularity;
+  WORD wProcessorLevel;
+  WORD wProcessorRevision;
+} SYSTEM_INFO;
+
+typedef struct _MEMORY_BASIC_INFORMATION {
+  LPVOID BaseAddress;
+  LPVOID AllocationBase;
+  DWORD AllocationProtect;
+  SIZE_T RegionSize;
+  DWORD State;
+  DWORD Protect;
+  DWORD Type;
+} MEMORY_BASIC_INFORMATION;
+
+/* Recursive, like the Windows critical section. */
+typedef struct _CRITICAL_SECTION {
+  pthread_mutex_t mutex;
+} CRITICAL_SECTION;
+
+typedef struct _VS_FIXEDFILEINFO {
+  DWORD dwSignature;
+  DWORD dwStrucVersion;
+  DWORD dwFileVersionMS;
+  DWORD dwFileVersionLS;
+  DWORD dwProductVersionMS;
+  DWORD dwProductVersionLS;
+  DWORD dwFileFlagsMask;
+  DWORD dwFileFlags;
+  DWORD dwFileOS;
+  DWORD dwFileType;
+  DWORD dwFileSubtype;
+  DWORD dwFileDateMS;
+  DWORD dwFileDateLS;
+} VS_FIXEDFILEINFO;
+
+typedef struct _IMAGE_DOS_HEADER {
+  WORD e_magic;
+  WORD e_cblp;
+  WORD e_cp;
+  WORD e_crlc;
+  WORD e_cparhdr;
+  WORD e_minalloc;
+  WORD e_maxalloc;
+  WORD e_ss;
+  WORD e_sp;
+  WORD e_csum;
+  WORD e_ip;
+  WORD e_cs;
+  WORD e_lfarlc;
+  WORD e_ovno;
+  WORD e_res[4];
+  WORD e_oemid;
+  WORD e_oeminfo;
+  WORD e_res2[10];
+  LONG e_lfanew;
+} IMAGE_DOS_HEADER;
+
+typedef struct _IMAGE_FILE_HEADER {
+  WORD Machine;
+  WORD NumberOfSections;
+  DWORD TimeDateStamp;
+  DWORD PointerToSymbolTable;
+  DWORD NumberOfSymbols;
+  WORD SizeOfOptionalHeader;
+  WORD Characteristics;
+} IMAGE_FILE_HEADER;
+
+typedef struct _IMAGE_DATA_DIRECTORY {
+  DWORD VirtualAddress;
+  DWORD Size;
+} IMAGE_DATA_DIRECTORY;
+
+#define IMAGE_NUMBEROF_DIRECTORY_ENTRIES 16
+
+typedef struct _IMAGE_OPTIONAL_HEADER {
+  WORD Magic;
+  BYTE MajorLinkerVersion;
+  BYTE MinorLinkerVersion;
+  DWORD SizeOfCode;
+  DWORD SizeOfInitializedData;
+  DWORD SizeOfUninitializedData;
+  DWORD AddressOfEntryPoint;
+  DWORD BaseOfCode;
+  DWORD BaseOfData;
+  DWORD ImageBase;
+  DWORD SectionAlignment;
+  DWORD FileAlignment;
+  WORD MajorOperatingSystemVersion;
+  WORD MinorOperatingSystemVersion;
+  WORD MajorImageVersion;
+  WORD MinorImageVersion;
+  WORD MajorSubsystemVersion;
+  WORD MinorSubsystemVersion;
+  DWORD Win32VersionValue;
+  DWORD SizeOfImage;
+  DWORD SizeOfHeaders;
+  DWORD CheckSum;
+  WORD Subsystem;
+  WORD DllCharacteristics;
+  DWORD SizeOfStackReserve;
+  DWORD SizeOfStackCommit;
+  DWORD SizeOfHeapReserve;
+  DWORD SizeOfHeapCommit;
+  DWORD LoaderFlags;
+  DWORD NumberOfRvaAndSizes;
+  IMAGE_DATA_DIRECTORY DataDirectory[IMAGE_NUMBEROF_DIRECTORY_ENTRIES];
+} IMAGE_OPTIONAL_HEADER32, IMAGE_OPTIONAL_HEADER;
+
+typedef struct _IMAGE_NT_HEADERS {
+  DWORD Signature;
+  IMAGE_FILE_HEADER FileHeader;
+  IMAGE_OPTIONAL_HEADER32 OptionalHeader;
+} IMAGE_NT_HEADERS32, IMAGE_NT_HEADERS;
+
+typedef struct _IMAGE_SECTION_HEADER {
+  BYTE Name[8];
+  union {
+    DWORD PhysicalAddress;
+    DWORD VirtualSize;
+  } Misc;
+  DWORD VirtualAddress;
+  DWORD SizeOfRawData;
+  DWORD PointerToRawData;
+  DWORD PointerToRelocations;
+  DWORD PointerToLinenumbers;
+  WORD NumberOfRelocations;
+  WORD NumberOfLinenumbers;
+  DWORD Characteristics;
+} IMAGE_SECTION_HEADER;
+
+typedef struct _IMAGE_IMPORT_DESCRIPTOR {
+  /* A union with Characteristics on Windows. */
+  DWORD OriginalFirstThunk;
+  DWORD TimeDateStamp;
+  DWORD ForwarderChain;
+  DWORD Name;
+  DWORD FirstThunk;
+} IMAGE_IMPORT_DESCRIPTOR;
+
+typedef struct _IMAGE_EXPORT_DIRECTORY {
+  DWORD Characteristics;
+  DWORD TimeDateStamp;
+  WORD MajorVersion;
+  WORD MinorVersion;
+  DWORD Name;
+  DWORD Base;
+  DWORD NumberOfFunctions;
+  DWORD NumberOfNames;
+  DWORD AddressOfFunctions;
+  DWORD AddressOfNames;
+  DWORD AddressOfNameOrdinals;
+} IMAGE_EXPORT_DIRECTORY;
+
+typedef struct _IMAGE_RESOURCE_DATA_ENTRY {
+  DWORD OffsetToData;
+  DWORD Size;
+  DWORD CodePage;
+  DWORD Reserved;
+} IMAGE_RESOURCE_DATA_ENTRY;
+
+#define TRUE 1
+#define FALSE 0
+
+#define MAX_PATH 260
+#define INFINITE 0xFFFFFFFF
+#define INVALID_HANDLE_VALUE ((HANDLE) (ULONG_PTR) -1)
+#define INVALID_FILE_ATTRIBUTES ((DWORD) -1)
+#define INVALID_SET_FILE_POINTER ((DWORD) -1)
+#define TLS_OUT_OF_INDEXES ((DWORD) 0xFFFFFFFF)
+#define STILL_ACTIVE 259
+
+#define WAIT_OBJECT_0 0x00000000
+#define WAIT_TIMEOUT 0x00000102
+#define WAIT_FAILED ((DWORD) 0xFFFFFFFF)
+
+#define NO_ERROR 0
+#define ERROR_SUCCESS 0
+#define ERROR_FILE_NOT_FOUND 2
+#define ERROR_PATH_NOT_FOUND 3
+#define ERROR_ACCESS_DENIED 5
+#define ERROR_INVALID_HANDLE 6
+#define ERROR_NOT_ENOUGH_MEMORY 8
+#define ERROR_INVALID_DATA 13
+#define ERROR_HANDLE_EOF 38
+#define ERROR_NOT_SUPPORTED 50
+#define ERROR_INVALID_PARAMETER 87
+#define ERROR_CALL_NOT_IMPLEMENTED 120
+#define ERROR_INSUFFICIENT_BUFFER 122
+#define ERROR_MOD_NOT_FOUND 126
+#define ERROR_PROC_NOT_FOUND 127
+#define ERROR_BAD_EXE_FORMAT 193
+#define ERROR_PARTIAL_COPY 299
+#define ERROR_INVALID_ADDRESS 487
+#define ERROR_NO_UNICODE_TRANSLATION 1113
+#define ERROR_CANCELLED 1223
+#define ERROR_RESOURCE_TYPE_NOT_FOUND 1813
+
+#define CP_ACP 0
+#define CP_UTF8 65001
+#define WC_NO_BEST_FIT_CHARS 0x00000400
+#define MB_ERR_INVALID_CHARS 0x00000008
+
+#define MB_OK 0x00000000
+#define MB_ICONERROR 0x00000010
+
+#define DLL_PROCESS_DETACH 0
+#define DLL_PROCESS_ATTACH 1
+#define DLL_THREAD_ATTACH 2
+#define DLL_THREAD_DETACH 3
+
+#define PAGE_NOACCESS 0x01
+#define PAGE_READONLY 0x02
+#define PAGE_READWRITE 0x04
+#define PAGE_EXECUTE_READ 0x20
+#define PAGE_EXECUTE_READWRITE 0x40
+#define MEM_COMMIT 0x00001000
+#define MEM_RESERVE 0x00002000
+#define MEM_DECOMMIT 0x00004000
+#define MEM_RELEASE 0x00008000
+#define MEM_FREE 0x00010000
+
+#define FILE_MAP_WRITE 0x0002
+#define FILE_MAP_READ 0x0004
+#define FILE_MAP_ALL_ACCESS 0x000F001F
+
+#define DUPLICATE_CLOSE_SOURCE 0x00000001
+#define DUPLICATE_SAME_ACCESS 0x00000002
+
+#define GENERIC_READ 0x80000000
+#define GENERIC_WRITE 0x40000000
+#define FILE_SHARE_READ 0x00000001
+#define FILE_SHARE_WRITE 0x00000002
+#define CREATE_ALWAYS 2
+#define OPEN_EXISTING 3
+#define FILE_ATTRIBUTE_DIRECTORY 0x00000010
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+#define FILE_FLAG_SEQUENTIAL_SCAN 0x08000000
+#define FILE_FLAG_OVERLAPPED 0x40000000
+#define FILE_BEGIN 0
+#define FILE_CURRENT 1
+#define FILE_END 2
+
+#define CREATE_SUSPENDED 0x00000004
+
+#define IMAGE_DOS_SIGNATURE 0x5A4D
+#define IMAGE_NT_SIGNATURE 0x00004550
+#define IMAGE_NT_OPTIONAL_HDR32_MAGIC 0x10B
+#define IMAGE_FILE_MACHINE_I386 0x014C
+#define IMAGE_FILE_MACHINE_AMD64 0x8664
+#define IMAGE_FILE_EXECUTABLE_IMAGE 0x0002
+#define IMAGE_FILE_32BIT_MACHINE 0x0100
+#define IMAGE_FILE_DLL 0x2000
+#define IMAGE_ORDINAL_FLAG32 0x80000000
+#define IMAGE_ORDINAL_FLAG IMAGE_ORDINAL_FLAG32
+#define IMAGE_SCN_CNT_CODE 0x00000020
+#define IMAGE_SCN_CNT_INITIALIZED_DATA 0x00000040
+#define IMAGE_SCN_MEM_EXECUTE 0x20000000
+#define IMAGE_SCN_MEM_READ 0x40000000
+#define IMAGE_SCN_MEM_WRITE 0x80000000
+#define IMAGE_DIRECTORY_ENTRY_EXPORT 0
+#define IMAGE_DIRECTORY_ENTRY_IMPORT 1
+#define IMAGE_DIRECTORY_ENTRY_RESOURCE 2
+#define IMAGE_DIRECTORY_ENTRY_BOUND_IMPORT 11
+#define IMAGE_DIRECTORY_ENTRY_IAT 12
+
+#define VS_FFI_SIGNATURE 0xFEEF04BD
+#define RT_VERSION 16
+#define MAKEINTRESOURCEW(i) ((LPWSTR) (ULONG_PTR) (WORD) (i))
+
+/* Errors */
+DWORD WINAPI GetLastError(void);
+void WINAPI SetLastError(DWORD last_error);
+
+/* Synchronization */
+void WINAPI InitializeCriticalSection(CRITICAL_SECTION* critical_section);
+void WINAPI DeleteCriticalSection(CRITICAL_SECTION* critical_section);
+void WINAPI EnterCriticalSection(CRITICAL_SECTION* critical_section);
+void WINAPI LeaveCriticalSection(CRITICAL_SECTION* critical_section);
+
+LONG WINAPI InterlockedIncrement(LONG volatile* addend);
+LONG WINAPI InterlockedDecrement(LONG volatile* addend);
+LONG WINAPI InterlockedExchange(LONG volatile* target, LONG value);
+LONG WINAPI InterlockedExchangeAdd(LONG volatile* addend, LONG value);
+LONG WINAPI InterlockedCompareExchange(
+    LONG volatile* destination,
+    LONG exchange,
+    LONG comparand
+);
+
+HANDLE WINAPI CreateEventW(
+    SECURITY_ATTRIBUTES* attributes,
+    BOOL is_manual_reset,
+    BOOL is_initial_state,
+    LPCWSTR name
+);
+BOOL WINAPI SetEvent(HANDLE event);
+BOOL WINAPI ResetEvent(HANDLE event);
+
+DWORD WINAPI WaitForSingleObject(HANDLE handle, DWORD milliseconds);
+DWORD WINAPI WaitForMultipleObjects(
+    DWORD count,
+    const HANDLE* handles,
+    BOOL is_wait_all,
+    DWORD milliseconds
+);
+BOOL WINAPI CloseHandle(HANDLE handle);
+BOOL WINAPI DuplicateHandle(
+    HANDLE source_process,
+    HANDLE source_handle,
+    HANDLE target_process,
+    HANDLE* target_handle,
+    DWORD desired_access,
+    BOOL is_inherit_handle,
+    DWORD options
+);
+
+/* Threads and processes */
+HANDLE WINAPI CreateThread(
+    SECURITY_ATTRIBUTES* attributes,
+    SIZE_T stack_size,
+    LPTHREAD_START_ROUTINE start_address,
+    LPVOID parameter,
+    DWORD creation_flags,
+    DWORD* thread_id
+);
+BOOL WINAPI GetExitCodeThread(HANDLE thread, DWORD* exit_code);
+BOOL WINAPI GetExitCodeProcess(HANDLE process, DWORD* exit_code);
+HANDLE WINAPI GetCurrentProcess(void);
+HANDLE WINAPI GetCurrentThread(void);
+DWORD WINAPI GetCurrentProcessId(void);
+DWORD WINAPI GetCurrentThreadId(void);
+DWORD WINAPI SuspendThread(HANDLE thread);
+DWORD WINAPI ResumeThread(HANDLE thread);
+void WINAPI Sleep(DWORD milliseconds);
+
+DWORD WINAPI TlsAlloc(void);
+BOOL WINAPI TlsFree(DWORD tls_index);
+LPVOID WINAPI TlsGetValue(DWORD tls_index);
+BOOL WINAPI TlsSetValue(DWORD tls_index, LPVOID value);
+
+/* Time */
+DWORD WINAPI GetTickCount(void);
+BOOL WINAPI QueryPerformanceCounter(LARGE_INTEGER* performance_count);
+BOOL WINAPI QueryPerformanceFrequency(LARGE_INTEGER* frequency);
+LONG WINAPI CompareFileTime(const FILETIME* file_time1, const FILETIME* file_time2);
+
+/* System */
+DWORD WINAPI GetVersion(void);
+void WINAPI GetSystemInfo(SYSTEM_INFO* system_info);
+HMODULE WINAPI GetModuleHandleA(LPCSTR module_name);
+HMODULE WINAPI GetModuleHandleW(LPCWSTR module_name);
+FARPROC WINAPI GetProcAddress(HMODULE module, LPCSTR proc_name);
+HMODULE WINAPI LoadLibraryA(LPCSTR lib_file_name);
+HMODULE WINAPI LoadLibraryW(LPCWSTR lib_file_name);
+int WINAPI MessageBoxW(HWND window, LPCWSTR text, LPCWSTR caption, UINT type);
+
+/* Strings */
+int WINAPI WideCharToMultiByte(
+    UINT code_page,
+    DWORD flags,
+    LPCWSTR wide_char_str,
+    int wide_char_count,
+    LPSTR multi_byte_str,
+    int multi_byte_count,
+    LPCSTR default_char,
+    BOOL* is_default_char_used
+);
+int WINAPI MultiByteToWideChar(
+    UINT code_page,
+    DWORD flags,
+    LPCSTR multi_byte_str,
+    int multi_byte_count,
+    LPWSTR wide_char_str,
+    int wide_char_count
+);
+
+/* Memory */
+LPVOID WINAPI VirtualAlloc(
+    LPVOID address,
+    SIZE_T size,
+    DWORD allocation_type,
+    DWORD protect
+);
+BOOL WINAPI VirtualFree(LPVOID address, SIZE_T size, DWORD free_type);
+HANDLE WINAPI CreateFileMappingA(
+    HANDLE file,
+    SECURITY_ATTRIBUTES* attributes,
+    DWORD protect,
+    DWORD maximum_size_high,
+    DWORD maximum_size_low,
+    LPCSTR name
+);
+LPVOID WINAPI MapViewOfFile(
+    HANDLE file_mapping,
+    DWORD desired_access,
+    DWORD file_offset_high,
+    DWORD file_offset_low,
+    SIZE_T num_bytes_to_map
+);
+BOOL WINAPI UnmapViewOfFile(LPCVOID base_address);
+
+/* Files */
+HANDLE WINAPI CreateFileA(
+    LPCSTR file_name,
+    DWORD desired_access,
+    DWORD share_mode,
+    SECURITY_ATTRIBUTES* attributes,
+    DWORD creation_disposition,
+    DWORD flags_and_attributes,
+    HANDLE template_file
+);
+BOOL WINAPI ReadFile(
+    HANDLE file,
+    LPVOID buffer,
+    DWORD num_bytes_to_read,
+    DWORD* num_bytes_read,
+    OVERLAPPED* overlapped
+);
+DWORD WINAPI SetFilePointer(
+    HANDLE file,
+    LONG distance_to_move,
+    LONG* distance_to_move_high,
+    DWORD move_method
+);
+DWORD WINAPI GetFileSize(HANDLE file, DWORD* file_size_high);
+BOOL WINAPI GetFileInformationByHandle(
+    HANDLE file,
+    BY_HANDLE_FILE_INFORMATION* file_information
+);
+DWORD WINAPI GetFileAttributesW(LPCWSTR file_name);
+DWORD WINAPI GetFullPathNameW(
+    LPCWSTR file_name,
+    DWORD buffer_length,
+    LPWSTR buffer,
+    LPWSTR* file_part
+);
+DWORD WINAPI SearchPathA(
+    LPCSTR path,
+    LPCSTR file_name,
+    LPCSTR extension,
+    DWORD buffer_length,
+    LPSTR buffer,
+    LPSTR* file_part
+);
+
+/* Version information, which is not implemented. */
+DWORD WINAPI GetFileVersionInfoSizeW(LPCWSTR file_name, DWORD* handle);
+BOOL WINAPI GetFileVersionInfoW(
+    LPCWSTR file_name,
+    DWORD handle,
+    DWORD length,
+    LPVOID data
+);
+BOOL WINAPI VerQueryValueW(
+    LPCVOID block,
+    LPCWSTR sub_block,
+    LPVOID* buffer,
+    UINT* length
+);
+
+/* Other processes, which are not implemented. */
+BOOL WINAPI ReadProcessMemory(
+    HANDLE process,
+    LPCVOID base_address,
+    LPVOID buffer,
+    SIZE_T size,
+    SIZE_T* num_bytes_read
+);
+BOOL WINAPI WriteProcessMemory(
+    HANDLE process,
+    LPVOID base_address,
+    LPCVOID buffer,
+    SIZE_T size,
+    SIZE_T* num_bytes_written
+);
+BOOL WINAPI VirtualProtectEx(
+    HANDLE process,
+    LPVOID address,
+    SIZE_T size,
+    DWORD new_protect,
+    DWORD* old_protect
+);
+SIZE_T WINAPI VirtualQueryEx(
+    HANDLE process,
+    LPCVOID address,
+    MEMORY_BASIC_INFORMATION* buffer,
+    SIZE_T length
+);
+LPVOID WINAPI VirtualAllocEx(
+    HANDLE process,
+    LPVOID address,
+    SIZE_T size,
+    DWORD allocation_type,
+    DWORD protect
+);
+BOOL WINAPI VirtualFreeEx(
+    HANDLE process,
+    LPVOID address,
+    SIZE_T size,
+    DWORD free_type
+);
+DWORD WINAPI QueueUserAPC(PAPCFUNC apc, HANDLE thread, ULONG_PTR data);
+HANDLE WINAPI CreateRemoteThread(
+    HANDLE process,
+    SECURITY_ATTRIBUTES* attributes,
+    SIZE_T stack_size,
+    LPTHREAD_START_ROUTINE start_address,
+    LPVOID parameter,
+    DWORD creation_flags,
+    DWORD* thread_id
+);
+
+/*
+* Test-only functions, which do not exist on Windows.
+*/
+
+/*
+* Creates a handle that stands in for a game process. The handle is
+* signaled once CompatProcess_Exit is called.
+*/
+HANDLE CompatProcess_Create(void);
+
+void CompatProcess_Exit(HANDLE process, DWORD exit_code);
+
+#endif /* SGGLDKL_TESTS_COMPAT_WINDOWS_H_ */
@@ -0,0 +1,2173 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#define _GNU_SOURCE
+
+#include <windows.h>
+#include <process.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+enum CompatObjectKind {
+  COMPAT_OBJECT_THREAD,
+  COMPAT_OBJECT_PROCESS,
+  COMPAT_OBJECT_EVENT,
+  COMPAT_OBJECT_MAPPING,
+  COMPAT_OBJECT_FILE
+};
+
+/*
+* A kernel object. An object is freed once its handles are closed and
+* it is no longer in use, which is when a thread exits or when a view
+* of a mapping is unmapped.
+*/
+struct CompatObject {
+  enum CompatObjectKind kind;
+  int num_references;
+
+  int is_signaled;
+  int is_manual_reset;
+  DWORD exit_code;
+
+  /* Threads */
+  LPTHREAD_START_ROUTINE start_address;
+  unsigned int (__stdcall *crt_start_address)(void*);
+  void* parameter;
+
+  /* Mappings */
+  struct CompatObject* next_mapping;
+  void* view;
+
+  /* Files */
+  int fd;
+};
+
+enum {
+  PSEUDO_PROCESS_HANDLE = -1,
+  PSEUDO_THREAD_HANDLE = -2
+};
+
+static const FILETIME kUnixEpochFileTime = { 0xD53E8000, 0x019DB1DE };
+
+/* Guards the signaled states and the reference counts of all objects. */
+static pthread_mutex_t object_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t object_condition = PTHREAD_COND_INITIALIZER;
+static struct CompatObject* mappings_head = NULL;
+
+static LONG next_thread_id = 1;
+static __thread DWORD current_thread_id = 0;
+static __thread DWORD last_error = 0;
+
+static char kernel32_module;
+static char ntdll_module;
+
+/*
+* Objects
+*/
+
+static struct CompatObject* CreateObject(enum CompatObjectKind kind) {
+  struct CompatObject* object;
+
+  object = calloc(1, sizeof(*object));
+
+  if (object == NULL) {
+    SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    return NULL;
+  }
+
+  object->kind = kind;
+  object->num_references = 1;
+  object->fd = -1;
+
+  return object;
+}
+
+static int IsPseudoHandle(HANDLE handle) {
+  return handle == (HANDLE) PSEUDO_PROCESS_HANDLE
+      || handle == (HANDLE) PSEUDO_THREAD_HANDLE;
+}
+
+/* Must be called with the object mutex held. */
+static void ReleaseObjectLocked(struct CompatObject* object) {
+  struct CompatObject** mapping_link;
+
+  object->num_references -= 1;
+
+  if (object->num_references > 0) {
+    return;
+  }
+
+  if (object->kind == COMPAT_OBJECT_MAPPING) {
+    for (mapping_link = &mappings_head;
+        *mapping_link != NULL;
+        mapping_link = &(*mapping_link)->next_mapping) {
+      if (*mapping_link == object) {
+        *mapping_link = object->next_mapping;
+        break;
+      }
+    }
+
+    free(object->view);
+  } else if (object->kind == COMPAT_OBJECT_FILE) {
+    close(object->fd);
+  }
+
+  free(object);
+}
+
+static void SignalObjectLocked(struct CompatObject* object) {
+  object->is_signaled = 1;
+  pthread_cond_broadcast(&object_condition);
+}
+
+static int IsObjectSignaledLocked(struct CompatObject* object) {
+  return object->is_signaled;
+}
+
+/* Consumes the signal of an auto-reset event. */
+static void AcquireObjectLocked(struct CompatObject* object) {
+  if (object->kind == COMPAT_OBJECT_EVENT && !object->is_manual_reset) {
+    object->is_signaled = 0;
+  }
+}
+
+static void GetDeadline(struct timespec* deadline, DWORD milliseconds) {
+  clock_gettime(CLOCK_REALTIME, deadline);
+
+  deadline->tv_sec += milliseconds / 1000;
+  deadline->tv_nsec += (long) (milliseconds % 1000) * 1000000L;
+
+  if (deadline->tv_nsec >= 1000000000L) {
+    deadline->tv_sec += 1;
+    deadline->tv_nsec -= 1000000000L;
+  }
+}
+
+/*
+* Strings
+*/
+
+size_t Compat_wcslen(const wchar_t* str) {
+  size_t len;
+
+  for (len = 0; str[len] != L'\0'; len += 1) {
+  }
+
+  return len;
+}
+
+int Compat_wcsncmp(const wchar_t* str1, const wchar_t* str2, size_t count) {
+  size_t i;
+
+  for (i = 0; i < count; i += 1) {
+    if (str1[i] != str2[i]) {
+      return (str1[i] < str2[i]) ? -1 : 1;
+    }
+
+    if (str1[i] == L'\0') {
+      break;
+    }
+  }
+
+  return 0;
+}
+
+int Compat_wcscmp(const wchar_t* str1, const wchar_t* str2) {
+  return Compat_wcsncmp(str1, str2, (size_t) -1);
+}
+
+wchar_t* Compat_wcscpy(wchar_t* dest, const wchar_t* src) {
+  memcpy(dest, src, (Compat_wcslen(src) + 1) * sizeof(dest[0]));
+
+  return dest;
+}
+
+wchar_t* Compat_wcsncpy(wchar_t* dest, const wchar_t* src, size_t count) {
+  size_t i;
+
+  for (i = 0; i < count && src[i] != L'\0'; i += 1) {
+    dest[i] = src[i];
+  }
+
+  for (; i < count; i += 1) {
+    dest[i] = L'\0';
+  }
+
+  return dest;
+}
+
+wchar_t* Compat_wcschr(const wchar_t* str, wchar_t ch) {
+  for (;; str += 1) {
+    if (*str == ch) {
+      return (wchar_t*) str;
+    }
+
+    if (*str == L'\0') {
+      return NULL;
+    }
+  }
+}
+
+wchar_t* Compat_wcsrchr(const wchar_t* str, wchar_t ch) {
+  const wchar_t* found;
+
+  found = NULL;
+
+  for (;; str += 1) {
+    if (*str == ch) {
+      found = str;
+    }
+
+    if (*str == L'\0') {
+      return (wchar_t*) found;
+    }
+  }
+}
+
+static wchar_t ToLowerWide(wchar_t ch) {
+  return (ch >= L'A' && ch <= L'Z') ? ch - L'A' + L'a' : ch;
+}
+
+int Compat_wcsnicmp(
+    const wchar_t* str1,
+    const wchar_t* str2,
+    size_t count
+) {
+  size_t i;
+  wchar_t ch1;
+  wchar_t ch2;
+
+  for (i = 0; i < count; i += 1) {
+    ch1 = ToLowerWide(str1[i]);
+    ch2 = ToLowerWide(str2[i]);
+
+    if (ch1 != ch2) {
+      return (ch1 < ch2) ? -1 : 1;
+    }
+
+    if (ch1 == L'\0') {
+      break;
+    }
+  }
+
+  return 0;
+}
+
+int Compat_wcsicmp(const wchar_t* str1, const wchar_t* str2) {
+  return Compat_wcsnicmp(str1, str2, (size_t) -1);
+}
+
+struct WideOutput {
+  wchar_t* buffer;
+  size_t count;
+  size_t len;
+};
+
+static void PutWideChar(struct WideOutput* output, wchar_t ch) {
+  if (output->len < output->count) {
+    output->buffer[output->len] = ch;
+  }
+
+  output->len += 1;
+}
+
+static void PutPadded(
+    struct WideOutput* output,
+    const wchar_t* wide_str,
+    const char* narrow_str,
+    size_t len,
+    size_t width,
+    int is_left_aligned,
+    wchar_t pad_char
+) {
+  size_t i;
+
+  if (!is_left_aligned) {
+    for (i = len; i < width; i += 1) {
+      PutWideChar(output, pad_char);
+    }
+  }
+
+  for (i = 0; i < len; i += 1) {
+    PutWideChar(
+        output,
+        (wide_str != NULL)
+            ? wide_str[i]
+            : (wchar_t) (unsigned char) narrow_str[i]
+    );
+  }
+
+  if (is_left_aligned) {
+    for (i = len; i < width; i += 1) {
+      PutWideChar(output, L' ');
+    }
+  }
+}
+
+int Compat_snwprintf(
+    wchar_t* buffer,
+    size_t count,
+    const wchar_t* format,
+    ...
+) {
+  struct WideOutput output;
+  va_list args;
+  const wchar_t* wide_str;
+  const char* narrow_str;
+  char number_str[32];
+  wchar_t ch_str[1];
+  int is_left_aligned;
+  int is_long;
+  int is_short;
+  wchar_t pad_char;
+  size_t width;
+
+  output.buffer = buffer;
+  output.count = count;
+  output.len = 0;
+
+  va_start(args, format);
+
+  for (; *format != L'\0'; format += 1) {
+    if (*format != L'%') {
+      PutWideChar(&output, *format);
+      continue;
+    }
+
+    format += 1;
+
+    is_left_aligned = 0;
+    pad_char = L' ';
+
+    for (;; format += 1) {
+      if (*format == L'-') {
+        is_left_aligned = 1;
+      } else if (*format == L'0') {
+        pad_char = L'0';
+      } else {
+        break;
+      }
+    }
+
+    for (width = 0; *format >= L'0' && *format <= L'9'; format += 1) {
+      width = width * 10 + (size_t) (*format - L'0');
+    }
+
+    is_long = 0;
+    is_short = 0;
+
+    if (*format == L'l') {
+      is_long = 1;
+      format += 1;
+    } else if (*format == L'h') {
+      is_short = 1;
+      format += 1;
+    }
+
+    wide_str = NULL;
+    narrow_str = NULL;
+
+    switch (*format) {
+      case L'%': {
+        PutWideChar(&output, L'%');
+        continue;
+      }
+
+      case L'c': {
+        ch_str[0] = (wchar_t) va_arg(args, int);
+        wide_str = ch_str;
+        PutPadded(&output, wide_str, NULL, 1, width, is_left_aligned, L' ');
+        continue;
+      }
+
+      case L's': {
+        if (is_short) {
+          narrow_str = va_arg(args, const char*);
+        } else {
+          wide_str = va_arg(args, const wchar_t*);
+        }
+
+        if (narrow_str == NULL && wide_str == NULL) {
+          narrow_str = "(null)";
+        }
+
+        PutPadded(
+            &output,
+            wide_str,
+            narrow_str,
+            (wide_str != NULL) ? Compat_wcslen(wide_str) : strlen(narrow_str),
+            width,
+            is_left_aligned,
+            L' '
+        );
+        continue;
+      }
+
+      case L'd': {
+        sprintf(
+            number_str,
+            "%ld",
+            is_long ? va_arg(args, long) : (long) va_arg(args, int)
+        );
+        break;
+      }
+
+      case L'u':
+      case L'x':
+      case L'X': {
+        sprintf(
+            number_str,
+            (*format == L'u') ? "%lu" : (*format == L'x') ? "%lx" : "%lX",
+            is_long
+                ? va_arg(args, unsigned long)
+                : (unsigned long) va_arg(args, unsigned int)
+        );
+        break;
+      }
+
+      default: {
+        va_end(args);
+
+        if (count > 0) {
+          buffer[0] = L'\0';
+        }
+
+        return -1;
+      }
+    }
+
+    PutPadded(
+        &output,
+        NULL,
+        number_str,
+        strlen(number_str),
+        width,
+        is_left_aligned,
+        is_left_aligned ? L' ' : pad_char
+    );
+  }
+
+  va_end(args);
+
+  /* As with the Microsoft CRT, a truncated string is not terminated. */
+  if (output.len >= count) {
+    return -1;
+  }
+
+  buffer[output.len] = L'\0';
+
+  return (int) output.len;
+}
+
+/*
+* Converts a path for use with POSIX, replacing the Windows separators.
+* Returns zero if the path is too long.
+*/
+static int ConvertPath(char* posix_path, size_t posix_path_size, LPCSTR path) {
+  size_t i;
+
+  for (i = 0; path[i] != '\0'; i += 1) {
+    if (i + 1 >= posix_path_size) {
+      SetLastError(ERROR_INVALID_PARAMETER);
+      return 0;
+    }
+
+    posix_path[i] = (path[i] == '\\') ? '/' : path[i];
+  }
+
+  posix_path[i] = '\0';
+
+  return 1;
+}
+
+static int ConvertWidePath(
+    char* posix_path,
+    size_t posix_path_size,
+    LPCWSTR path
+) {
+  char utf8_path[MAX_PATH * 4];
+
+  if (WideCharToMultiByte(
+      CP_UTF8,
+      0,
+      path,
+      -1,
+      utf8_path,
+      sizeof(utf8_path),
+      NULL,
+      NULL
+  ) == 0) {
+    return 0;
+  }
+
+  return ConvertPath(posix_path, posix_path_size, utf8_path);
+}
+
+FILE* Compat_wfopen(const wchar_t* path, const wchar_t* mode) {
+  char posix_path[MAX_PATH * 4];
+  char narrow_mode[8];
+  size_t i;
+
+  if (!ConvertWidePath(posix_path, sizeof(posix_path), path)) {
+    return NULL;
+  }
+
+  for (i = 0; mode[i] != L'\0' && i + 1 < sizeof(narrow_mode); i += 1) {
+    narrow_mode[i] = (char) mode[i];
+  }
+
+  narrow_mode[i] = '\0';
+
+  return fopen(posix_path, narrow_mode);
+}
+
+static DWORD GetErrorFromErrno(int error_number) {
+  switch (error_number) {
+    case ENOENT: {
+      return ERROR_FILE_NOT_FOUND;
+    }
+
+    case ENOTDIR: {
+      return ERROR_PATH_NOT_FOUND;
+    }
+
+    case EACCES:
+    case EISDIR: {
+      return ERROR_ACCESS_DENIED;
+    }
+
+    case ENOMEM: {
+      return ERROR_NOT_ENOUGH_MEMORY;
+    }
+
+    default: {
+      return ERROR_INVALID_PARAMETER;
+    }
+  }
+}
+
+/*
+* Errors
+*/
+
+DWORD WINAPI GetLastError(void) {
+  return last_error;
+}
+
+void WINAPI SetLastError(DWORD error) {
+  last_error = error;
+}
+
+/*
+* Synchronization
+*/
+
+void WINAPI InitializeCriticalSection(CRITICAL_SECTION* critical_section) {
+  pthread_mutexattr_t mutex_attr;
+
+  pthread_mutexattr_init(&mutex_attr);
+  pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&critical_section->mutex, &mutex_attr);
+  pthread_mutexattr_destroy(&mutex_attr);
+}
+
+void WINAPI DeleteCriticalSection(CRITICAL_SECTION* critical_section) {
+  pthread_mutex_destroy(&critical_section->mutex);
+}
+
+void WINAPI EnterCriticalSection(CRITICAL_SECTION* critical_section) {
+  pthread_mutex_lock(&critical_section->mutex);
+}
+
+void WINAPI LeaveCriticalSection(CRITICAL_SECTION* critical_section) {
+  pthread_mutex_unlock(&critical_section->mutex);
+}
+
+LONG WINAPI InterlockedIncrement(LONG volatile* addend) {
+  return __sync_add_and_fetch(addend, 1);
+}
+
+LONG WINAPI InterlockedDecrement(LONG volatile* addend) {
+  return __sync_sub_and_fetch(addend, 1);
+}
+
+LONG WINAPI InterlockedExchange(LONG volatile* target, LONG value) {
+  __sync_synchronize();
+
+  return __sync_lock_test_and_set(target, value);
+}
+
+LONG WINAPI InterlockedExchangeAdd(LONG volatile* addend, LONG value) {
+  return __sync_fetch_and_add(addend, value);
+}
+
+LONG WINAPI InterlockedCompareExchange(
+    LONG volatile* destination,
+    LONG exchange,
+    LONG comparand
+) {
+  return __sync_val_compare_and_swap(destination, comparand, exchange);
+}
+
+HANDLE WINAPI CreateEventW(
+    SECURITY_ATTRIBUTES* attributes,
+    BOOL is_manual_reset,
+    BOOL is_initial_state,
+    LPCWSTR name
+) {
+  struct CompatObject* event;
+
+  (void) attributes;
+  (void) name;
+
+  event = CreateObject(COMPAT_OBJECT_EVENT);
+
+  if (event == NULL) {
+    return NULL;
+  }
+
+  event->is_manual_reset = is_manual_reset;
+  event->is_signaled = is_initial_state;
+
+  return event;
+}
+
+BOOL WINAPI SetEvent(HANDLE event) {
+  pthread_mutex_lock(&object_mutex);
+  SignalObjectLocked(event);
+  pthread_mutex_unlock(&object_mutex);
+
+  return TRUE;
+}
+
+BOOL WINAPI ResetEvent(HANDLE event) {
+  pthread_mutex_lock(&object_mutex);
+  ((struct CompatObject*) event)->is_signaled = 0;
+  pthread_mutex_unlock(&object_mutex);
+
+  return TRUE;
+}
+
+DWORD WINAPI WaitForMultipleObjects(
+    DWORD count,
+    const HANDLE* handles,
+    BOOL is_wait_all,
+    DWORD milliseconds
+) {
+  struct timespec deadline;
+  DWORD i;
+  DWORD num_signaled;
+  DWORD i_first_signaled;
+  int wait_result;
+
+  for (i = 0; i < count; i += 1) {
+    if (handles[i] == NULL || IsPseudoHandle(handles[i])) {
+      SetLastError(ERROR_INVALID_HANDLE);
+      return WAIT_FAILED;
+    }
+  }
+
+  if (milliseconds != INFINITE) {
+    GetDeadline(&deadline, milliseconds);
+  }
+
+  pthread_mutex_lock(&object_mutex);
+
+  for (;;) {
+    num_signaled = 0;
+    i_first_signaled = count;
+
+    for (i = 0; i < count; i += 1) {
+      if (IsObjectSignaledLocked(handles[i])) {
+        num_signaled += 1;
+
+        if (i_first_signaled == count) {
+          i_first_signaled = i;
+        }
+      }
+    }
+
+    if (is_wait_all ? (num_signaled == count) : (num_signaled > 0)) {
+      break;
+    }
+
+    if (milliseconds == INFINITE) {
+      pthread_cond_wait(&object_condition, &object_mutex);
+    } else {
+      wait_result = pthread_cond_timedwait(
+          &object_condition,
+          &object_mutex,
+          &deadline
+      );
+
+      if (wait_result == ETIMEDOUT) {
+        pthread_mutex_unlock(&object_mutex);
+        return WAIT_TIMEOUT;
+      }
+    }
+  }
+
+  if (is_wait_all) {
+    for (i = 0; i < count; i += 1) {
+      AcquireObjectLocked(handles[i]);
+    }
+  } else {
+    AcquireObjectLocked(handles[i_first_signaled]);
+  }
+
+  pthread_mutex_unlock(&object_mutex);
+
+  return WAIT_OBJECT_0 + (is_wait_all ? 0 : i_first_signaled);
+}
+
+DWORD WINAPI WaitForSingleObject(HANDLE handle, DWORD milliseconds) {
+  return WaitForMultipleObjects(1, &handle, TRUE, milliseconds);
+}
+
+BOOL WINAPI CloseHandle(HANDLE handle) {
+  if (handle == NULL || handle == INVALID_HANDLE_VALUE) {
+    SetLastError(ERROR_INVALID_HANDLE);
+    return FALSE;
+  }
+
+  if (IsPseudoHandle(handle)) {
+    return TRUE;
+  }
+
+  pthread_mutex_lock(&object_mutex);
+  ReleaseObjectLocked(handle);
+  pthread_mutex_unlock(&object_mutex);
+
+  return TRUE;
+}
+
+/*
+* All processes share the same handles, so a duplicate is another
+* reference to the same object.
+*/
+BOOL WINAPI DuplicateHandle(
+    HANDLE source_process,
+    HANDLE source_handle,
+    HANDLE target_process,
+    HANDLE* target_handle,
+    DWORD desired_access,
+    BOOL is_inherit_handle,
+    DWORD options
+) {
+  (void) source_process;
+  (void) target_process;
+  (void) desired_access;
+  (void) is_inherit_handle;
+
+  if (source_handle == NULL || IsPseudoHandle(source_handle)) {
+    SetLastError(ERROR_INVALID_HANDLE);
+    return FALSE;
+  }
+
+  pthread_mutex_lock(&object_mutex);
+
+  if (target_handle != NULL) {
+    ((struct CompatObject*) source_handle)->num_references += 1;
+    *target_handle = source_handle;
+  }
+
+  if ((options & DUPLICATE_CLOSE_SOURCE) != 0) {
+    ReleaseObjectLocked(source_handle);
+  }
+
+  pthread_mutex_unlock(&object_mutex);
+
+  return TRUE;
+}
+
+/*
+* Threads and processes
+*/
+
+static void* RunThread(void* parameter) {
+  struct CompatObject* thread;
+  DWORD exit_code;
+
+  thread = parameter;
+
+  if (thread->crt_start_address != NULL) {
+    exit_code = thread->crt_start_address(thread->parameter);
+  } else {
+    exit_code = thread->start_address(thread->parameter);
+  }
+
+  pthread_mutex_lock(&object_mutex);
+  thread->exit_code = exit_code;
+  SignalObjectLocked(thread);
+  ReleaseObjectLocked(thread);
+  pthread_mutex_unlock(&object_mutex);
+
+  return NULL;
+}
+
+static HANDLE StartThread(struct CompatObject* thread, DWORD* thread_id) {
+  pthread_attr_t thread_attr;
+  pthread_t posix_thread;
+  int create_result;
+
+  thread->exit_code = STILL_ACTIVE;
+
+  /* The running thread holds a reference, released when it exits. */
+  thread->num_references = 2;
+
+  pthread_attr_init(&thread_attr);
+  pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED);
+  create_result = pthread_create(&posix_thread, &thread_attr, &RunThread, thread);
+  pthread_attr_destroy(&thread_attr);
+
+  if (create_result != 0) {
+    free(thread);
+    SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    return NULL;
+  }
+
+  if (thread_id != NULL) {
+    *thread_id = 0;
+  }
+
+  return thread;
+}
+
+HANDLE WINAPI CreateThread(
+    SECURITY_ATTRIBUTES* attributes,
+    SIZE_T stack_size,
+    LPTHREAD_START_ROUTINE start_address,
+    LPVOID parameter,
+    DWORD creation_flags,
+    DWORD* thread_id
+) {
+  struct CompatObject* thread;
+
+  (void) attributes;
+  (void) stack_size;
+
+  if (creation_flags != 0) {
+    SetLastError(ERROR_NOT_SUPPORTED);
+    return NULL;
+  }
+
+  thread = CreateObject(COMPAT_OBJECT_THREAD);
+
+  if (thread == NULL) {
+    return NULL;
+  }
+
+  thread->start_address = start_address;
+  thread->parameter = parameter;
+
+  return StartThread(thread, thread_id);
+}
+
+unsigned long _beginthreadex(
+    void* security,
+    unsigned int stack_size,
+    unsigned int (__stdcall *start_address)(void*),
+    void* arglist,
+    unsigned int init_flag,
+    unsigned int* thread_id
+) {
+  struct CompatObject* thread;
+  DWORD start_thread_id;
+  HANDLE thread_handle;
+
+  (void) security;
+  (void) stack_size;
+
+  if (init_flag != 0) {
+    errno = EINVAL;
+    return 0;
+  }
+
+  thread = CreateObject(COMPAT_OBJECT_THREAD);
+
+  if (thread == NULL) {
+    errno = ENOMEM;
+    return 0;
+  }
+
+  thread->crt_start_address = start_address;
+  thread->parameter = arglist;
+
+  thread_handle = StartThread(thread, &start_thread_id);
+
+  if (thread_id != NULL) {
+    *thread_id = start_thread_id;
+  }
+
+  return (unsigned long) thread_handle;
+}
+
+BOOL WINAPI GetExitCodeThread(HANDLE thread, DWORD* exit_code) {
+  pthread_mutex_lock(&object_mutex);
+  *exit_code = ((struct CompatObject*) thread)->exit_code;
+  pthread_mutex_unlock(&object_mutex);
+
+  return TRUE;
+}
+
+BOOL WINAPI GetExitCodeProcess(HANDLE process, DWORD* exit_code) {
+  return GetExitCodeThread(process, exit_code);
+}
+
+HANDLE CompatProcess_Create(void) {
+  struct CompatObject* process;
+
+  process = CreateObject(COMPAT_OBJECT_PROCESS);
+
+  if (process == NULL) {
+    return NULL;
+  }
+
+  process->exit_code = STILL_ACTIVE;
+
+  return process;
+}
+
+void CompatProcess_Exit(HANDLE process, DWORD exit_code) {
+  pthread_mutex_lock(&object_mutex);
+  ((struct CompatObject*) process)->exit_code = exit_code;
+  SignalObjectLocked(process);
+  pthread_mutex_unlock(&object_mutex);
+}
+
+HANDLE WINAPI GetCurrentProcess(void) {
+  return (HANDLE) PSEUDO_PROCESS_HANDLE;
+}
+
+HANDLE WINAPI GetCurrentThread(void) {
+  return (HANDLE) PSEUDO_THREAD_HANDLE;
+}
+
+DWORD WINAPI GetCurrentProcessId(void) {
+  return (DWORD) getpid();
+}
+
+DWORD WINAPI GetCurrentThreadId(void) {
+  if (current_thread_id == 0) {
+    current_thread_id = (DWORD) InterlockedIncrement(&next_thread_id);
+  }
+
+  return current_thread_id;
+}
+
+DWORD WINAPI SuspendThread(HANDLE thread) {
+  (void) thread;
+
+  SetLastError(ERROR_NOT_SUPPORTED);
+
+  return (DWORD) -1;
+}
+
+DWORD WINAPI ResumeThread(HANDLE thread) {
+  (void) thread;
+
+  SetLastError(ERROR_NOT_SUPPORTED);
+
+  return (DWORD) -1;
+}
+
+void WINAPI Sleep(DWORD milliseconds) {
+  struct timespec duration;
+
+  if (milliseconds == 0) {
+    sched_yield();
+    return;
+  }
+
+  duration.tv_sec = milliseconds / 1000;
+  duration.tv_nsec = (long) (milliseconds % 1000) * 1000000L;
+
+  while (nanosleep(&duration, &duration) != 0 && errno == EINTR) {
+  }
+}
+
+DWORD WINAPI TlsAlloc(void) {
+  pthread_key_t key;
+
+  if (pthread_key_create(&key, NULL) != 0) {
+    return TLS_OUT_OF_INDEXES;
+  }
+
+  return (DWORD) key;
+}
+
+BOOL WINAPI TlsFree(DWORD tls_index) {
+  return pthread_key_delete((pthread_key_t) tls_index) == 0;
+}
+
+LPVOID WINAPI TlsGetValue(DWORD tls_index) {
+  SetLastError(ERROR_SUCCESS);
+
+  return pthread_getspecific((pthread_key_t) tls_index);
+}
+
+BOOL WINAPI TlsSetValue(DWORD tls_index, LPVOID value) {
+  return pthread_setspecific((pthread_key_t) tls_index, value) == 0;
+}
+
+/*
+* Time
+*/
+
+DWORD WINAPI GetTickCount(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (DWORD) (now.tv_sec * 1000UL + now.tv_nsec / 1000000L);
+}
+
+BOOL WINAPI QueryPerformanceCounter(LARGE_INTEGER* performance_count) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  performance_count->QuadPart = now.tv_sec * 1000000000LL + now.tv_nsec;
+
+  return TRUE;
+}
+
+BOOL WINAPI QueryPerformanceFrequency(LARGE_INTEGER* frequency) {
+  frequency->QuadPart = 1000000000LL;
+
+  return TRUE;
+}
+
+LONG WINAPI CompareFileTime(
+    const FILETIME* file_time1,
+    const FILETIME* file_time2
+) {
+  if (file_time1->dwHighDateTime != file_time2->dwHighDateTime) {
+    return (file_time1->dwHighDateTime < file_time2->dwHighDateTime)
+        ? -1
+        : 1;
+  }
+
+  if (file_time1->dwLowDateTime != file_time2->dwLowDateTime) {
+    return (file_time1->dwLowDateTime < file_time2->dwLowDateTime) ? -1 : 1;
+  }
+
+  return 0;
+}
+
+/*
+* System
+*/
+
+/* Windows XP, which is a Windows NT version. */
+DWORD WINAPI GetVersion(void) {
+  return 0x0A280105;
+}
+
+void WINAPI GetSystemInfo(SYSTEM_INFO* system_info) {
+  memset(system_info, 0, sizeof(*system_info));
+
+  system_info->dwPageSize = 0x1000;
+  system_info->lpMinimumApplicationAddress = (LPVOID) 0x00010000;
+  system_info->lpMaximumApplicationAddress = (LPVOID) 0x7FFEFFFF;
+  system_info->dwActiveProcessorMask = 1;
+  system_info->dwNumberOfProcessors = 1;
+  system_info->dwAllocationGranularity = 0x10000;
+}
+
+HMODULE WINAPI GetModuleHandleA(LPCSTR module_name) {
+  if (strcasecmp(module_name, "kernel32.dll") == 0) {
+    return &kernel32_module;
+  }
+
+  if (strcasecmp(module_name, "ntdll.dll") == 0) {
+    return &ntdll_module;
+  }
+
+  SetLastError(ERROR_MOD_NOT_FOUND);
+
+  return NULL;
+}
+
+HMODULE WINAPI GetModuleHandleW(LPCWSTR module_name) {
+  char narrow_module_name[MAX_PATH];
+
+  if (WideCharToMultiByte(
+      CP_UTF8,
+      0,
+      module_name,
+      -1,
+      narrow_module_name,
+      sizeof(narrow_module_name),
+      NULL,
+      NULL
+  ) == 0) {
+    return NULL;
+  }
+
+  return GetModuleHandleA(narrow_module_name);
+}
+
+/* Only the kernel32 functions used by the payload are exported. */
+FARPROC WINAPI GetProcAddress(HMODULE module, LPCSTR proc_name) {
+  static const struct {
+    const char* name;
+    FARPROC address;
+  } kKernel32Exports[] = {
+    { "GetCurrentThread", (FARPROC) &GetCurrentThread },
+    { "GetLastError", (FARPROC) &GetLastError },
+    { "GetTickCount", (FARPROC) &GetTickCount },
+    { "LoadLibraryA", (FARPROC) &LoadLibraryA },
+    { "LoadLibraryW", (FARPROC) &LoadLibraryW },
+    { "MapViewOfFile", (FARPROC) &MapViewOfFile },
+    { "Sleep", (FARPROC) &Sleep },
+    { "SuspendThread", (FARPROC) &SuspendThread },
+    { "UnmapViewOfFile", (FARPROC) &UnmapViewOfFile },
+    { "VirtualAlloc", (FARPROC) &VirtualAlloc },
+    { "VirtualFree", (FARPROC) &VirtualFree }
+  };
+
+  size_t i;
+
+  if (module == &kernel32_module) {
+    for (i = 0; i < sizeof(kKernel32Exports) / sizeof(kKernel32Exports[0]); i += 1) {
+      if (strcmp(kKernel32Exports[i].name, proc_name) == 0) {
+        return kKernel32Exports[i].address;
+      }
+    }
+  }
+
+  SetLastError(ERROR_PROC_NOT_FOUND);
+
+  return NULL;
+}
+
+HMODULE WINAPI LoadLibraryA(LPCSTR lib_file_name) {
+  (void) lib_file_name;
+
+  SetLastError(ERROR_MOD_NOT_FOUND);
+
+  return NULL;
+}
+
+HMODULE WINAPI LoadLibraryW(LPCWSTR lib_file_name) {
+  (void) lib_file_name;
+
+  SetLastError(ERROR_MOD_NOT_FOUND);
+
+  return NULL;
+}
+
+int WINAPI MessageBoxW(HWND window, LPCWSTR text, LPCWSTR caption, UINT type) {
+  char narrow_text[1024];
+  char narrow_caption[256];
+
+  (void) window;
+  (void) type;
+
+  WideCharToMultiByte(CP_UTF8, 0, text, -1, narrow_text, sizeof(narrow_text), NULL, NULL);
+  WideCharToMultiByte(CP_UTF8, 0, caption, -1, narrow_caption, sizeof(narrow_caption), NULL, NULL);
+
+  fprintf(stderr, "%s: %s\n", narrow_caption, narrow_text);
+
+  return 1;
+}
+
+/*
+* Strings. CP_ACP is Latin-1, and characters that cannot be encoded are
+* replaced with '?'. CP_UTF8 replaces unpaired surrogates and invalid
+* sequences with U+FFFD, like Windows Vista and later.
+*/
+
+static int EncodeUtf8(unsigned long code_point, char* encoded) {
+  if (code_point < 0x80) {
+    encoded[0] = (char) code_point;
+    return 1;
+  }
+
+  if (code_point < 0x800) {
+    encoded[0] = (char) (0xC0 | (code_point >> 6));
+    encoded[1] = (char) (0x80 | (code_point & 0x3F));
+    return 2;
+  }
+
+  if (code_point < 0x10000) {
+    encoded[0] = (char) (0xE0 | (code_point >> 12));
+    encoded[1] = (char) (0x80 | ((code_point >> 6) & 0x3F));
+    encoded[2] = (char) (0x80 | (code_point & 0x3F));
+    return 3;
+  }
+
+  encoded[0] = (char) (0xF0 | (code_point >> 18));
+  encoded[1] = (char) (0x80 | ((code_point >> 12) & 0x3F));
+  encoded[2] = (char) (0x80 | ((code_point >> 6) & 0x3F));
+  encoded[3] = (char) (0x80 | (code_point & 0x3F));
+  return 4;
+}
+
+int WINAPI WideCharToMultiByte(
+    UINT code_page,
+    DWORD flags,
+    LPCWSTR wide_char_str,
+    int wide_char_count,
+    LPSTR multi_byte_str,
+    int multi_byte_count,
+    LPCSTR default_char,
+    BOOL* is_default_char_used
+) {
+  size_t wide_len;
+  size_t i;
+  size_t num_bytes;
+  unsigned long code_point;
+  char encoded[4];
+  int encoded_len;
+
+  (void) flags;
+
+  if (code_page != CP_ACP && code_page != CP_UTF8) {
+    SetLastError(ERROR_INVALID_PARAMETER);
+    return 0;
+  }
+
+  wide_len = (wide_char_count < 0)
+      ? Compat_wcslen(wide_char_str) + 1
+      : (size_t) wide_char_count;
+
+  if (is_default_char_used != NULL) {
+    *is_default_char_used = FALSE;
+  }
+
+  num_bytes = 0;
+
+  for (i = 0; i < wide_len; i += 1) {
+    code_point = (unsigned short) wide_char_str[i];
+
+    if (code_page == CP_ACP) {
+      if (code_point < 0x100) {
+        encoded[0] = (char) code_point;
+      } else {
+        encoded[0] = (default_char != NULL) ? default_char[0] : '?';
+
+        if (is_default_char_used != NULL) {
+          *is_default_char_used = TRUE;
+        }
+      }
+
+      encoded_len = 1;
+    } else {
+      if (code_point >= 0xD800 && code_point < 0xDC00
+          && i + 1 < wide_len
+          && (unsigned short) wide_char_str[i + 1] >= 0xDC00
+          && (unsigned short) wide_char_str[i + 1] < 0xE000) {
+        code_point = 0x10000
+            + ((code_point - 0xD800) << 10)
+            + ((unsigned short) wide_char_str[i + 1] - 0xDC00);
+        i += 1;
+      } else if (code_point >= 0xD800 && code_point < 0xE000) {
+        code_point = 0xFFFD;
+      }
+
+      encoded_len = EncodeUtf8(code_point, encoded);
+    }
+
+    if (multi_byte_count != 0) {
+      if (num_bytes + encoded_len > (size_t) multi_byte_count) {
+        SetLastError(ERROR_INSUFFICIENT_BUFFER);
+        return 0;
+      }
+
+      memcpy(&multi_byte_str[num_bytes], encoded, encoded_len);
+    }
+
+    num_bytes += encoded_len;
+  }
+
+  return (int) num_bytes;
+}
+
+/* Returns the number of bytes consumed. */
+static size_t DecodeUtf8(
+    const unsigned char* str,
+    size_t len,
+    unsigned long* code_point
+) {
+  size_t num_continuation_bytes;
+  size_t i;
+  unsigned long min_code_point;
+
+  if (str[0] < 0x80) {
+    *code_point = str[0];
+    return 1;
+  } else if ((str[0] & 0xE0) == 0xC0) {
+    *code_point = str[0] & 0x1F;
+    num_continuation_bytes = 1;
+    min_code_point = 0x80;
+  } else if ((str[0] & 0xF0) == 0xE0) {
+    *code_point = str[0] & 0x0F;
+    num_continuation_bytes = 2;
+    min_code_point = 0x800;
+  } else if ((str[0] & 0xF8) == 0xF0) {
+    *code_point = str[0] & 0x07;
+    num_continuation_bytes = 3;
+    min_code_point = 0x10000;
+  } else {
+    *code_point = 0xFFFD;
+    return 1;
+  }
+
+  for (i = 1; i <= num_continuation_bytes; i += 1) {
+    if (i >= len || (str[i] & 0xC0) != 0x80) {
+      *code_point = 0xFFFD;
+      return i;
+    }
+
+    *code_point = (*code_point << 6) | (str[i] & 0x3F);
+  }
+
+  if (*code_point < min_code_point
+      || *code_point > 0x10FFFF
+      || (*code_point >= 0xD800 && *code_point < 0xE000)) {
+    *code_point = 0xFFFD;
+  }
+
+  return i;
+}
+
+int WINAPI MultiByteToWideChar(
+    UINT code_page,
+    DWORD flags,
+    LPCSTR multi_byte_str,
+    int multi_byte_count,
+    LPWSTR wide_char_str,
+    int wide_char_count
+) {
+  const unsigned char* str;
+  size_t len;
+  size_t i;
+  size_t num_wide_chars;
+  unsigned long code_point;
+  wchar_t encoded[2];
+  size_t encoded_len;
+
+  (void) flags;
+
+  if (code_page != CP_ACP && code_page != CP_UTF8) {
+    SetLastError(ERROR_INVALID_PARAMETER);
+    return 0;
+  }
+
+  str = (const unsigned char*) multi_byte_str;
+  len = (multi_byte_count < 0)
+      ? strlen(multi_byte_str) + 1
+      : (size_t) multi_byte_count;
+
+  num_wide_chars = 0;
+
+  for (i = 0; i < len;) {
+    if (code_page == CP_ACP) {
+      code_point = str[i];
+      i += 1;
+    } else {
+      i += DecodeUtf8(&str[i], len - i, &code_point);
+    }
+
+    if (code_point >= 0x10000) {
+      encoded[0] = (wchar_t) (0xD800 + ((code_point - 0x10000) >> 10));
+      encoded[1] = (wchar_t) (0xDC00 + ((code_point - 0x10000) & 0x3FF));
+      encoded_len = 2;
+    } else {
+      encoded[0] = (wchar_t) code_point;
+      encoded_len = 1;
+    }
+
+    if (wide_char_count != 0) {
+      if (num_wide_chars + encoded_len > (size_t) wide_char_count) {
+        SetLastError(ERROR_INSUFFICIENT_BUFFER);
+        return 0;
+      }
+
+      memcpy(
+          &wide_char_str[num_wide_chars],
+          encoded,
+          encoded_len * sizeof(encoded[0])
+      );
+    }
+
+    num_wide_chars += encoded_len;
+  }
+
+  return (int) num_wide_chars;
+}
+
+/*
+* Memory
+*/
+
+LPVOID WINAPI VirtualAlloc(
+    LPVOID address,
+    SIZE_T size,
+    DWORD allocation_type,
+    DWORD protect
+) {
+  void* allocation;
+
+  (void) allocation_type;
+  (void) protect;
+
+  if (address != NULL) {
+    SetLastError(ERROR_NOT_SUPPORTED);
+    return NULL;
+  }
+
+  allocation = calloc(1, size);
+
+  if (allocation == NULL) {
+    SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+  }
+
+  return allocation;
+}
+
+BOOL WINAPI VirtualFree(LPVOID address, SIZE_T size, DWORD free_type) {
+  if (size != 0 || free_type != MEM_RELEASE) {
+    SetLastError(ERROR_INVALID_PARAMETER);
+    return FALSE;
+  }
+
+  free(address);
+
+  return TRUE;
+}
+
+/* Only pagefile backed mappings are implemented. */
+HANDLE WINAPI CreateFileMappingA(
+    HANDLE file,
+    SECURITY_ATTRIBUTES* attributes,
+    DWORD protect,
+    DWORD maximum_size_high,
+    DWORD maximum_size_low,
+    LPCSTR name
+) {
+  struct CompatObject* mapping;
+
+  (void) attributes;
+  (void) protect;
+
+  if (file != INVALID_HANDLE_VALUE || maximum_size_high != 0 || name != NULL) {
+    SetLastError(ERROR_NOT_SUPPORTED);
+    return NULL;
+  }
+
+  mapping = CreateObject(COMPAT_OBJECT_MAPPING);
+
+  if (mapping == NULL) {
+    return NULL;
+  }
+
+  mapping->view = calloc(1, maximum_size_low);
+
+  if (mapping->view == NULL) {
+    free(mapping);
+    SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    return NULL;
+  }
+
+  pthread_mutex_lock(&object_mutex);
+  mapping->next_mapping = mappings_head;
+  mappings_head = mapping;
+  pthread_mutex_unlock(&object_mutex);
+
+  return mapping;
+}
+
+/* Every view of a mapping is at the same address. */
+LPVOID WINAPI MapViewOfFile(
+    HANDLE file_mapping,
+    DWORD desired_access,
+    DWORD file_offset_high,
+    DWORD file_offset_low,
+    SIZE_T num_bytes_to_map
+) {
+  struct CompatObject* mapping;
+
+  (void) desired_access;
+  (void) num_bytes_to_map;
+
+  mapping = file_mapping;
+
+  if (mapping == NULL
+      || IsPseudoHandle(mapping)
+      || mapping->kind != COMPAT_OBJECT_MAPPING
+      || file_offset_high != 0
+      || file_offset_low != 0) {
+    SetLastError(ERROR_INVALID_PARAMETER);
+    return NULL;
+  }
+
+  pthread_mutex_lock(&object_mutex);
+  mapping->num_references += 1;
+  pthread_mutex_unlock(&object_mutex);
+
+  return mapping->view;
+}
+
+BOOL WINAPI UnmapViewOfFile(LPCVOID base_address) {
+  struct CompatObject* mapping;
+
+  pthread_mutex_lock(&object_mutex);
+
+  for (mapping = mappings_head;
+      mapping != NULL;
+      mapping = mapping->next_mapping) {
+    if (mapping->view == base_address) {
+      ReleaseObjectLocked(mapping);
+      pthread_mutex_unlock(&object_mutex);
+
+      return TRUE;
+    }
+  }
+
+  pthread_mutex_unlock(&object_mutex);
+
+  SetLastError(ERROR_INVALID_PARAMETER);
+
+  return FALSE;
+}
+
+/*
+* Files
+*/
+
+HANDLE WINAPI CreateFileA(
+    LPCSTR file_name,
+    DWORD desired_access,
+    DWORD share_mode,
+    SECURITY_ATTRIBUTES* attributes,
+    DWORD creation_disposition,
+    DWORD flags_and_attributes,
+    HANDLE template_file
+) {
+  char posix_path[MAX_PATH * 4];
+  struct CompatObject* file;
+  struct stat file_stat;
+  int open_flags;
+  int fd;
+
+  (void) share_mode;
+  (void) attributes;
+  (void) flags_and_attributes;
+  (void) template_file;
+
+  if (!ConvertPath(posix_path, sizeof(posix_path), file_name)) {
+    return INVALID_HANDLE_VALUE;
+  }
+
+  if (creation_disposition == OPEN_EXISTING) {
+    open_flags = ((desired_access & GENERIC_WRITE) != 0) ? O_RDWR : O_RDONLY;
+  } else if (creation_disposition == CREATE_ALWAYS) {
+    open_flags = O_RDWR | O_CREAT | O_TRUNC;
+  } else {
+    SetLastError(ERROR_NOT_SUPPORTED);
+    return INVALID_HANDLE_VALUE;
+  }
+
+  fd = open(posix_path, open_flags, 0644);
+
+  if (fd == -1) {
+    SetLastError(GetErrorFromErrno(errno));
+    return INVALID_HANDLE_VALUE;
+  }
+
+  /* Directories can only be opened with backup semantics. */
+  if (fstat(fd, &file_stat) != 0 || S_ISDIR(file_stat.st_mode)) {
+    close(fd);
+    SetLastError(ERROR_ACCESS_DENIED);
+    return INVALID_HANDLE_VALUE;
+  }
+
+  file = CreateObject(COMPAT_OBJECT_FILE);
+
+  if (file == NULL) {
+    close(fd);
+    return INVALID_HANDLE_VALUE;
+  }
+
+  file->fd = fd;
+
+  return file;
+}
+
+BOOL WINAPI ReadFile(
+    HANDLE file,
+    LPVOID buffer,
+    DWORD num_bytes_to_read,
+    DWORD* num_bytes_read,
+    OVERLAPPED* overlapped
+) {
+  ssize_t read_result;
+  DWORD total_bytes_read;
+
+  if (overlapped != NULL) {
+    SetLastError(ERROR_NOT_SUPPORTED);
+    return FALSE;
+  }
+
+  total_bytes_read = 0;
+
+  while (total_bytes_read < num_bytes_to_read) {
+    read_result = read(
+        ((struct CompatObject*) file)->fd,
+        (char*) buffer + total_bytes_read,
+        num_bytes_to_read - total_bytes_read
+    );
+
+    if (read_result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      SetLastError(GetErrorFromErrno(errno));
+      return FALSE;
+    }
+
+    if (read_result == 0) {
+      break;
+    }
+
+    total_bytes_read += (DWORD) read_result;
+  }
+
+  if (num_bytes_read != NULL) {
+    *num_bytes_read = total_bytes_read;
+  }
+
+  return TRUE;
+}
+
+DWORD WINAPI SetFilePointer(
+    HANDLE file,
+    LONG distance_to_move,
+    LONG* distance_to_move_high,
+    DWORD move_method
+) {
+  off_t offset;
+  off_t new_offset;
+
+  if (distance_to_move_high != NULL) {
+    offset = (off_t) (((unsigned long long) (DWORD) *distance_to_move_high << 32)
+        | (DWORD) distance_to_move);
+  } else {
+    offset = distance_to_move;
+  }
+
+  new_offset = lseek(
+      ((struct CompatObject*) file)->fd,
+      offset,
+      (move_method == FILE_BEGIN)
+          ? SEEK_SET
+          : (move_method == FILE_CURRENT) ? SEEK_CUR : SEEK_END
+  );
+
+  if (new_offset == (off_t) -1) {
+    SetLastError(ERROR_INVALID_PARAMETER);
+    return INVALID_SET_FILE_POINTER;
+  }
+
+  if (distance_to_move_high != NULL) {
+    *distance_to_move_high = (LONG) (new_offset >> 32);
+  }
+
+  SetLastError(NO_ERROR);
+
+  return (DWORD) new_offset;
+}
+
+DWORD WINAPI GetFileSize(HANDLE file, DWORD* file_size_high) {
+  struct stat file_stat;
+
+  if (fstat(((struct CompatObject*) file)->fd, &file_stat) != 0) {
+    SetLastError(GetErrorFromErrno(errno));
+    return (DWORD) -1;
+  }
+
+  if (file_size_high != NULL) {
+    *file_size_high = (DWORD) ((unsigned long long) file_stat.st_size >> 32);
+  }
+
+  SetLastError(NO_ERROR);
+
+  return (DWORD) file_stat.st_size;
+}
+
+BOOL WINAPI GetFileInformationByHandle(
+    HANDLE file,
+    BY_HANDLE_FILE_INFORMATION* file_information
+) {
+  struct stat file_stat;
+  unsigned long long file_time;
+
+  if (fstat(((struct CompatObject*) file)->fd, &file_stat) != 0) {
+    SetLastError(GetErrorFromErrno(errno));
+    return FALSE;
+  }
+
+  file_time = ((unsigned long long) kUnixEpochFileTime.dwHighDateTime << 32)
+      | kUnixEpochFileTime.dwLowDateTime;
+  file_time += (unsigned long long) file_stat.st_mtim.tv_sec * 10000000ULL
+      + (unsigned long long) file_stat.st_mtim.tv_nsec / 100;
+
+  memset(file_information, 0, sizeof(*file_information));
+
+  file_information->dwFileAttributes = FILE_ATTRIBUTE_NORMAL;
+  file_information->ftLastWriteTime.dwLowDateTime = (DWORD) file_time;
+  file_information->ftLastWriteTime.dwHighDateTime = (DWORD) (file_time >> 32);
+  file_information->dwVolumeSerialNumber = (DWORD) file_stat.st_dev;
+  file_information->nFileSizeHigh =
+      (DWORD) ((unsigned long long) file_stat.st_size >> 32);
+  file_information->nFileSizeLow = (DWORD) file_stat.st_size;
+  file_information->nNumberOfLinks = (DWORD) file_stat.st_nlink;
+  file_information->nFileIndexHigh =
+      (DWORD) ((unsigned long long) file_stat.st_ino >> 32);
+  file_information->nFileIndexLow = (DWORD) file_stat.st_ino;
+
+  return TRUE;
+}
+
+DWORD WINAPI GetFileAttributesW(LPCWSTR file_name) {
+  char posix_path[MAX_PATH * 4];
+  struct stat file_stat;
+
+  if (!ConvertWidePath(posix_path, sizeof(posix_path), file_name)) {
+    return INVALID_FILE_ATTRIBUTES;
+  }
+
+  if (stat(posix_path, &file_stat) != 0) {
+    SetLastError(GetErrorFromErrno(errno));
+    return INVALID_FILE_ATTRIBUTES;
+  }
+
+  return S_ISDIR(file_stat.st_mode)
+      ? FILE_ATTRIBUTE_DIRECTORY
+      : FILE_ATTRIBUTE_NORMAL;
+}
+
+/* Relative paths are resolved against the current directory. */
+DWORD WINAPI GetFullPathNameW(
+    LPCWSTR file_name,
+    DWORD buffer_length,
+    LPWSTR buffer,
+    LPWSTR* file_part
+) {
+  char current_dir[MAX_PATH * 4];
+  wchar_t full_path[MAX_PATH * 2];
+  size_t current_dir_len;
+  size_t file_name_len;
+  size_t full_path_len;
+
+  current_dir_len = 0;
+
+  if (file_name[0] != L'/' && file_name[0] != L'\\') {
+    if (getcwd(current_dir, sizeof(current_dir)) == NULL) {
+      SetLastError(GetErrorFromErrno(errno));
+      return 0;
+    }
+
+    current_dir_len = (size_t) MultiByteToWideChar(
+        CP_UTF8,
+        0,
+        current_dir,
+        (int) strlen(current_dir),
+        full_path,
+        MAX_PATH
+    );
+
+    if (current_dir_len == 0) {
+      return 0;
+    }
+
+    full_path[current_dir_len] = L'/';
+    current_dir_len += 1;
+  }
+
+  file_name_len = Compat_wcslen(file_name);
+  full_path_len = current_dir_len + file_name_len;
+
+  if (full_path_len >= sizeof(full_path) / sizeof(full_path[0])) {
+    SetLastError(ERROR_INSUFFICIENT_BUFFER);
+    return 0;
+  }
+
+  memcpy(
+      &full_path[current_dir_len],
+      file_name,
+      (file_name_len + 1) * sizeof(full_path[0])
+  );
+
+  if (full_path_len >= buffer_length) {
+    return (DWORD) (full_path_len + 1);
+  }
+
+  memcpy(buffer, full_path, (full_path_len + 1) * sizeof(buffer[0]));
+
+  if (file_part != NULL) {
+    *file_part = buffer + full_path_len;
+
+    while (*file_part > buffer
+        && (*file_part)[-1] != L'/'
+        && (*file_part)[-1] != L'\\') {
+      *file_part -= 1;
+    }
+  }
+
+  return (DWORD) full_path_len;
+}
+
+/*
+* Searches for the file in a directory, without case, as the file
+* system is case sensitive on POSIX. Returns the length of the path
+* found, or zero.
+*/
+static size_t SearchDirectory(
+    const char* dir_path,
+    const char* file_name,
+    char* found_path,
+    size_t found_path_size
+) {
+  DIR* dir;
+  struct dirent* dir_entry;
+  int found_path_len;
+
+  dir = opendir(dir_path);
+
+  if (dir == NULL) {
+    return 0;
+  }
+
+  found_path_len = 0;
+
+  while ((dir_entry = readdir(dir)) != NULL) {
+    if (strcasecmp(dir_entry->d_name, file_name) == 0) {
+      found_path_len = snprintf(
+          found_path,
+          found_path_size,
+          "%s/%s",
+          dir_path,
+          dir_entry->d_name
+      );
+
+      break;
+    }
+  }
+
+  closedir(dir);
+
+  if (found_path_len < 0 || (size_t) found_path_len >= found_path_size) {
+    return 0;
+  }
+
+  return (size_t) found_path_len;
+}
+
+/*
+* Without a path, only the DLLs that are always present in the system
+* directory of a Windows installation are found.
+*/
+DWORD WINAPI SearchPathA(
+    LPCSTR path,
+    LPCSTR file_name,
+    LPCSTR extension,
+    DWORD buffer_length,
+    LPSTR buffer,
+    LPSTR* file_part
+) {
+  static const char* const kSystemLibraries[] = {
+    "advapi32.dll",
+    "comctl32.dll",
+    "ddraw.dll",
+    "dsound.dll",
+    "gdi32.dll",
+    "kernel32.dll",
+    "msvcrt.dll",
+    "ntdll.dll",
+    "ole32.dll",
+    "shell32.dll",
+    "shlwapi.dll",
+    "user32.dll",
+    "version.dll",
+    "winmm.dll",
+    "wsock32.dll"
+  };
+
+  char dir_path[MAX_PATH * 4];
+  char found_path[MAX_PATH * 4];
+  size_t found_path_len;
+  size_t i;
+
+  (void) extension;
+
+  found_path_len = 0;
+
+  if (path == NULL) {
+    for (i = 0; i < sizeof(kSystemLibraries) / sizeof(kSystemLibraries[0]); i += 1) {
+      if (strcasecmp(kSystemLibraries[i], file_name) == 0) {
+        found_path_len = (size_t) snprintf(
+            found_path,
+            sizeof(found_path),
+            "C:\\WINDOWS\\system32\\%s",
+            kSystemLibraries[i]
+        );
+
+        break;
+      }
+    }
+  } else if (ConvertPath(dir_path, sizeof(dir_path), path)) {
+    found_path_len = SearchDirectory(
+        dir_path,
+        file_name,
+        found_path,
+        sizeof(found_path)
+    );
+  }
+
+  if (found_path_len == 0) {
+    SetLastError(ERROR_FILE_NOT_FOUND);
+    return 0;
+  }
+
+  if (found_path_len >= buffer_length) {
+    return (DWORD) (found_path_len + 1);
+  }
+
+  memcpy(buffer, found_path, found_path_len + 1);
+
+  if (file_part != NULL) {
+    *file_part = strrchr(buffer, (path == NULL) ? '\\' : '/') + 1;
+  }
+
+  return (DWORD) found_path_len;
+}
+
+/*
+* Not implemented
+*/
+
+DWORD WINAPI GetFileVersionInfoSizeW(LPCWSTR file_name, DWORD* handle) {
+  (void) file_name;
+
+  if (handle != NULL) {
+    *handle = 0;
+  }
+
+  SetLastError(ERROR_RESOURCE_TYPE_NOT_FOUND);
+
+  return 0;
+}
+
+BOOL WINAPI GetFileVersionInfoW(
+    LPCWSTR file_name,
+    DWORD handle,
+    DWORD length,
+    LPVOID data
+) {
+  (void) file_name;
+  (void) handle;
+  (void) length;
+  (void) data;
+
+  SetLastError(ERROR_RESOURCE_TYPE_NOT_FOUND);
+
+  return FALSE;
+}
+
+BOOL WINAPI VerQueryValueW(
+    LPCVOID block,
+    LPCWSTR sub_block,
+    LPVOID* buffer,
+    UINT* length
+) {
+  (void) block;
+  (void) sub_block;
+  (void) buffer;
+  (void) length;
+
+  SetLastError(ERROR_RESOURCE_TYPE_NOT_FOUND);
+
+  return FALSE;
+}
+
+BOOL WINAPI ReadProcessMemory(
+    HANDLE process,
+    LPCVOID base_address,
+    LPVOID buffer,
+    SIZE_T size,
+    SIZE_T* num_bytes_read
+) {
+  (void) process;
+  (void) base_address;
+  (void) buffer;
+  (void) size;
+
+  if (num_bytes_read != NULL) {
+    *num_bytes_read = 0;
+  }
+
+  SetLastError(ERROR_NOT_SUPPORTED);
+
+  return FALSE;
+}
+
+BOOL WINAPI WriteProcessMemory(
+    HANDLE process,
+    LPVOID base_address,
+    LPCVOID buffer,
+    SIZE_T size,
+    SIZE_T* num_bytes_written
+) {
+  (void) process;
+  (void) base_address;
+  (void) buffer;
+  (void) size;
+
+  if (num_bytes_written != NULL) {
+    *num_bytes_written = 0;
+  }
+
+  SetLastError(ERROR_NOT_SUPPORTED);
+
+  return FALSE;
+}
+
+BOOL WINAPI VirtualProtectEx(
+    HANDLE process,
+    LPVOID address,
+    SIZE_T size,
+    DWORD new_protect,
+    DWORD* old_protect
+) {
+  (void) process;
+  (void) address;
+  (void) size;
+  (void) new_protect;
+  (void) old_protect;
+
+  SetLastError(ERROR_NOT_SUPPORTED);
+
+  return FALSE;
+}
+
+SIZE_T WINAPI VirtualQueryEx(
+    HANDLE process,
+    LPCVOID address,
+    MEMORY_BASIC_INFORMATION* buffer,
+    SIZE_T length
+) {
+  (void) process;
+  (void) address;
+  (void) buffer;
+  (void) length;
+
+  SetLastError(ERROR_NOT_SUPPORTED);
+
+  return 0;
+}
+
+LPVOID WINAPI VirtualAllocEx(
+    HANDLE process,
+    LPVOID address,
+    SIZE_T size,
+    DWORD allocation_type,
+    DWORD protect
+) {
+  (void) process;
+  (void) address;
+  (void) size;
+  (void) allocation_type;
+  (void) protect;
+
+  SetLastError(ERROR_NOT_SUPPORTED);
+
+  return NULL;
+}
+
+BOOL WINAPI VirtualFreeEx(
+    HANDLE process,
+    LPVOID address,
+    SIZE_T size,
+    DWORD free_type
+) {
+  (void) process;
+  (void) address;
+  (void) size;
+  (void) free_type;
+
+  SetLastError(ERROR_NOT_SUPPORTED);
+
+  return FALSE;
+}
+
+DWORD WINAPI QueueUserAPC(PAPCFUNC apc, HANDLE thread, ULONG_PTR data) {
+  (void) apc;
+  (void) thread;
+  (void) data;
+
+  SetLastError(ERROR_NOT_SUPPORTED);
+
+  return 0;
+}
+
+HANDLE WINAPI CreateRemoteThread(
+    HANDLE process,
+    SECURITY_ATTRIBUTES* attributes,
+    SIZE_T stack_size,
+    LPTHREAD_START_ROUTINE start_address,
+    LPVOID parameter,
+    DWORD creation_flags,
+    DWORD* thread_id
+) {
+  (void) process;
+  (void) attributes;
+  (void) stack_size;
+  (void) start_address;
+  (void) parameter;
+  (void) creation_flags;
+  (void) thread_id;
+
+  SetLastError(ERROR_NOT_SUPPORTED);
+
+  return NULL;
+}
@@ -0,0 +1,454 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#include "fixture_pe.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum Constant {
+  MAX_VERSION_BLOCK_SIZE = 2048,
+
+  NT_HEADERS_OFFSET = 0x100,
+  SIZE_OF_HEADERS = 0x400,
+  SECTION_RVA = 0x1000,
+  FILE_ALIGNMENT = 0x200,
+  SECTION_ALIGNMENT = 0x1000,
+
+  NODE_TYPE_BINARY = 0,
+  NODE_TYPE_TEXT = 1,
+
+  /*
+  * The resource section holds one directory for each of the type, name
+  * and language levels, each with one ID entry, then the data entry and
+  * the version block.
+  */
+  RESOURCE_DIRECTORY_SIZE = 16,
+  RESOURCE_DIRECTORY_NUM_ID_ENTRIES_OFFSET = 14,
+  RESOURCE_DIRECTORY_ENTRY_SIZE = 8,
+  RESOURCE_DATA_ENTRY_SIZE = 16,
+  RESOURCE_LEVEL_SIZE =
+      RESOURCE_DIRECTORY_SIZE + RESOURCE_DIRECTORY_ENTRY_SIZE,
+  RESOURCE_NAME_DIRECTORY_OFFSET = RESOURCE_LEVEL_SIZE,
+  RESOURCE_LANGUAGE_DIRECTORY_OFFSET = 2 * RESOURCE_LEVEL_SIZE,
+  RESOURCE_DATA_ENTRY_OFFSET = 3 * RESOURCE_LEVEL_SIZE,
+  VERSION_BLOCK_OFFSET = RESOURCE_DATA_ENTRY_OFFSET + RESOURCE_DATA_ENTRY_SIZE,
+
+  RESOURCE_NAME_ID = 1,
+  LANGUAGE_ENGLISH_US = 0x0409,
+  CODE_PAGE_UNICODE = 0x04B0
+};
+
+static const DWORD kResourceSubdirectoryFlag = 0x80000000;
+
+static const wchar_t kTranslationKey[] = L"040904b0";
+
+struct BlockWriter {
+  unsigned char data[MAX_VERSION_BLOCK_SIZE];
+  size_t size;
+  int is_overflowed;
+};
+
+static void BlockWriter_Write(
+    struct BlockWriter* writer,
+    const void* data,
+    size_t size
+) {
+  if (writer->is_overflowed || sizeof(writer->data) - writer->size < size) {
+    writer->is_overflowed = 1;
+    return;
+  }
+
+  memcpy(writer->data + writer->size, data, size);
+  writer->size += size;
+}
+
+static void BlockWriter_WriteWord(struct BlockWriter* writer, WORD value) {
+  BlockWriter_Write(writer, &value, sizeof(value));
+}
+
+static void BlockWriter_Align(struct BlockWriter* writer) {
+  static const unsigned char kPadding[3] = { 0 };
+
+  BlockWriter_Write(writer, kPadding, (4 - (writer->size & 3)) & 3);
+}
+
+/*
+* Writes the header, key and value of a node, and returns its offset so
+* that its length can be set once its children are written.
+*/
+static size_t BlockWriter_BeginNode(
+    struct BlockWriter* writer,
+    const wchar_t* key,
+    WORD type,
+    const void* value,
+    WORD value_length,
+    size_t value_size
+) {
+  size_t node_offset;
+
+  BlockWriter_Align(writer);
+
+  node_offset = writer->size;
+
+  BlockWriter_WriteWord(writer, 0);
+  BlockWriter_WriteWord(writer, value_length);
+  BlockWriter_WriteWord(writer, type);
+  BlockWriter_Write(writer, key, (wcslen(key) + 1) * sizeof(key[0]));
+
+  if (value_size > 0) {
+    BlockWriter_Align(writer);
+    BlockWriter_Write(writer, value, value_size);
+  }
+
+  return node_offset;
+}
+
+static void BlockWriter_EndNode(
+    struct BlockWriter* writer,
+    size_t node_offset
+) {
+  WORD length;
+
+  if (writer->is_overflowed) {
+    return;
+  }
+
+  length = (WORD) (writer->size - node_offset);
+  memcpy(writer->data + node_offset, &length, sizeof(length));
+}
+
+static void BlockWriter_WriteString(
+    struct BlockWriter* writer,
+    const wchar_t* key,
+    const wchar_t* value
+) {
+  size_t value_len;
+
+  /* The length of a text value is in characters, with the terminator. */
+  value_len = wcslen(value) + 1;
+
+  BlockWriter_EndNode(
+      writer,
+      BlockWriter_BeginNode(
+          writer,
+          key,
+          NODE_TYPE_TEXT,
+          value,
+          (WORD) value_len,
+          value_len * sizeof(value[0])
+      )
+  );
+}
+
+static void WriteDword(unsigned char* buffer, size_t offset, DWORD value) {
+  memcpy(buffer + offset, &value, sizeof(value));
+}
+
+static void WriteResourceDirectory(
+    unsigned char* section,
+    size_t directory_offset,
+    WORD id,
+    DWORD entry_data
+) {
+  WORD num_id_entries;
+
+  num_id_entries = 1;
+
+  memcpy(
+      section + directory_offset + RESOURCE_DIRECTORY_NUM_ID_ENTRIES_OFFSET,
+      &num_id_entries,
+      sizeof(num_id_entries)
+  );
+  WriteDword(section, directory_offset + RESOURCE_DIRECTORY_SIZE, id);
+  WriteDword(
+      section,
+      directory_offset + RESOURCE_DIRECTORY_SIZE + sizeof(DWORD),
+      entry_data
+  );
+}
+
+static DWORD AlignUp(DWORD value, DWORD alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void FixturePeSpec_Init(struct FixturePeSpec* spec) {
+  memset(spec, 0, sizeof(*spec));
+}
+
+unsigned char* FixturePe_BuildVersionBlock(
+    const struct FixturePeSpec* spec,
+    size_t* block_size
+) {
+  struct BlockWriter* writer;
+  VS_FIXEDFILEINFO file_info;
+  WORD translation[2];
+  size_t root_offset;
+  size_t string_file_info_offset;
+  size_t string_table_offset;
+  size_t var_file_info_offset;
+  unsigned char* block;
+
+  writer = malloc(sizeof(*writer));
+
+  if (writer == NULL) {
+    return NULL;
+  }
+
+  writer->size = 0;
+  writer->is_overflowed = 0;
+
+  memset(&file_info, 0, sizeof(file_info));
+  file_info.dwSignature = VS_FFI_SIGNATURE;
+  file_info.dwStrucVersion = 0x00010000;
+  file_info.dwFileVersionMS = spec->file_version_ms;
+  file_info.dwFileVersionLS = spec->file_version_ls;
+  file_info.dwProductVersionMS = spec->product_version_ms;
+  file_info.dwProductVersionLS = spec->product_version_ls;
+
+  root_offset = BlockWriter_BeginNode(
+      writer,
+      L"VS_VERSION_INFO",
+      NODE_TYPE_BINARY,
+      &file_info,
+      sizeof(file_info),
+      sizeof(file_info)
+  );
+
+  string_file_info_offset = BlockWriter_BeginNode(
+      writer,
+      L"StringFileInfo",
+      NODE_TYPE_TEXT,
+      NULL,
+      0,
+      0
+  );
+
+  string_table_offset = BlockWriter_BeginNode(
+      writer,
+      kTranslationKey,
+      NODE_TYPE_TEXT,
+      NULL,
+      0,
+      0
+  );
+
+  if (spec->file_version_str != NULL) {
+    BlockWriter_WriteString(writer, L"FileVersion", spec->file_version_str);
+  }
+
+  if (spec->product_name != NULL) {
+    BlockWriter_WriteString(writer, L"ProductName", spec->product_name);
+  }
+
+  BlockWriter_EndNode(writer, string_table_offset);
+  BlockWriter_EndNode(writer, string_file_info_offset);
+
+  var_file_info_offset = BlockWriter_BeginNode(
+      writer,
+      L"VarFileInfo",
+      NODE_TYPE_TEXT,
+      NULL,
+      0,
+      0
+  );
+
+  translation[0] = LANGUAGE_ENGLISH_US;
+  translation[1] = CODE_PAGE_UNICODE;
+
+  BlockWriter_EndNode(
+      writer,
+      BlockWriter_BeginNode(
+          writer,
+          L"Translation",
+          NODE_TYPE_BINARY,
+          translation,
+          sizeof(translation),
+          sizeof(translation)
+      )
+  );
+
+  BlockWriter_EndNode(writer, var_file_info_offset);
+  BlockWriter_EndNode(writer, root_offset);
+
+  block = NULL;
+
+  if (writer->is_overflowed) {
+    goto free_writer;
+  }
+
+  block = malloc(writer->size);
+
+  if (block == NULL) {
+    goto free_writer;
+  }
+
+  memcpy(block, writer->data, writer->size);
+  *block_size = writer->size;
+
+free_writer:
+  free(writer);
+
+  return block;
+}
+
+unsigned char* FixturePe_Build(
+    const struct FixturePeSpec* spec,
+    size_t* file_size
+) {
+  unsigned char* version_block;
+  size_t version_block_size;
+  DWORD section_data_size;
+  DWORD section_raw_size;
+
+  IMAGE_DOS_HEADER dos_header;
+  IMAGE_NT_HEADERS nt_headers;
+  IMAGE_SECTION_HEADER section_header;
+  IMAGE_RESOURCE_DATA_ENTRY data_entry;
+
+  unsigned char* file_data;
+  unsigned char* section;
+
+  if (spec->signature_offset != 0
+      && (spec->signature_offset < (long) sizeof(dos_header)
+          || spec->signature_offset
+              > NT_HEADERS_OFFSET - (long) sizeof(spec->signature))) {
+    return NULL;
+  }
+
+  version_block = FixturePe_BuildVersionBlock(spec, &version_block_size);
+
+  if (version_block == NULL) {
+    return NULL;
+  }
+
+  section_data_size = VERSION_BLOCK_OFFSET + (DWORD) version_block_size;
+  section_raw_size = AlignUp(section_data_size, FILE_ALIGNMENT);
+
+  *file_size = SIZE_OF_HEADERS + section_raw_size;
+  file_data = calloc(*file_size, 1);
+
+  if (file_data == NULL) {
+    goto free_version_block;
+  }
+
+  memset(&dos_header, 0, sizeof(dos_header));
+  dos_header.e_magic = IMAGE_DOS_SIGNATURE;
+  dos_header.e_lfanew = NT_HEADERS_OFFSET;
+  memcpy(file_data, &dos_header, sizeof(dos_header));
+
+  if (spec->signature_offset != 0) {
+    memcpy(
+        file_data + spec->signature_offset,
+        spec->signature,
+        sizeof(spec->signature)
+    );
+  }
+
+  memset(&nt_headers, 0, sizeof(nt_headers));
+  nt_headers.Signature = IMAGE_NT_SIGNATURE;
+  nt_headers.FileHeader.Machine = IMAGE_FILE_MACHINE_I386;
+  nt_headers.FileHeader.NumberOfSections = 1;
+  nt_headers.FileHeader.SizeOfOptionalHeader =
+      sizeof(nt_headers.OptionalHeader);
+  nt_headers.FileHeader.Characteristics = IMAGE_FILE_EXECUTABLE_IMAGE
+      | IMAGE_FILE_32BIT_MACHINE
+      | spec->characteristics;
+
+  nt_headers.OptionalHeader.Magic = IMAGE_NT_OPTIONAL_HDR32_MAGIC;
+  nt_headers.OptionalHeader.ImageBase =
+      (spec->characteristics & IMAGE_FILE_DLL) ? 0x10000000 : 0x00400000;
+  nt_headers.OptionalHeader.SectionAlignment = SECTION_ALIGNMENT;
+  nt_headers.OptionalHeader.FileAlignment = FILE_ALIGNMENT;
+  nt_headers.OptionalHeader.MajorSubsystemVersion = 4;
+  nt_headers.OptionalHeader.SizeOfImage = SECTION_RVA
+      + AlignUp(section_data_size, SECTION_ALIGNMENT);
+  nt_headers.OptionalHeader.SizeOfHeaders = SIZE_OF_HEADERS;
+  nt_headers.OptionalHeader.Subsystem = 2;
+  nt_headers.OptionalHeader.NumberOfRvaAndSizes =
+      IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+  nt_headers.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_RESOURCE]
+      .VirtualAddress = SECTION_RVA;
+  nt_headers.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_RESOURCE]
+      .Size = section_data_size;
+  memcpy(file_data + NT_HEADERS_OFFSET, &nt_headers, sizeof(nt_headers));
+
+  memset(&section_header, 0, sizeof(section_header));
+  memcpy(section_header.Name, ".rsrc", sizeof(".rsrc"));
+  section_header.Misc.VirtualSize = section_data_size;
+  section_header.VirtualAddress = SECTION_RVA;
+  section_header.SizeOfRawData = section_raw_size;
+  section_header.PointerToRawData = SIZE_OF_HEADERS;
+  section_header.Characteristics = IMAGE_SCN_CNT_INITIALIZED_DATA
+      | IMAGE_SCN_MEM_READ;
+  memcpy(
+      file_data + NT_HEADERS_OFFSET + sizeof(nt_headers),
+      &section_header,
+      sizeof(section_header)
+  );
+
+  section = file_data + SIZE_OF_HEADERS;
+
+  WriteResourceDirectory(
+      section,
+      0,
+      RT_VERSION,
+      kResourceSubdirectoryFlag | RESOURCE_NAME_DIRECTORY_OFFSET
+  );
+  WriteResourceDirectory(
+      section,
+      RESOURCE_NAME_DIRECTORY_OFFSET,
+      RESOURCE_NAME_ID,
+      kResourceSubdirectoryFlag | RESOURCE_LANGUAGE_DIRECTORY_OFFSET
+  );
+  WriteResourceDirectory(
+      section,
+      RESOURCE_LANGUAGE_DIRECTORY_OFFSET,
+      LANGUAGE_ENGLISH_US,
+      RESOURCE_DATA_ENTRY_OFFSET
+  );
+
+  /* The data entry holds the RVA of the data, not its section offset. */
+  memset(&data_entry, 0, sizeof(data_entry));
+  data_entry.OffsetToData = SECTION_RVA + VERSION_BLOCK_OFFSET;
+  data_entry.Size = (DWORD) version_block_size;
+  memcpy(
+      section + RESOURCE_DATA_ENTRY_OFFSET,
+      &data_entry,
+      sizeof(data_entry)
+  );
+
+  memcpy(section + VERSION_BLOCK_OFFSET, version_block, version_block_size);
+
+free_version_block:
+  free(version_block);
+
+  return file_data;
+}
@@ -0,0 +1,86 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#ifndef SGGLDKL_TESTS_FIXTURE_PE_H_
+#define SGGLDKL_TESTS_FIXTURE_PE_H_
+
+#include <stddef.h>
+#include <wchar.h>
+#include <windows.h>
+
+/*
+* Builds synthetic 32-bit PE files, laid out as on disk, with a version
+* resource in their only section. They hold just enough for the game
+* detection to read them, so that every game version can be detected
+* without the game files.
+*/
+
+struct FixturePeSpec {
+  /* Zero for an executable, or IMAGE_FILE_DLL for a library. */
+  WORD characteristics;
+
+  /* The strings of the version resource, or NULL to leave them out. */
+  const wchar_t* product_name;
+  const wchar_t* file_version_str;
+
+  DWORD file_version_ms;
+  DWORD file_version_ls;
+  DWORD product_version_ms;
+  DWORD product_version_ls;
+
+  /*
+  * Bytes written into the headers, where the signatures of the game
+  * files are checked, or a zero offset to write nothing. The offset
+  * must be in the DOS stub, before the NT headers.
+  */
+  long signature_offset;
+  unsigned char signature[4];
+};
+
+/* Builds an unused spec, with every version zero and no strings. */
+void FixturePeSpec_Init(struct FixturePeSpec* spec);
+
+/*
+* Returns a VS_VERSIONINFO block with the fixed file info and strings,
+* in the form read by VersionResource_ParseFileInfo, or NULL on
+* failure. The block must be freed.
+*/
+unsigned char* FixturePe_BuildVersionBlock(
+    const struct FixturePeSpec* spec,
+    size_t* block_size
+);
+
+/* Returns the PE file, which must be freed, or NULL on failure. */
+unsigned char* FixturePe_Build(
+    const struct FixturePeSpec* spec,
+    size_t* file_size
+);
+
+#endif /* SGGLDKL_TESTS_FIXTURE_PE_H_ */
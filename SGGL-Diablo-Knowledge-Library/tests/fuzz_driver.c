@@ -0,0 +1,531 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+/*
+* Runs the fuzz targets without libFuzzer. With no arguments, the seed
+* corpus is built from synthetic fixtures and mutated at random, and
+* the executions per second of each target are printed as a JSON
+* report. Otherwise, each argument is a file that is run through every
+* target once, which is how AFL runs the driver and how a crashing
+* input is reproduced.
+*
+*   fuzz_driver                       Fuzzes and reports execs/s.
+*   fuzz_driver FILE...               Runs the files.
+*   fuzz_driver --write-corpus DIR    Writes the seed corpus.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "../src/helper/version_resource.h"
+#include "../src/patch_helper/pe_header.h"
+#include "bench_util.h"
+#include "fixture_pe.h"
+#include "fuzz_parsers.h"
+
+#define MAKE_VERSION_PART(left, right) \
+    (((DWORD) (left) << 16) | (right))
+
+enum Constant {
+  MAX_NUM_SEEDS = 8,
+  MAX_NUM_MUTATIONS = 4,
+
+  /* Cut inside the NT headers of the fixtures. */
+  TRUNCATED_HEADERS_SIZE = 0x180,
+
+  STORM_SIGNATURE_OFFSET = 0xF0
+};
+
+static const DWORD kInterestingValues[] = {
+  0x00000000, 0x00000001, 0x0000FFFF, 0x00010000,
+  0x7FFFFFFF, 0x80000000, 0xFFFFFFFE, 0xFFFFFFFF
+};
+
+struct FuzzSeed {
+  const char* name;
+  unsigned char* data;
+  size_t size;
+};
+
+struct FuzzTarget {
+  const char* name;
+  void (*func)(const unsigned char* data, size_t size);
+};
+
+static const struct FuzzTarget kFuzzTargets[] = {
+  { "fuzz/pe_header", &FuzzParsers_RunPeHeader },
+  { "fuzz/version_resource", &FuzzParsers_RunVersionResource },
+  { "fuzz/buffer_detection", &FuzzParsers_RunBufferDetection },
+  { "fuzz/all_targets", &FuzzParsers_RunAll }
+};
+
+/*
+* The mutated input is placed at the end of its buffer, so that any read
+* past its size runs into the redzone of the address sanitizer.
+*/
+struct FuzzContext {
+  const struct FuzzSeed* seeds;
+  size_t num_seeds;
+  size_t i_next_seed;
+
+  void (*target_func)(const unsigned char* data, size_t size);
+  unsigned int random_state;
+
+  unsigned char* scratch;
+  unsigned char* input;
+  size_t input_capacity;
+};
+
+static int AddSeed(
+    struct FuzzSeed* seeds,
+    size_t* num_seeds,
+    const char* name,
+    unsigned char* data,
+    size_t size
+) {
+  if (data == NULL) {
+    return 0;
+  }
+
+  seeds[*num_seeds].name = name;
+  seeds[*num_seeds].data = data;
+  seeds[*num_seeds].size = size;
+  *num_seeds += 1;
+
+  return 1;
+}
+
+/*
+* Builds a seed for every kind of input that the parsers take: the games
+* of each family, storm.dll with a signature, a bare version block, and
+* headers that are cut short. Returns zero on failure, in which case
+* the seeds that were built still need to be freed.
+*/
+static int BuildSeeds(struct FuzzSeed* seeds, size_t* num_seeds) {
+  struct FixturePeSpec spec;
+  unsigned char* data;
+  size_t size;
+
+  *num_seeds = 0;
+
+  FixturePeSpec_Init(&spec);
+  spec.product_name = L"Blizzard Entertainment Diablo";
+  spec.file_version_ms = MAKE_VERSION_PART(96, 12);
+  spec.file_version_ls = MAKE_VERSION_PART(26, 3);
+  spec.product_version_ms = spec.file_version_ms;
+  spec.product_version_ls = spec.file_version_ls;
+
+  data = FixturePe_Build(&spec, &size);
+
+  if (!AddSeed(seeds, num_seeds, "diablo_exe", data, size)) {
+    return 0;
+  }
+
+  FixturePeSpec_Init(&spec);
+  spec.product_name = L"Synergistic Software Hellfire";
+  spec.file_version_str = L"1.01";
+  spec.file_version_ms = MAKE_VERSION_PART(1, 0);
+  spec.file_version_ls = MAKE_VERSION_PART(1, 0);
+
+  data = FixturePe_Build(&spec, &size);
+
+  if (!AddSeed(seeds, num_seeds, "hellfire_exe", data, size)) {
+    return 0;
+  }
+
+  FixturePeSpec_Init(&spec);
+  spec.product_name = L"Diablo II";
+  spec.file_version_str = L"1, 0, 13, 60";
+  spec.file_version_ms = MAKE_VERSION_PART(1, 0);
+  spec.file_version_ls = MAKE_VERSION_PART(13, 60);
+
+  data = FixturePe_Build(&spec, &size);
+
+  if (!AddSeed(seeds, num_seeds, "diablo_ii_exe", data, size)) {
+    return 0;
+  }
+
+  data = FixturePe_BuildVersionBlock(&spec, &size);
+
+  if (!AddSeed(seeds, num_seeds, "version_block", data, size)) {
+    return 0;
+  }
+
+  FixturePeSpec_Init(&spec);
+  spec.characteristics = IMAGE_FILE_DLL;
+  spec.file_version_ms = MAKE_VERSION_PART(1998, 4);
+  spec.file_version_ls = MAKE_VERSION_PART(15, 1);
+  spec.signature_offset = STORM_SIGNATURE_OFFSET;
+  memcpy(spec.signature, "\x8B\x44\x24\x04", sizeof(spec.signature));
+
+  data = FixturePe_Build(&spec, &size);
+
+  if (!AddSeed(seeds, num_seeds, "storm_dll", data, size)) {
+    return 0;
+  }
+
+  data = malloc(TRUNCATED_HEADERS_SIZE);
+
+  if (data != NULL) {
+    memcpy(data, seeds[0].data, TRUNCATED_HEADERS_SIZE);
+  }
+
+  if (!AddSeed(
+      seeds,
+      num_seeds,
+      "truncated_headers",
+      data,
+      TRUNCATED_HEADERS_SIZE
+  )) {
+    return 0;
+  }
+
+  return 1;
+}
+
+static void FreeSeeds(struct FuzzSeed* seeds, size_t num_seeds) {
+  size_t i_seed;
+
+  for (i_seed = 0; i_seed < num_seeds; i_seed += 1) {
+    free(seeds[i_seed].data);
+  }
+}
+
+/*
+* Checks that the seeds reach the parsers that they were built for, so
+* that the mutations start from inputs that are parsed in depth.
+*/
+static int CheckSeeds(const struct FuzzSeed* seeds, size_t num_seeds) {
+  size_t i_seed;
+  IMAGE_NT_HEADERS nt_headers;
+  VS_FIXEDFILEINFO file_info;
+  int is_pe_file;
+  int is_valid;
+
+  for (i_seed = 0; i_seed < num_seeds; i_seed += 1) {
+    is_pe_file = PeHeader_ParseNtHeaders(
+        &nt_headers,
+        seeds[i_seed].data,
+        seeds[i_seed].size
+    );
+
+    if (strcmp(seeds[i_seed].name, "version_block") == 0) {
+      is_valid = !is_pe_file && VersionResource_ParseFileInfo(
+          &file_info,
+          seeds[i_seed].data,
+          seeds[i_seed].size
+      );
+    } else if (strcmp(seeds[i_seed].name, "truncated_headers") == 0) {
+      is_valid = !is_pe_file;
+    } else {
+      is_valid = is_pe_file;
+    }
+
+    if (!is_valid) {
+      printf("The seed %s is not parsed as expected.\n", seeds[i_seed].name);
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+static void Mutate(
+    unsigned char* input,
+    size_t* size,
+    unsigned int* random_state
+) {
+  unsigned int choice;
+  size_t position;
+  DWORD value;
+
+  if (*size == 0) {
+    return;
+  }
+
+  choice = rand_r(random_state) % 8;
+  position = rand_r(random_state) % *size;
+
+  switch (choice) {
+    case 0:
+    case 1:
+    case 2: {
+      input[position] ^= (unsigned char) (1 << (rand_r(random_state) % 8));
+      break;
+    }
+
+    case 3:
+    case 4: {
+      input[position] = (unsigned char) rand_r(random_state);
+      break;
+    }
+
+    case 5:
+    case 6: {
+      if (*size < sizeof(value)) {
+        break;
+      }
+
+      position = rand_r(random_state) % (*size - sizeof(value) + 1);
+      value = kInterestingValues[
+          rand_r(random_state)
+              % (sizeof(kInterestingValues) / sizeof(kInterestingValues[0]))
+      ];
+
+      memcpy(&input[position], &value, sizeof(value));
+
+      break;
+    }
+
+    default: {
+      *size = position;
+      break;
+    }
+  }
+}
+
+static void RunMutatedInput(void* context) {
+  struct FuzzContext* fuzz_context;
+  const struct FuzzSeed* seed;
+  size_t size;
+  unsigned int num_mutations;
+  unsigned int i_mutation;
+  unsigned char* input;
+
+  fuzz_context = context;
+
+  seed = &fuzz_context->seeds[fuzz_context->i_next_seed];
+  fuzz_context->i_next_seed =
+      (fuzz_context->i_next_seed + 1) % fuzz_context->num_seeds;
+
+  memcpy(fuzz_context->scratch, seed->data, seed->size);
+  size = seed->size;
+
+  num_mutations = 1 + rand_r(&fuzz_context->random_state)
+      % MAX_NUM_MUTATIONS;
+
+  for (i_mutation = 0; i_mutation < num_mutations; i_mutation += 1) {
+    Mutate(fuzz_context->scratch, &size, &fuzz_context->random_state);
+  }
+
+  input = fuzz_context->input + fuzz_context->input_capacity - size;
+  memcpy(input, fuzz_context->scratch, size);
+
+  fuzz_context->target_func(input, size);
+}
+
+static void RunSeeds(void* context) {
+  const struct FuzzContext* fuzz_context;
+  size_t i_seed;
+
+  fuzz_context = context;
+
+  for (i_seed = 0; i_seed < fuzz_context->num_seeds; i_seed += 1) {
+    FuzzParsers_RunAll(
+        fuzz_context->seeds[i_seed].data,
+        fuzz_context->seeds[i_seed].size
+    );
+  }
+}
+
+static int Fuzz(const struct FuzzSeed* seeds, size_t num_seeds) {
+  struct FuzzContext fuzz_context;
+  struct BenchResult result;
+  size_t i_seed;
+  size_t i_target;
+
+  memset(&fuzz_context, 0, sizeof(fuzz_context));
+  fuzz_context.seeds = seeds;
+  fuzz_context.num_seeds = num_seeds;
+
+  for (i_seed = 0; i_seed < num_seeds; i_seed += 1) {
+    if (seeds[i_seed].size > fuzz_context.input_capacity) {
+      fuzz_context.input_capacity = seeds[i_seed].size;
+    }
+  }
+
+  fuzz_context.scratch = malloc(fuzz_context.input_capacity);
+  fuzz_context.input = malloc(fuzz_context.input_capacity);
+
+  if (fuzz_context.scratch == NULL || fuzz_context.input == NULL) {
+    free(fuzz_context.input);
+    free(fuzz_context.scratch);
+
+    return 0;
+  }
+
+  BenchUtil_BeginReport("fuzz_parsers");
+
+  /* Each call runs the whole corpus, unmutated. */
+  BenchUtil_Measure(&result, "fuzz/seed_corpus", &RunSeeds, &fuzz_context);
+  BenchUtil_ReportResult(&result);
+
+  for (i_target = 0;
+      i_target < sizeof(kFuzzTargets) / sizeof(kFuzzTargets[0]);
+      i_target += 1) {
+    fuzz_context.target_func = kFuzzTargets[i_target].func;
+
+    /* The same inputs for each target, so that their rates compare. */
+    fuzz_context.random_state = 1;
+    fuzz_context.i_next_seed = 0;
+
+    BenchUtil_Measure(
+        &result,
+        kFuzzTargets[i_target].name,
+        &RunMutatedInput,
+        &fuzz_context
+    );
+    BenchUtil_ReportResult(&result);
+  }
+
+  BenchUtil_EndReport();
+
+  free(fuzz_context.input);
+  free(fuzz_context.scratch);
+
+  return 1;
+}
+
+static int WriteCorpus(
+    const char* directory_path,
+    const struct FuzzSeed* seeds,
+    size_t num_seeds
+) {
+  size_t i_seed;
+  char path[1024];
+  FILE* seed_file;
+  size_t num_written;
+
+  for (i_seed = 0; i_seed < num_seeds; i_seed += 1) {
+    snprintf(
+        path,
+        sizeof(path),
+        "%s/%s",
+        directory_path,
+        seeds[i_seed].name
+    );
+
+    seed_file = fopen(path, "wb");
+
+    if (seed_file == NULL) {
+      printf("Could not open %s.\n", path);
+      return 0;
+    }
+
+    num_written = fwrite(seeds[i_seed].data, 1, seeds[i_seed].size, seed_file);
+    fclose(seed_file);
+
+    if (num_written != seeds[i_seed].size) {
+      printf("Could not write %s.\n", path);
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+static int RunFile(const char* path) {
+  FILE* input_file;
+  unsigned char* data;
+  long size;
+
+  input_file = fopen(path, "rb");
+
+  if (input_file == NULL) {
+    printf("Could not open %s.\n", path);
+    return 0;
+  }
+
+  fseek(input_file, 0, SEEK_END);
+  size = ftell(input_file);
+  fseek(input_file, 0, SEEK_SET);
+
+  /* Exactly the size of the file, for the address sanitizer. */
+  data = malloc((size > 0) ? size : 1);
+
+  if (data == NULL || fread(data, 1, size, input_file) != (size_t) size) {
+    printf("Could not read %s.\n", path);
+
+    free(data);
+    fclose(input_file);
+
+    return 0;
+  }
+
+  fclose(input_file);
+
+  FuzzParsers_RunAll(data, size);
+
+  free(data);
+
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  struct FuzzSeed seeds[MAX_NUM_SEEDS];
+  size_t num_seeds;
+  int is_success;
+  int i_arg;
+
+  if (argc > 1 && strcmp(argv[1], "--write-corpus") != 0) {
+    for (i_arg = 1; i_arg < argc; i_arg += 1) {
+      if (!RunFile(argv[i_arg])) {
+        return 1;
+      }
+    }
+
+    return 0;
+  }
+
+  is_success = BuildSeeds(seeds, &num_seeds);
+
+  if (!is_success) {
+    printf("Could not build the seed corpus.\n");
+  } else {
+    is_success = CheckSeeds(seeds, num_seeds);
+  }
+
+  if (is_success) {
+    if (argc > 2) {
+      is_success = WriteCorpus(argv[2], seeds, num_seeds);
+    } else if (argc > 1) {
+      printf("Usage: %s --write-corpus DIR\n", argv[0]);
+      is_success = 0;
+    } else {
+      is_success = Fuzz(seeds, num_seeds);
+    }
+  }
+
+  FreeSeeds(seeds, num_seeds);
+
+  return is_success ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+/*
+* The fuzz targets, and the entry point used by libFuzzer. This file
+* has no main, so that it can be linked either with libFuzzer or with
+* fuzz_driver.c, which runs the targets standalone or under AFL.
+*/
+
+#include "fuzz_parsers.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include <windows.h>
+
+#include "../include/file_buffer.h"
+#include "../include/game_info.h"
+#include "../src/buffer_detection.h"
+#include "../src/game_version.h"
+#include "../src/helper/version_resource.h"
+#include "../src/patch_helper/pe_header.h"
+
+static const wchar_t* const kStringNames[] = {
+  L"FileVersion",
+  L"ProductName"
+};
+
+void FuzzParsers_RunPeHeader(const unsigned char* data, size_t size) {
+  WORD machine;
+  IMAGE_NT_HEADERS nt_headers;
+
+  PeHeader_ParseMachine(&machine, data, size);
+  PeHeader_ParseNtHeaders(&nt_headers, data, size);
+}
+
+void FuzzParsers_RunVersionResource(
+    const unsigned char* data,
+    size_t size
+) {
+  VS_FIXEDFILEINFO file_info;
+  size_t i_string_name;
+  wchar_t* string_value;
+
+  VersionResource_ParseFileInfo(&file_info, data, size);
+
+  for (i_string_name = 0;
+      i_string_name < sizeof(kStringNames) / sizeof(kStringNames[0]);
+      i_string_name += 1) {
+    string_value = VersionResource_ExtractStringValue(
+        data,
+        size,
+        kStringNames[i_string_name],
+        wcslen(kStringNames[i_string_name])
+    );
+
+    free(string_value);
+  }
+}
+
+void FuzzParsers_RunBufferDetection(
+    const unsigned char* data,
+    size_t size
+) {
+  VS_FIXEDFILEINFO file_info;
+  struct KnowledgeFileBuffer storm_buffer;
+  struct KnowledgeGameDetection detection;
+  enum GameVersion game_version;
+
+  BufferDetection_ExtractFileInfo(data, size, &file_info);
+
+  storm_buffer.file_name = L"storm.dll";
+  storm_buffer.data = data;
+  storm_buffer.size = size;
+
+  BufferDetection_DetectGameVersion(
+      data,
+      size,
+      &storm_buffer,
+      1,
+      &detection,
+      &game_version
+  );
+}
+
+void FuzzParsers_RunAll(const unsigned char* data, size_t size) {
+  FuzzParsers_RunPeHeader(data, size);
+  FuzzParsers_RunVersionResource(data, size);
+  FuzzParsers_RunBufferDetection(data, size);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  FuzzParsers_RunAll(data, size);
+
+  return 0;
+}
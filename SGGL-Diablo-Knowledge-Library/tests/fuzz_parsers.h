@@ -0,0 +1,54 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#ifndef SGGLDKL_TESTS_FUZZ_PARSERS_H_
+#define SGGLDKL_TESTS_FUZZ_PARSERS_H_
+
+#include <stddef.h>
+
+/*
+* The fuzz targets for the parsing of untrusted files. Each one feeds
+* the input to a parser as a whole, and only returns if the parser did
+* not read out of bounds. The results are discarded.
+*/
+
+/* The input is the start of a PE file. */
+void FuzzParsers_RunPeHeader(const unsigned char* data, size_t size);
+
+/* The input is a VS_VERSIONINFO block. */
+void FuzzParsers_RunVersionResource(const unsigned char* data, size_t size);
+
+/* The input is a whole game file, which also stands in for storm.dll. */
+void FuzzParsers_RunBufferDetection(const unsigned char* data, size_t size);
+
+/* Runs every target on the input. */
+void FuzzParsers_RunAll(const unsigned char* data, size_t size);
+
+#endif /* SGGLDKL_TESTS_FUZZ_PARSERS_H_ */
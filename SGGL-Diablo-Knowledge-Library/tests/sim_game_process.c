@@ -0,0 +1,1070 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#include "sim_game_process.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sched.h>
+#include <unistd.h>
+#include <windows.h>
+
+#include "../src/helper/error_handling.h"
+#include "../src/patch_helper/entry_hijack_patch.h"
+#include "../src/patch_helper/shared_control_block.h"
+
+enum Constant {
+  STACK_SIZE = 0x1000,
+
+  /* The size of the first library path buffer of the payload. */
+  INITIAL_LIB_PATH_SIZE = 32,
+
+  /* The pseudo handle returned by GetCurrentThread. */
+  CURRENT_THREAD_PSEUDO_HANDLE = 0xFFFFFFFE,
+
+  FIRST_MODULE_ADDRESS = 0x10000000,
+  MODULE_ADDRESS_STRIDE = 0x10000,
+
+  MAX_PREEMPTION_MICROSECONDS = 200
+};
+
+static const DWORD kImageProtect = PAGE_EXECUTE_READ;
+static const DWORD kDataProtect = PAGE_READWRITE;
+
+/*
+* Finds the region holding every byte of the range. The mutex must be
+* held.
+*/
+static struct SimMemoryRegion* FindRegionLocked(
+    struct SimGameProcess* sim_game_process,
+    const void* address,
+    size_t size
+) {
+  size_t i_region;
+  struct SimMemoryRegion* region;
+  size_t region_start;
+  size_t range_start;
+
+  range_start = (size_t) address;
+
+  for (i_region = 0;
+      i_region < sim_game_process->num_regions;
+      i_region += 1) {
+    region = &sim_game_process->regions[i_region];
+    region_start = (size_t) region->address;
+
+    if (range_start >= region_start
+        && size <= region->size
+        && range_start - region_start <= region->size - size) {
+      return region;
+    }
+  }
+
+  return NULL;
+}
+
+static int AddRegionLocked(
+    struct SimGameProcess* sim_game_process,
+    unsigned char* address,
+    size_t size,
+    DWORD protect
+) {
+  struct SimMemoryRegion* region;
+
+  if (sim_game_process->num_regions >= SIM_GAME_PROCESS_MAX_REGIONS) {
+    return 0;
+  }
+
+  region = &sim_game_process->regions[sim_game_process->num_regions];
+  region->address = address;
+  region->size = size;
+  region->protect = protect;
+
+  sim_game_process->num_regions += 1;
+
+  return 1;
+}
+
+static void RemoveRegionLocked(
+    struct SimGameProcess* sim_game_process,
+    const void* address
+) {
+  size_t i_region;
+
+  for (i_region = 0;
+      i_region < sim_game_process->num_regions;
+      i_region += 1) {
+    if (sim_game_process->regions[i_region].address == address) {
+      sim_game_process->num_regions -= 1;
+      sim_game_process->regions[i_region] =
+          sim_game_process->regions[sim_game_process->num_regions];
+
+      return;
+    }
+  }
+}
+
+/* Emulates VirtualAlloc in the game process. */
+static void* AllocateData(
+    struct SimGameProcess* sim_game_process,
+    size_t size
+) {
+  unsigned char* data;
+  int is_add_region_success;
+
+  data = calloc(size, 1);
+
+  if (data == NULL) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+  is_add_region_success = AddRegionLocked(
+      sim_game_process,
+      data,
+      size,
+      kDataProtect
+  );
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  if (!is_add_region_success) {
+    free(data);
+    return NULL;
+  }
+
+  return data;
+}
+
+/* Emulates VirtualFree in the game process. */
+static void FreeData(
+    struct SimGameProcess* sim_game_process,
+    void* data
+) {
+  pthread_mutex_lock(&sim_game_process->mutex);
+  RemoveRegionLocked(sim_game_process, data);
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  free(data);
+}
+
+static void Preempt(struct SimGameProcess* sim_game_process) {
+  unsigned int choice;
+
+  choice = rand_r(&sim_game_process->preemption_seed) % 4;
+
+  switch (choice) {
+    case 0: {
+      break;
+    }
+
+    case 1: {
+      sched_yield();
+      break;
+    }
+
+    default: {
+      usleep(
+          rand_r(&sim_game_process->preemption_seed)
+              % MAX_PREEMPTION_MICROSECONDS
+      );
+
+      break;
+    }
+  }
+}
+
+/*
+* A point where the main thread can be stopped. Blocks while the thread
+* is suspended. Returns zero if the process is terminating.
+*/
+static int CheckSuspendPoint(struct SimGameProcess* sim_game_process) {
+  int is_running;
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+
+  while (sim_game_process->suspend_count > 0
+      && !sim_game_process->is_terminating) {
+    pthread_cond_wait(
+        &sim_game_process->condition,
+        &sim_game_process->mutex
+    );
+  }
+
+  is_running = !sim_game_process->is_terminating;
+
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  if (is_running && sim_game_process->is_preemption_enabled) {
+    Preempt(sim_game_process);
+  }
+
+  return is_running;
+}
+
+/* Emulates SuspendThread on the current thread. */
+static int SuspendSelf(struct SimGameProcess* sim_game_process) {
+  pthread_mutex_lock(&sim_game_process->mutex);
+  sim_game_process->suspend_count += 1;
+  sim_game_process->num_self_suspends += 1;
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  return CheckSuspendPoint(sim_game_process);
+}
+
+/*
+* Waits for SGGL in the same way as the payload, by suspending itself,
+* or by parking in the shared control block if it is used.
+*/
+static int Park(
+    struct SimGameProcess* sim_game_process,
+    struct SharedControlBlock* shared_control_block
+) {
+  LONG park_count;
+
+  if (shared_control_block == NULL) {
+    return SuspendSelf(sim_game_process);
+  }
+
+  park_count = InterlockedIncrement(&shared_control_block->park_count);
+
+  while (shared_control_block->release_count != park_count) {
+    if (!CheckSuspendPoint(sim_game_process)) {
+      return 0;
+    }
+
+    Sleep(0);
+  }
+
+  return 1;
+}
+
+static int IsPatchApplied(
+    struct SimGameProcess* sim_game_process,
+    const struct PatchImage* patch_image
+) {
+  int is_applied;
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+  is_applied = memcmp(
+      patch_image->position,
+      patch_image->patch_buffer,
+      patch_image->buffer_size
+  ) == 0;
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  return is_applied;
+}
+
+static int IsPatchRemoved(
+    struct SimGameProcess* sim_game_process,
+    const struct PatchImage* patch_image
+) {
+  size_t offset;
+  int is_removed;
+
+  offset = (unsigned char*) patch_image->position
+      - sim_game_process->image;
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+  is_removed = memcmp(
+      patch_image->position,
+      &sim_game_process->original_image[offset],
+      patch_image->buffer_size
+  ) == 0;
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  return is_removed;
+}
+
+/*
+* Emulates the call to LoadLibraryW or LoadLibraryA, which records the
+* path instead of loading it.
+*/
+static void LoadLibraryFromPath(
+    struct SimGameProcess* sim_game_process,
+    volatile struct StackData* stack_data
+) {
+  size_t i_load;
+  wchar_t* loaded_path;
+  size_t lib_path_len;
+  HMODULE lib_module;
+  DWORD lib_last_error;
+
+  i_load = sim_game_process->num_loads;
+
+  if (i_load < SIM_GAME_PROCESS_MAX_LOADS) {
+    loaded_path = sim_game_process->loaded_paths[i_load];
+
+    if (stack_data->LoadLibraryW_ptr != NULL) {
+      lib_path_len = stack_data->lib_path_size / sizeof(wchar_t);
+
+      if (lib_path_len > MAX_PATH - 1) {
+        lib_path_len = MAX_PATH - 1;
+      }
+
+      wcsncpy(loaded_path, stack_data->lib_path, lib_path_len);
+      loaded_path[lib_path_len] = L'\0';
+    } else {
+      MultiByteToWideChar(
+          CP_ACP,
+          0,
+          stack_data->lib_path,
+          -1,
+          loaded_path,
+          MAX_PATH
+      );
+      loaded_path[MAX_PATH - 1] = L'\0';
+    }
+  }
+
+  if (i_load == sim_game_process->i_failing_load) {
+    lib_module = NULL;
+    lib_last_error = ERROR_MOD_NOT_FOUND;
+  } else {
+    lib_module = (HMODULE) (size_t) (
+        FIRST_MODULE_ADDRESS + i_load * MODULE_ADDRESS_STRIDE
+    );
+    lib_last_error = ERROR_SUCCESS;
+  }
+
+  if (i_load < SIM_GAME_PROCESS_MAX_LOADS) {
+    sim_game_process->loaded_modules[i_load] = lib_module;
+  }
+
+  sim_game_process->num_loads += 1;
+
+  stack_data->lib_module = lib_module;
+  stack_data->lib_last_error = lib_last_error;
+  stack_data->lib_load_end_tick = GetTickCount();
+
+  if (sim_game_process->is_cancel_requested != NULL
+      && sim_game_process->num_loads
+          == sim_game_process->num_loads_before_cancel) {
+    InterlockedExchange(sim_game_process->is_cancel_requested, 1);
+  }
+}
+
+/*
+* Emulates the payload, from the call made by the entry hijack patch up
+* to the jump into the cleanup. Returns zero if the process is
+* terminating.
+*/
+static int RunPayload(struct SimGameProcess* sim_game_process) {
+  const struct InjectorPatchImages* patch_images;
+  volatile struct StackData* stack_data;
+  struct SharedControlBlock* shared_control_block;
+  unsigned char* free_space_address;
+
+  patch_images = sim_game_process->patch_images;
+  stack_data = sim_game_process->stack_data;
+  shared_control_block = NULL;
+
+  sim_game_process->is_payload_run = 1;
+
+  /*
+  * The entry hijack patch pushes the address of its free space, where
+  * the payload stores the address of its stack data.
+  */
+  pthread_mutex_lock(&sim_game_process->mutex);
+  memcpy(
+      &free_space_address,
+      (unsigned char*) patch_images->entry_hijack_image.position + 1,
+      sizeof(free_space_address)
+  );
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  stack_data->is_ready_to_execute = 0;
+  __sync_synchronize();
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+  memcpy(free_space_address, &stack_data, sizeof(stack_data));
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  while (!stack_data->is_ready_to_execute) {
+    if (!CheckSuspendPoint(sim_game_process)) {
+      return 0;
+    }
+
+    sched_yield();
+  }
+
+  stack_data->is_lib_resize_needed = 1;
+  stack_data->is_ready_to_exit = 0;
+  stack_data->current_thread_handle = CURRENT_THREAD_PSEUDO_HANDLE;
+  stack_data->lib_path_size = INITIAL_LIB_PATH_SIZE;
+  stack_data->shared_control_block = NULL;
+
+  /*
+  * If SGGL has shared a mapping, then the stack data is moved into it,
+  * and the payload announces whether that worked by suspending itself
+  * once.
+  */
+  if (stack_data->shared_mapping_handle != NULL) {
+    shared_control_block = MapViewOfFile(
+        stack_data->shared_mapping_handle,
+        FILE_MAP_WRITE,
+        0,
+        0,
+        0
+    );
+
+    if (shared_control_block != NULL) {
+      stack_data->shared_control_block = shared_control_block;
+      memcpy(
+          &shared_control_block->stack_data,
+          (const void*) stack_data,
+          sizeof(shared_control_block->stack_data)
+      );
+
+      stack_data = &shared_control_block->stack_data;
+      sim_game_process->is_shared_control_block_used = 1;
+    }
+
+    if (!SuspendSelf(sim_game_process)) {
+      return 0;
+    }
+  }
+
+  for (;;) {
+    stack_data->lib_path = AllocateData(
+        sim_game_process,
+        stack_data->lib_path_size
+    );
+    sim_game_process->num_path_allocations += 1;
+    stack_data->is_lib_resize_needed = 0;
+
+    do {
+      if (!Park(sim_game_process, shared_control_block)) {
+        return 0;
+      }
+
+      if (stack_data->is_lib_resize_needed) {
+        break;
+      }
+
+      if (stack_data->num_libs == 0) {
+        goto end;
+      }
+
+      stack_data->lib_load_start_tick = GetTickCount();
+      LoadLibraryFromPath(sim_game_process, stack_data);
+      stack_data->num_libs -= 1;
+    } while (1);
+
+    FreeData(sim_game_process, stack_data->lib_path);
+    stack_data->lib_path_size *= 2;
+  }
+
+end:
+  FreeData(sim_game_process, stack_data->lib_path);
+
+  if (shared_control_block != NULL) {
+    UnmapViewOfFile(shared_control_block);
+  }
+
+  return 1;
+}
+
+/*
+* Emulates the cleanup at the entry point, which suspends the thread
+* so that SGGL can remove the patches, then pops the stack data and
+* returns to the position of the entry hijack patch.
+*/
+static int RunCleanup(struct SimGameProcess* sim_game_process) {
+  const struct InjectorPatchImages* patch_images;
+
+  patch_images = sim_game_process->patch_images;
+
+  if (!CheckSuspendPoint(sim_game_process)) {
+    return 0;
+  }
+
+  sim_game_process->is_cleanup_run = IsPatchApplied(
+      sim_game_process,
+      &patch_images->cleanup_image
+  );
+
+  if (!SuspendSelf(sim_game_process)) {
+    return 0;
+  }
+
+  /* The game's code reuses the stack once the stack data is popped. */
+  pthread_mutex_lock(&sim_game_process->mutex);
+  memset(
+      sim_game_process->stack_data,
+      0xCC,
+      sizeof(*sim_game_process->stack_data)
+  );
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  return 1;
+}
+
+static void* RunMainThread(void* parameter) {
+  struct SimGameProcess* sim_game_process;
+  const struct InjectorPatchImages* patch_images;
+
+  sim_game_process = parameter;
+  patch_images = sim_game_process->patch_images;
+
+  if (!CheckSuspendPoint(sim_game_process)) {
+    goto exit_process;
+  }
+
+  if (IsPatchApplied(sim_game_process, &patch_images->entry_hijack_image)) {
+    if (!IsPatchApplied(sim_game_process, &patch_images->payload_image)) {
+      goto exit_process;
+    }
+
+    if (!RunPayload(sim_game_process)) {
+      goto exit_process;
+    }
+
+    if (!RunCleanup(sim_game_process)) {
+      goto exit_process;
+    }
+
+    sim_game_process->is_game_code_restored =
+        IsPatchRemoved(sim_game_process, &patch_images->entry_hijack_image)
+            && IsPatchRemoved(sim_game_process, &patch_images->payload_image);
+  }
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+  sim_game_process->is_game_running = 1;
+  pthread_cond_broadcast(&sim_game_process->condition);
+
+  /* The game runs until it is terminated. */
+  while (!sim_game_process->is_terminating) {
+    pthread_cond_wait(
+        &sim_game_process->condition,
+        &sim_game_process->mutex
+    );
+  }
+
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+exit_process:
+  CompatProcess_Exit(sim_game_process->process_info.hProcess, 0);
+
+  return NULL;
+}
+
+static int SimReadMemory(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    const void* address,
+    void* buffer,
+    size_t size,
+    size_t* num_bytes_read
+) {
+  struct SimGameProcess* sim_game_process;
+  struct SimMemoryRegion* region;
+
+  sim_game_process = context;
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+
+  sim_game_process->counters.num_reads += 1;
+  region = FindRegionLocked(sim_game_process, address, size);
+
+  if (region != NULL) {
+    memcpy(buffer, address, size);
+  }
+
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  if (num_bytes_read != NULL) {
+    *num_bytes_read = (region != NULL) ? size : 0;
+  }
+
+  if (region == NULL) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"ReadProcessMemory",
+        ERROR_PARTIAL_COPY
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+static int SimWriteMemory(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* address,
+    const void* buffer,
+    size_t size,
+    size_t* num_bytes_written
+) {
+  struct SimGameProcess* sim_game_process;
+  struct SimMemoryRegion* region;
+
+  sim_game_process = context;
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+
+  sim_game_process->counters.num_writes += 1;
+  region = FindRegionLocked(sim_game_process, address, size);
+
+  if (region != NULL) {
+    memcpy(address, buffer, size);
+  }
+
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  if (num_bytes_written != NULL) {
+    *num_bytes_written = (region != NULL) ? size : 0;
+  }
+
+  if (region == NULL) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"WriteProcessMemory",
+        ERROR_PARTIAL_COPY
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+/* The protection is tracked for each region as a whole. */
+static int SimProtectMemory(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* address,
+    size_t size,
+    DWORD new_protect,
+    DWORD* old_protect
+) {
+  struct SimGameProcess* sim_game_process;
+  struct SimMemoryRegion* region;
+
+  sim_game_process = context;
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+
+  sim_game_process->counters.num_protects += 1;
+  region = FindRegionLocked(sim_game_process, address, size);
+
+  if (region != NULL) {
+    *old_protect = region->protect;
+    region->protect = new_protect;
+  }
+
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  if (region == NULL) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"VirtualProtectEx",
+        ERROR_INVALID_ADDRESS
+    );
+
+    return 0;
+  }
+
+  return 1;
+}
+
+static int SimSuspendThread(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    DWORD* previous_suspend_count
+) {
+  struct SimGameProcess* sim_game_process;
+
+  sim_game_process = context;
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+
+  sim_game_process->counters.num_suspends += 1;
+  *previous_suspend_count = sim_game_process->suspend_count;
+  sim_game_process->suspend_count += 1;
+
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  return 1;
+}
+
+static int SimResumeThread(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    DWORD* previous_suspend_count
+) {
+  struct SimGameProcess* sim_game_process;
+
+  sim_game_process = context;
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+
+  sim_game_process->counters.num_resumes += 1;
+  *previous_suspend_count = sim_game_process->suspend_count;
+
+  if (sim_game_process->suspend_count > 0) {
+    sim_game_process->suspend_count -= 1;
+  }
+
+  if (sim_game_process->suspend_count == 0) {
+    pthread_cond_broadcast(&sim_game_process->condition);
+  }
+
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  return 1;
+}
+
+/*
+* Only the entry hijack strategy is simulated, so the operations that
+* are only used by the other strategies fail as they do on Windows 9X.
+*/
+static int FailUnsupported(
+    struct SimGameProcess* sim_game_process,
+    const wchar_t* function_name
+) {
+  pthread_mutex_lock(&sim_game_process->mutex);
+  sim_game_process->counters.num_unsupported_calls += 1;
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  RecordWindowsFunctionFailureWithLastError(
+      function_name,
+      ERROR_CALL_NOT_IMPLEMENTED
+  );
+
+  return 0;
+}
+
+static int SimAllocateMemory(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* min_address,
+    size_t size,
+    DWORD protect,
+    void** address
+) {
+  return FailUnsupported(context, L"VirtualAllocEx");
+}
+
+static int SimFreeMemory(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* address
+) {
+  return FailUnsupported(context, L"VirtualFreeEx");
+}
+
+static int SimQueueApc(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* func,
+    ULONG_PTR param
+) {
+  return FailUnsupported(context, L"QueueUserAPC");
+}
+
+static int SimRunThread(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    void* func,
+    void* param,
+    DWORD* exit_code
+) {
+  return FailUnsupported(context, L"CreateRemoteThread");
+}
+
+/* The process handle is signaled once the main thread exits. */
+static int SimWaitForExit(
+    void* context,
+    const PROCESS_INFORMATION* process_info,
+    DWORD timeout_milliseconds,
+    int* is_exited
+) {
+  struct SimGameProcess* sim_game_process;
+  DWORD wait_result;
+
+  sim_game_process = context;
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+  sim_game_process->counters.num_exit_waits += 1;
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  wait_result = WaitForSingleObject(
+      process_info->hProcess,
+      timeout_milliseconds
+  );
+
+  if (wait_result == WAIT_FAILED) {
+    RecordWindowsFunctionFailureWithLastError(
+        L"WaitForSingleObject",
+        GetLastError()
+    );
+
+    return 0;
+  }
+
+  *is_exited = (wait_result == WAIT_OBJECT_0);
+
+  return 1;
+}
+
+static const struct RemoteProcessOps kSimRemoteProcessOps = {
+  &SimReadMemory,
+  &SimWriteMemory,
+  &SimProtectMemory,
+  &SimSuspendThread,
+  &SimResumeThread,
+  &SimAllocateMemory,
+  &SimFreeMemory,
+  &SimQueueApc,
+  &SimRunThread,
+  &SimWaitForExit
+};
+
+static void InitPeHeader(
+    struct SimGameProcess* sim_game_process,
+    const wchar_t* game_file_path
+) {
+  IMAGE_NT_HEADERS* nt_headers;
+
+  memset(&sim_game_process->pe_header, 0, sizeof(sim_game_process->pe_header));
+
+  sim_game_process->pe_header.file_path = (wchar_t*) game_file_path;
+  sim_game_process->pe_header.file_path_len = wcslen(game_file_path);
+
+  nt_headers = &sim_game_process->pe_header.nt_headers;
+  nt_headers->Signature = IMAGE_NT_SIGNATURE;
+  nt_headers->FileHeader.Machine = IMAGE_FILE_MACHINE_I386;
+  nt_headers->FileHeader.Characteristics = IMAGE_FILE_EXECUTABLE_IMAGE
+      | IMAGE_FILE_32BIT_MACHINE;
+  nt_headers->OptionalHeader.Magic = IMAGE_NT_OPTIONAL_HDR32_MAGIC;
+  nt_headers->OptionalHeader.ImageBase =
+      (DWORD) (size_t) sim_game_process->image;
+  nt_headers->OptionalHeader.AddressOfEntryPoint =
+      SIM_GAME_PROCESS_ENTRY_POINT_OFFSET;
+  nt_headers->OptionalHeader.SizeOfImage = SIM_GAME_PROCESS_IMAGE_SIZE;
+}
+
+struct SimGameProcess* SimGameProcess_Init(
+    struct SimGameProcess* sim_game_process,
+    const wchar_t* game_file_path
+) {
+  void* image;
+  size_t i_byte;
+  unsigned char* stack;
+
+  memset(sim_game_process, 0, sizeof(*sim_game_process));
+
+  sim_game_process->i_failing_load = (size_t) -1;
+  sim_game_process->suspend_count = SIM_GAME_PROCESS_INITIAL_SUSPEND_COUNT;
+
+  image = mmap(
+      NULL,
+      SIM_GAME_PROCESS_IMAGE_SIZE,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT,
+      -1,
+      0
+  );
+
+  if (image == MAP_FAILED) {
+    return NULL;
+  }
+
+  sim_game_process->image = image;
+
+  /* Any pattern will do for the game's code, as long as it is known. */
+  for (i_byte = 0; i_byte < SIM_GAME_PROCESS_IMAGE_SIZE; i_byte += 1) {
+    sim_game_process->image[i_byte] = (unsigned char) (i_byte * 7 + 1);
+  }
+
+  sim_game_process->original_image = malloc(SIM_GAME_PROCESS_IMAGE_SIZE);
+
+  if (sim_game_process->original_image == NULL) {
+    goto unmap_image;
+  }
+
+  memcpy(
+      sim_game_process->original_image,
+      sim_game_process->image,
+      SIM_GAME_PROCESS_IMAGE_SIZE
+  );
+
+  stack = calloc(STACK_SIZE, 1);
+
+  if (stack == NULL) {
+    goto free_original_image;
+  }
+
+  /* The stack data is at the top of the stack, as pushed by pushad. */
+  sim_game_process->stack_data = (struct StackData*) (
+      stack + STACK_SIZE - sizeof(struct StackData)
+  );
+
+  AddRegionLocked(
+      sim_game_process,
+      sim_game_process->image,
+      SIM_GAME_PROCESS_IMAGE_SIZE,
+      kImageProtect
+  );
+  AddRegionLocked(sim_game_process, stack, STACK_SIZE, kDataProtect);
+
+  InitPeHeader(sim_game_process, game_file_path);
+
+  sim_game_process->process_info.hProcess = CompatProcess_Create();
+  sim_game_process->process_info.dwProcessId = GetCurrentProcessId();
+
+  pthread_mutex_init(&sim_game_process->mutex, NULL);
+  pthread_cond_init(&sim_game_process->condition, NULL);
+
+  return sim_game_process;
+
+free_original_image:
+  free(sim_game_process->original_image);
+
+unmap_image:
+  munmap(sim_game_process->image, SIM_GAME_PROCESS_IMAGE_SIZE);
+
+  return NULL;
+}
+
+void SimGameProcess_Deinit(struct SimGameProcess* sim_game_process) {
+  size_t i_region;
+  unsigned char* address;
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+  sim_game_process->is_terminating = 1;
+  pthread_cond_broadcast(&sim_game_process->condition);
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  if (sim_game_process->is_main_thread_started) {
+    pthread_join(sim_game_process->main_thread, NULL);
+  }
+
+  /* The stack and any path buffer left by a terminated payload. */
+  for (i_region = 0;
+      i_region < sim_game_process->num_regions;
+      i_region += 1) {
+    address = sim_game_process->regions[i_region].address;
+
+    if (address != sim_game_process->image) {
+      free(address);
+    }
+  }
+
+  pthread_cond_destroy(&sim_game_process->condition);
+  pthread_mutex_destroy(&sim_game_process->mutex);
+
+  CloseHandle(sim_game_process->process_info.hProcess);
+
+  free(sim_game_process->original_image);
+  munmap(sim_game_process->image, SIM_GAME_PROCESS_IMAGE_SIZE);
+}
+
+int SimGameProcess_Start(
+    struct SimGameProcess* sim_game_process,
+    const struct InjectorPatchImages* patch_images
+) {
+  int create_result;
+
+  sim_game_process->patch_images = patch_images;
+
+  create_result = pthread_create(
+      &sim_game_process->main_thread,
+      NULL,
+      &RunMainThread,
+      sim_game_process
+  );
+
+  if (create_result != 0) {
+    return 0;
+  }
+
+  sim_game_process->is_main_thread_started = 1;
+
+  return 1;
+}
+
+int SimGameProcess_WaitForGame(
+    struct SimGameProcess* sim_game_process,
+    DWORD timeout_milliseconds
+) {
+  DWORD start_tick;
+  int is_game_running;
+
+  start_tick = GetTickCount();
+
+  for (;;) {
+    pthread_mutex_lock(&sim_game_process->mutex);
+    is_game_running = sim_game_process->is_game_running;
+    pthread_mutex_unlock(&sim_game_process->mutex);
+
+    if (is_game_running) {
+      return 1;
+    }
+
+    if (GetTickCount() - start_tick >= timeout_milliseconds) {
+      return 0;
+    }
+
+    Sleep(1);
+  }
+}
+
+int SimGameProcess_IsImageOriginal(
+    const struct SimGameProcess* sim_game_process
+) {
+  return memcmp(
+      sim_game_process->image,
+      sim_game_process->original_image,
+      SIM_GAME_PROCESS_IMAGE_SIZE
+  ) == 0;
+}
+
+DWORD SimGameProcess_GetProtect(
+    struct SimGameProcess* sim_game_process,
+    const void* address
+) {
+  struct SimMemoryRegion* region;
+  DWORD protect;
+
+  pthread_mutex_lock(&sim_game_process->mutex);
+
+  region = FindRegionLocked(sim_game_process, address, 1);
+  protect = (region != NULL) ? region->protect : 0;
+
+  pthread_mutex_unlock(&sim_game_process->mutex);
+
+  return protect;
+}
+
+const struct RemoteProcessOps* SimGameProcess_GetRemoteProcessOps(void) {
+  return &kSimRemoteProcessOps;
+}
@@ -0,0 +1,200 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#ifndef SGGLDKL_TESTS_SIM_GAME_PROCESS_H_
+#define SGGLDKL_TESTS_SIM_GAME_PROCESS_H_
+
+#include <stddef.h>
+#include <pthread.h>
+#include <wchar.h>
+#include <windows.h>
+
+#include "../src/patch_helper/injector_patches.h"
+#include "../src/patch_helper/pe_header.h"
+#include "../src/patch_helper/remote_process.h"
+#include "../src/patch_helper/stack_data.h"
+
+/*
+* A simulated game process, for driving the injection without a game.
+* Its main thread is a host thread that emulates the state machine of
+* the payload in payload_patch.c and of the cleanup in cleanup_patch.c,
+* instead of running their x86 code. The process memory is host memory,
+* and the remote process operations only access the regions that the
+* process has mapped, in the same way that ReadProcessMemory fails on
+* unmapped pages.
+*
+* The main thread can only be stopped at the points where it checks its
+* suspend count. If preemption is enabled, then it also yields or sleeps
+* for a random time at each of those points, to vary the interleaving
+* with the injector.
+*/
+
+enum {
+  SIM_GAME_PROCESS_IMAGE_SIZE = 0x4000,
+  SIM_GAME_PROCESS_ENTRY_POINT_OFFSET = 0x1000,
+  SIM_GAME_PROCESS_MAX_REGIONS = 8,
+  SIM_GAME_PROCESS_MAX_LOADS = 16,
+
+  /* The suspend count of a thread that was created suspended. */
+  SIM_GAME_PROCESS_INITIAL_SUSPEND_COUNT = 1
+};
+
+struct SimMemoryRegion {
+  unsigned char* address;
+  size_t size;
+  DWORD protect;
+};
+
+/*
+* The calls made to the remote process operations. Each call is one
+* round trip to the game process.
+*/
+struct SimRoundTripCounters {
+  size_t num_reads;
+  size_t num_writes;
+  size_t num_protects;
+  size_t num_suspends;
+  size_t num_resumes;
+  size_t num_exit_waits;
+  size_t num_unsupported_calls;
+};
+
+struct SimGameProcess {
+  PROCESS_INFORMATION process_info;
+
+  /*
+  * The image is placed below 4 GB, so that its base address fits in
+  * the PE header. The file path of the PE header is not owned.
+  */
+  unsigned char* image;
+  unsigned char* original_image;
+  struct PeHeader pe_header;
+
+  const struct InjectorPatchImages* patch_images;
+
+  /* The stack data on the stack of the main thread. */
+  struct StackData* stack_data;
+
+  /*
+  * The behavior of the process, which can be changed before it is
+  * started. The load with the index of i_failing_load fails with
+  * ERROR_MOD_NOT_FOUND. If is_cancel_requested is not NULL, then it is
+  * set once num_loads_before_cancel libraries have been loaded.
+  */
+  size_t i_failing_load;
+  size_t num_loads_before_cancel;
+  volatile LONG* is_cancel_requested;
+  int is_preemption_enabled;
+  unsigned int preemption_seed;
+
+  /*
+  * What the main thread has done. These are only read by the test
+  * once SimGameProcess_WaitForGame has returned.
+  */
+  wchar_t loaded_paths[SIM_GAME_PROCESS_MAX_LOADS][MAX_PATH];
+  HMODULE loaded_modules[SIM_GAME_PROCESS_MAX_LOADS];
+  size_t num_loads;
+  size_t num_path_allocations;
+  size_t num_self_suspends;
+  int is_payload_run;
+  int is_shared_control_block_used;
+  int is_cleanup_run;
+  int is_game_code_restored;
+  int is_game_running;
+
+  struct SimRoundTripCounters counters;
+
+  struct SimMemoryRegion regions[SIM_GAME_PROCESS_MAX_REGIONS];
+  size_t num_regions;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t condition;
+  pthread_t main_thread;
+  int is_main_thread_started;
+  DWORD suspend_count;
+  int is_terminating;
+};
+
+/*
+* Maps the image and the stack of the main thread, and sets up a PE
+* header for the image. Returns NULL on failure, in which case nothing
+* needs to be deinited. The game file path must outlive the process.
+*/
+struct SimGameProcess* SimGameProcess_Init(
+    struct SimGameProcess* sim_game_process,
+    const wchar_t* game_file_path
+);
+
+/*
+* Terminates the main thread if it is still running, then unmaps the
+* memory of the process.
+*/
+void SimGameProcess_Deinit(struct SimGameProcess* sim_game_process);
+
+/*
+* Starts the main thread, suspended, as a game is created for the
+* injection. The patch images must be built for the PE header of the
+* process, and must outlive it. Returns zero on failure.
+*/
+int SimGameProcess_Start(
+    struct SimGameProcess* sim_game_process,
+    const struct InjectorPatchImages* patch_images
+);
+
+/*
+* Waits until the main thread has returned to the game's code. Returns
+* zero if it did not within the timeout.
+*/
+int SimGameProcess_WaitForGame(
+    struct SimGameProcess* sim_game_process,
+    DWORD timeout_milliseconds
+);
+
+/* Returns nonzero if the image holds only the game's code. */
+int SimGameProcess_IsImageOriginal(
+    const struct SimGameProcess* sim_game_process
+);
+
+/*
+* The protection of the region holding the address, or zero if the
+* address is not mapped.
+*/
+DWORD SimGameProcess_GetProtect(
+    struct SimGameProcess* sim_game_process,
+    const void* address
+);
+
+/*
+* The operations on the simulated process, which take the simulated
+* process as their context.
+*/
+const struct RemoteProcessOps* SimGameProcess_GetRemoteProcessOps(void);
+
+#endif /* SGGLDKL_TESTS_SIM_GAME_PROCESS_H_ */
@@ -0,0 +1,126 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+/*
+* Stands in for the patch modules whose code is x86 assembly, so that
+* the injector can be linked on any host. The images hold marker bytes
+* instead of code, and the simulated game process emulates what the
+* code would have done once it finds the markers in its image.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <windows.h>
+
+#include "../src/patch_helper/cleanup_patch.h"
+#include "../src/patch_helper/load_library_thread.h"
+#include "../src/patch_helper/payload_patch.h"
+
+enum Constant {
+  CLEANUP_SIZE = 16,
+  PAYLOAD_SIZE = 256,
+  LOAD_LIBRARY_THREAD_CODE_SIZE = 64,
+
+  CLEANUP_MARKER = 0xC1,
+  PAYLOAD_MARKER = 0xFA,
+  LOAD_LIBRARY_THREAD_MARKER = 0x11
+};
+
+static struct PatchImage* InitMarkerImage(
+    struct PatchImage* patch_image,
+    void* position,
+    size_t size,
+    unsigned char marker
+) {
+  unsigned char marker_bytes[PAYLOAD_SIZE];
+
+  memset(marker_bytes, marker, size);
+
+  return PatchImage_Init(patch_image, position, size, marker_bytes);
+}
+
+struct PatchImage* CleanupPatch_InitImage(
+    struct PatchImage* cleanup_image,
+    void* (*patch_address)(void)
+) {
+  return InitMarkerImage(
+      cleanup_image,
+      (void*) patch_address,
+      CleanupPatch_GetSize(),
+      CLEANUP_MARKER
+  );
+}
+
+void CleanupPatch_DeinitImage(struct PatchImage* cleanup_image) {
+  PatchImage_Deinit(cleanup_image);
+}
+
+size_t CleanupPatch_GetSize(void) {
+  return CLEANUP_SIZE;
+}
+
+struct PatchImage* PayloadPatch_InitImage(
+    struct PatchImage* payload_image,
+    void* (*patch_address)(void),
+    void* (*cleanup_func_address)(void)
+) {
+  return InitMarkerImage(
+      payload_image,
+      (void*) patch_address,
+      PayloadPatch_GetSize(),
+      PAYLOAD_MARKER
+  );
+}
+
+void PayloadPatch_DeinitImage(struct PatchImage* payload_image) {
+  PatchImage_Deinit(payload_image);
+}
+
+size_t PayloadPatch_GetSize(void) {
+  return PAYLOAD_SIZE;
+}
+
+int LoadLibraryThread_InitFuncs(struct LoadLibraryThreadData* data) {
+  memset(data, 0, sizeof(*data));
+
+  return 0;
+}
+
+const unsigned char* LoadLibraryThread_GetCode(void) {
+  static unsigned char code[LOAD_LIBRARY_THREAD_CODE_SIZE];
+
+  memset(code, LOAD_LIBRARY_THREAD_MARKER, sizeof(code));
+
+  return code;
+}
+
+size_t LoadLibraryThread_GetCodeSize(void) {
+  return LOAD_LIBRARY_THREAD_CODE_SIZE;
+}
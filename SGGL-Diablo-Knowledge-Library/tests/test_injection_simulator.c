@@ -0,0 +1,542 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+/*
+* Tests the injection handshake against a simulated game process, over
+* both the stack and the shared memory transports.
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <wchar.h>
+#include <windows.h>
+
+#include "../include/injection_progress.h"
+#include "../include/injection_strategy.h"
+#include "../include/library_load_result.h"
+#include "../src/game_version.h"
+#include "../src/library_injector.h"
+#include "../src/patch_helper/injector_patches.h"
+#include "fixture_pe.h"
+#include "sim_game_process.h"
+#include "test_util.h"
+
+enum Constant {
+  NUM_LIBRARIES = 3,
+  NUM_PREEMPTED_ROUNDS = 20,
+  GAME_TIMEOUT_MILLISECONDS = 10000,
+
+  /* Long enough for the payload to grow its path buffer a few times. */
+  LONG_LIBRARY_NAME_LEN = 120
+};
+
+/* A game and its libraries, written to a temporary directory. */
+struct InjectionFixture {
+  char directory_path[64];
+
+  wchar_t game_file_path[MAX_PATH];
+  wchar_t library_paths[NUM_LIBRARIES][MAX_PATH];
+  const wchar_t* libraries[NUM_LIBRARIES];
+};
+
+/* The result of one injection into a simulated game process. */
+struct InjectionRun {
+  int is_inject_success;
+  int is_game_running;
+  int is_image_original;
+
+  struct InjectionStatus status;
+  struct KnowledgeLibraryLoadResult load_results[NUM_LIBRARIES];
+  DWORD entry_point_protect;
+};
+
+static struct InjectionFixture fixture;
+
+static int WriteFixtureFile(
+    const char* directory_path,
+    const char* file_name,
+    WORD characteristics,
+    wchar_t* file_path
+) {
+  struct FixturePeSpec spec;
+  unsigned char* file;
+  size_t file_size;
+  char path[MAX_PATH];
+  FILE* path_file;
+  size_t num_written;
+  size_t i_char;
+
+  FixturePeSpec_Init(&spec);
+  spec.characteristics = characteristics;
+
+  file = FixturePe_Build(&spec, &file_size);
+
+  if (file == NULL) {
+    return 0;
+  }
+
+  snprintf(path, sizeof(path), "%s/%s", directory_path, file_name);
+
+  path_file = fopen(path, "wb");
+  num_written = 0;
+
+  if (path_file != NULL) {
+    num_written = fwrite(file, 1, file_size, path_file);
+    fclose(path_file);
+  }
+
+  free(file);
+
+  for (i_char = 0; path[i_char] != '\0'; i_char += 1) {
+    file_path[i_char] = (wchar_t) path[i_char];
+  }
+
+  file_path[i_char] = L'\0';
+
+  return num_written == file_size;
+}
+
+static int InitFixture(void) {
+  char long_library_name[LONG_LIBRARY_NAME_LEN + 1];
+  size_t i_library;
+
+  strcpy(fixture.directory_path, "/tmp/sggldkl_injection_XXXXXX");
+
+  if (mkdtemp(fixture.directory_path) == NULL) {
+    return 0;
+  }
+
+  memset(long_library_name, 'l', LONG_LIBRARY_NAME_LEN - 4);
+  strcpy(&long_library_name[LONG_LIBRARY_NAME_LEN - 4], ".dll");
+
+  if (!WriteFixtureFile(
+      fixture.directory_path,
+      "Diablo.exe",
+      0,
+      fixture.game_file_path
+  )
+      || !WriteFixtureFile(
+          fixture.directory_path,
+          "first.dll",
+          IMAGE_FILE_DLL,
+          fixture.library_paths[0]
+      )
+      || !WriteFixtureFile(
+          fixture.directory_path,
+          long_library_name,
+          IMAGE_FILE_DLL,
+          fixture.library_paths[1]
+      )
+      || !WriteFixtureFile(
+          fixture.directory_path,
+          "third.dll",
+          IMAGE_FILE_DLL,
+          fixture.library_paths[2]
+      )) {
+    return 0;
+  }
+
+  for (i_library = 0; i_library < NUM_LIBRARIES; i_library += 1) {
+    fixture.libraries[i_library] = fixture.library_paths[i_library];
+  }
+
+  return 1;
+}
+
+static void DeinitFixture(void) {
+  char command[128];
+
+  snprintf(command, sizeof(command), "rm -rf %s", fixture.directory_path);
+  system(command);
+}
+
+static int InitSimGameProcess(struct SimGameProcess* sim_game_process) {
+  int is_init_success;
+
+  is_init_success = SimGameProcess_Init(
+      sim_game_process,
+      fixture.game_file_path
+  ) != NULL;
+
+  TEST_CHECK(is_init_success);
+
+  return is_init_success;
+}
+
+/*
+* Injects the libraries into the simulated game process, which must be
+* inited but not started, then waits for the game to run. The
+* simulated process is deinited before returning.
+*/
+static void Inject(
+    struct SimGameProcess* sim_game_process,
+    int is_shared_memory_transport_enabled,
+    const volatile LONG* is_cancel_requested,
+    struct InjectionRun* run
+) {
+  struct InjectorPatchImages patch_images;
+  struct LibraryInjector library_injector;
+
+  memset(run, 0, sizeof(*run));
+
+  TEST_CHECK(
+      InjectorPatchImages_Init(
+          &patch_images,
+          &sim_game_process->pe_header,
+          DIABLO_1_00
+      ) != NULL
+  );
+
+  LibraryInjector_Init(
+      &library_injector,
+      &sim_game_process->pe_header,
+      &patch_images,
+      DIABLO_1_00
+  );
+  LibraryInjector_SetSharedMemoryTransportEnabled(
+      &library_injector,
+      is_shared_memory_transport_enabled
+  );
+  LibraryInjector_SetReadAheadEnabled(&library_injector, 0);
+  LibraryInjector_SetInjectionStrategy(
+      &library_injector,
+      KNOWLEDGE_INJECTION_STRATEGY_ENTRY_HIJACK
+  );
+  LibraryInjector_SetRemoteProcessOps(
+      &library_injector,
+      SimGameProcess_GetRemoteProcessOps(),
+      sim_game_process
+  );
+
+  TEST_CHECK(SimGameProcess_Start(sim_game_process, &patch_images));
+
+  run->is_inject_success =
+      LibraryInjector_InjectLibrariesToProcessesWithStatus(
+          &library_injector,
+          &library_injector.settings,
+          fixture.libraries,
+          NUM_LIBRARIES,
+          &sim_game_process->process_info,
+          1,
+          &run->status,
+          run->load_results,
+          is_cancel_requested
+      );
+
+  run->is_game_running = SimGameProcess_WaitForGame(
+      sim_game_process,
+      GAME_TIMEOUT_MILLISECONDS
+  );
+  run->is_image_original = SimGameProcess_IsImageOriginal(sim_game_process);
+  run->entry_point_protect = SimGameProcess_GetProtect(
+      sim_game_process,
+      PeHeader_GetHardEntryPointAddress(&sim_game_process->pe_header)
+  );
+
+  LibraryInjector_Deinit(&library_injector);
+
+  /*
+  * The main thread still reads the images until it is terminated. Only
+  * the records of the simulated process are left for the test.
+  */
+  SimGameProcess_Deinit(sim_game_process);
+  InjectorPatchImages_Deinit(&patch_images);
+}
+
+/*
+* Checks that every library was loaded in order, and that the game was
+* left as it was before the injection.
+*/
+static void CheckCompleteInjection(
+    const struct SimGameProcess* sim_game_process,
+    const struct InjectionRun* run
+) {
+  size_t i_library;
+
+  TEST_CHECK(run->is_inject_success);
+  TEST_CHECK(run->is_game_running);
+  TEST_CHECK(run->status.phase == KNOWLEDGE_INJECTION_PHASE_COMPLETE);
+  TEST_CHECK(run->status.num_libs_loaded == NUM_LIBRARIES);
+
+  TEST_CHECK(sim_game_process->is_payload_run);
+  TEST_CHECK(sim_game_process->is_cleanup_run);
+  TEST_CHECK(sim_game_process->is_game_code_restored);
+  TEST_CHECK(sim_game_process->num_loads == NUM_LIBRARIES);
+  TEST_CHECK(run->is_image_original);
+  TEST_CHECK(run->entry_point_protect == PAGE_EXECUTE_READ);
+
+  for (i_library = 0; i_library < NUM_LIBRARIES; i_library += 1) {
+    TEST_CHECK(
+        wcscmp(
+            sim_game_process->loaded_paths[i_library],
+            fixture.libraries[i_library]
+        ) == 0
+    );
+
+    TEST_CHECK(run->load_results[i_library].is_attempted);
+    TEST_CHECK(
+        run->load_results[i_library].module
+            == sim_game_process->loaded_modules[i_library]
+    );
+    TEST_CHECK(
+        run->load_results[i_library].load_end_tick
+            - run->load_results[i_library].load_start_tick
+            < GAME_TIMEOUT_MILLISECONDS
+    );
+  }
+}
+
+static void TestInjectsThroughStack(void) {
+  struct SimGameProcess sim_game_process;
+  struct InjectionRun run;
+
+  if (!InitSimGameProcess(&sim_game_process)) {
+    return;
+  }
+
+  Inject(&sim_game_process, 0, NULL, &run);
+
+  CheckCompleteInjection(&sim_game_process, &run);
+  TEST_CHECK(!sim_game_process.is_shared_control_block_used);
+  TEST_CHECK(run.is_image_original);
+
+  /* The payload grows its path buffer for the long library name. */
+  TEST_CHECK(sim_game_process.num_path_allocations > 2);
+}
+
+static void TestInjectsThroughSharedMemory(void) {
+  struct SimGameProcess sim_game_process;
+  struct InjectionRun run;
+
+  if (!InitSimGameProcess(&sim_game_process)) {
+    return;
+  }
+
+  Inject(&sim_game_process, 1, NULL, &run);
+
+  CheckCompleteInjection(&sim_game_process, &run);
+  TEST_CHECK(sim_game_process.is_shared_control_block_used);
+  TEST_CHECK(run.is_image_original);
+
+  /*
+  * Parking in shared memory replaces the suspends of every library,
+  * so only the announcement and the cleanup suspend remain.
+  */
+  TEST_CHECK(sim_game_process.num_self_suspends == 2);
+}
+
+static void TestSharedMemoryTakesFewerRoundTrips(void) {
+  struct SimGameProcess stack_process;
+  struct SimGameProcess shared_process;
+  struct InjectionRun run;
+  size_t num_stack_round_trips;
+  size_t num_shared_round_trips;
+
+  if (!InitSimGameProcess(&stack_process)) {
+    return;
+  }
+
+  Inject(&stack_process, 0, NULL, &run);
+  TEST_CHECK(run.is_inject_success);
+
+  if (!InitSimGameProcess(&shared_process)) {
+    return;
+  }
+
+  Inject(&shared_process, 1, NULL, &run);
+  TEST_CHECK(run.is_inject_success);
+
+  /*
+  * The reads are left out, as most of them poll for the payload to
+  * start and for the stack to be reused, and so depend on scheduling.
+  */
+  num_stack_round_trips = stack_process.counters.num_writes
+      + stack_process.counters.num_suspends
+      + stack_process.counters.num_resumes;
+  num_shared_round_trips = shared_process.counters.num_writes
+      + shared_process.counters.num_suspends
+      + shared_process.counters.num_resumes;
+
+  TEST_CHECK(num_shared_round_trips < num_stack_round_trips);
+  TEST_CHECK(stack_process.counters.num_unsupported_calls == 0);
+  TEST_CHECK(shared_process.counters.num_unsupported_calls == 0);
+}
+
+static void TestRecordsFailedLoad(void) {
+  struct SimGameProcess sim_game_process;
+  struct InjectionRun run;
+
+  if (!InitSimGameProcess(&sim_game_process)) {
+    return;
+  }
+  sim_game_process.i_failing_load = 1;
+
+  Inject(&sim_game_process, 1, NULL, &run);
+
+  TEST_CHECK(run.is_inject_success);
+  TEST_CHECK(sim_game_process.num_loads == NUM_LIBRARIES);
+  TEST_CHECK(run.load_results[0].module != NULL);
+  TEST_CHECK(run.load_results[1].is_attempted);
+  TEST_CHECK(run.load_results[1].module == NULL);
+  TEST_CHECK(run.load_results[1].last_error == ERROR_MOD_NOT_FOUND);
+  TEST_CHECK(run.load_results[2].module != NULL);
+  TEST_CHECK(run.is_image_original);
+}
+
+static void TestCancelBeforeInjectionLoadsNothing(void) {
+  struct SimGameProcess sim_game_process;
+  struct InjectionRun run;
+  volatile LONG is_cancel_requested;
+
+  is_cancel_requested = 1;
+
+  if (!InitSimGameProcess(&sim_game_process)) {
+    return;
+  }
+
+  Inject(&sim_game_process, 1, &is_cancel_requested, &run);
+
+  TEST_CHECK(run.status.phase == KNOWLEDGE_INJECTION_PHASE_CANCELLED);
+  TEST_CHECK(run.is_game_running);
+  TEST_CHECK(sim_game_process.num_loads == 0);
+  TEST_CHECK(!run.load_results[0].is_attempted);
+  TEST_CHECK(sim_game_process.is_game_code_restored);
+  TEST_CHECK(run.is_image_original);
+}
+
+/*
+* The cancellation is requested while the first library loads. It is
+* checked before the injector waits for the payload to park, so the
+* second library may still be loaded, but never the third.
+*/
+static void TestCancelSkipsRemainingLibraries(void) {
+  static const int kIsSharedMemoryTransportEnabled[] = { 0, 1 };
+
+  struct SimGameProcess sim_game_process;
+  struct InjectionRun run;
+  volatile LONG is_cancel_requested;
+  size_t i_transport;
+  size_t i_library;
+
+  for (i_transport = 0;
+      i_transport < sizeof(kIsSharedMemoryTransportEnabled)
+          / sizeof(kIsSharedMemoryTransportEnabled[0]);
+      i_transport += 1) {
+    is_cancel_requested = 0;
+
+    if (!InitSimGameProcess(&sim_game_process)) {
+      return;
+    }
+
+    sim_game_process.is_cancel_requested = &is_cancel_requested;
+    sim_game_process.num_loads_before_cancel = 1;
+
+    Inject(
+        &sim_game_process,
+        kIsSharedMemoryTransportEnabled[i_transport],
+        &is_cancel_requested,
+        &run
+    );
+
+    TEST_CHECK(run.status.phase == KNOWLEDGE_INJECTION_PHASE_CANCELLED);
+    TEST_CHECK(run.is_game_running);
+    TEST_CHECK(sim_game_process.num_loads >= 1);
+    TEST_CHECK(sim_game_process.num_loads < NUM_LIBRARIES);
+    TEST_CHECK(sim_game_process.is_game_code_restored);
+    TEST_CHECK(run.is_image_original);
+
+    for (i_library = 0; i_library < NUM_LIBRARIES; i_library += 1) {
+      TEST_CHECK(
+          run.load_results[i_library].is_attempted
+              == (i_library < sim_game_process.num_loads)
+      );
+    }
+  }
+}
+
+/*
+* Preempts the main thread at random at every point where it could be
+* suspended, so that the handshake sees varied interleavings.
+*/
+static void TestHandshakeSurvivesPreemption(void) {
+  struct SimGameProcess sim_game_process;
+  struct InjectionRun run;
+  unsigned int i_round;
+
+  for (i_round = 0; i_round < NUM_PREEMPTED_ROUNDS; i_round += 1) {
+    if (!InitSimGameProcess(&sim_game_process)) {
+      return;
+    }
+    sim_game_process.is_preemption_enabled = 1;
+    sim_game_process.preemption_seed = i_round + 1;
+
+    Inject(&sim_game_process, i_round % 2, NULL, &run);
+
+    CheckCompleteInjection(&sim_game_process, &run);
+    TEST_CHECK(run.is_image_original);
+  }
+}
+
+int main(void) {
+  if (!InitFixture()) {
+    printf("Could not write the fixture files.\n");
+    return 1;
+  }
+
+  TestUtil_Run("InjectsThroughStack", &TestInjectsThroughStack);
+  TestUtil_Run(
+      "InjectsThroughSharedMemory",
+      &TestInjectsThroughSharedMemory
+  );
+  TestUtil_Run(
+      "SharedMemoryTakesFewerRoundTrips",
+      &TestSharedMemoryTakesFewerRoundTrips
+  );
+  TestUtil_Run("RecordsFailedLoad", &TestRecordsFailedLoad);
+  TestUtil_Run(
+      "CancelBeforeInjectionLoadsNothing",
+      &TestCancelBeforeInjectionLoadsNothing
+  );
+  TestUtil_Run(
+      "CancelSkipsRemainingLibraries",
+      &TestCancelSkipsRemainingLibraries
+  );
+  TestUtil_Run(
+      "HandshakeSurvivesPreemption",
+      &TestHandshakeSurvivesPreemption
+  );
+
+  DeinitFixture();
+
+  return TestUtil_Finish();
+}
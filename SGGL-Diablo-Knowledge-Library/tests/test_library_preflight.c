@@ -0,0 +1,201 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+
+/*
+* Tests that the preflight finds the libraries where the loader of the
+* game would, and not in the current directory of the caller.
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <wchar.h>
+#include <windows.h>
+
+#include "../include/library_preflight_result.h"
+#include "../src/library_preflight.h"
+#include "fixture_pe.h"
+#include "test_util.h"
+
+/*
+* The game and a library in one directory, and a stray library in
+* another directory, which is made the current directory.
+*/
+struct PreflightFixture {
+  char game_dir_path[64];
+  char current_dir_path[64];
+
+  wchar_t game_file_path[MAX_PATH];
+  wchar_t library_path[MAX_PATH];
+};
+
+static struct PreflightFixture fixture;
+
+static int WriteFixtureFile(
+    const char* directory_path,
+    const char* file_name,
+    WORD characteristics,
+    wchar_t* file_path
+) {
+  struct FixturePeSpec spec;
+  unsigned char* file;
+  size_t file_size;
+  char path[MAX_PATH];
+  FILE* path_file;
+  size_t num_written;
+  size_t i_char;
+
+  FixturePeSpec_Init(&spec);
+  spec.characteristics = characteristics;
+
+  file = FixturePe_Build(&spec, &file_size);
+
+  if (file == NULL) {
+    return 0;
+  }
+
+  snprintf(path, sizeof(path), "%s/%s", directory_path, file_name);
+
+  path_file = fopen(path, "wb");
+  num_written = 0;
+
+  if (path_file != NULL) {
+    num_written = fwrite(file, 1, file_size, path_file);
+    fclose(path_file);
+  }
+
+  free(file);
+
+  if (file_path != NULL) {
+    for (i_char = 0; path[i_char] != '\0'; i_char += 1) {
+      file_path[i_char] = (wchar_t) path[i_char];
+    }
+
+    file_path[i_char] = L'\0';
+  }
+
+  return num_written == file_size;
+}
+
+static int InitFixture(void) {
+  strcpy(fixture.game_dir_path, "/tmp/sggldkl_preflight_game_XXXXXX");
+  strcpy(fixture.current_dir_path, "/tmp/sggldkl_preflight_cwd_XXXXXX");
+
+  if (mkdtemp(fixture.game_dir_path) == NULL
+      || mkdtemp(fixture.current_dir_path) == NULL) {
+    return 0;
+  }
+
+  return WriteFixtureFile(
+      fixture.game_dir_path,
+      "Diablo.exe",
+      0,
+      fixture.game_file_path
+  )
+      && WriteFixtureFile(
+          fixture.game_dir_path,
+          "beside_game.dll",
+          IMAGE_FILE_DLL,
+          fixture.library_path
+      )
+      && WriteFixtureFile(
+          fixture.current_dir_path,
+          "stray.dll",
+          IMAGE_FILE_DLL,
+          NULL
+      )
+      && chdir(fixture.current_dir_path) == 0;
+}
+
+static void DeinitFixture(void) {
+  char command[160];
+
+  snprintf(
+      command,
+      sizeof(command),
+      "rm -rf %s %s",
+      fixture.game_dir_path,
+      fixture.current_dir_path
+  );
+  system(command);
+}
+
+static enum KnowledgeLibraryStatus CheckLibrary(const wchar_t* library) {
+  struct LibraryPreflightCache cache;
+  struct KnowledgeLibraryPreflight preflight;
+
+  LibraryPreflightCache_Init(&cache);
+
+  LibraryPreflight_CheckLibraries(
+      &cache,
+      fixture.game_file_path,
+      &library,
+      1,
+      0,
+      &preflight
+  );
+
+  LibraryPreflightCache_Deinit(&cache);
+
+  return preflight.status;
+}
+
+static void TestFindsAbsoluteLibrary(void) {
+  TEST_CHECK(CheckLibrary(fixture.library_path) == KNOWLEDGE_LIBRARY_VALID);
+}
+
+static void TestFindsBareLibraryInGameDirectory(void) {
+  TEST_CHECK(CheckLibrary(L"beside_game.dll") == KNOWLEDGE_LIBRARY_VALID);
+}
+
+static void TestIgnoresCurrentDirectory(void) {
+  TEST_CHECK(CheckLibrary(L"stray.dll") == KNOWLEDGE_LIBRARY_NOT_FOUND);
+}
+
+int main(void) {
+  if (!InitFixture()) {
+    printf("Could not write the fixture files.\n");
+    return 1;
+  }
+
+  TestUtil_Run("FindsAbsoluteLibrary", &TestFindsAbsoluteLibrary);
+  TestUtil_Run(
+      "FindsBareLibraryInGameDirectory",
+      &TestFindsBareLibraryInGameDirectory
+  );
+  TestUtil_Run("IgnoresCurrentDirectory", &TestIgnoresCurrentDirectory);
+
+  DeinitFixture();
+
+  return TestUtil_Finish();
+}
@@ -0,0 +1,228 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+/*
+* Tests the park and release protocol of the shared control block, with
+* a thread that parks in the same way as the payload.
+*/
+
+#include <stddef.h>
+#include <string.h>
+#include <windows.h>
+#include <process.h>
+
+#include "../include/error_detail.h"
+#include "../src/helper/error_handling.h"
+#include "../src/patch_helper/shared_control_block.h"
+#include "test_util.h"
+
+enum Constant {
+  NUM_HANDSHAKE_ROUNDS = 1000
+};
+
+struct PayloadThreadData {
+  struct SharedControlBlock* shared_control_block;
+  size_t num_rounds;
+};
+
+/*
+* Parks once per round. Between parks, the stack data is written in the
+* same way as the payload writes the load result of a library.
+*/
+static unsigned int __stdcall RunPayloadThread(void* parameter) {
+  struct PayloadThreadData* data;
+  struct SharedControlBlock* shared_control_block;
+  size_t i_round;
+  LONG park_count;
+
+  data = parameter;
+  shared_control_block = data->shared_control_block;
+
+  for (i_round = 0; i_round < data->num_rounds; i_round += 1) {
+    park_count = InterlockedIncrement(&shared_control_block->park_count);
+
+    while (shared_control_block->release_count != park_count) {
+      Sleep(0);
+    }
+
+    /* The value written by SGGL before the release must be visible. */
+    shared_control_block->stack_data.lib_last_error =
+        (DWORD) shared_control_block->stack_data.num_libs;
+  }
+
+  return 0;
+}
+
+static void TestHandshakeRounds(void) {
+  struct SharedControlBlockMapping mapping;
+  struct PayloadThreadData data;
+  PROCESS_INFORMATION process_info;
+  HANDLE payload_thread;
+  size_t i_round;
+  int is_park_success;
+
+  memset(&process_info, 0, sizeof(process_info));
+  process_info.hProcess = CompatProcess_Create();
+
+  TEST_CHECK(SharedControlBlockMapping_Init(&mapping, &process_info));
+  TEST_CHECK(mapping.shared_control_block->park_count == 0);
+  TEST_CHECK(mapping.shared_control_block->release_count == 0);
+
+  data.shared_control_block = mapping.shared_control_block;
+  data.num_rounds = NUM_HANDSHAKE_ROUNDS;
+
+  payload_thread = (HANDLE) _beginthreadex(
+      NULL,
+      0,
+      &RunPayloadThread,
+      &data,
+      0,
+      NULL
+  );
+
+  TEST_CHECK(payload_thread != NULL);
+
+  for (i_round = 0; i_round < NUM_HANDSHAKE_ROUNDS; i_round += 1) {
+    is_park_success = SharedControlBlock_WaitForPark(
+        mapping.shared_control_block,
+        process_info.hProcess
+    );
+
+    TEST_CHECK(is_park_success);
+
+    if (!is_park_success) {
+      break;
+    }
+
+    TEST_CHECK(
+        mapping.shared_control_block->park_count
+            == mapping.shared_control_block->release_count + 1
+    );
+
+    /* The payload's write from the previous round must be visible. */
+    if (i_round > 0) {
+      TEST_CHECK(
+          mapping.shared_control_block->stack_data.lib_last_error
+              == i_round - 1
+      );
+    }
+
+    mapping.shared_control_block->stack_data.num_libs = i_round;
+    SharedControlBlock_Release(mapping.shared_control_block);
+  }
+
+  TEST_CHECK(WaitForSingleObject(payload_thread, 10000) == WAIT_OBJECT_0);
+  TEST_CHECK(
+      mapping.shared_control_block->stack_data.lib_last_error
+          == NUM_HANDSHAKE_ROUNDS - 1
+  );
+
+  CloseHandle(payload_thread);
+
+  SharedControlBlockMapping_Deinit(&mapping);
+  TEST_CHECK(mapping.shared_control_block == NULL);
+  TEST_CHECK(mapping.remote_mapping_handle == NULL);
+
+  CloseHandle(process_info.hProcess);
+}
+
+static void TestWaitForParkReturnsWhenGameExits(void) {
+  struct SharedControlBlock shared_control_block;
+  struct KnowledgeErrorDetail error_detail;
+  HANDLE process_handle;
+
+  memset(&shared_control_block, 0, sizeof(shared_control_block));
+
+  process_handle = CompatProcess_Create();
+  CompatProcess_Exit(process_handle, 1);
+
+  ErrorHandling_ClearLastErrorDetail();
+
+  TEST_CHECK(
+      !SharedControlBlock_WaitForPark(&shared_control_block, process_handle)
+  );
+  TEST_CHECK(ErrorHandling_GetLastErrorDetail(&error_detail));
+  TEST_CHECK(error_detail.kind == KNOWLEDGE_ERROR_GENERAL);
+  TEST_CHECK(wcscmp(error_detail.caption, L"Game Exited") == 0);
+
+  CloseHandle(process_handle);
+}
+
+static void TestWaitForParkReturnsWhenWaitFails(void) {
+  struct SharedControlBlock shared_control_block;
+  struct KnowledgeErrorDetail error_detail;
+
+  memset(&shared_control_block, 0, sizeof(shared_control_block));
+
+  ErrorHandling_ClearLastErrorDetail();
+
+  TEST_CHECK(!SharedControlBlock_WaitForPark(&shared_control_block, NULL));
+  TEST_CHECK(ErrorHandling_GetLastErrorDetail(&error_detail));
+  TEST_CHECK(error_detail.kind == KNOWLEDGE_ERROR_WINDOWS_FUNCTION);
+  TEST_CHECK(error_detail.last_error == ERROR_INVALID_HANDLE);
+  TEST_CHECK(
+      wcscmp(error_detail.function_name, L"WaitForSingleObject") == 0
+  );
+}
+
+/* A payload that has already parked is not waited for. */
+static void TestWaitForParkDoesNotWaitWhenParked(void) {
+  struct SharedControlBlock shared_control_block;
+
+  memset(&shared_control_block, 0, sizeof(shared_control_block));
+  shared_control_block.park_count = 1;
+
+  TEST_CHECK(SharedControlBlock_WaitForPark(&shared_control_block, NULL));
+
+  SharedControlBlock_Release(&shared_control_block);
+  TEST_CHECK(shared_control_block.release_count == 1);
+}
+
+int main(void) {
+  ErrorHandling_Init();
+
+  TestUtil_Run("HandshakeRounds", &TestHandshakeRounds);
+  TestUtil_Run(
+      "WaitForParkReturnsWhenGameExits",
+      &TestWaitForParkReturnsWhenGameExits
+  );
+  TestUtil_Run(
+      "WaitForParkReturnsWhenWaitFails",
+      &TestWaitForParkReturnsWhenWaitFails
+  );
+  TestUtil_Run(
+      "WaitForParkDoesNotWaitWhenParked",
+      &TestWaitForParkDoesNotWaitWhenParked
+  );
+
+  ErrorHandling_Deinit();
+
+  return TestUtil_Finish();
+}
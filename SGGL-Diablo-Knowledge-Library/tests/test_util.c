@@ -0,0 +1,69 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#include "test_util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int num_test_failures = 0;
+static int num_failed_tests = 0;
+static int num_tests = 0;
+
+void TestUtil_RecordFailure(
+    const char* condition,
+    const char* file_name,
+    int line
+) {
+  fprintf(stderr, "%s:%d: check failed: %s\n", file_name, line, condition);
+
+  num_test_failures += 1;
+}
+
+void TestUtil_Run(const char* test_name, void (*test_func)(void)) {
+  num_test_failures = 0;
+
+  test_func();
+
+  num_tests += 1;
+
+  if (num_test_failures == 0) {
+    printf("PASS %s\n", test_name);
+  } else {
+    printf("FAIL %s\n", test_name);
+    num_failed_tests += 1;
+  }
+}
+
+int TestUtil_Finish(void) {
+  printf("%d of %d tests passed.\n", num_tests - num_failed_tests, num_tests);
+
+  return (num_failed_tests == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
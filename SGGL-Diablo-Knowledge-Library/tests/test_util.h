@@ -0,0 +1,57 @@
+/**
+ * SlashGaming Game Loader - Diablo Knowledge Library
+ * Copyright (C) 2020  Mir Drualga
+ *
+ * This file is part of SlashGaming Game Loader - Diablo Knowledge Library.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Additional permissions under GNU Affero General Public License version 3
+ *  section 7
+ *
+ *  If you modify this Program, or any covered work, by linking or combining
+ *  it with any program (or a modified version of that program and its
+ *  libraries), containing parts covered by the terms of an incompatible
+ *  license, the licensors of this Program grant you additional permission
+ *  to convey the resulting work.
+ */
+
+
+#ifndef SGGLDKL_TESTS_TEST_UTIL_H_
+#define SGGLDKL_TESTS_TEST_UTIL_H_
+
+#include <stddef.h>
+
+/*
+* Checks a condition, reporting the failure and continuing the test if
+* it does not hold.
+*/
+#define TEST_CHECK(condition) \
+    ((condition) \
+        ? (void) 0 \
+        : TestUtil_RecordFailure(#condition, __FILE__, __LINE__))
+
+void TestUtil_RecordFailure(
+    const char* condition,
+    const char* file_name,
+    int line
+);
+
+/* Runs the test function, then reports whether its checks passed. */
+void TestUtil_Run(const char* test_name, void (*test_func)(void));
+
+/* Returns the exit status of the test program. */
+int TestUtil_Finish(void);
+
+#endif /* SGGLDKL_TESTS_TEST_UTIL_H_ */